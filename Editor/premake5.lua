@@ -58,7 +58,8 @@ project "ForgeEditor"
 
         links 
         {
-            "stdc++fs"
+            "stdc++fs",
+            "pthread"
         }
 
     filter "system:macosx"
@@ -31,21 +31,10 @@ namespace Editor
 
 		Input::OnMouseClicked.AddEventListener([&](MouseButton button)
 		{
-			if (button == MouseButton::Left && m_ViewportFocused)
+			glm::vec2 position;
+			if (button == MouseButton::Left && m_ViewportFocused && GetViewportMousePosition(position))
 			{
-				ImVec2 position = ImGui::GetMousePos();
-				position.x -= m_ViewportBounds[0].x;
-				position.y -= m_ViewportBounds[0].y;
-				glm::vec2 viewportSize = m_ViewportBounds[1] - m_ViewportBounds[0];
-				position.y = viewportSize.y - position.y;
-				if (position.x >= 0 && position.x < viewportSize.x && position.y >= 0 && position.y < viewportSize.y)
-				{
-					Viewport cameraViewport = m_Camera.GetComponent<CameraComponent>().Viewport;
-					position.x = position.x * cameraViewport.Width / viewportSize.x;
-					position.y = position.y * cameraViewport.Height / viewportSize.y;
-					Entity pickedEntity = m_Scene->PickEntity({ position.x, position.y }, m_Camera);
-					m_SceneHierarchy.SetSelectedEntity(pickedEntity);
-				}
+				m_ClickPick = m_Scene->PickEntityAsync(position, m_Camera);
 			}
 			return false;
 		});
@@ -64,6 +53,29 @@ namespace Editor
 			m_Camera.GetComponent<CameraComponent>().Frustum = Frustum::Perspective(PI / 3.0f, m_ViewportSize.x / m_ViewportSize.y, 0.01f, 1000.0f);
 		}
 
+		if (m_ClickPick && m_ClickPick->IsReady())
+		{
+			m_SceneHierarchy.SetSelectedEntity(m_ClickPick->GetResult().Entity);
+			m_ClickPick = nullptr;
+		}
+
+		// Only one hover pick is in flight at a time, a new one is issued once the last one has resolved
+		if (!m_HoverPick || m_HoverPick->IsReady())
+		{
+			if (m_HoverPick)
+				m_SceneHierarchy.SetHoveredEntity(m_HoverPick->GetResult().Entity);
+			glm::vec2 position;
+			if (m_ViewportHovered && GetViewportMousePosition(position))
+			{
+				m_HoverPick = m_Scene->PickEntityAsync(position, m_Camera);
+			}
+			else
+			{
+				m_HoverPick = nullptr;
+				m_SceneHierarchy.SetHoveredEntity({});
+			}
+		}
+
 		if (m_ViewportFocused)
 		{
 			if (!m_OperationLocked)
@@ -106,6 +118,22 @@ namespace Editor
 		}
 	}
 
+	bool EditorLayer::GetViewportMousePosition(glm::vec2& position) const
+	{
+		ImVec2 mousePosition = ImGui::GetMousePos();
+		position = { mousePosition.x - m_ViewportBounds[0].x, mousePosition.y - m_ViewportBounds[0].y };
+		glm::vec2 viewportSize = m_ViewportBounds[1] - m_ViewportBounds[0];
+		position.y = viewportSize.y - position.y;
+		if (position.x >= 0 && position.x < viewportSize.x && position.y >= 0 && position.y < viewportSize.y)
+		{
+			Viewport cameraViewport = m_Camera.GetComponent<CameraComponent>().Viewport;
+			position.x = position.x * cameraViewport.Width / viewportSize.x;
+			position.y = position.y * cameraViewport.Height / viewportSize.y;
+			return true;
+		}
+		return false;
+	}
+
 	void EditorLayer::OnImGuiRender()
 	{
 		bool fullscreen = true;
@@ -191,7 +219,17 @@ namespace Editor
 
 		ImGui::Begin("Stats");
 		ImGui::Text("Frame time: %.3f", m_Timestep.Milliseconds());
-		ImGui::Text("Draw calls: %i", m_Application->GetRenderer().GetStats().DrawCount);
+		const RendererStats& stats = m_Application->GetRenderer().GetStats();
+		ImGui::Text("Draw calls: %i", stats.DrawCount);
+		ImGui::Text("Visible: %i", stats.VisibleCount);
+		ImGui::Text("Culled: %i", stats.CulledCount);
+		ImGui::Text("Shader binds: %i", stats.ShaderBindCount);
+		ImGui::Text("State changes: %i", stats.StateChangeCount);
+		ImGui::Text("Instanced: %i", stats.InstancedCount);
+		const Renderer2DStats& spriteStats = m_Scene->GetSpriteStats();
+		ImGui::Text("Sprites: %i", spriteStats.SpriteCount);
+		ImGui::Text("Sprite batches: %i", spriteStats.BatchCount);
+		ImGui::Text("Sprite textures: %i (%i in atlas)", spriteStats.TextureCount, spriteStats.AtlasTextureCount);
 		ImGui::End();
 
 		ImGui::Begin("Scene");
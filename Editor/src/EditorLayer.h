@@ -31,6 +31,9 @@ namespace Editor
 		glm::vec2 m_ViewportSize;
 
 		Forge::Entity m_Camera;
+		// Picks resolve a frame or two after they are issued so that reading back the entity id never stalls
+		Forge::Ref<Forge::PickRequest> m_HoverPick;
+		Forge::Ref<Forge::PickRequest> m_ClickPick;
 		bool m_OperationLocked = false;
 		ImGuizmo::OPERATION m_GuizmoOperation = ImGuizmo::OPERATION::TRANSLATE;
 
@@ -46,6 +49,8 @@ namespace Editor
 
 	private:
 		void NewScene();
+		// Mouse position in camera viewport coordinates, returns false if the mouse is outside the viewport
+		bool GetViewportMousePosition(glm::vec2& position) const;
 	};
 
 }
@@ -55,6 +55,7 @@ namespace Editor
 							break;
 						case ShaderDataType::Sampler1D:
 						case ShaderDataType::Sampler2D:
+						case ShaderDataType::Sampler2DArray:
 						case ShaderDataType::Sampler3D:
 						case ShaderDataType::SamplerCube:
 							DrawTextureControl(specification.Name, uniforms.GetUniform<Ref<Texture>>(specification.VariableName));
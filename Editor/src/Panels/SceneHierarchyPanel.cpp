@@ -159,7 +159,14 @@ namespace Editor
 		{
 			tag = entity.GetComponent<TagComponent>().Tag;
 		}
+		if (m_SelectedEntity && entity == m_SelectedEntity)
+			flags |= ImGuiTreeNodeFlags_Selected;
+		bool hovered = m_HoveredEntity && entity == m_HoveredEntity;
+		if (hovered)
+			ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.8f, 0.3f, 1.0f));
 		bool opened = ImGui::TreeNodeEx((void*)(uint64_t)(uint32_t)entity, flags, tag.c_str());
+		if (hovered)
+			ImGui::PopStyleColor();
 		if (ImGui::IsItemClicked())
 		{
 			m_SelectedEntity = entity;
@@ -404,6 +411,7 @@ namespace Editor
 							break;
 						case ShaderDataType::Sampler1D:
 						case ShaderDataType::Sampler2D:
+						case ShaderDataType::Sampler2DArray:
 						case ShaderDataType::Sampler3D:
 						case ShaderDataType::SamplerCube:
 							DrawTextureControl(specification.Name, uniforms.GetUniform<Ref<Texture>>(specification.VariableName));
@@ -447,6 +455,11 @@ namespace Editor
 		{
 			DrawColorControl("Color", sprite.Color);
 			DrawTextureControl<Texture2D>("Texture", sprite.Texture);
+			glm::vec2 uvMin = { sprite.UvRect.x, sprite.UvRect.y };
+			glm::vec2 uvMax = { sprite.UvRect.z, sprite.UvRect.w };
+			DrawVec2Control("UV Min", uvMin);
+			DrawVec2Control("UV Max", uvMax, 1.0f);
+			sprite.UvRect = { uvMin, uvMax };
 		});
 	}
 
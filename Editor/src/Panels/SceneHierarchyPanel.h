@@ -12,12 +12,16 @@ namespace Editor
 	private:
 		Forge::Scene* m_Scene;
 		Forge::Entity m_SelectedEntity;
+		// Entity under the mouse in the viewport, highlighted in the hierarchy
+		Forge::Entity m_HoveredEntity;
 
 	public:
 		SceneHierarchyPanel() = default;
 
 		inline Forge::Entity GetSelectedEntity() const { return m_SelectedEntity; }
 		inline void SetSelectedEntity(Forge::Entity entity) { m_SelectedEntity = entity; }
+		inline Forge::Entity GetHoveredEntity() const { return m_HoveredEntity; }
+		inline void SetHoveredEntity(Forge::Entity entity) { m_HoveredEntity = entity; }
 
 		void SetScene(Forge::Scene* scene);
 		void OnImGuiRender();
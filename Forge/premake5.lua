@@ -69,7 +69,8 @@ project "Forge"
 
         links 
         {
-            "stdc++fs"
+            "stdc++fs",
+            "pthread"
         }
 
     filter "system:macosx"
@@ -51,6 +51,7 @@ namespace Forge
     Ref<Shader> GraphicsCache::s_DefaultPickShader;
     std::unordered_map<int, Ref<Shader>> GraphicsCache::s_DefaultColorAnimatedShaders;
     std::unordered_map<int, Ref<Shader>> GraphicsCache::s_LitTextureAnimatedShaders;
+    std::unordered_map<const Shader*, Ref<Shader>> GraphicsCache::s_InstancedShaders;
 
     Ref<Mesh> GraphicsCache::s_SquareMesh;
     Ref<Mesh> GraphicsCache::s_CubeMesh;
@@ -194,6 +195,7 @@ namespace Forge
 #include "Shaders/LitColor.h"
 
             s_DefaultColorShader = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ "NO_LIGHTING" });
+            s_InstancedShaders[s_DefaultColorShader.get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ "NO_LIGHTING", InstancedShaderDefine });
             RegisterNewAsset(DefaultColorShaderAssetLocation, s_DefaultColorShader, s_Shaders);
         }
     }
@@ -219,6 +221,8 @@ namespace Forge
 
             s_LitColorShader[0] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource);
             s_LitColorShader[1] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ ShadowMapShaderDefine });
+            s_InstancedShaders[s_LitColorShader[0].get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ InstancedShaderDefine });
+            s_InstancedShaders[s_LitColorShader[1].get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ ShadowMapShaderDefine, InstancedShaderDefine });
             RegisterNewAsset(LitColorNoShadowShaderAssetLocation, s_LitColorShader[0], s_Shaders);
             RegisterNewAsset(LitColorShaderAssetLocation, s_LitColorShader[1], s_Shaders);
         }
@@ -247,6 +251,8 @@ namespace Forge
 
             s_PbrColorShader[0] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource);
             s_PbrColorShader[1] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ ShadowMapShaderDefine });
+            s_InstancedShaders[s_PbrColorShader[0].get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ InstancedShaderDefine });
+            s_InstancedShaders[s_PbrColorShader[1].get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ ShadowMapShaderDefine, InstancedShaderDefine });
             RegisterNewAsset(PbrColorNoShadowShaderAssetLocation, s_PbrColorShader[0], s_Shaders);
             RegisterNewAsset(PbrColorShaderAssetLocation, s_PbrColorShader[1], s_Shaders);
         }
@@ -302,6 +308,7 @@ namespace Forge
 #include "Shaders/DefaultShadow.h"
 
             s_DefaultShadowShader = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource);
+            s_InstancedShaders[s_DefaultShadowShader.get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ InstancedShaderDefine });
             RegisterNewAsset(DefaultShadowShaderAssetLocation, s_DefaultShadowShader, s_Shaders);
         }
     }
@@ -326,6 +333,7 @@ namespace Forge
 #include "Shaders/DefaultPick.h"
 
             s_DefaultPickShader = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource);
+            s_InstancedShaders[s_DefaultPickShader.get()] = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource, ShaderDefines{ InstancedShaderDefine });
             RegisterNewAsset(DefaultPickShaderAssetLocation, s_DefaultPickShader, s_Shaders);
         }
     }
@@ -356,6 +364,9 @@ namespace Forge
             vao->SetIndexBuffer(ibo);
 
             s_SquareMesh = CreateRef<Mesh>(vao);
+            s_SquareMesh->CalculateBounds(vertices, sizeof(vertices) / layout.GetStride(), 8);
+            s_SquareMesh->SetTriangles(TriangleMesh::Create(
+              vertices, sizeof(vertices) / layout.GetStride(), 8, indices, sizeof(indices) / sizeof(uint32_t)));
             RegisterNewAsset(SquareMeshAssetLocation, s_SquareMesh, s_Meshes);
         }
     }
@@ -408,6 +419,9 @@ namespace Forge
             vao->SetIndexBuffer(ibo);
 
             s_CubeMesh = CreateRef<Mesh>(vao);
+            s_CubeMesh->CalculateBounds(vertices, sizeof(vertices) / layout.GetStride(), 8);
+            s_CubeMesh->SetTriangles(TriangleMesh::Create(
+              vertices, sizeof(vertices) / layout.GetStride(), 8, indices, sizeof(indices) / sizeof(uint32_t)));
             RegisterNewAsset(CubeMeshAssetLocation, s_CubeMesh, s_Meshes);
         }
     }
@@ -472,10 +486,13 @@ namespace Forge
         vao->AddVertexBuffer(vbo);
         vao->SetIndexBuffer(ibo);
 
+        Ref<Mesh> mesh = CreateRef<Mesh>(vao);
+        mesh->CalculateBounds(vertexData, vertexCount, 8);
+        mesh->SetTriangles(TriangleMesh::Create(vertexData, vertexCount, 8, indexData, indexCount));
+
         delete[] vertexData;
         delete[] indexData;
 
-        Ref<Mesh> mesh = CreateRef<Mesh>(vao);
         RegisterNewAsset(GetGridMeshAssetLocation(xVertices, zVertices), mesh, s_Meshes);
         return mesh;
     }
@@ -577,14 +594,25 @@ namespace Forge
             vao->AddVertexBuffer(vbo);
             vao->SetIndexBuffer(ibo);
 
+            s_SphereMesh = CreateRef<Mesh>(vao);
+            s_SphereMesh->CalculateBounds(vertices, vertexCount, 8);
+            s_SphereMesh->SetTriangles(TriangleMesh::Create(vertices, vertexCount, 8, indices, indexCount));
+
             delete[] vertices;
             delete[] indices;
 
-            s_SphereMesh = CreateRef<Mesh>(vao);
             RegisterNewAsset(SphereMeshAssetLocation, s_SphereMesh, s_Meshes);
         }
     }
 
+    Ref<Shader> GraphicsCache::GetInstancedShader(const Ref<Shader>& shader)
+    {
+        auto it = s_InstancedShaders.find(shader.get());
+        if (it != s_InstancedShaders.end())
+            return it->second;
+        return nullptr;
+    }
+
     void GraphicsCache::CreateWhiteTexture()
     {
         if (!s_WhiteTexture)
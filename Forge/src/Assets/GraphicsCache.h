@@ -98,6 +98,7 @@ namespace Forge
         static Ref<Shader> s_DefaultPickShader;
         static std::unordered_map<int, Ref<Shader>> s_DefaultColorAnimatedShaders;
         static std::unordered_map<int, Ref<Shader>> s_LitTextureAnimatedShaders;
+        static std::unordered_map<const Shader*, Ref<Shader>> s_InstancedShaders;
 
         static Ref<Mesh> s_SquareMesh;
         static Ref<Mesh> s_CubeMesh;
@@ -277,6 +278,9 @@ namespace Forge
             return s_DefaultPickShader;
         }
 
+        // Returns the variant of an engine shader compiled with InstancedShaderDefine, or nullptr if there is none
+        static Ref<Shader> GetInstancedShader(const Ref<Shader>& shader);
+
         inline static ShadowFormationShaderSet DefaultShadowShaders()
         {
             return ShadowFormationShaderSet {DefaultPointShadowShader(), DefaultShadowShader()};
@@ -3,6 +3,7 @@ layout(location = 0) in vec3 v_Position;
 layout(location = 1) in vec2 v_TexCoord;
 layout(location = 2) in vec4 v_Color;
 layout(location = 3) in int v_TextureID;
+layout(location = 4) in int v_AtlasLayer;
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -14,6 +15,7 @@ layout(std140, binding = 0) uniform Camera
 out vec2 f_TexCoord;
 out vec4 f_Color;
 out flat int f_TextureID;
+out flat int f_AtlasLayer;
 
 void main()
 {
@@ -21,6 +23,7 @@ void main()
     f_TexCoord = v_TexCoord;
     f_Color = v_Color;
     f_TextureID = v_TextureID;
+    f_AtlasLayer = v_AtlasLayer;
 }
 
 #shader FRAGMENT
@@ -29,10 +32,15 @@ layout(location = 0) out vec4 f_FragColor;
 in vec2 f_TexCoord;
 in vec4 f_Color;
 in flat int f_TextureID;
+in flat int f_AtlasLayer;
 
-uniform sampler2D u_Textures[32];
+uniform sampler2D u_Textures[16];
+uniform sampler2DArray u_Atlas;
 
 void main()
 {
-    f_FragColor = texture(u_Textures[f_TextureID], f_TexCoord) * f_Color;
+    if (f_AtlasLayer >= 0)
+        f_FragColor = texture(u_Atlas, vec3(f_TexCoord, f_AtlasLayer)) * f_Color;
+    else
+        f_FragColor = texture(u_Textures[f_TextureID], f_TexCoord) * f_Color;
 }
@@ -1,7 +1,7 @@
 #shader VERTEX
 layout (location = 0) in vec3 v_Position;
 
-uniform mat4 frg_ModelMatrix;
+#include <Instancing.h>
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -13,14 +13,26 @@ layout(std140, binding = 0) uniform Camera
     vec3 frg_CameraPosition;
 };
 
+#ifdef INSTANCED
+flat out int f_InstanceEntityID;
+#endif
+
 void main()
 {
     gl_Position = frg_ProjViewMatrix * frg_ModelMatrix * vec4(v_Position, 1.0);
+#ifdef INSTANCED
+    f_InstanceEntityID = frg_InstanceEntityID;
+#endif
 }
 
 #shader FRAGMENT
 layout (location = 0) out int f_EntityID;
+#ifdef INSTANCED
+flat in int f_InstanceEntityID;
+#define frg_EntityID f_InstanceEntityID
+#else
 uniform int frg_EntityID;
+#endif
 void main()
 {
    f_EntityID = frg_EntityID;
@@ -1,7 +1,7 @@
 #shader VERTEX
 layout (location = 0) in vec3 v_Position;
 
-uniform mat4 frg_ModelMatrix;
+#include <Instancing.h>
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -17,7 +17,10 @@ layout(std140, binding = 0) uniform Camera
     vec3 frg_CameraPosition;
 };
 
-uniform mat4 frg_JointTransforms[JOINT_COUNT];
+layout(std140, binding = 4) uniform JointTransforms
+{
+    mat4 frg_JointTransforms[JOINT_COUNT];
+};
 
 out vec3 f_Position;
 out vec3 f_Normal;
@@ -3,7 +3,7 @@
 layout (location = 0) in vec3 v_Position;
 layout (location = 1) in vec3 v_Normal;
 
-uniform mat4 frg_ModelMatrix;
+#include <Instancing.h>
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -11,13 +11,23 @@ namespace Forge
 
     Application::Application(const WindowProps& props)
         : m_Window(nullptr),
+          m_Context(nullptr),
+          m_Framebuffer(nullptr),
           m_Renderer(nullptr),
           m_Scenes(),
           m_PrevFrameTime(std::chrono::high_resolution_clock::now()),
           m_ImGuiLayer(nullptr),
           m_LayerStack()
     {
-        if (!props.NoGraphics)
+        if (props.Backend)
+        {
+            m_Context = std::make_unique<GraphicsContext>(*props.Backend);
+            m_Context->Init();
+            m_Framebuffer = Framebuffer::CreateWindowFramebuffer(props.Width, props.Height);
+            m_Renderer = std::make_unique<Renderer3D>();
+            RenderCommand::Init();
+        }
+        else if (!props.NoGraphics)
         {
             m_Window = std::make_unique<Window>(props);
             m_Renderer = std::make_unique<Renderer3D>();
@@ -34,13 +44,13 @@ namespace Forge
 
     void Application::SetClearColor(const Color& color)
     {
-        if (m_Window)
+        if (m_Renderer)
             RenderCommand::SetClearColor(color);
     }
 
     Scene& Application::CreateScene()
     {
-        Ref<Framebuffer> framebuffer = nullptr;
+        Ref<Framebuffer> framebuffer = m_Framebuffer;
         if (m_Window)
             framebuffer = m_Window->GetFramebuffer();
         Scope<Scene> scene = CreateScope<Scene>(framebuffer, GetRenderer());
@@ -78,11 +88,15 @@ namespace Forge
             m_ImGuiLayer->End();
         }
         RendererStats stats;
-        if (m_Renderer && m_Window)
+        if (m_Renderer)
         {
             stats = m_Renderer->GetStats();
+            DynamicBufferStats uploads = DynamicVertexBuffer::EndFrame();
+            stats.UploadBytes = uploads.UploadBytes;
+            stats.UploadStallMs = uploads.StallMs;
             m_Renderer->Flush();
-            m_Window->Update();
+            if (m_Window)
+                m_Window->Update();
         }
         m_PrevFrameTime = now;
         return stats;
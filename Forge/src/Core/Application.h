@@ -14,6 +14,9 @@ namespace Forge
     {
     private:
         std::unique_ptr<Window> m_Window;
+        // Context and target of headless applications, which have no window
+        std::unique_ptr<GraphicsContext> m_Context;
+        Ref<Framebuffer> m_Framebuffer;
         std::unique_ptr<Renderer3D> m_Renderer;
         std::vector<Scope<Scene>> m_Scenes;
 
@@ -9,16 +9,34 @@
 namespace Forge
 {
 
+	// GL functions of the driver behind the current GLFW context
+	class FORGE_API GlfwRenderBackend : public RenderBackend
+	{
+	public:
+		void* GetProcAddress(const char* name) override
+		{
+			return (void*)glfwGetProcAddress(name);
+		}
+	};
+
+	static GlfwRenderBackend s_GlfwBackend;
+
 	GraphicsContext::GraphicsContext(GLFWwindow* handle)
-		: m_Handle(handle)
+		: m_Handle(handle), m_Backend(&s_GlfwBackend)
+	{
+	}
+
+	GraphicsContext::GraphicsContext(RenderBackend& backend)
+		: m_Handle(nullptr), m_Backend(&backend)
 	{
 	}
 
 	void GraphicsContext::Init()
 	{
-		glfwMakeContextCurrent(m_Handle);
-		int status = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
-		FORGE_ASSERT(status != 0, "Failed to initialize Glad");
+		if (m_Handle)
+			glfwMakeContextCurrent(m_Handle);
+		bool loaded = RenderBackend::Load(*m_Backend);
+		FORGE_ASSERT(loaded, "Failed to initialize Glad");
 
 		FORGE_INFO("OpenGL Info:");
 		FORGE_INFO("  Vendor: {0}", glGetString(GL_VENDOR));
@@ -32,7 +50,8 @@ namespace Forge
 
 	void GraphicsContext::SwapBuffers()
 	{
-		glfwSwapBuffers(m_Handle);
+		if (m_Handle)
+			glfwSwapBuffers(m_Handle);
 	}
 
 }
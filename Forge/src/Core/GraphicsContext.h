@@ -1,5 +1,6 @@
 #pragma once
 #include "Logging.h"
+#include "Renderer/RenderBackend.h"
 
 struct GLFWwindow;
 
@@ -10,9 +11,12 @@ namespace Forge
 	{
 	private:
 		GLFWwindow* m_Handle;
+		RenderBackend* m_Backend;
 
 	public:
 		GraphicsContext(GLFWwindow* handle);
+		// Headless context that renders through the given backend, which must outlive the context
+		GraphicsContext(RenderBackend& backend);
 
 		void Init();
 		void SwapBuffers();
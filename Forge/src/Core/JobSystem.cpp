@@ -0,0 +1,113 @@
+#include "ForgePch.h"
+#include "JobSystem.h"
+
+namespace Forge
+{
+
+    static thread_local bool s_InsideJob = false;
+
+    JobSystem::JobSystem(uint32_t workerCount)
+        : m_Workers(), m_Mutex(), m_WorkAvailable(), m_WorkFinished(), m_CurrentJob(nullptr), m_Generation(0), m_ActiveWorkers(0), m_Running(true)
+    {
+        m_Workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++)
+            m_Workers.emplace_back([this]() { WorkerLoop(); });
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_Mutex);
+            m_Running = false;
+        }
+        m_WorkAvailable.notify_all();
+        for (std::thread& worker : m_Workers)
+            worker.join();
+    }
+
+    void JobSystem::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+    {
+        if (count == 0)
+            return;
+        grainSize = std::max<size_t>(grainSize, 1);
+        if (count <= grainSize || m_Workers.empty() || s_InsideJob)
+        {
+            func(0, count);
+            return;
+        }
+
+        Job job;
+        job.Func = &func;
+        job.Count = count;
+        job.GrainSize = grainSize;
+        job.NextIndex = 0;
+        {
+            std::scoped_lock<std::mutex> lock(m_Mutex);
+            if (m_CurrentJob != nullptr)
+            {
+                // Another thread owns the pool
+                func(0, count);
+                return;
+            }
+            m_CurrentJob = &job;
+            m_Generation++;
+        }
+        m_WorkAvailable.notify_all();
+
+        RunJob(job);
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        // Every range has been claimed, wait for the workers still running one
+        m_CurrentJob = nullptr;
+        m_WorkFinished.wait(lock, [this]() { return m_ActiveWorkers == 0; });
+    }
+
+    JobSystem& JobSystem::Get()
+    {
+        static JobSystem s_Instance(std::max(std::thread::hardware_concurrency(), 1U) - 1);
+        return s_Instance;
+    }
+
+    void JobSystem::WorkerLoop()
+    {
+        uint64_t generation = 0;
+        while (true)
+        {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WorkAvailable.wait(lock, [this, generation]() { return !m_Running || (m_CurrentJob != nullptr && m_Generation != generation); });
+                if (!m_Running)
+                    return;
+                job = m_CurrentJob;
+                generation = m_Generation;
+                m_ActiveWorkers++;
+            }
+
+            RunJob(*job);
+
+            bool finished;
+            {
+                std::scoped_lock<std::mutex> lock(m_Mutex);
+                finished = --m_ActiveWorkers == 0;
+            }
+            if (finished)
+                m_WorkFinished.notify_all();
+        }
+    }
+
+    void JobSystem::RunJob(Job& job)
+    {
+        bool insideJob = s_InsideJob;
+        s_InsideJob = true;
+        while (true)
+        {
+            size_t begin = job.NextIndex.fetch_add(job.GrainSize);
+            if (begin >= job.Count)
+                break;
+            (*job.Func)(begin, std::min(begin + job.GrainSize, job.Count));
+        }
+        s_InsideJob = insideJob;
+    }
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "ForgePch.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Forge
+{
+
+	// Fixed pool of worker threads, started on first use
+	class FORGE_API JobSystem
+	{
+	private:
+		struct FORGE_API Job
+		{
+		public:
+			const std::function<void(size_t, size_t)>* Func;
+			size_t Count;
+			size_t GrainSize;
+			std::atomic<size_t> NextIndex;
+		};
+
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkAvailable;
+		std::condition_variable m_WorkFinished;
+		Job* m_CurrentJob;
+		uint64_t m_Generation;
+		uint32_t m_ActiveWorkers;
+		bool m_Running;
+
+	public:
+		JobSystem(uint32_t workerCount);
+		JobSystem(const JobSystem& other) = delete;
+		JobSystem& operator=(const JobSystem& other) = delete;
+		~JobSystem();
+
+		// Number of threads that execute jobs, including the calling thread
+		inline uint32_t GetThreadCount() const { return uint32_t(m_Workers.size()) + 1; }
+
+		// Calls func(begin, end) over ranges of at most grainSize covering [0, count) and returns once all have completed
+		// The calling thread takes part, so nested calls from inside func run serially
+		void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+
+	public:
+		static JobSystem& Get();
+
+	private:
+		void WorkerLoop();
+		static void RunJob(Job& job);
+
+	};
+
+}
@@ -34,6 +34,8 @@ namespace Forge
         uint32_t Height = 720;
         std::string Title = "Forge";
         bool NoGraphics = false;
+        // Renders without a window or GPU through this backend when set, see RecordingRenderBackend
+        RenderBackend* Backend = nullptr;
     };
 
     class FORGE_API Window
@@ -2,9 +2,12 @@
 #include "ForgePch.h"
 
 #include "Renderer/VertexArray.h"
+#include "Renderer/DynamicVertexBuffer.h"
+#include "Renderer/MeshBuilder.h"
 #include "Renderer/Shader.h"
 #include "Renderer/RenderCommand.h"
 #include "Renderer/Renderer3D.h"
+#include "Renderer/RecordingRenderBackend.h"
 #include "Assets/GraphicsCache.h"
 
 #include "Core/Color.h"
@@ -12,13 +15,19 @@
 #include "Core/Window.h"
 #include "Core/Input.h"
 #include "Core/Application.h"
+#include "Core/JobSystem.h"
 
 #include "Math/Constants.h"
 #include "Math/Math.h"
+#include "Math/Bounds.h"
+#include "Math/DynamicBvh.h"
+#include "Math/SimdLanes.h"
 
 #include "Scene/Scene.h"
 #include "Scene/Entity.h"
 #include "Scene/Transform.h"
+#include "Scene/TransformHierarchy.h"
+#include "Scene/SpatialIndex.h"
 #include "Scene/CameraComponent.h"
 #include "Scene/ModelRenderer.h"
 #include "Scene/Components.h"
@@ -26,6 +35,8 @@
 #include "Scene/SpriteRenderer.h"
 #include "Scene/Colliders.h"
 #include "Scene/Collision.h"
+#include "Scene/CollisionBatch.h"
+#include "Scene/CollisionSystem.h"
 #include "Scene/EntityUtils.h"
 
 #include "Scene/SceneSerializer.h"
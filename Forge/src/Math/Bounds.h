@@ -0,0 +1,208 @@
+#pragma once
+#include "ForgePch.h"
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Forge
+{
+
+    struct FORGE_API BoundingBox
+    {
+    public:
+        glm::vec3 Min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 Max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    public:
+        inline bool IsValid() const
+        {
+            return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+        }
+        inline glm::vec3 GetCenter() const
+        {
+            return (Min + Max) * 0.5f;
+        }
+        inline glm::vec3 GetExtents() const
+        {
+            return (Max - Min) * 0.5f;
+        }
+        inline float GetSurfaceArea() const
+        {
+            glm::vec3 size = Max - Min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        inline bool Contains(const BoundingBox& other) const
+        {
+            return Min.x <= other.Min.x && Min.y <= other.Min.y && Min.z <= other.Min.z && Max.x >= other.Max.x &&
+                   Max.y >= other.Max.y && Max.z >= other.Max.z;
+        }
+        inline bool Intersects(const BoundingBox& other) const
+        {
+            return Min.x <= other.Max.x && Min.y <= other.Max.y && Min.z <= other.Max.z && Max.x >= other.Min.x &&
+                   Max.y >= other.Min.y && Max.z >= other.Min.z;
+        }
+
+        inline void Expand(const glm::vec3& point)
+        {
+            Min = glm::min(Min, point);
+            Max = glm::max(Max, point);
+        }
+
+        // Returns the axis aligned box that encloses this box after it has been transformed
+        inline BoundingBox Transform(const glm::mat4& transform) const
+        {
+            if (!IsValid())
+                return *this;
+            glm::vec3 center = transform * glm::vec4(GetCenter(), 1.0f);
+            glm::vec3 extents = GetExtents();
+            glm::vec3 worldExtents = glm::abs(glm::vec3(transform[0])) * extents.x +
+                                     glm::abs(glm::vec3(transform[1])) * extents.y +
+                                     glm::abs(glm::vec3(transform[2])) * extents.z;
+            BoundingBox result;
+            result.Min = center - worldExtents;
+            result.Max = center + worldExtents;
+            return result;
+        }
+    };
+
+    inline BoundingBox Union(const BoundingBox& a, const BoundingBox& b)
+    {
+        BoundingBox result;
+        result.Min = glm::min(a.Min, b.Min);
+        result.Max = glm::max(a.Max, b.Max);
+        return result;
+    }
+
+    struct FORGE_API BoundingSphere
+    {
+    public:
+        glm::vec3 Center = glm::vec3(0.0f);
+        float Radius = -1.0f;
+
+    public:
+        inline bool IsValid() const
+        {
+            return Radius >= 0.0f;
+        }
+
+        // Conservative, the radius is scaled by the largest axis scale of the transform
+        inline BoundingSphere Transform(const glm::mat4& transform) const
+        {
+            if (!IsValid())
+                return *this;
+            float scale = std::sqrt(std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+              std::max(glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+                glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2])))));
+            BoundingSphere result;
+            result.Center = transform * glm::vec4(Center, 1.0f);
+            result.Radius = Radius * scale;
+            return result;
+        }
+    };
+
+    // positions points to the first position component, stride is the number of floats between consecutive positions
+    inline BoundingBox CalculateBoundingBox(const float* positions, size_t count, size_t stride)
+    {
+        BoundingBox result;
+        for (size_t i = 0; i < count; i++)
+        {
+            const float* position = positions + i * stride;
+            result.Expand({position[0], position[1], position[2]});
+        }
+        return result;
+    }
+
+    // Sphere centred on the box, with a radius that reaches the furthest vertex rather than the box corners
+    inline BoundingSphere CalculateBoundingSphere(
+      const float* positions, size_t count, size_t stride, const BoundingBox& box)
+    {
+        BoundingSphere result;
+        if (!box.IsValid())
+            return result;
+        result.Center = box.GetCenter();
+        float radius2 = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            const float* position = positions + i * stride;
+            glm::vec3 delta = glm::vec3 {position[0], position[1], position[2]} - result.Center;
+            radius2 = std::max(radius2, glm::dot(delta, delta));
+        }
+        result.Radius = std::sqrt(radius2);
+        return result;
+    }
+
+    // 6 planes (left, right, bottom, top, near, far) extracted from a view projection matrix
+    // Each plane is stored as (normal, distance) with the normal pointing into the frustum
+    struct FORGE_API FrustumPlanes
+    {
+    public:
+        glm::vec4 Planes[6];
+
+    public:
+        inline FrustumPlanes() : Planes() {}
+
+        inline FrustumPlanes(const glm::mat4& viewProjection)
+        {
+            glm::vec4 rows[4];
+            for (int i = 0; i < 4; i++)
+                rows[i] = {viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]};
+            Planes[0] = rows[3] + rows[0];
+            Planes[1] = rows[3] - rows[0];
+            Planes[2] = rows[3] + rows[1];
+            Planes[3] = rows[3] - rows[1];
+            Planes[4] = rows[3] + rows[2];
+            Planes[5] = rows[3] - rows[2];
+            for (glm::vec4& plane : Planes)
+                plane /= glm::length(glm::vec3(plane));
+        }
+
+        inline bool Intersects(const BoundingBox& box) const
+        {
+            for (const glm::vec4& plane : Planes)
+            {
+                // Test the corner furthest along the plane normal
+                glm::vec3 corner = {
+                  plane.x >= 0.0f ? box.Max.x : box.Min.x,
+                  plane.y >= 0.0f ? box.Max.y : box.Min.y,
+                  plane.z >= 0.0f ? box.Max.z : box.Min.z,
+                };
+                if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    inline bool IntersectsSphere(const BoundingBox& box, const glm::vec3& center, float radius)
+    {
+        glm::vec3 closest = glm::clamp(center, box.Min, box.Max);
+        glm::vec3 delta = closest - center;
+        return glm::dot(delta, delta) <= radius * radius;
+    }
+
+    struct FORGE_API Ray
+    {
+    public:
+        glm::vec3 Origin = glm::vec3(0.0f);
+        glm::vec3 Direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    };
+
+    // Slab test against the part of the ray between 0 and maxDistance, inverseDirection is 1 / ray.Direction
+    // distance is set to where the ray enters the box (0 if the origin is inside)
+    inline bool IntersectsRay(const BoundingBox& box, const Ray& ray, const glm::vec3& inverseDirection,
+      float maxDistance, float& distance)
+    {
+        glm::vec3 t0 = (box.Min - ray.Origin) * inverseDirection;
+        glm::vec3 t1 = (box.Max - ray.Origin) * inverseDirection;
+        glm::vec3 entries = glm::min(t0, t1);
+        glm::vec3 exits = glm::max(t0, t1);
+        float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+        float exit = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+        distance = enter;
+        return enter <= exit;
+    }
+
+}
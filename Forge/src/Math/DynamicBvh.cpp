@@ -0,0 +1,347 @@
+#include "ForgePch.h"
+#include "DynamicBvh.h"
+
+namespace Forge
+{
+
+    DynamicBvh::DynamicBvh(float margin)
+        : m_Nodes(), m_Root(NullNode), m_FreeList(NullNode), m_ProxyCount(0), m_Margin(margin), m_BuiltCost(0.0f), m_Scratch()
+    {
+    }
+
+    int32_t DynamicBvh::CreateProxy(const BoundingBox& box, uint32_t userData)
+    {
+        FORGE_ASSERT(box.IsValid(), "Invalid proxy bounds");
+        int32_t proxy = AllocateNode();
+        m_Nodes[proxy].Box = Fatten(box, m_Margin);
+        m_Nodes[proxy].UserData = userData;
+        InsertLeaf(proxy);
+        m_ProxyCount++;
+        return proxy;
+    }
+
+    void DynamicBvh::DestroyProxy(int32_t proxy)
+    {
+        FORGE_ASSERT(m_Nodes[proxy].IsLeaf(), "Invalid proxy");
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_ProxyCount--;
+    }
+
+    bool DynamicBvh::MoveProxy(int32_t proxy, const BoundingBox& box)
+    {
+        FORGE_ASSERT(box.IsValid(), "Invalid proxy bounds");
+        if (!NeedsUpdate(proxy, box))
+            return false;
+        RemoveLeaf(proxy);
+        m_Nodes[proxy].Box = Fatten(box, m_Margin);
+        InsertLeaf(proxy);
+        return true;
+    }
+
+    bool DynamicBvh::SetProxyBounds(int32_t proxy, const BoundingBox& box)
+    {
+        FORGE_ASSERT(box.IsValid(), "Invalid proxy bounds");
+        if (!NeedsUpdate(proxy, box))
+            return false;
+        m_Nodes[proxy].Box = Fatten(box, m_Margin);
+        return true;
+    }
+
+    void DynamicBvh::Refit()
+    {
+        if (m_Root == NullNode)
+            return;
+        // Post order traversal, a node is pushed a second time (negated) once its children have been visited
+        m_Scratch.clear();
+        m_Scratch.push_back(m_Root);
+        while (!m_Scratch.empty())
+        {
+            int32_t entry = m_Scratch.back();
+            m_Scratch.pop_back();
+            if (entry < 0)
+            {
+                Node& node = m_Nodes[~entry];
+                node.Box = Union(m_Nodes[node.Children[0]].Box, m_Nodes[node.Children[1]].Box);
+            }
+            else if (!m_Nodes[entry].IsLeaf())
+            {
+                m_Scratch.push_back(~entry);
+                m_Scratch.push_back(m_Nodes[entry].Children[0]);
+                m_Scratch.push_back(m_Nodes[entry].Children[1]);
+            }
+        }
+        if (CalculateCost() > RebuildCostRatio * m_BuiltCost)
+            Rebuild();
+    }
+
+    void DynamicBvh::Rebuild()
+    {
+        if (m_Root == NullNode)
+            return;
+        // Keep the leaves so that proxy ids stay valid and free every internal node
+        std::vector<int32_t> leaves;
+        leaves.reserve(m_ProxyCount);
+        m_Scratch.clear();
+        m_Scratch.push_back(m_Root);
+        while (!m_Scratch.empty())
+        {
+            int32_t index = m_Scratch.back();
+            m_Scratch.pop_back();
+            if (m_Nodes[index].IsLeaf())
+            {
+                leaves.push_back(index);
+            }
+            else
+            {
+                m_Scratch.push_back(m_Nodes[index].Children[0]);
+                m_Scratch.push_back(m_Nodes[index].Children[1]);
+                FreeNode(index);
+            }
+        }
+        m_Root = Build(leaves.data(), leaves.size());
+        m_Nodes[m_Root].Parent = NullNode;
+        m_BuiltCost = CalculateCost();
+    }
+
+    void DynamicBvh::Clear()
+    {
+        m_Nodes.clear();
+        m_Root = NullNode;
+        m_FreeList = NullNode;
+        m_ProxyCount = 0;
+        m_BuiltCost = 0.0f;
+    }
+
+    int32_t DynamicBvh::AllocateNode()
+    {
+        int32_t index;
+        if (m_FreeList != NullNode)
+        {
+            index = m_FreeList;
+            m_FreeList = m_Nodes[index].Parent;
+        }
+        else
+        {
+            index = int32_t(m_Nodes.size());
+            m_Nodes.emplace_back();
+        }
+        Node& node = m_Nodes[index];
+        node.Box = {};
+        node.UserData = 0;
+        node.Parent = NullNode;
+        node.Children[0] = NullNode;
+        node.Children[1] = NullNode;
+        node.Height = 0;
+        return index;
+    }
+
+    void DynamicBvh::FreeNode(int32_t index)
+    {
+        m_Nodes[index].Parent = m_FreeList;
+        m_Nodes[index].Height = -1;
+        m_FreeList = index;
+    }
+
+    void DynamicBvh::InsertLeaf(int32_t leaf)
+    {
+        if (m_Root == NullNode)
+        {
+            m_Root = leaf;
+            m_Nodes[leaf].Parent = NullNode;
+            return;
+        }
+
+        // Walk down to the sibling that minimises the increase in surface area of the tree
+        BoundingBox leafBox = m_Nodes[leaf].Box;
+        int32_t index = m_Root;
+        while (!m_Nodes[index].IsLeaf())
+        {
+            const Node& node = m_Nodes[index];
+            float area = node.Box.GetSurfaceArea();
+            float combinedArea = Union(node.Box, leafBox).GetSurfaceArea();
+            // Cost of pairing the leaf with this node
+            float cost = 2.0f * combinedArea;
+            // Every ancestor of a deeper sibling grows by the same amount
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float childCosts[2];
+            for (int i = 0; i < 2; i++)
+            {
+                const Node& child = m_Nodes[node.Children[i]];
+                float childArea = Union(child.Box, leafBox).GetSurfaceArea();
+                childCosts[i] = child.IsLeaf() ? childArea + inheritanceCost
+                                               : childArea - child.Box.GetSurfaceArea() + inheritanceCost;
+            }
+
+            if (cost < childCosts[0] && cost < childCosts[1])
+                break;
+            index = childCosts[0] < childCosts[1] ? node.Children[0] : node.Children[1];
+        }
+
+        int32_t sibling = index;
+        int32_t oldParent = m_Nodes[sibling].Parent;
+        int32_t newParent = AllocateNode();
+        Node& parent = m_Nodes[newParent];
+        parent.Parent = oldParent;
+        parent.Box = Union(leafBox, m_Nodes[sibling].Box);
+        parent.Height = m_Nodes[sibling].Height + 1;
+        parent.Children[0] = sibling;
+        parent.Children[1] = leaf;
+        m_Nodes[sibling].Parent = newParent;
+        m_Nodes[leaf].Parent = newParent;
+
+        if (oldParent != NullNode)
+            ReplaceChild(oldParent, sibling, newParent);
+        else
+            m_Root = newParent;
+
+        RefitFrom(newParent);
+    }
+
+    void DynamicBvh::RemoveLeaf(int32_t leaf)
+    {
+        if (leaf == m_Root)
+        {
+            m_Root = NullNode;
+            return;
+        }
+
+        int32_t parent = m_Nodes[leaf].Parent;
+        int32_t grandParent = m_Nodes[parent].Parent;
+        int32_t sibling = m_Nodes[parent].Children[0] == leaf ? m_Nodes[parent].Children[1]
+                                                               : m_Nodes[parent].Children[0];
+
+        m_Nodes[sibling].Parent = grandParent;
+        if (grandParent != NullNode)
+            ReplaceChild(grandParent, parent, sibling);
+        else
+            m_Root = sibling;
+        FreeNode(parent);
+        RefitFrom(grandParent);
+    }
+
+    void DynamicBvh::ReplaceChild(int32_t parent, int32_t child, int32_t replacement)
+    {
+        Node& node = m_Nodes[parent];
+        if (node.Children[0] == child)
+            node.Children[0] = replacement;
+        else
+            node.Children[1] = replacement;
+    }
+
+    void DynamicBvh::RefitFrom(int32_t index)
+    {
+        while (index != NullNode)
+        {
+            index = Balance(index);
+            Node& node = m_Nodes[index];
+            const Node& child0 = m_Nodes[node.Children[0]];
+            const Node& child1 = m_Nodes[node.Children[1]];
+            node.Height = 1 + std::max(child0.Height, child1.Height);
+            node.Box = Union(child0.Box, child1.Box);
+            index = node.Parent;
+        }
+    }
+
+    int32_t DynamicBvh::Balance(int32_t index)
+    {
+        Node& a = m_Nodes[index];
+        if (a.IsLeaf() || a.Height < 2)
+            return index;
+
+        int32_t balance = m_Nodes[a.Children[1]].Height - m_Nodes[a.Children[0]].Height;
+        if (balance >= -1 && balance <= 1)
+            return index;
+
+        // Rotate the taller child up to replace a
+        int side = balance > 1 ? 1 : 0;
+        int32_t promotedIndex = a.Children[side];
+        int32_t otherIndex = a.Children[1 - side];
+        Node& promoted = m_Nodes[promotedIndex];
+        int32_t grandChildren[2] = {promoted.Children[0], promoted.Children[1]};
+
+        promoted.Parent = a.Parent;
+        a.Parent = promotedIndex;
+        if (promoted.Parent != NullNode)
+            ReplaceChild(promoted.Parent, index, promotedIndex);
+        else
+            m_Root = promotedIndex;
+
+        // The taller grandchild stays under the promoted node, the other one takes its place under a
+        bool firstTaller = m_Nodes[grandChildren[0]].Height > m_Nodes[grandChildren[1]].Height;
+        int32_t keptIndex = firstTaller ? grandChildren[0] : grandChildren[1];
+        int32_t movedIndex = firstTaller ? grandChildren[1] : grandChildren[0];
+
+        promoted.Children[0] = index;
+        promoted.Children[1] = keptIndex;
+        a.Children[side] = movedIndex;
+        m_Nodes[movedIndex].Parent = index;
+
+        const Node& other = m_Nodes[otherIndex];
+        const Node& moved = m_Nodes[movedIndex];
+        const Node& kept = m_Nodes[keptIndex];
+        a.Box = Union(other.Box, moved.Box);
+        a.Height = 1 + std::max(other.Height, moved.Height);
+        promoted.Box = Union(a.Box, kept.Box);
+        promoted.Height = 1 + std::max(a.Height, kept.Height);
+        return promotedIndex;
+    }
+
+    int32_t DynamicBvh::Build(int32_t* leaves, size_t count)
+    {
+        if (count == 1)
+            return leaves[0];
+
+        // Median split along the axis with the largest spread of leaf centres
+        BoundingBox centers;
+        for (size_t i = 0; i < count; i++)
+            centers.Expand(m_Nodes[leaves[i]].Box.GetCenter());
+        glm::vec3 size = centers.Max - centers.Min;
+        int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+        size_t half = count / 2;
+        std::nth_element(leaves, leaves + half, leaves + count, [this, axis](int32_t a, int32_t b) {
+            return m_Nodes[a].Box.Min[axis] + m_Nodes[a].Box.Max[axis] <
+                   m_Nodes[b].Box.Min[axis] + m_Nodes[b].Box.Max[axis];
+        });
+
+        int32_t child0 = Build(leaves, half);
+        int32_t child1 = Build(leaves + half, count - half);
+        int32_t index = AllocateNode();
+        Node& node = m_Nodes[index];
+        node.Children[0] = child0;
+        node.Children[1] = child1;
+        node.Box = Union(m_Nodes[child0].Box, m_Nodes[child1].Box);
+        node.Height = 1 + std::max(m_Nodes[child0].Height, m_Nodes[child1].Height);
+        m_Nodes[child0].Parent = index;
+        m_Nodes[child1].Parent = index;
+        return index;
+    }
+
+    float DynamicBvh::CalculateCost() const
+    {
+        float cost = 0.0f;
+        for (const Node& node : m_Nodes)
+        {
+            if (node.Height > 0)
+                cost += node.Box.GetSurfaceArea();
+        }
+        return cost;
+    }
+
+    bool DynamicBvh::NeedsUpdate(int32_t proxy, const BoundingBox& box) const
+    {
+        // Shrink the fat bounds again once they are much larger than the box, otherwise queries get looser over time
+        const BoundingBox& fatBounds = m_Nodes[proxy].Box;
+        return !fatBounds.Contains(box) || !Fatten(box, 4.0f * m_Margin).Contains(fatBounds);
+    }
+
+    BoundingBox DynamicBvh::Fatten(const BoundingBox& box, float margin) const
+    {
+        BoundingBox result;
+        result.Min = box.Min - glm::vec3(margin);
+        result.Max = box.Max + glm::vec3(margin);
+        return result;
+    }
+
+}
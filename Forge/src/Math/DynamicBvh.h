@@ -0,0 +1,303 @@
+#pragma once
+#include "ForgePch.h"
+#include "Bounds.h"
+#include "Scene/CollisionBatch.h"
+
+namespace Forge
+{
+
+    // Bounding volume hierarchy of axis aligned boxes that is updated incrementally.
+    // Leaves store a box enlarged by a margin so that small movements do not change the tree,
+    // and the tree is kept balanced with rotations as leaves are inserted and removed
+    class FORGE_API DynamicBvh
+    {
+    public:
+        static constexpr int32_t NullNode = -1;
+
+    private:
+        struct FORGE_API Node
+        {
+        public:
+            BoundingBox Box;
+            uint32_t UserData;
+            // Next free node while the node is in the free list
+            int32_t Parent;
+            int32_t Children[2];
+            // 0 for leaves, -1 for free nodes
+            int32_t Height;
+
+        public:
+            inline bool IsLeaf() const
+            {
+                return Children[0] == NullNode;
+            }
+        };
+
+        // Refit() rebuilds the tree once its cost has grown by this much since the last build
+        static constexpr float RebuildCostRatio = 1.5f;
+
+        std::vector<Node> m_Nodes;
+        int32_t m_Root;
+        int32_t m_FreeList;
+        uint32_t m_ProxyCount;
+        float m_Margin;
+        float m_BuiltCost;
+        std::vector<int32_t> m_Scratch;
+
+    public:
+        DynamicBvh(float margin = 0.1f);
+
+        inline uint32_t GetProxyCount() const
+        {
+            return m_ProxyCount;
+        }
+        inline int32_t GetHeight() const
+        {
+            return m_Root == NullNode ? 0 : m_Nodes[m_Root].Height;
+        }
+        inline uint32_t GetUserData(int32_t proxy) const
+        {
+            return m_Nodes[proxy].UserData;
+        }
+        inline void SetUserData(int32_t proxy, uint32_t userData)
+        {
+            m_Nodes[proxy].UserData = userData;
+        }
+        // Enlarged box stored in the tree, contains the box last given for this proxy
+        inline const BoundingBox& GetFatBounds(int32_t proxy) const
+        {
+            return m_Nodes[proxy].Box;
+        }
+
+        int32_t CreateProxy(const BoundingBox& box, uint32_t userData);
+        void DestroyProxy(int32_t proxy);
+        // Returns true if the proxy was reinserted because the box left (or became much smaller than) its fat bounds
+        bool MoveProxy(int32_t proxy, const BoundingBox& box);
+        // Same as MoveProxy() but only updates the leaf, Refit() must be called before the tree is queried again.
+        // Much cheaper than reinserting when a large part of the tree moves at once
+        bool SetProxyBounds(int32_t proxy, const BoundingBox& box);
+        // Recalculates every internal box after SetProxyBounds(), rebuilding the tree if the boxes have become loose
+        void Refit();
+        // Top down rebuild over the current proxies, proxy ids remain valid
+        void Rebuild();
+        void Clear();
+
+        // Calls callback(userData) for every proxy whose fat bounds pass overlaps(box)
+        template<typename Overlaps, typename Callback>
+        void Query(const Overlaps& overlaps, const Callback& callback) const
+        {
+            if (m_Root == NullNode)
+                return;
+            std::vector<int32_t> stack;
+            stack.reserve(64);
+            stack.push_back(m_Root);
+            while (!stack.empty())
+            {
+                const Node& node = m_Nodes[stack.back()];
+                stack.pop_back();
+                if (!overlaps(node.Box))
+                    continue;
+                if (node.IsLeaf())
+                {
+                    callback(node.UserData);
+                }
+                else
+                {
+                    stack.push_back(node.Children[0]);
+                    stack.push_back(node.Children[1]);
+                }
+            }
+        }
+
+        // Same as Query() but tests up to CollisionBatchWidth boxes at once, testBatch(batch) returns a bit for every lane
+        // that overlaps
+        template<typename TestBatch, typename Callback>
+        void QueryBatch(const TestBatch& testBatch, const Callback& callback) const
+        {
+            if (m_Root == NullNode)
+                return;
+            std::vector<int32_t> stack;
+            stack.reserve(64);
+            stack.push_back(m_Root);
+            AABBBatch batch;
+            int32_t nodes[CollisionBatchWidth];
+            while (!stack.empty())
+            {
+                size_t count = PopBatch(stack, batch, nodes);
+                uint32_t overlapping = testBatch(batch) & GetLaneMask(count);
+                for (size_t lane = 0; lane < count; lane++)
+                {
+                    if ((overlapping & (1u << lane)) == 0)
+                        continue;
+                    const Node& node = m_Nodes[nodes[lane]];
+                    if (node.IsLeaf())
+                    {
+                        callback(node.UserData);
+                    }
+                    else
+                    {
+                        stack.push_back(node.Children[0]);
+                        stack.push_back(node.Children[1]);
+                    }
+                }
+            }
+        }
+
+        template<typename Callback>
+        inline void QueryBox(const BoundingBox& box, const Callback& callback) const
+        {
+            QueryBatch([&box](const AABBBatch& batch) { return TestAABBIntersections(box, batch); }, callback);
+        }
+
+        template<typename Callback>
+        inline void QueryFrustum(const FrustumPlanes& frustum, const Callback& callback) const
+        {
+            QueryBatch([&frustum](const AABBBatch& batch) { return TestFrustumIntersections(frustum, batch); }, callback);
+        }
+
+        template<typename Callback>
+        inline void QuerySphere(const glm::vec3& center, float radius, const Callback& callback) const
+        {
+            Query([&center, radius](const BoundingBox& bounds) { return IntersectsSphere(bounds, center, radius); },
+              callback);
+        }
+
+        // Calls callback(userDataA, userDataB) once for every pair of proxies whose fat bounds overlap.
+        // Descends the tree against itself, which is much cheaper than querying around every proxy
+        template<typename Callback>
+        void QueryPairs(const Callback& callback) const
+        {
+            if (m_Root == NullNode)
+                return;
+            // A node paired with itself stands for the pairs within its subtree
+            std::vector<std::pair<int32_t, int32_t>> stack;
+            stack.reserve(64);
+            stack.push_back({m_Root, m_Root});
+            AABBBatch boxesA;
+            AABBBatch boxesB;
+            std::pair<int32_t, int32_t> pairs[CollisionBatchWidth];
+            while (!stack.empty())
+            {
+                // Pairs of different nodes are tested a batch at a time, a node paired with itself only expands
+                size_t count = 0;
+                while (!stack.empty() && count < CollisionBatchWidth)
+                {
+                    auto [a, b] = stack.back();
+                    stack.pop_back();
+                    if (a == b)
+                    {
+                        const Node& node = m_Nodes[a];
+                        if (!node.IsLeaf())
+                        {
+                            stack.push_back({node.Children[0], node.Children[0]});
+                            stack.push_back({node.Children[1], node.Children[1]});
+                            stack.push_back({node.Children[0], node.Children[1]});
+                        }
+                        continue;
+                    }
+                    boxesA.Set(count, m_Nodes[a].Box);
+                    boxesB.Set(count, m_Nodes[b].Box);
+                    pairs[count++] = {a, b};
+                }
+                uint32_t overlapping = TestAABBIntersections(boxesA, boxesB) & GetLaneMask(count);
+                for (size_t lane = 0; lane < count; lane++)
+                {
+                    if ((overlapping & (1u << lane)) == 0)
+                        continue;
+                    auto [a, b] = pairs[lane];
+                    const Node& nodeA = m_Nodes[a];
+                    const Node& nodeB = m_Nodes[b];
+                    if (nodeA.IsLeaf() && nodeB.IsLeaf())
+                    {
+                        callback(nodeA.UserData, nodeB.UserData);
+                    }
+                    else if (nodeB.IsLeaf() || (!nodeA.IsLeaf() && nodeA.Height >= nodeB.Height))
+                    {
+                        stack.push_back({nodeA.Children[0], b});
+                        stack.push_back({nodeA.Children[1], b});
+                    }
+                    else
+                    {
+                        stack.push_back({a, nodeB.Children[0]});
+                        stack.push_back({a, nodeB.Children[1]});
+                    }
+                }
+            }
+        }
+
+        // Calls callback(userData, maxDistance) for every proxy whose fat bounds are hit within maxDistance.
+        // The callback returns the new maximum distance, so returning the distance of an exact hit clips the ray
+        // and returning 0 ends the query
+        template<typename Callback>
+        void Raycast(const Ray& ray, float maxDistance, const Callback& callback) const
+        {
+            if (m_Root == NullNode)
+                return;
+            glm::vec3 inverseDirection = 1.0f / ray.Direction;
+            std::vector<int32_t> stack;
+            stack.reserve(64);
+            stack.push_back(m_Root);
+            AABBBatch batch;
+            int32_t nodes[CollisionBatchWidth];
+            float distances[CollisionBatchWidth];
+            while (!stack.empty())
+            {
+                size_t count = PopBatch(stack, batch, nodes);
+                uint32_t hits =
+                  TestRayIntersections(ray, inverseDirection, maxDistance, batch, distances) & GetLaneMask(count);
+                for (size_t lane = 0; lane < count; lane++)
+                {
+                    // A hit earlier in the batch may have clipped the ray in front of this box
+                    if ((hits & (1u << lane)) == 0 || distances[lane] > maxDistance)
+                        continue;
+                    const Node& node = m_Nodes[nodes[lane]];
+                    if (node.IsLeaf())
+                    {
+                        maxDistance = callback(node.UserData, maxDistance);
+                        if (maxDistance <= 0.0f)
+                            return;
+                    }
+                    else
+                    {
+                        stack.push_back(node.Children[0]);
+                        stack.push_back(node.Children[1]);
+                    }
+                }
+            }
+        }
+
+    private:
+        // Moves up to CollisionBatchWidth nodes from the top of the stack into the lanes of batch and returns how many.
+        // The lanes after them still hold an earlier batch, so results are masked with GetLaneMask()
+        inline size_t PopBatch(std::vector<int32_t>& stack, AABBBatch& batch, int32_t (&nodes)[CollisionBatchWidth]) const
+        {
+            size_t count = std::min(stack.size(), CollisionBatchWidth);
+            for (size_t lane = 0; lane < count; lane++)
+            {
+                nodes[lane] = stack.back();
+                stack.pop_back();
+                batch.Set(lane, m_Nodes[nodes[lane]].Box);
+            }
+            return count;
+        }
+        static inline uint32_t GetLaneMask(size_t count)
+        {
+            return (1u << count) - 1;
+        }
+
+        int32_t AllocateNode();
+        void FreeNode(int32_t index);
+        void InsertLeaf(int32_t leaf);
+        void RemoveLeaf(int32_t leaf);
+        void ReplaceChild(int32_t parent, int32_t child, int32_t replacement);
+        // Recalculates boxes and heights from index up to the root, balancing on the way
+        void RefitFrom(int32_t index);
+        int32_t Balance(int32_t index);
+        int32_t Build(int32_t* leaves, size_t count);
+        // Sum of the surface areas of the internal nodes, proportional to the expected cost of a query
+        float CalculateCost() const;
+        bool NeedsUpdate(int32_t proxy, const BoundingBox& box) const;
+        BoundingBox Fatten(const BoundingBox& box, float margin) const;
+    };
+
+}
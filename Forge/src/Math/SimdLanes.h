@@ -0,0 +1,109 @@
+#pragma once
+#include "ForgePch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FORGE_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FORGE_SIMD_SSE2
+#endif
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Forge
+{
+
+    // Floats processed together by SIMD kernels, such as the collision batches and the sprite vertex writer.
+    // 8 with AVX2, 4 with SSE2 and a single float otherwise so that every kernel has a scalar fallback.
+    // Comparisons return lanes with every bit set where the comparison holds
+    struct FORGE_API FloatLanes
+    {
+    public:
+#if defined(FORGE_SIMD_AVX2)
+        static constexpr size_t Width = 8;
+        __m256 Value;
+
+        static inline FloatLanes Load(const float* values) { return {_mm256_loadu_ps(values)}; }
+        static inline FloatLanes Set(float value) { return {_mm256_set1_ps(value)}; }
+        inline void Store(float* values) const { _mm256_storeu_ps(values, Value); }
+        inline uint32_t GetMask() const { return uint32_t(_mm256_movemask_ps(Value)); }
+
+        inline FloatLanes operator+(FloatLanes other) const { return {_mm256_add_ps(Value, other.Value)}; }
+        inline FloatLanes operator-(FloatLanes other) const { return {_mm256_sub_ps(Value, other.Value)}; }
+        inline FloatLanes operator*(FloatLanes other) const { return {_mm256_mul_ps(Value, other.Value)}; }
+        inline FloatLanes operator&(FloatLanes other) const { return {_mm256_and_ps(Value, other.Value)}; }
+        inline FloatLanes operator|(FloatLanes other) const { return {_mm256_or_ps(Value, other.Value)}; }
+        inline FloatLanes operator<(FloatLanes other) const { return {_mm256_cmp_ps(Value, other.Value, _CMP_LT_OQ)}; }
+        inline FloatLanes operator<=(FloatLanes other) const { return {_mm256_cmp_ps(Value, other.Value, _CMP_LE_OQ)}; }
+        inline FloatLanes operator>(FloatLanes other) const { return {_mm256_cmp_ps(Value, other.Value, _CMP_GT_OQ)}; }
+        inline FloatLanes operator>=(FloatLanes other) const { return {_mm256_cmp_ps(Value, other.Value, _CMP_GE_OQ)}; }
+        static inline FloatLanes Abs(FloatLanes lanes) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), lanes.Value)}; }
+        static inline FloatLanes Min(FloatLanes a, FloatLanes b) { return {_mm256_min_ps(a.Value, b.Value)}; }
+        static inline FloatLanes Max(FloatLanes a, FloatLanes b) { return {_mm256_max_ps(a.Value, b.Value)}; }
+#elif defined(FORGE_SIMD_SSE2)
+        static constexpr size_t Width = 4;
+        __m128 Value;
+
+        static inline FloatLanes Load(const float* values) { return {_mm_loadu_ps(values)}; }
+        static inline FloatLanes Set(float value) { return {_mm_set1_ps(value)}; }
+        inline void Store(float* values) const { _mm_storeu_ps(values, Value); }
+        inline uint32_t GetMask() const { return uint32_t(_mm_movemask_ps(Value)); }
+
+        inline FloatLanes operator+(FloatLanes other) const { return {_mm_add_ps(Value, other.Value)}; }
+        inline FloatLanes operator-(FloatLanes other) const { return {_mm_sub_ps(Value, other.Value)}; }
+        inline FloatLanes operator*(FloatLanes other) const { return {_mm_mul_ps(Value, other.Value)}; }
+        inline FloatLanes operator&(FloatLanes other) const { return {_mm_and_ps(Value, other.Value)}; }
+        inline FloatLanes operator|(FloatLanes other) const { return {_mm_or_ps(Value, other.Value)}; }
+        inline FloatLanes operator<(FloatLanes other) const { return {_mm_cmplt_ps(Value, other.Value)}; }
+        inline FloatLanes operator<=(FloatLanes other) const { return {_mm_cmple_ps(Value, other.Value)}; }
+        inline FloatLanes operator>(FloatLanes other) const { return {_mm_cmpgt_ps(Value, other.Value)}; }
+        inline FloatLanes operator>=(FloatLanes other) const { return {_mm_cmpge_ps(Value, other.Value)}; }
+        static inline FloatLanes Abs(FloatLanes lanes) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), lanes.Value)}; }
+        static inline FloatLanes Min(FloatLanes a, FloatLanes b) { return {_mm_min_ps(a.Value, b.Value)}; }
+        static inline FloatLanes Max(FloatLanes a, FloatLanes b) { return {_mm_max_ps(a.Value, b.Value)}; }
+#else
+        static constexpr size_t Width = 1;
+        float Value;
+
+        static inline FloatLanes Load(const float* values) { return {*values}; }
+        static inline FloatLanes Set(float value) { return {value}; }
+        inline void Store(float* values) const { *values = Value; }
+        inline uint32_t GetMask() const { return std::signbit(Value) ? 1 : 0; }
+
+        inline FloatLanes operator+(FloatLanes other) const { return {Value + other.Value}; }
+        inline FloatLanes operator-(FloatLanes other) const { return {Value - other.Value}; }
+        inline FloatLanes operator*(FloatLanes other) const { return {Value * other.Value}; }
+        inline FloatLanes operator&(FloatLanes other) const { return FromBits(GetBits() & other.GetBits()); }
+        inline FloatLanes operator|(FloatLanes other) const { return FromBits(GetBits() | other.GetBits()); }
+        inline FloatLanes operator<(FloatLanes other) const { return FromBool(Value < other.Value); }
+        inline FloatLanes operator<=(FloatLanes other) const { return FromBool(Value <= other.Value); }
+        inline FloatLanes operator>(FloatLanes other) const { return FromBool(Value > other.Value); }
+        inline FloatLanes operator>=(FloatLanes other) const { return FromBool(Value >= other.Value); }
+        static inline FloatLanes Abs(FloatLanes lanes) { return {std::fabs(lanes.Value)}; }
+        static inline FloatLanes Min(FloatLanes a, FloatLanes b) { return {a.Value < b.Value ? a.Value : b.Value}; }
+        static inline FloatLanes Max(FloatLanes a, FloatLanes b) { return {a.Value > b.Value ? a.Value : b.Value}; }
+
+    private:
+        inline uint32_t GetBits() const
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &Value, sizeof(bits));
+            return bits;
+        }
+        static inline FloatLanes FromBits(uint32_t bits)
+        {
+            FloatLanes result;
+            std::memcpy(&result.Value, &bits, sizeof(bits));
+            return result;
+        }
+        static inline FloatLanes FromBool(bool value)
+        {
+            return FromBits(value ? 0xFFFFFFFF : 0);
+        }
+#endif
+    };
+
+}
@@ -6,17 +6,38 @@
 namespace Forge
 {
 
+	// Joints are stored parent first so that a single forward pass visits every parent before its children
 	struct FORGE_API Skeleton
 	{
 	public:
-		Scope<Joint> Root;
-		int JointCount;
+		// Palette index of each joint, matches the joint ids in the vertex data
+		std::vector<int> JointIds;
+		// Index of each joint's parent in these arrays, -1 for roots
+		std::vector<int> ParentIndices;
+		std::vector<glm::mat4> InverseBindTransforms;
 
 	public:
-		Skeleton() = default;
-		inline Skeleton(Scope<Joint>&& root, int jointCount)
-			: Root(std::move(root)), JointCount(jointCount)
-		{}
+		inline int GetJointCount() const { return int(JointIds.size()); }
+
+		inline void AddJoint(int id, int parentIndex, const glm::mat4& inverseBindTransform)
+		{
+			FORGE_ASSERT(parentIndex < GetJointCount(), "Parent joints must be added first");
+			JointIds.push_back(id);
+			ParentIndices.push_back(parentIndex);
+			InverseBindTransforms.push_back(inverseBindTransform);
+		}
+
+		// localTransforms and palette are indexed by joint id, worldTransforms is scratch space, all must have GetJointCount() elements
+		inline void CalculatePalette(const glm::mat4* localTransforms, glm::mat4* worldTransforms, glm::mat4* palette) const
+		{
+			for (size_t i = 0; i < JointIds.size(); i++)
+			{
+				int parent = ParentIndices[i];
+				const glm::mat4& local = localTransforms[JointIds[i]];
+				worldTransforms[i] = parent < 0 ? local : worldTransforms[parent] * local;
+				palette[JointIds[i]] = worldTransforms[i] * InverseBindTransforms[i];
+			}
+		}
 	};
 
 	class FORGE_API AnimatedMesh : public Mesh
@@ -31,17 +52,11 @@ namespace Forge
 		{
 		}
 
-		inline const Joint& GetRootJoint() const { return *m_Skeleton->Root; }
-		inline Joint& GetRootJoint() { return *m_Skeleton->Root; }
-		inline int GetJointCount() const { return m_Skeleton->JointCount; }
-		std::vector<glm::mat4> GetJointTransforms() const;
+		inline const Ref<Skeleton>& GetSkeleton() const { return m_Skeleton; }
+		inline int GetJointCount() const { return m_Skeleton->GetJointCount(); }
 		inline virtual bool IsAnimated() const override { return true; }
 
-		inline bool IsCompatible(const Ref<Animation>& animation) const { return animation == nullptr || animation->KeyFrames[0].Transforms.size() == GetJointCount(); }
-		virtual void Apply(const Ref<Shader>& shader, const ShaderRequirements& requirements) override;
-
-	private:
-		void RemoveAnimation();
+		inline bool IsCompatible(const Ref<Animation>& animation) const { return animation == nullptr || animation->GetJointCount() == GetJointCount(); }
 
 	};
 
@@ -1,28 +1,92 @@
 #pragma once
 #include "Joint.h"
+#include "AnimationCompression.h"
+
+#include <algorithm>
 
 namespace Forge
 {
 
-	struct FORGE_API AnimationKeyFrame
+	// Keys of a single animated property, sorted by time stamp
+	template<typename T>
+	struct FORGE_API AnimationTrack
+	{
+	public:
+		std::vector<float> TimeStamps;
+		std::vector<T> Values;
+
+	public:
+		inline bool IsEmpty() const { return TimeStamps.empty(); }
+		inline float GetLength() const { return IsEmpty() ? 0.0f : TimeStamps.back(); }
+
+		inline void AddKey(float time, const T& value)
+		{
+			TimeStamps.push_back(time);
+			Values.push_back(value);
+		}
+	};
+
+	struct FORGE_API JointAnimation
 	{
 	public:
-		std::vector<JointTransform> Transforms;
-		float TimeStamp;
+		AnimationTrack<glm::vec3> Translation;
+		AnimationTrack<QuantizedQuat> Orientation;
 	};
 
 	struct FORGE_API Animation
 	{
 	public:
-		std::vector<AnimationKeyFrame> KeyFrames;
+		// Indexed by joint id
+		std::vector<JointAnimation> Joints;
 
 	public:
+		inline int GetJointCount() const { return int(Joints.size()); }
 		inline float GetLength() const
 		{
-			if (KeyFrames.empty())
-				return 0.0f;
-			return KeyFrames.back().TimeStamp;
+			float length = 0.0f;
+			for (const JointAnimation& joint : Joints)
+				length = std::max({ length, joint.Translation.GetLength(), joint.Orientation.GetLength() });
+			return length;
 		}
 	};
 
+	// Playback normally moves forward by at most a few keys per frame, further jumps are treated as seeks
+	constexpr uint32_t KeyFrameCursorSteps = 4;
+
+	// Returns the index of the last key at or before time, cursor is the result of the previous lookup on the same track
+	inline uint32_t FindKeyFrame(const std::vector<float>& timeStamps, float time, uint32_t cursor)
+	{
+		uint32_t count = uint32_t(timeStamps.size());
+		if (cursor < count && timeStamps[cursor] <= time)
+		{
+			for (uint32_t i = 0; i < KeyFrameCursorSteps; i++)
+			{
+				if (cursor + 1 >= count || timeStamps[cursor + 1] > time)
+					return cursor;
+				cursor++;
+			}
+		}
+		auto it = std::upper_bound(timeStamps.begin(), timeStamps.end(), time);
+		return it == timeStamps.begin() ? 0 : uint32_t(it - timeStamps.begin() - 1);
+	}
+
+	inline const glm::vec3& DecodeKey(const glm::vec3& key) { return key; }
+	inline const glm::quat& DecodeKey(const glm::quat& key) { return key; }
+	inline glm::quat DecodeKey(const QuantizedQuat& key) { return key.Decode(); }
+
+	inline glm::vec3 InterpolateKeys(const glm::vec3& a, const glm::vec3& b, float t) { return a + (b - a) * t; }
+	inline glm::quat InterpolateKeys(const glm::quat& a, const glm::quat& b, float t) { return glm::slerp(a, b, t); }
+
+	// Track must not be empty, cursor is updated to the key used
+	template<typename T>
+	inline auto SampleTrack(const AnimationTrack<T>& track, float time, uint32_t& cursor)
+	{
+		using ValueType = std::decay_t<decltype(DecodeKey(track.Values[0]))>;
+		cursor = FindKeyFrame(track.TimeStamps, time, cursor);
+		if (cursor + 1 >= track.TimeStamps.size() || time <= track.TimeStamps[cursor])
+			return ValueType(DecodeKey(track.Values[cursor]));
+		float t = (time - track.TimeStamps[cursor]) / (track.TimeStamps[cursor + 1] - track.TimeStamps[cursor]);
+		return InterpolateKeys(ValueType(DecodeKey(track.Values[cursor])), ValueType(DecodeKey(track.Values[cursor + 1])), t);
+	}
+
 }
@@ -0,0 +1,147 @@
+#include "ForgePch.h"
+#include "AnimationCompression.h"
+#include "Animation.h"
+
+namespace Forge
+{
+
+    // The three smallest components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+    static constexpr float QuantizedComponentRange = 0.70710678f;
+    static constexpr uint16_t QuantizedComponentMax = 0x7FFF;
+
+    QuantizedQuat QuantizedQuat::Encode(const glm::quat& orientation)
+    {
+        glm::quat q = glm::normalize(orientation);
+        float components[4] = { q.x, q.y, q.z, q.w };
+        int largest = 0;
+        for (int i = 1; i < 4; i++)
+        {
+            if (std::abs(components[i]) > std::abs(components[largest]))
+                largest = i;
+        }
+        // q and -q are the same rotation, so the dropped component is always reconstructed as positive
+        float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        QuantizedQuat result;
+        int index = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+            float normalized = (components[i] * sign + QuantizedComponentRange) / (2.0f * QuantizedComponentRange);
+            result.Components[index++] = uint16_t(std::round(std::clamp(normalized, 0.0f, 1.0f) * QuantizedComponentMax));
+        }
+        result.Components[0] |= uint16_t((largest & 1) << 15);
+        result.Components[1] |= uint16_t((largest >> 1) << 15);
+        return result;
+    }
+
+    glm::quat QuantizedQuat::Decode() const
+    {
+        int largest = (Components[0] >> 15) | ((Components[1] >> 15) << 1);
+        float components[4];
+        float sum = 0.0f;
+        int index = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+            float normalized = float(Components[index++] & QuantizedComponentMax) / QuantizedComponentMax;
+            components[i] = normalized * 2.0f * QuantizedComponentRange - QuantizedComponentRange;
+            sum += components[i] * components[i];
+        }
+        components[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+        return glm::quat(components[3], components[0], components[1], components[2]);
+    }
+
+    float AngleBetween(const glm::quat& a, const glm::quat& b)
+    {
+        // atan2 form stays accurate for small angles, acos of the dot product does not in single precision
+        float sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+        float difference = 0.0f;
+        float sum = 0.0f;
+        for (int i = 0; i < 4; i++)
+        {
+            float d = a[i] - b[i] * sign;
+            float s = a[i] + b[i] * sign;
+            difference += d * d;
+            sum += s * s;
+        }
+        return 2.0f * std::atan2(std::sqrt(difference), std::sqrt(sum));
+    }
+
+    static float KeyError(const glm::vec3& reconstructed, const glm::vec3& source)
+    {
+        return glm::length(reconstructed - source);
+    }
+
+    static float KeyError(const glm::quat& reconstructed, const glm::quat& source)
+    {
+        return AngleBetween(reconstructed, source);
+    }
+
+    // Indices of the keys to keep, error is measured between values interpolated from stored keys and the source values
+    template<typename T>
+    static std::vector<size_t> SelectKeys(const std::vector<float>& timeStamps, const std::vector<T>& stored, const std::vector<T>& source, float tolerance)
+    {
+        std::vector<size_t> keys;
+        size_t count = timeStamps.size();
+        if (count == 0)
+            return keys;
+        keys.push_back(0);
+
+        bool constant = true;
+        for (size_t i = 1; i < count && constant; i++)
+            constant = KeyError(stored[0], source[i]) <= tolerance;
+        if (constant)
+            return keys;
+
+        size_t anchor = 0;
+        for (size_t end = anchor + 2; end < count; end++)
+        {
+            float duration = timeStamps[end] - timeStamps[anchor];
+            bool valid = true;
+            for (size_t i = anchor + 1; i < end && valid; i++)
+            {
+                float t = duration > 0.0f ? (timeStamps[i] - timeStamps[anchor]) / duration : 0.0f;
+                valid = KeyError(InterpolateKeys(stored[anchor], stored[end], t), source[i]) <= tolerance;
+            }
+            if (!valid)
+            {
+                anchor = end - 1;
+                keys.push_back(anchor);
+            }
+        }
+        if (count > 1)
+            keys.push_back(count - 1);
+        return keys;
+    }
+
+    AnimationTrack<glm::vec3> CompressTrack(const AnimationTrack<glm::vec3>& track, float tolerance)
+    {
+        AnimationTrack<glm::vec3> result;
+        for (size_t key : SelectKeys(track.TimeStamps, track.Values, track.Values, tolerance))
+            result.AddKey(track.TimeStamps[key], track.Values[key]);
+        return result;
+    }
+
+    AnimationTrack<QuantizedQuat> CompressTrack(const AnimationTrack<glm::quat>& track, float tolerance)
+    {
+        // Keys are selected against their quantized values so the tolerance includes quantization error
+        std::vector<QuantizedQuat> quantized;
+        std::vector<glm::quat> decoded;
+        quantized.reserve(track.Values.size());
+        decoded.reserve(track.Values.size());
+        for (const glm::quat& value : track.Values)
+        {
+            quantized.push_back(QuantizedQuat::Encode(value));
+            decoded.push_back(quantized.back().Decode());
+        }
+
+        AnimationTrack<QuantizedQuat> result;
+        for (size_t key : SelectKeys(track.TimeStamps, decoded, track.Values, tolerance))
+            result.AddKey(track.TimeStamps[key], quantized[key]);
+        return result;
+    }
+
+}
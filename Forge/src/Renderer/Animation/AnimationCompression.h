@@ -0,0 +1,37 @@
+#pragma once
+#include "Joint.h"
+
+namespace Forge
+{
+
+	// Rotation stored as its three smallest components in 15 bits each, the index of the dropped largest component is kept in the spare top bits
+	struct FORGE_API QuantizedQuat
+	{
+	public:
+		uint16_t Components[3];
+
+	public:
+		static QuantizedQuat Encode(const glm::quat& orientation);
+		glm::quat Decode() const;
+	};
+
+	struct FORGE_API AnimationCompressionSettings
+	{
+	public:
+		// Maximum distance a reconstructed translation may be from the source
+		float TranslationTolerance = 0.0001f;
+		// Maximum angle in radians a reconstructed orientation may be from the source, includes quantization error
+		float OrientationTolerance = 0.001f;
+	};
+
+	template<typename T>
+	struct AnimationTrack;
+
+	// Removes keys that can be reconstructed within tolerance by interpolating their neighbours, constant tracks are collapsed to a single key
+	AnimationTrack<glm::vec3> CompressTrack(const AnimationTrack<glm::vec3>& track, float tolerance);
+	AnimationTrack<QuantizedQuat> CompressTrack(const AnimationTrack<glm::quat>& track, float tolerance);
+
+	// Angle in radians between two orientations
+	float AngleBetween(const glm::quat& a, const glm::quat& b);
+
+}
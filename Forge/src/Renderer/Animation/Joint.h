@@ -31,13 +31,4 @@ namespace Forge
 		}
 	};
 
-	struct FORGE_API Joint
-	{
-	public:
-		glm::mat4 Transform;
-		int Id;
-		std::vector<Scope<Joint>> Children;
-		glm::mat4 InverseBindTransform;
-	};
-
 }
@@ -18,6 +18,13 @@ namespace Forge
         Init(data, sizeBytes);
     }
 
+    VertexBuffer::VertexBuffer(size_t sizeBytes, const BufferLayout& layout, GLbitfield storageFlags)
+        : m_Handle(), m_Layout(layout)
+    {
+        glCreateBuffers(1, &m_Handle.Id);
+        glNamedBufferStorage(m_Handle.Id, sizeBytes, nullptr, storageFlags);
+    }
+
     void VertexBuffer::Bind() const
     {
         glBindBuffer(GL_ARRAY_BUFFER, m_Handle.Id);
@@ -33,6 +40,18 @@ namespace Forge
         glNamedBufferSubData(m_Handle.Id, 0, sizeBytes, data);
     }
 
+    void* VertexBuffer::Map()
+    {
+        if (m_Handle.Id == 0)
+            return nullptr;
+        return glMapNamedBuffer(m_Handle.Id, GL_WRITE_ONLY);
+    }
+
+    bool VertexBuffer::Unmap()
+    {
+        return glUnmapNamedBuffer(m_Handle.Id) == GL_TRUE;
+    }
+
     Ref<VertexBuffer> VertexBuffer::Create(size_t sizeBytes, const BufferLayout& layout)
     {
         return CreateRef<VertexBuffer>(nullptr, sizeBytes, layout);
@@ -78,6 +97,23 @@ namespace Forge
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
+    void IndexBuffer::SetData(const Type* data, size_t sizeBytes)
+    {
+        glNamedBufferSubData(m_Handle.Id, 0, sizeBytes, data);
+    }
+
+    void* IndexBuffer::Map()
+    {
+        if (m_Handle.Id == 0)
+            return nullptr;
+        return glMapNamedBuffer(m_Handle.Id, GL_WRITE_ONLY);
+    }
+
+    bool IndexBuffer::Unmap()
+    {
+        return glUnmapNamedBuffer(m_Handle.Id) == GL_TRUE;
+    }
+
     Ref<IndexBuffer> IndexBuffer::Create(size_t sizeBytes, ShaderDataType type)
     {
         return CreateRef<IndexBuffer>(nullptr, sizeBytes, type);
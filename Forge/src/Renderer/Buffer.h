@@ -66,12 +66,19 @@ namespace Forge
 	public:
 		VertexBuffer();
 		VertexBuffer(const void* data, size_t sizeBytes, const BufferLayout& layout);
+		// Immutable storage allocated with glNamedBufferStorage
+		VertexBuffer(size_t sizeBytes, const BufferLayout& layout, GLbitfield storageFlags);
 
+		inline uint32_t GetId() const { return m_Handle.Id; }
 		inline const BufferLayout& GetLayout() const { return m_Layout; }
 		void Bind() const;
 		void Unbind() const;
 
 		void SetData(const void* data, size_t sizeBytes);
+		// Maps the buffer for writing, returns nullptr if the buffer is empty or cannot be mapped
+		void* Map();
+		// Returns false if the contents were lost while mapped and must be written again
+		bool Unmap();
 
 	public:
 		static Ref<VertexBuffer> Create(size_t sizeBytes, const BufferLayout& layout);
@@ -103,6 +110,12 @@ namespace Forge
 		void Bind() const;
 		void Unbind() const;
 
+		void SetData(const Type* data, size_t sizeBytes);
+		// Maps the buffer for writing, returns nullptr if the buffer is empty or cannot be mapped
+		void* Map();
+		// Returns false if the contents were lost while mapped and must be written again
+		bool Unmap();
+
 	public:
 		static Ref<IndexBuffer> Create(size_t sizeBytes, ShaderDataType type = ShaderDataType::Uint);
 		static Ref<IndexBuffer> Create(const Type* data, size_t sizeBytes, ShaderDataType type = ShaderDataType::Uint);
@@ -0,0 +1,143 @@
+#include "ForgePch.h"
+#include "DynamicVertexBuffer.h"
+
+#include <chrono>
+
+namespace Forge
+{
+
+    static constexpr uint64_t s_NeverMapped = ~uint64_t(0);
+
+    uint64_t DynamicVertexBuffer::s_Frame = 0;
+    DynamicBufferStats DynamicVertexBuffer::s_FrameStats = {};
+
+    DynamicVertexBuffer::DynamicVertexBuffer(size_t capacityBytes, const BufferLayout& layout, uint32_t frameCount)
+        : m_Buffer(),
+          m_Capacity(0),
+          m_FrameCount(0),
+          m_PersistentMapping(nullptr),
+          m_Fences(),
+          m_Region(0),
+          m_Frame(s_NeverMapped),
+          m_UsedBytes(0),
+          m_MappedOffset(0),
+          m_Mapped(false)
+    {
+        FORGE_ASSERT(frameCount > 0, "Dynamic vertex buffers need at least one region");
+        // Regions start on a whole vertex so that every map has a base vertex
+        size_t stride = layout.GetStride();
+        m_Capacity = (capacityBytes + stride - 1) / stride * stride;
+        if (GLAD_GL_VERSION_4_4)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            m_FrameCount = frameCount;
+            m_Buffer = CreateRef<VertexBuffer>(m_Capacity * m_FrameCount, layout, flags);
+            m_PersistentMapping = (uint8_t*)glMapNamedBufferRange(m_Buffer->GetId(), 0, m_Capacity * m_FrameCount, flags);
+            if (m_PersistentMapping)
+            {
+                m_Fences.resize(m_FrameCount, nullptr);
+                return;
+            }
+            // Immutable storage cannot be orphaned, so fall back to a mutable buffer
+            FORGE_WARN("Failed to persistently map a dynamic vertex buffer, falling back to orphaning");
+        }
+        m_FrameCount = 1;
+        m_Buffer = VertexBuffer::Create(m_Capacity, layout);
+    }
+
+    DynamicVertexBuffer::~DynamicVertexBuffer()
+    {
+        for (GLsync fence : m_Fences)
+        {
+            if (fence)
+                glDeleteSync(fence);
+        }
+        if (m_PersistentMapping || m_Mapped)
+            m_Buffer->Unmap();
+    }
+
+    bool DynamicVertexBuffer::CanMap(size_t sizeBytes) const
+    {
+        size_t usedBytes = m_Frame == s_Frame ? m_UsedBytes : 0;
+        return usedBytes + sizeBytes <= m_Capacity;
+    }
+
+    void* DynamicVertexBuffer::Map(size_t sizeBytes)
+    {
+        FORGE_ASSERT(!m_Mapped, "Dynamic vertex buffer is already mapped");
+        FORGE_ASSERT(sizeBytes <= m_Capacity, "Data does not fit in a region of the dynamic vertex buffer");
+        if (m_Frame != s_Frame || m_UsedBytes + sizeBytes > m_Capacity)
+            NextRegion();
+
+        size_t stride = m_Buffer->GetLayout().GetStride();
+        m_MappedOffset = m_Region * m_Capacity + m_UsedBytes;
+        m_UsedBytes += (sizeBytes + stride - 1) / stride * stride;
+        m_Mapped = true;
+        s_FrameStats.UploadBytes += sizeBytes;
+        if (m_PersistentMapping)
+            return m_PersistentMapping + m_MappedOffset;
+        // The storage was orphaned since anything in the range was drawn
+        return glMapNamedBufferRange(m_Buffer->GetId(), m_MappedOffset, sizeBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    void DynamicVertexBuffer::Unmap()
+    {
+        FORGE_ASSERT(m_Mapped, "Dynamic vertex buffer is not mapped");
+        if (!m_PersistentMapping)
+            m_Buffer->Unmap();
+        m_Mapped = false;
+    }
+
+    void DynamicVertexBuffer::SetData(const void* data, size_t sizeBytes)
+    {
+        void* memory = Map(sizeBytes);
+        if (memory)
+            memcpy(memory, data, sizeBytes);
+        Unmap();
+    }
+
+    Ref<DynamicVertexBuffer> DynamicVertexBuffer::Create(size_t capacityBytes, const BufferLayout& layout, uint32_t frameCount)
+    {
+        return CreateRef<DynamicVertexBuffer>(capacityBytes, layout, frameCount);
+    }
+
+    DynamicBufferStats DynamicVertexBuffer::EndFrame()
+    {
+        DynamicBufferStats stats = s_FrameStats;
+        s_FrameStats = {};
+        s_Frame++;
+        return stats;
+    }
+
+    void DynamicVertexBuffer::NextRegion()
+    {
+        m_UsedBytes = 0;
+        if (!m_PersistentMapping)
+        {
+            glNamedBufferData(m_Buffer->GetId(), m_Capacity, nullptr, GL_STREAM_DRAW);
+            m_Frame = s_Frame;
+            return;
+        }
+
+        // The data of the current region has been drawn
+        if (m_Frame != s_NeverMapped)
+            m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_Region = (m_Region + 1) % m_FrameCount;
+        m_Frame = s_Frame;
+
+        GLsync fence = m_Fences[m_Region];
+        if (!fence)
+            return;
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            auto start = std::chrono::steady_clock::now();
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            s_FrameStats.StallMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            s_FrameStats.StallCount++;
+        }
+        glDeleteSync(fence);
+        m_Fences[m_Region] = nullptr;
+    }
+
+}
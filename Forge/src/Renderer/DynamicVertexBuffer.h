@@ -0,0 +1,74 @@
+#pragma once
+#include "Buffer.h"
+
+namespace Forge
+{
+
+	struct FORGE_API DynamicBufferStats
+	{
+	public:
+		// Bytes mapped for writing in dynamic vertex buffers
+		size_t UploadBytes = 0;
+		// Time spent waiting for the GPU to finish reading a region before it could be written
+		float StallMs = 0.0f;
+		uint32_t StallCount = 0;
+	};
+
+	// Vertex buffer rewritten by the CPU every frame.
+	// The buffer is split into one region per frame in flight that are written in turn. With GL 4.4 the whole buffer stays
+	// persistently mapped, and a region is written once the fence placed after its last frame has signalled. Otherwise, or if the
+	// persistent mapping fails, the buffer holds a single region that is orphaned at the start of every frame.
+	// Data mapped in the same frame is placed one after the other in the region of the frame, data that does not fit moves to the
+	// next region. Data must be drawn before a later map moves past its region, and draws must start at GetBaseVertex() of their data
+	class FORGE_API DynamicVertexBuffer
+	{
+	public:
+		static constexpr uint32_t DefaultFrameCount = 3;
+
+	private:
+		Ref<VertexBuffer> m_Buffer;
+		// Bytes of each region
+		size_t m_Capacity;
+		uint32_t m_FrameCount;
+		uint8_t* m_PersistentMapping;
+		std::vector<GLsync> m_Fences;
+		uint32_t m_Region;
+		// Frame of the last Map() and the bytes of the region used during it
+		uint64_t m_Frame;
+		size_t m_UsedBytes;
+		size_t m_MappedOffset;
+		bool m_Mapped;
+
+		static uint64_t s_Frame;
+		static DynamicBufferStats s_FrameStats;
+
+	public:
+		DynamicVertexBuffer(size_t capacityBytes, const BufferLayout& layout, uint32_t frameCount = DefaultFrameCount);
+		DynamicVertexBuffer(const DynamicVertexBuffer& other) = delete;
+		DynamicVertexBuffer& operator=(const DynamicVertexBuffer& other) = delete;
+		~DynamicVertexBuffer();
+
+		inline const Ref<VertexBuffer>& GetVertexBuffer() const { return m_Buffer; }
+		inline size_t GetCapacity() const { return m_Capacity; }
+		inline bool IsPersistent() const { return m_PersistentMapping != nullptr; }
+		// Index of the first vertex written by the last Map(), passed as the base vertex or base instance of the draws that read it
+		inline uint32_t GetBaseVertex() const { return uint32_t(m_MappedOffset / m_Buffer->GetLayout().GetStride()); }
+
+		// Whether sizeBytes fit in what is left of the region of this frame
+		bool CanMap(size_t sizeBytes) const;
+		// Returns write only memory for sizeBytes, which must not exceed the capacity. Moving to the next region waits for the GPU
+		// if it is still reading it. The memory can be written from any thread until Unmap()
+		void* Map(size_t sizeBytes);
+		void Unmap();
+		void SetData(const void* data, size_t sizeBytes);
+
+	public:
+		static Ref<DynamicVertexBuffer> Create(size_t capacityBytes, const BufferLayout& layout, uint32_t frameCount = DefaultFrameCount);
+		// Must be called once per frame after every draw of the frame was issued, returns the stats of the frame
+		static DynamicBufferStats EndFrame();
+
+	private:
+		void NextRegion();
+	};
+
+}
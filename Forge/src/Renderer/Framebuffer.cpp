@@ -39,6 +39,57 @@ namespace Forge
         return nullptr;
     }
 
+    PixelReadback::PixelReadback() : m_Buffer(), m_Fence(nullptr), m_Ready(false)
+    {
+        glCreateBuffers(1, &m_Buffer.Id);
+        glNamedBufferStorage(m_Buffer.Id, sizeof(int), nullptr, 0);
+    }
+
+    PixelReadback::~PixelReadback()
+    {
+        if (m_Fence)
+            glDeleteSync(m_Fence);
+    }
+
+    bool PixelReadback::IsReady()
+    {
+        if (!m_Ready)
+        {
+            GLenum status = glClientWaitSync(m_Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            m_Ready = status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+        }
+        return m_Ready;
+    }
+
+    int PixelReadback::GetInt()
+    {
+        int value;
+        Read(&value, sizeof(value));
+        return value;
+    }
+
+    float PixelReadback::GetFloat()
+    {
+        float value;
+        Read(&value, sizeof(value));
+        return value;
+    }
+
+    void PixelReadback::Read(void* data, size_t size)
+    {
+        if (!m_Ready)
+        {
+            glClientWaitSync(m_Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            m_Ready = true;
+        }
+        glGetNamedBufferSubData(m_Buffer.Id, 0, size, data);
+    }
+
+    void PixelReadback::Fence()
+    {
+        m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
     Framebuffer::Framebuffer(const FramebufferProps& props) : m_Handle(), m_Props(props)
     {
         FORGE_ASSERT(props.Width > 0 && props.Height > 0, "Invalid framebuffer dimensions");
@@ -104,6 +155,34 @@ namespace Forge
         return pixelData;
     }
 
+    Ref<PixelReadback> Framebuffer::ReadPixelAsync(int index, int x, int y)
+    {
+        FORGE_ASSERT(index >= 0 && index < m_ColorAttachmentSpecifications.size(), "Invalid attachment index");
+        Ref<PixelReadback> readback = CreateRef<PixelReadback>();
+        Bind();
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + index);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->m_Buffer.Id);
+        glReadPixels(x, y, 1, 1, GL_RED_INTEGER, GL_INT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback->Fence();
+        return readback;
+    }
+
+    Ref<PixelReadback> Framebuffer::ReadDepthPixelAsync(int x, int y)
+    {
+        FORGE_ASSERT(m_DepthAttachment != nullptr &&
+                       m_DepthAttachmentSpecification.TextureType == FramebufferTextureType::Texture2D &&
+                       m_DepthAttachmentSpecification.TextureFormat != FramebufferTextureFormat::None,
+          "Invalid depth attachment");
+        Ref<PixelReadback> readback = CreateRef<PixelReadback>();
+        Bind();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->m_Buffer.Id);
+        glReadPixels(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback->Fence();
+        return readback;
+    }
+
     Ref<Framebuffer> Framebuffer::Create(const FramebufferProps& props)
     {
         Ref<Framebuffer> framebuffer = CreateRef<Framebuffer>(props);
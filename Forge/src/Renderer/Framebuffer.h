@@ -79,6 +79,36 @@ namespace Forge
         std::vector<FramebufferTextureSpecification> Attachments;
     };
 
+    // Pixel copied into a pixel buffer object by Framebuffer::ReadPixelAsync().
+    // The copy is fenced, so the value can be fetched without stalling once the GPU has caught up (usually a frame or two later)
+    class FORGE_API PixelReadback
+    {
+    private:
+        using Handle = Detail::ScopedId<Detail::BufferDestructor>;
+
+        Handle m_Buffer;
+        GLsync m_Fence;
+        bool m_Ready;
+
+    public:
+        PixelReadback();
+        PixelReadback(const PixelReadback& other) = delete;
+        PixelReadback& operator=(const PixelReadback& other) = delete;
+        ~PixelReadback();
+
+        // Does not block
+        bool IsReady();
+        // Block until the copy has finished if it is not ready yet
+        int GetInt();
+        float GetFloat();
+
+        friend class Framebuffer;
+
+    private:
+        void Read(void* data, size_t size);
+        void Fence();
+    };
+
     class FORGE_API Framebuffer
     {
     private:
@@ -139,8 +169,11 @@ namespace Forge
         void Unbind() const;
         void SetSize(uint32_t width, uint32_t height);
         void ClearAttachment(int index, int value);
+        // Blocks until every queued command has been executed by the GPU, prefer the async versions
         int ReadPixel(int index, int x, int y);
         float ReadDepthPixel(int x, int y);
+        Ref<PixelReadback> ReadPixelAsync(int index, int x, int y);
+        Ref<PixelReadback> ReadDepthPixelAsync(int x, int y);
 
         friend class RenderTexture;
 
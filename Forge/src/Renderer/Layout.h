@@ -30,6 +30,7 @@ namespace Forge
 
 		Sampler1D,
 		Sampler2D,
+		Sampler2DArray,
 		Sampler3D,
 		SamplerCube,
 	};
@@ -101,6 +102,7 @@ namespace Forge
 			return 16 * sizeof(GLfloat);
 		case ShaderDataType::Sampler1D:
 		case ShaderDataType::Sampler2D:
+		case ShaderDataType::Sampler2DArray:
 		case ShaderDataType::Sampler3D:
 		case ShaderDataType::SamplerCube:
 			return 1 * sizeof(int);
@@ -7,6 +7,8 @@
 namespace Forge
 {
 
+    uint32_t Material::s_NextId = 0;
+
     Material::Material() : Material(nullptr) {}
 
     Material::Material(const Ref<Shader>& shader)
@@ -16,14 +18,18 @@ namespace Forge
     }
 
     Material::Material(const MaterialShaderSet& shaders)
-        : m_Shaders({shaders.PickShader,
+        : m_Id(s_NextId++),
+          m_Shaders({shaders.PickShader,
             shaders.WithShadowShader,
             shaders.WithoutShadowShader,
             shaders.ShadowFormationShaders.PointShadow,
             shaders.ShadowFormationShaders.Shadow}),
+          m_InstancedShaders(),
           m_Uniforms(),
           m_CastsShadows(true)
     {
+        for (int i = 0; i < RENDER_PASS_COUNT; i++)
+            m_InstancedShaders[i] = GraphicsCache::GetInstancedShader(m_Shaders[i]);
         m_Uniforms.AddFromDescriptors(
           RenderPass::PointShadowFormation, GetShader(RenderPass::PointShadowFormation)->GetUniformDescriptors());
         m_Uniforms.AddFromDescriptors(
@@ -36,9 +42,21 @@ namespace Forge
         m_Uniforms.Init();
     }
 
+    void Material::SetShader(RenderPass pass, const Ref<Shader>& shader)
+    {
+        m_Shaders[int(pass)] = shader;
+        m_InstancedShaders[int(pass)] = GraphicsCache::GetInstancedShader(shader);
+        m_Uniforms.ClearHandles();
+    }
+
     void Material::Apply(RenderPass pass, RendererContext& context) const
     {
-        m_Uniforms.Apply(pass, GetShader(pass), context);
+        Apply(pass, GetShader(pass), context);
+    }
+
+    void Material::Apply(RenderPass pass, const Ref<Shader>& shader, RendererContext& context) const
+    {
+        m_Uniforms.Apply(pass, shader, context);
     }
 
     Ref<Material> Material::CreateFromShaderSource(
@@ -7,6 +7,7 @@ namespace Forge
 {
 
     constexpr const char ShadowMapShaderDefine[] = "SHADOW_MAP";
+    constexpr const char InstancedShaderDefine[] = "INSTANCED";
 
     struct FORGE_API ShadowFormationShaderSet
     {
@@ -27,7 +28,11 @@ namespace Forge
     class FORGE_API Material
     {
     private:
+        static uint32_t s_NextId;
+
+        uint32_t m_Id;
         std::array<Ref<Shader>, RENDER_PASS_COUNT> m_Shaders;
+        std::array<Ref<Shader>, RENDER_PASS_COUNT> m_InstancedShaders;
         UniformContext m_Uniforms;
         RenderSettings m_Settings;
         bool m_CastsShadows;
@@ -38,6 +43,11 @@ namespace Forge
         Material(const MaterialShaderSet& shaders);
         virtual ~Material() = default;
 
+        // Unique id used to group draws that share a material
+        inline uint32_t GetId() const
+        {
+            return m_Id;
+        }
         inline const RenderSettings& GetSettings() const
         {
             return m_Settings;
@@ -51,6 +61,11 @@ namespace Forge
         {
             return m_Shaders[int(pass)];
         }
+        // Variant of the pass shader that reads per instance data, nullptr if the shader has no instanced variant
+        inline const Ref<Shader>& GetInstancedShader(RenderPass pass) const
+        {
+            return m_InstancedShaders[int(pass)];
+        }
         inline const UniformContext& GetUniforms() const
         {
             return m_Uniforms;
@@ -64,10 +79,7 @@ namespace Forge
             return m_CastsShadows;
         }
 
-        inline void SetShader(RenderPass pass, const Ref<Shader>& shader)
-        {
-            m_Shaders[int(pass)] = shader;
-        }
+        void SetShader(RenderPass pass, const Ref<Shader>& shader);
 
         inline void SetCastsShadows(bool castsShadows)
         {
@@ -75,6 +87,7 @@ namespace Forge
         }
 
         void Apply(RenderPass pass, RendererContext& context) const;
+        void Apply(RenderPass pass, const Ref<Shader>& shader, RendererContext& context) const;
 
     public:
         static Ref<Material> CreateFromShaderSource(
@@ -8,13 +8,13 @@ namespace Forge
 #define FORGE_UNIFORM_REFERENCE(T, Offset) (*(T*)(m_Buffer.get() + (Offset)))
 
 	UniformContext::UniformContext()
-		: m_Size(0), m_TextureSize(0), m_UniformSpecificationIndices(), m_UniformSpecifications(), m_Buffer(nullptr), m_Textures(nullptr)
+		: m_Size(0), m_TextureSize(0), m_UniformSpecificationIndices(), m_UniformSpecifications(), m_Buffer(nullptr), m_Textures(nullptr), m_ShaderHandles()
 	{
 	}
 
 	UniformContext::UniformContext(const UniformContext& other)
 		: m_Size(other.m_Size), m_TextureSize(other.m_TextureSize), m_UniformSpecificationIndices(other.m_UniformSpecificationIndices), m_UniformSpecifications(other.m_UniformSpecifications),
-		m_Buffer(), m_Textures()
+		m_Buffer(), m_Textures(), m_ShaderHandles(other.m_ShaderHandles)
 	{
 		m_Buffer = std::make_unique<std::byte[]>(m_Size);
 		std::memcpy(m_Buffer.get(), other.m_Buffer.get(), m_Size);
@@ -29,6 +29,7 @@ namespace Forge
 		m_TextureSize = other.m_TextureSize;
 		m_UniformSpecificationIndices = other.m_UniformSpecificationIndices;
 		m_UniformSpecifications = other.m_UniformSpecifications;
+		m_ShaderHandles = other.m_ShaderHandles;
 		m_Buffer = std::make_unique<std::byte[]>(m_Size);
 		std::memcpy(m_Buffer.get(), other.m_Buffer.get(), m_Size);
 		m_Textures = std::make_unique<Ref<Texture>[]>(m_TextureSize);
@@ -75,7 +76,7 @@ namespace Forge
 		int index = 0;
 		for (const UniformSpecification& specification : m_UniformSpecifications)
 		{
-			if (specification.Type == ShaderDataType::Sampler1D || specification.Type == ShaderDataType::Sampler2D || specification.Type == ShaderDataType::Sampler3D || specification.Type == ShaderDataType::SamplerCube)
+			if (specification.Type == ShaderDataType::Sampler1D || specification.Type == ShaderDataType::Sampler2D || specification.Type == ShaderDataType::Sampler2DArray || specification.Type == ShaderDataType::Sampler3D || specification.Type == ShaderDataType::SamplerCube)
 			{
 				m_Textures[index] = nullptr;
 				FORGE_UNIFORM_REFERENCE(int, specification.Offset) = index;
@@ -90,50 +91,55 @@ namespace Forge
 
 	void UniformContext::Apply(RenderPass pass, const Ref<Shader>& shader, RendererContext& context) const
 	{
-		for (const UniformSpecification& specification : m_UniformSpecifications)
+		const std::vector<UniformHandle>& handles = GetHandles(shader);
+		for (size_t i = 0; i < m_UniformSpecifications.size(); i++)
 		{
+			const UniformSpecification& specification = m_UniformSpecifications[i];
 			if (specification.RenderPasses.test(size_t(pass)))
 			{
 				switch (specification.Type)
 				{
 				case ShaderDataType::Mat4:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(glm::mat4, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(glm::mat4, specification.Offset));
 					break;
 				case ShaderDataType::Mat3:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(glm::mat3, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(glm::mat3, specification.Offset));
 					break;
 				case ShaderDataType::Mat2:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(glm::mat2, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(glm::mat2, specification.Offset));
 					break;
 				case ShaderDataType::Float:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(float, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(float, specification.Offset));
 					break;
 				case ShaderDataType::Float2:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(glm::vec2, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(glm::vec2, specification.Offset));
 					break;
 				case ShaderDataType::Float3:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(glm::vec3, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(glm::vec3, specification.Offset));
 					break;
 				case ShaderDataType::Float4:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(glm::vec4, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(glm::vec4, specification.Offset));
 					break;
 				case ShaderDataType::Int:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(int, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(int, specification.Offset));
 					break;
 				case ShaderDataType::Bool:
-					shader->SetUniform(specification.VariableName, FORGE_UNIFORM_REFERENCE(bool, specification.Offset));
+					shader->SetUniform(handles[i], FORGE_UNIFORM_REFERENCE(bool, specification.Offset));
 					break;
 				case ShaderDataType::Sampler1D:
-					ApplyTextureUniform(shader, specification, context, GL_TEXTURE_1D);
+					ApplyTextureUniform(shader, specification, handles[i], context, GL_TEXTURE_1D);
 					break;
 				case ShaderDataType::Sampler2D:
-					ApplyTextureUniform(shader, specification, context, GL_TEXTURE_2D);
+					ApplyTextureUniform(shader, specification, handles[i], context, GL_TEXTURE_2D);
+					break;
+				case ShaderDataType::Sampler2DArray:
+					ApplyTextureUniform(shader, specification, handles[i], context, GL_TEXTURE_2D_ARRAY);
 					break;
 				case ShaderDataType::Sampler3D:
-					ApplyTextureUniform(shader, specification, context, GL_TEXTURE_3D);
+					ApplyTextureUniform(shader, specification, handles[i], context, GL_TEXTURE_3D);
 					break;
 				case ShaderDataType::SamplerCube:
-					ApplyTextureUniform(shader, specification, context, GL_TEXTURE_CUBE_MAP);
+					ApplyTextureUniform(shader, specification, handles[i], context, GL_TEXTURE_CUBE_MAP);
 					break;
 				default:
 					FORGE_ASSERT(false, "Invalid uniform type");
@@ -163,7 +169,7 @@ namespace Forge
 			m_UniformSpecificationIndices[specification.VariableName] = (int)m_UniformSpecifications.size();
 			m_UniformSpecifications.push_back(specification);
 
-			if (specification.Type == ShaderDataType::Sampler1D || specification.Type == ShaderDataType::Sampler2D || specification.Type == ShaderDataType::Sampler3D || specification.Type == ShaderDataType::SamplerCube)
+			if (specification.Type == ShaderDataType::Sampler1D || specification.Type == ShaderDataType::Sampler2D || specification.Type == ShaderDataType::Sampler2DArray || specification.Type == ShaderDataType::Sampler3D || specification.Type == ShaderDataType::SamplerCube)
 			{
 				m_TextureSize++;
 			}
@@ -172,12 +178,27 @@ namespace Forge
 		}
 	}
 
-	void UniformContext::ApplyTextureUniform(const Ref<Shader>& shader, const UniformSpecification& specification, RendererContext& context, GLenum textureTarget) const
+	const std::vector<UniformHandle>& UniformContext::GetHandles(const Ref<Shader>& shader) const
+	{
+		for (const auto& [shaderId, handles] : m_ShaderHandles)
+		{
+			if (shaderId == shader->GetUniqueId())
+				return handles;
+		}
+		std::vector<UniformHandle> handles;
+		handles.reserve(m_UniformSpecifications.size());
+		for (const UniformSpecification& specification : m_UniformSpecifications)
+			handles.push_back(shader->GetUniformHandle(specification.VariableName));
+		m_ShaderHandles.push_back({ shader->GetUniqueId(), std::move(handles) });
+		return m_ShaderHandles.back().second;
+	}
+
+	void UniformContext::ApplyTextureUniform(const Ref<Shader>& shader, const UniformSpecification& specification, UniformHandle handle, RendererContext& context, GLenum textureTarget) const
 	{
 		int textureIndex = FORGE_UNIFORM_REFERENCE(int, specification.Offset);
 		FORGE_ASSERT(!m_Textures[textureIndex] || m_Textures[textureIndex]->GetTarget() == textureTarget, "Invalid texture for uniform");
 		int slot = context.BindTexture(m_Textures[textureIndex], textureTarget);
-		shader->SetUniform(specification.VariableName, slot);
+		shader->SetUniform(handle, slot);
 	}
 
 #undef FORGE_UNIFORM_REFERENCE
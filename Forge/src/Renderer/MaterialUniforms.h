@@ -32,6 +32,8 @@ namespace Forge
 	public:
 		PolygonMode Mode = PolygonMode::Fill;
 		CullFace Culling = CullFace::Back;
+		// Drawn after every opaque draw of the pass, in the order they were submitted
+		bool Transparent = false;
 	};
 
 	struct FORGE_API UniformSpecification
@@ -53,6 +55,9 @@ namespace Forge
 		std::vector<UniformSpecification> m_UniformSpecifications;
 		std::unique_ptr<std::byte[]> m_Buffer;
 		std::unique_ptr<Ref<Texture>[]> m_Textures;
+		// Uniform handles for each shader this context has been applied to, keyed by Shader::GetUniqueId() and indexed like
+		// m_UniformSpecifications
+		mutable std::vector<std::pair<uint32_t, std::vector<UniformHandle>>> m_ShaderHandles;
 
 	public:
 		UniformContext();
@@ -69,7 +74,7 @@ namespace Forge
 		T& GetUniform(const std::string& varname) const
 		{
 			FORGE_ASSERT(HasUniform(varname), "Invalid uniform name");
-			if constexpr (std::is_same_v<T, Ref<Texture2D>> || std::is_same_v<T, Ref<TextureCube>> || std::is_same_v<T, Ref<RenderTexture>> || std::is_same_v<T, Ref<Texture>>)
+			if constexpr (std::is_same_v<T, Ref<Texture2D>> || std::is_same_v<T, Ref<TextureCube>> || std::is_same_v<T, Ref<Texture2DArray>> || std::is_same_v<T, Ref<RenderTexture>> || std::is_same_v<T, Ref<Texture>>)
 			{
 				int index = *(int*)(m_Buffer.get() + m_UniformSpecifications[m_UniformSpecificationIndices.at(varname)].Offset);
 				return (T&)m_Textures[index];
@@ -86,10 +91,13 @@ namespace Forge
 		void AddFromDescriptors(RenderPass pass, const std::vector<UniformDescriptor>& descriptors);
 		void Init();
 		void Apply(RenderPass pass, const Ref<Shader>& shader, RendererContext& context) const;
+		// Must be called if a shader this context was applied to is replaced
+		inline void ClearHandles() { m_ShaderHandles.clear(); }
 
 	private:
 		void AddDescriptor(RenderPass pass, const UniformDescriptor& descriptor);
-		void ApplyTextureUniform(const Ref<Shader>& shader, const UniformSpecification& specifiation, RendererContext& context, GLenum textureTarget) const;
+		const std::vector<UniformHandle>& GetHandles(const Ref<Shader>& shader) const;
+		void ApplyTextureUniform(const Ref<Shader>& shader, const UniformSpecification& specifiation, UniformHandle handle, RendererContext& context, GLenum textureTarget) const;
 
 	};
 
@@ -2,6 +2,8 @@
 #include "VertexArray.h"
 #include "Shader.h"
 #include "RendererContext.h"
+#include "TriangleMesh.h"
+#include "Math/Bounds.h"
 
 namespace Forge
 {
@@ -11,14 +13,17 @@ namespace Forge
 	private:
 		Ref<VertexArray> m_Vertices;
 		GLuint m_DrawMode;
+		BoundingBox m_Bounds;
+		BoundingSphere m_BoundingSphere;
+		Ref<TriangleMesh> m_Triangles;
 
 	public:
 		inline Mesh()
-			: m_Vertices(), m_DrawMode(GL_TRIANGLES)
+			: m_Vertices(), m_DrawMode(GL_TRIANGLES), m_Bounds(), m_BoundingSphere(), m_Triangles()
 		{}
 
 		inline Mesh(const Ref<VertexArray>& vertices)
-			: m_Vertices(vertices), m_DrawMode(GL_TRIANGLES)
+			: m_Vertices(vertices), m_DrawMode(GL_TRIANGLES), m_Bounds(), m_BoundingSphere(), m_Triangles()
 		{}
 
 		virtual ~Mesh() = default;
@@ -26,9 +31,39 @@ namespace Forge
 		inline GLuint GetDrawMode() const { return m_DrawMode; }
 		inline void SetDrawMode(GLuint mode) { m_DrawMode = mode; }
 		inline const Ref<VertexArray>& GetVertices() const { return m_Vertices; }
-		inline virtual bool IsAnimated() const { return false; }
+		// Local space bounds, meshes without valid bounds are never culled
+		inline const BoundingBox& GetBounds() const { return m_Bounds; }
+		inline const BoundingSphere& GetBoundingSphere() const { return m_BoundingSphere; }
+		inline void SetBounds(const BoundingBox& bounds, const BoundingSphere& sphere) { m_Bounds = bounds; m_BoundingSphere = sphere; }
+
+		// Should be called with the CPU side vertex data when the mesh is built, stride is measured in floats
+		inline void CalculateBounds(const float* positions, size_t vertexCount, size_t stride)
+		{
+			m_Bounds = CalculateBoundingBox(positions, vertexCount, stride);
+			m_BoundingSphere = CalculateBoundingSphere(positions, vertexCount, stride, m_Bounds);
+		}
+		// Only kept for meshes that should be pickable by ray casts
+		inline const Ref<TriangleMesh>& GetTriangles() const { return m_Triangles; }
+		inline void SetTriangles(const Ref<TriangleMesh>& triangles) { m_Triangles = triangles; }
 
-		inline virtual void Apply(const Ref<Shader>& shader, const ShaderRequirements& requirements) {}
+		// ray is in mesh space, tests the bounds and then the triangles (or only the bounds if no triangles are kept)
+		// Animated meshes are tested in their bind pose
+		inline bool Raycast(const Ray& ray, float maxDistance, float& distance) const
+		{
+			float boundsDistance;
+			if (!m_Bounds.IsValid() || !IntersectsRay(m_Bounds, ray, 1.0f / ray.Direction, maxDistance, boundsDistance))
+				return false;
+			if (!m_Triangles)
+			{
+				distance = boundsDistance;
+				return true;
+			}
+			return m_Triangles->Raycast(ray, maxDistance, distance);
+		}
+
+		inline virtual bool IsAnimated() const { return false; }
+		// Skinned vertices can move past the bind pose bounds, so animated meshes are never culled
+		inline bool IsCullable() const { return m_Bounds.IsValid() && !IsAnimated(); }
 	};
 
 }
@@ -0,0 +1,92 @@
+#include "ForgePch.h"
+#include "MeshBuilder.h"
+
+namespace Forge
+{
+
+    MeshBuilder::MeshBuilder(const BufferLayout& layout, size_t vertexCount, size_t indexCount, MeshBuilderMode mode)
+        : m_Layout(layout), m_VertexBuffer(), m_IndexBuffer(), m_VertexBytes(vertexCount * layout.GetStride()),
+          m_IndexCount(indexCount), m_Vertices(nullptr), m_Indices(nullptr), m_StagingVertices(), m_StagingIndices(),
+          m_Mapped(false)
+    {
+        if (mode == MeshBuilderMode::Mapped)
+        {
+            m_VertexBuffer = VertexBuffer::Create(m_VertexBytes, layout);
+            m_IndexBuffer = IndexBuffer::Create(m_IndexCount * sizeof(IndexBuffer::Type));
+            m_Vertices = m_VertexBuffer->Map();
+            m_Indices = static_cast<IndexBuffer::Type*>(m_IndexBuffer->Map());
+            m_Mapped = m_Vertices != nullptr && m_Indices != nullptr;
+        }
+        if (!m_Mapped)
+        {
+            if (m_Vertices != nullptr)
+                m_VertexBuffer->Unmap();
+            if (m_Indices != nullptr)
+                m_IndexBuffer->Unmap();
+            m_StagingVertices.resize(m_VertexBytes);
+            m_StagingIndices.resize(m_IndexCount);
+            m_Vertices = m_StagingVertices.data();
+            m_Indices = m_StagingIndices.data();
+        }
+    }
+
+    MeshBuilder::~MeshBuilder()
+    {
+        Unmap();
+    }
+
+    Ref<Mesh> MeshBuilder::Build(const BoundingBox& bounds, GLuint drawMode)
+    {
+        if (m_Mapped)
+        {
+            bool vertices = m_VertexBuffer->Unmap();
+            bool indices = m_IndexBuffer->Unmap();
+            m_Mapped = false;
+            if (!vertices || !indices)
+                FORGE_WARN("Mesh buffers were lost while mapped");
+        }
+        else if (!m_VertexBuffer)
+        {
+            m_VertexBuffer = VertexBuffer::Create(m_StagingVertices.data(), m_VertexBytes, m_Layout);
+            m_IndexBuffer = IndexBuffer::Create(m_StagingIndices.data(), m_IndexCount * sizeof(IndexBuffer::Type));
+        }
+        else
+        {
+            if (m_VertexBytes > 0)
+                m_VertexBuffer->SetData(m_StagingVertices.data(), m_VertexBytes);
+            if (m_IndexCount > 0)
+                m_IndexBuffer->SetData(m_StagingIndices.data(), m_IndexCount * sizeof(IndexBuffer::Type));
+        }
+        m_Vertices = nullptr;
+        m_Indices = nullptr;
+        m_StagingVertices = {};
+        m_StagingIndices = {};
+
+        Ref<VertexArray> vao = VertexArray::Create();
+        vao->AddVertexBuffer(m_VertexBuffer);
+        vao->SetIndexBuffer(m_IndexBuffer);
+        Ref<Mesh> mesh = CreateRef<Mesh>(vao);
+        mesh->SetDrawMode(drawMode);
+
+        // Encloses the box rather than the vertices, which are not read back
+        BoundingSphere sphere;
+        if (bounds.IsValid())
+        {
+            sphere.Center = bounds.GetCenter();
+            sphere.Radius = glm::length(bounds.GetExtents());
+        }
+        mesh->SetBounds(bounds, sphere);
+        return mesh;
+    }
+
+    void MeshBuilder::Unmap()
+    {
+        if (m_Mapped)
+        {
+            m_VertexBuffer->Unmap();
+            m_IndexBuffer->Unmap();
+            m_Mapped = false;
+        }
+    }
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Mesh.h"
+
+namespace Forge
+{
+
+    enum class MeshBuilderMode
+    {
+        // Writes into the mapped GL buffers, the builder must be created and built on the render thread
+        Mapped,
+        // Writes into a staging copy that Build() uploads, so the builder can be filled on any thread
+        Staging,
+    };
+
+    // Builds a mesh whose vertex and index counts are known up front.
+    // Vertices and indices are written straight into the mapped GL buffers, or into a staging copy that is uploaded by
+    // Build() in staging mode or if the buffers cannot be mapped. Disjoint ranges may be written from several threads
+    class FORGE_API MeshBuilder
+    {
+    private:
+        BufferLayout m_Layout;
+        Ref<VertexBuffer> m_VertexBuffer;
+        Ref<IndexBuffer> m_IndexBuffer;
+        size_t m_VertexBytes;
+        size_t m_IndexCount;
+        void* m_Vertices;
+        IndexBuffer::Type* m_Indices;
+        std::vector<uint8_t> m_StagingVertices;
+        std::vector<IndexBuffer::Type> m_StagingIndices;
+        bool m_Mapped;
+
+    public:
+        MeshBuilder(const BufferLayout& layout, size_t vertexCount, size_t indexCount,
+          MeshBuilderMode mode = MeshBuilderMode::Mapped);
+        MeshBuilder(const MeshBuilder& other) = delete;
+        MeshBuilder& operator=(const MeshBuilder& other) = delete;
+        ~MeshBuilder();
+
+        // T should match the stride of the layout
+        template<typename T>
+        inline T* GetVertices() const
+        {
+            return static_cast<T*>(m_Vertices);
+        }
+        inline IndexBuffer::Type* GetIndices() const { return m_Indices; }
+        inline size_t GetVertexBytes() const { return m_VertexBytes; }
+        inline size_t GetIndexCount() const { return m_IndexCount; }
+        // Size of the vertex and index buffers
+        inline size_t GetSizeBytes() const { return m_VertexBytes + m_IndexCount * sizeof(IndexBuffer::Type); }
+
+        // Finishes writing, bounds are in mesh space since the vertices are not read back.
+        // The builder cannot be used afterwards
+        Ref<Mesh> Build(const BoundingBox& bounds, GLuint drawMode = GL_TRIANGLES);
+
+    private:
+        void Unmap();
+    };
+
+}
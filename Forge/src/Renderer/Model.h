@@ -37,6 +37,50 @@ namespace Forge
             m_SubModels.push_back(submodel);
         }
 
+        // True if the bounds of every submodel can be used for culling, see Mesh::IsCullable()
+        inline bool IsCullable() const
+        {
+            for (const SubModel& submodel : m_SubModels)
+            {
+                if (!submodel.Mesh->IsCullable())
+                    return false;
+            }
+            return !m_SubModels.empty();
+        }
+
+        // Combined bounds of all submodels in model space, submodels without bounds are ignored
+        inline BoundingBox GetBounds() const
+        {
+            BoundingBox result;
+            for (const SubModel& submodel : m_SubModels)
+            {
+                BoundingBox bounds = submodel.Mesh->GetBounds().Transform(submodel.Transform);
+                if (bounds.IsValid())
+                {
+                    result.Expand(bounds.Min);
+                    result.Expand(bounds.Max);
+                }
+            }
+            return result;
+        }
+
+        inline BoundingSphere GetBoundingSphere() const
+        {
+            BoundingBox box = GetBounds();
+            BoundingSphere result;
+            if (!box.IsValid())
+                return result;
+            result.Center = box.GetCenter();
+            result.Radius = 0.0f;
+            for (const SubModel& submodel : m_SubModels)
+            {
+                BoundingSphere sphere = submodel.Mesh->GetBoundingSphere().Transform(submodel.Transform);
+                if (sphere.IsValid())
+                    result.Radius = std::max(result.Radius, glm::length(sphere.Center - result.Center) + sphere.Radius);
+            }
+            return result;
+        }
+
     public:
         inline static Ref<Model> Create(
           const Ref<Mesh>& mesh, const Ref<Material>& material, const glm::mat4& transform = glm::mat4(1.0f))
@@ -0,0 +1,1291 @@
+#include "ForgePch.h"
+#include "RecordingRenderBackend.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+namespace Forge
+{
+
+	namespace Detail
+	{
+
+		// Member of a struct or a uniform declared in GLSL
+		struct GlslVariable
+		{
+		public:
+			std::string Type;
+			std::string Name;
+			int Size = 1;
+			bool IsArray = false;
+		};
+
+		// Declarations at global scope of one shader stage
+		struct GlslDeclarations
+		{
+		public:
+			std::unordered_map<std::string, std::vector<GlslVariable>> Structs;
+			std::vector<GlslVariable> Uniforms;
+			std::vector<std::string> UniformBlocks;
+		};
+
+		static std::string StripComments(const std::string& source)
+		{
+			std::string result;
+			result.reserve(source.size());
+			size_t i = 0;
+			while (i < source.size())
+			{
+				if (source.compare(i, 2, "//") == 0)
+				{
+					while (i < source.size() && source[i] != '\n')
+						i++;
+				}
+				else if (source.compare(i, 2, "/*") == 0)
+				{
+					size_t end = source.find("*/", i + 2);
+					end = end == std::string::npos ? source.size() : end + 2;
+					// Keep the lines so that directives stay on their own line
+					for (; i < end; i++)
+					{
+						if (source[i] == '\n')
+							result += '\n';
+					}
+				}
+				else if (source.compare(i, 2, "\\\n") == 0)
+				{
+					i += 2;
+				}
+				else
+				{
+					result += source[i++];
+				}
+			}
+			return result;
+		}
+
+		static std::vector<std::string> Tokenize(const std::string& text)
+		{
+			std::vector<std::string> tokens;
+			size_t i = 0;
+			while (i < text.size())
+			{
+				char c = text[i];
+				if (std::isspace((unsigned char)c))
+				{
+					i++;
+				}
+				else if (std::isalnum((unsigned char)c) || c == '_')
+				{
+					size_t start = i;
+					while (i < text.size() && (std::isalnum((unsigned char)text[i]) || text[i] == '_' || (std::isdigit((unsigned char)c) && text[i] == '.')))
+						i++;
+					tokens.push_back(text.substr(start, i - start));
+				}
+				else
+				{
+					tokens.push_back(std::string(1, c));
+					i++;
+				}
+			}
+			return tokens;
+		}
+
+		// Replaces object-like macros, function-like macros are left in place
+		static void ExpandMacros(const std::vector<std::string>& tokens, const std::unordered_map<std::string, std::string>& macros, std::vector<std::string>& result, int depth = 0)
+		{
+			for (const std::string& token : tokens)
+			{
+				auto it = macros.find(token);
+				if (it != macros.end() && depth < 16)
+					ExpandMacros(Tokenize(it->second), macros, result, depth + 1);
+				else
+					result.push_back(token);
+			}
+		}
+
+		// Evaluates the integer expressions of #if and #elif, operators are split into single character tokens
+		class ConditionParser
+		{
+		private:
+			const std::vector<std::string>& m_Tokens;
+			size_t m_Position;
+
+		public:
+			ConditionParser(const std::vector<std::string>& tokens)
+				: m_Tokens(tokens), m_Position(0)
+			{
+			}
+
+			int Evaluate()
+			{
+				int value = Or();
+				return m_Position == m_Tokens.size() ? value : 1;
+			}
+
+		private:
+			bool Accept(const char* a, const char* b = nullptr)
+			{
+				if (m_Position < m_Tokens.size() && m_Tokens[m_Position] == a && (!b || (m_Position + 1 < m_Tokens.size() && m_Tokens[m_Position + 1] == b)))
+				{
+					m_Position += b ? 2 : 1;
+					return true;
+				}
+				return false;
+			}
+
+			int Or()
+			{
+				int value = And();
+				while (Accept("|", "|"))
+					value = And() || value;
+				return value;
+			}
+
+			int And()
+			{
+				int value = Compare();
+				while (Accept("&", "&"))
+					value = Compare() && value;
+				return value;
+			}
+
+			int Compare()
+			{
+				int value = Unary();
+				while (true)
+				{
+					if (Accept("=", "="))
+						value = value == Unary();
+					else if (Accept("!", "="))
+						value = value != Unary();
+					else if (Accept("<", "="))
+						value = value <= Unary();
+					else if (Accept(">", "="))
+						value = value >= Unary();
+					else if (Accept("<"))
+						value = value < Unary();
+					else if (Accept(">"))
+						value = value > Unary();
+					else
+						return value;
+				}
+			}
+
+			int Unary()
+			{
+				if (Accept("!"))
+					return !Unary();
+				if (Accept("-"))
+					return -Unary();
+				if (Accept("("))
+				{
+					int value = Or();
+					Accept(")");
+					return value;
+				}
+				if (m_Position >= m_Tokens.size())
+					return 0;
+				const std::string& token = m_Tokens[m_Position++];
+				if (std::isdigit((unsigned char)token[0]))
+					return std::stoi(token);
+				// Identifiers that are not macros are 0, as in C
+				return token == "true" ? 1 : 0;
+			}
+		};
+
+		static bool EvaluateCondition(const std::string& expression, const std::unordered_map<std::string, std::string>& macros)
+		{
+			std::vector<std::string> tokens = Tokenize(expression);
+			std::vector<std::string> resolved;
+			for (size_t i = 0; i < tokens.size(); i++)
+			{
+				if (tokens[i] == "defined")
+				{
+					bool parenthesized = i + 1 < tokens.size() && tokens[i + 1] == "(";
+					size_t name = parenthesized ? i + 2 : i + 1;
+					if (name < tokens.size())
+						resolved.push_back(macros.find(tokens[name]) != macros.end() ? "1" : "0");
+					i = parenthesized ? name + 1 : name;
+				}
+				else
+				{
+					resolved.push_back(tokens[i]);
+				}
+			}
+			std::vector<std::string> expanded;
+			ExpandMacros(resolved, macros, expanded);
+			return ConditionParser(expanded).Evaluate() != 0;
+		}
+
+		// Source with inactive conditional blocks and directives removed and macros expanded, as tokens
+		static std::vector<std::string> Preprocess(const std::string& source)
+		{
+			struct Conditional
+			{
+			public:
+				bool ParentActive;
+				bool Active;
+				bool Taken;
+			};
+
+			std::unordered_map<std::string, std::string> macros;
+			std::vector<Conditional> conditionals;
+			std::string text;
+			std::istringstream lines(StripComments(source));
+			std::string line;
+			while (std::getline(lines, line))
+			{
+				size_t start = line.find_first_not_of(" \t\r");
+				bool active = conditionals.empty() || conditionals.back().Active;
+				if (start == std::string::npos || line[start] != '#')
+				{
+					if (active)
+					{
+						text += line;
+						text += '\n';
+					}
+					continue;
+				}
+
+				std::vector<std::string> directive = Tokenize(line.substr(start + 1));
+				if (directive.empty())
+					continue;
+				const std::string& name = directive[0];
+				std::string argument = directive.size() > 1 ? directive[1] : "";
+				size_t nameEnd = line.find(name, start) + name.size();
+				std::string rest = line.substr(nameEnd);
+				if (name == "ifdef" || name == "ifndef" || name == "if")
+				{
+					bool condition = name == "if" ? EvaluateCondition(rest, macros) : (macros.find(argument) != macros.end()) == (name == "ifdef");
+					conditionals.push_back({ active, active && condition, condition });
+				}
+				else if (name == "elif" && !conditionals.empty())
+				{
+					Conditional& conditional = conditionals.back();
+					bool condition = !conditional.Taken && EvaluateCondition(rest, macros);
+					conditional.Active = conditional.ParentActive && condition;
+					conditional.Taken |= condition;
+				}
+				else if (name == "else" && !conditionals.empty())
+				{
+					Conditional& conditional = conditionals.back();
+					conditional.Active = conditional.ParentActive && !conditional.Taken;
+					conditional.Taken = true;
+				}
+				else if (name == "endif" && !conditionals.empty())
+				{
+					conditionals.pop_back();
+				}
+				else if (name == "define" && active && !argument.empty())
+				{
+					size_t argumentEnd = line.find(argument, nameEnd) + argument.size();
+					bool functionLike = argumentEnd < line.size() && line[argumentEnd] == '(';
+					if (!functionLike)
+						macros[argument] = line.substr(argumentEnd);
+				}
+				else if (name == "undef" && active)
+				{
+					macros.erase(argument);
+				}
+			}
+
+			std::vector<std::string> tokens;
+			ExpandMacros(Tokenize(text), macros, tokens);
+			return tokens;
+		}
+
+		static size_t SkipBlock(const std::vector<std::string>& tokens, size_t i)
+		{
+			int depth = 0;
+			for (; i < tokens.size(); i++)
+			{
+				if (tokens[i] == "{")
+					depth++;
+				else if (tokens[i] == "}" && --depth == 0)
+					return i + 1;
+			}
+			return i;
+		}
+
+		// Reads "name[size], name2;" from i, returns the index after the semicolon
+		static size_t ReadDeclarators(const std::vector<std::string>& tokens, size_t i, const std::string& type, const std::unordered_map<std::string, int>& constants, std::vector<GlslVariable>& variables)
+		{
+			while (i < tokens.size() && tokens[i] != ";")
+			{
+				GlslVariable variable;
+				variable.Type = type;
+				variable.Name = tokens[i++];
+				if (i < tokens.size() && tokens[i] == "[")
+				{
+					variable.IsArray = true;
+					if (i + 2 < tokens.size() && tokens[i + 2] == "]")
+					{
+						const std::string& size = tokens[i + 1];
+						auto constant = constants.find(size);
+						if (constant != constants.end())
+							variable.Size = constant->second;
+						else if (std::isdigit((unsigned char)size[0]))
+							variable.Size = std::stoi(size);
+					}
+					while (i < tokens.size() && tokens[i] != "]")
+						i++;
+					i++;
+				}
+				variables.push_back(variable);
+				// Initializers and anything else up to the next declarator
+				while (i < tokens.size() && tokens[i] != "," && tokens[i] != ";")
+					i++;
+				if (i < tokens.size() && tokens[i] == ",")
+					i++;
+			}
+			return i + 1;
+		}
+
+		static bool IsQualifier(const std::string& token)
+		{
+			return token == "lowp" || token == "mediump" || token == "highp" || token == "flat" || token == "smooth" || token == "noperspective" ||
+				token == "const" || token == "readonly" || token == "writeonly" || token == "coherent" || token == "restrict" || token == "volatile";
+		}
+
+		static GlslDeclarations ReflectGlsl(const std::string& source)
+		{
+			GlslDeclarations declarations;
+			std::unordered_map<std::string, int> constants;
+			std::vector<std::string> tokens = Preprocess(source);
+			int depth = 0;
+			size_t i = 0;
+			while (i < tokens.size())
+			{
+				const std::string& token = tokens[i];
+				if (depth != 0 || (token != "struct" && token != "uniform" && token != "const"))
+				{
+					if (token == "{")
+						depth++;
+					else if (token == "}")
+						depth--;
+					i++;
+				}
+				else if (token == "const")
+				{
+					// const int NAME = value; sizes uniform arrays
+					if (i + 4 < tokens.size() && (tokens[i + 1] == "int" || tokens[i + 1] == "uint") && tokens[i + 3] == "=" && std::isdigit((unsigned char)tokens[i + 4][0]))
+						constants[tokens[i + 2]] = std::stoi(tokens[i + 4]);
+					while (i < tokens.size() && tokens[i] != ";")
+						i++;
+					i++;
+				}
+				else if (token == "struct" && i + 2 < tokens.size() && tokens[i + 2] == "{")
+				{
+					std::vector<GlslVariable>& members = declarations.Structs[tokens[i + 1]];
+					i += 3;
+					while (i < tokens.size() && tokens[i] != "}")
+					{
+						while (i < tokens.size() && IsQualifier(tokens[i]))
+							i++;
+						if (i >= tokens.size())
+							break;
+						const std::string& type = tokens[i];
+						i = ReadDeclarators(tokens, i + 1, type, constants, members);
+					}
+					while (i < tokens.size() && tokens[i] != ";")
+						i++;
+					i++;
+				}
+				else if (token == "uniform")
+				{
+					i++;
+					while (i < tokens.size() && IsQualifier(tokens[i]))
+						i++;
+					if (i + 1 >= tokens.size())
+						break;
+					const std::string& type = tokens[i];
+					if (tokens[i + 1] == "{")
+					{
+						declarations.UniformBlocks.push_back(type);
+						i = SkipBlock(tokens, i + 1);
+						while (i < tokens.size() && tokens[i] != ";")
+							i++;
+						i++;
+					}
+					else
+					{
+						i = ReadDeclarators(tokens, i + 1, type, constants, declarations.Uniforms);
+					}
+				}
+				else
+				{
+					i++;
+				}
+			}
+			return declarations;
+		}
+
+		static GLenum GetUniformType(const std::string& glslType)
+		{
+			static const std::unordered_map<std::string, GLenum> s_Types = {
+				{ "float", GL_FLOAT },
+				{ "vec2", GL_FLOAT_VEC2 },
+				{ "vec3", GL_FLOAT_VEC3 },
+				{ "vec4", GL_FLOAT_VEC4 },
+				{ "int", GL_INT },
+				{ "ivec2", GL_INT_VEC2 },
+				{ "ivec3", GL_INT_VEC3 },
+				{ "ivec4", GL_INT_VEC4 },
+				{ "uint", GL_UNSIGNED_INT },
+				{ "uvec2", GL_UNSIGNED_INT_VEC2 },
+				{ "uvec3", GL_UNSIGNED_INT_VEC3 },
+				{ "uvec4", GL_UNSIGNED_INT_VEC4 },
+				{ "bool", GL_BOOL },
+				{ "mat2", GL_FLOAT_MAT2 },
+				{ "mat3", GL_FLOAT_MAT3 },
+				{ "mat4", GL_FLOAT_MAT4 },
+				{ "sampler1D", GL_SAMPLER_1D },
+				{ "sampler2D", GL_SAMPLER_2D },
+				{ "sampler2DArray", GL_SAMPLER_2D_ARRAY },
+				{ "sampler3D", GL_SAMPLER_3D },
+				{ "samplerCube", GL_SAMPLER_CUBE },
+				{ "sampler2DShadow", GL_SAMPLER_2D_SHADOW },
+				{ "isampler2D", GL_INT_SAMPLER_2D },
+				{ "usampler2D", GL_UNSIGNED_INT_SAMPLER_2D },
+			};
+			auto it = s_Types.find(glslType);
+			return it == s_Types.end() ? GL_NONE : it->second;
+		}
+
+		static uint32_t GetTexelSize(GLenum format, GLenum type)
+		{
+			switch (type)
+			{
+			case GL_UNSIGNED_INT_24_8:
+				return 4;
+			case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+				return 8;
+			}
+			uint32_t componentSize = 4;
+			switch (type)
+			{
+			case GL_BYTE:
+			case GL_UNSIGNED_BYTE:
+				componentSize = 1;
+				break;
+			case GL_SHORT:
+			case GL_UNSIGNED_SHORT:
+			case GL_HALF_FLOAT:
+				componentSize = 2;
+				break;
+			}
+			switch (format)
+			{
+			case GL_RG:
+			case GL_RG_INTEGER:
+			case GL_DEPTH_STENCIL:
+				return 2 * componentSize;
+			case GL_RGB:
+			case GL_BGR:
+			case GL_RGB_INTEGER:
+				return 3 * componentSize;
+			case GL_RGBA:
+			case GL_BGRA:
+			case GL_RGBA_INTEGER:
+				return 4 * componentSize;
+			}
+			return componentSize;
+		}
+
+		// Stands in for the GL functions, calls go to the backend that was last loaded
+		struct RecordingFunctions
+		{
+		public:
+			static RecordingRenderBackend* s_Backend;
+
+		public:
+			static uint32_t CreateHandle()
+			{
+				return s_Backend->m_NextHandle++;
+			}
+
+			static void CreateHandles(GLsizei n, GLuint* handles)
+			{
+				for (GLsizei i = 0; i < n; i++)
+					handles[i] = CreateHandle();
+			}
+
+			static std::vector<uint8_t>* FindBuffer(GLuint buffer)
+			{
+				auto it = s_Backend->m_Buffers.find(buffer);
+				return it == s_Backend->m_Buffers.end() ? nullptr : &it->second;
+			}
+
+			static void SetUniform(GLint location, size_t size, uint32_t count = 1)
+			{
+				s_Backend->Record(RecordedCommandType::SetUniform, uint32_t(location), s_Backend->m_CurrentProgram, size, count);
+			}
+
+			static void SetState(GLenum state, uint32_t value)
+			{
+				s_Backend->Record(RecordedCommandType::SetState, state, value);
+			}
+
+			// Context
+
+			static const GLubyte* APIENTRY GetString(GLenum name)
+			{
+				switch (name)
+				{
+				case GL_VENDOR:
+					return (const GLubyte*)"Forge";
+				case GL_RENDERER:
+					return (const GLubyte*)"Recording";
+				case GL_VERSION:
+					return (const GLubyte*)"4.6.0 Recording";
+				case GL_SHADING_LANGUAGE_VERSION:
+					return (const GLubyte*)"4.60";
+				}
+				return (const GLubyte*)"";
+			}
+
+			static const GLubyte* APIENTRY GetStringi(GLenum name, GLuint index)
+			{
+				// glad fails to load without at least one extension
+				return (const GLubyte*)"GL_FORGE_recording";
+			}
+
+			static void APIENTRY GetIntegerv(GLenum name, GLint* data)
+			{
+				switch (name)
+				{
+				case GL_NUM_EXTENSIONS: *data = 1; return;
+				case GL_MAJOR_VERSION: *data = 4; return;
+				case GL_MINOR_VERSION: *data = 6; return;
+				case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *data = 256; return;
+				case GL_MAX_UNIFORM_BLOCK_SIZE: *data = 65536; return;
+				case GL_MAX_ARRAY_TEXTURE_LAYERS: *data = 2048; return;
+				case GL_MAX_TEXTURE_SIZE: *data = 16384; return;
+				case GL_MAX_TEXTURE_IMAGE_UNITS: *data = 32; return;
+				case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS: *data = 192; return;
+				}
+				*data = 0;
+			}
+
+			static void APIENTRY DebugMessageCallback(GLDEBUGPROC callback, const void* userParam) {}
+			static void APIENTRY DebugMessageControl(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled) {}
+
+			static GLsync APIENTRY FenceSync(GLenum condition, GLbitfield flags)
+			{
+				return (GLsync)uintptr_t(CreateHandle());
+			}
+
+			static GLenum APIENTRY ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+			{
+				return GL_ALREADY_SIGNALED;
+			}
+
+			static void APIENTRY DeleteSync(GLsync sync) {}
+
+			// State
+
+			static void APIENTRY Enable(GLenum cap)
+			{
+				SetState(cap, 1);
+			}
+
+			static void APIENTRY Disable(GLenum cap)
+			{
+				SetState(cap, 0);
+			}
+
+			static void APIENTRY BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+			{
+				SetState(GL_BLEND_SRC, sourceFactor);
+			}
+
+			static void APIENTRY CullFace(GLenum mode)
+			{
+				SetState(GL_CULL_FACE_MODE, mode);
+			}
+
+			static void APIENTRY PolygonMode(GLenum face, GLenum mode)
+			{
+				SetState(GL_POLYGON_MODE, mode);
+			}
+
+			static void APIENTRY Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+			{
+				SetState(GL_VIEWPORT, 0);
+			}
+
+			static void APIENTRY ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+			{
+				SetState(GL_COLOR_CLEAR_VALUE, 0);
+			}
+
+			static void APIENTRY Clear(GLbitfield mask)
+			{
+				s_Backend->Record(RecordedCommandType::Clear, mask, 0);
+			}
+
+			static void APIENTRY ActiveTexture(GLenum texture)
+			{
+				s_Backend->m_ActiveTextureUnit = texture - GL_TEXTURE0;
+				SetState(GL_ACTIVE_TEXTURE, texture);
+			}
+
+			// Draws
+
+			static void APIENTRY DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex)
+			{
+				s_Backend->Record(RecordedCommandType::Draw, mode, s_Backend->m_CurrentProgram, size_t(count), 1);
+			}
+
+			static void APIENTRY DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLint baseVertex, GLuint baseInstance)
+			{
+				s_Backend->Record(RecordedCommandType::Draw, mode, s_Backend->m_CurrentProgram, size_t(count), uint32_t(instanceCount));
+			}
+
+			// Buffers
+
+			static void APIENTRY CreateBuffers(GLsizei n, GLuint* buffers)
+			{
+				CreateHandles(n, buffers);
+				for (GLsizei i = 0; i < n; i++)
+					s_Backend->m_Buffers[buffers[i]];
+			}
+
+			static void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+			{
+				// Objects can outlive the backend when they are released on exit
+				if (!s_Backend)
+					return;
+				for (GLsizei i = 0; i < n; i++)
+					s_Backend->m_Buffers.erase(buffers[i]);
+			}
+
+			static void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+			{
+				if (target == GL_PIXEL_PACK_BUFFER)
+					s_Backend->m_PixelPackBuffer = buffer;
+				s_Backend->Record(RecordedCommandType::BindBuffer, target, buffer);
+			}
+
+			static void APIENTRY BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+			{
+				s_Backend->Record(RecordedCommandType::BindBuffer, target, buffer);
+			}
+
+			static void APIENTRY BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+			{
+				s_Backend->Record(RecordedCommandType::BindBuffer, target, buffer);
+			}
+
+			static void SetBufferData(GLuint buffer, GLsizeiptr size, const void* data)
+			{
+				std::vector<uint8_t>* storage = FindBuffer(buffer);
+				if (!storage)
+					return;
+				storage->assign(size_t(size), 0);
+				if (data)
+				{
+					std::memcpy(storage->data(), data, size_t(size));
+					s_Backend->Record(RecordedCommandType::UploadBuffer, GL_BUFFER, buffer, size_t(size));
+				}
+			}
+
+			static void APIENTRY NamedBufferStorage(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+			{
+				SetBufferData(buffer, size, data);
+			}
+
+			static void APIENTRY NamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+			{
+				SetBufferData(buffer, size, data);
+			}
+
+			static void APIENTRY NamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+			{
+				std::vector<uint8_t>* storage = FindBuffer(buffer);
+				if (storage && size_t(offset + size) <= storage->size())
+					std::memcpy(storage->data() + offset, data, size_t(size));
+				s_Backend->Record(RecordedCommandType::UploadBuffer, GL_BUFFER, buffer, size_t(size));
+			}
+
+			static void APIENTRY GetNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, void* data)
+			{
+				std::vector<uint8_t>* storage = FindBuffer(buffer);
+				if (storage && size_t(offset + size) <= storage->size())
+					std::memcpy(data, storage->data() + offset, size_t(size));
+				else
+					std::memset(data, 0, size_t(size));
+				s_Backend->Record(RecordedCommandType::Readback, GL_BUFFER, buffer, size_t(size));
+			}
+
+			static void* APIENTRY MapNamedBuffer(GLuint buffer, GLenum access)
+			{
+				std::vector<uint8_t>* storage = FindBuffer(buffer);
+				if (!storage)
+					return nullptr;
+				if (access != GL_READ_ONLY)
+					s_Backend->Record(RecordedCommandType::UploadBuffer, GL_BUFFER, buffer, storage->size());
+				return storage->data();
+			}
+
+			static void* APIENTRY MapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+			{
+				std::vector<uint8_t>* storage = FindBuffer(buffer);
+				if (!storage || size_t(offset + length) > storage->size())
+					return nullptr;
+				// What is written into a persistent mapping is unknown, it is mapped once for the lifetime of the buffer
+				if ((access & GL_MAP_WRITE_BIT) && !(access & GL_MAP_PERSISTENT_BIT))
+					s_Backend->Record(RecordedCommandType::UploadBuffer, GL_BUFFER, buffer, size_t(length));
+				return storage->data() + offset;
+			}
+
+			static GLboolean APIENTRY UnmapNamedBuffer(GLuint buffer)
+			{
+				return GL_TRUE;
+			}
+
+			// Vertex arrays
+
+			static void APIENTRY CreateVertexArrays(GLsizei n, GLuint* arrays)
+			{
+				CreateHandles(n, arrays);
+			}
+
+			static void APIENTRY DeleteVertexArrays(GLsizei n, const GLuint* arrays) {}
+
+			static void APIENTRY BindVertexArray(GLuint array)
+			{
+				s_Backend->Record(RecordedCommandType::BindVertexArray, GL_VERTEX_ARRAY, array);
+			}
+
+			static void APIENTRY EnableVertexAttribArray(GLuint index) {}
+			static void APIENTRY VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {}
+			static void APIENTRY VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {}
+			static void APIENTRY VertexAttribDivisor(GLuint index, GLuint divisor) {}
+
+			// Textures
+
+			static void APIENTRY CreateTextures(GLenum target, GLsizei n, GLuint* textures)
+			{
+				CreateHandles(n, textures);
+			}
+
+			static void APIENTRY DeleteTextures(GLsizei n, const GLuint* textures)
+			{
+				if (!s_Backend)
+					return;
+				for (GLsizei i = 0; i < n; i++)
+					s_Backend->m_TexelSizes.erase(textures[i]);
+			}
+
+			static void APIENTRY BindTexture(GLenum target, GLuint texture)
+			{
+				uint32_t unit = s_Backend->m_ActiveTextureUnit;
+				s_Backend->m_TextureBindings[(uint64_t(unit) << 32) | target] = texture;
+				s_Backend->Record(RecordedCommandType::BindTexture, unit, texture);
+			}
+
+			static void APIENTRY BindTextureUnit(GLuint unit, GLuint texture)
+			{
+				s_Backend->Record(RecordedCommandType::BindTexture, unit, texture);
+			}
+
+			static GLuint GetBoundTexture(GLenum target)
+			{
+				// Faces of a cube map are written through the cube map binding
+				if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+					target = GL_TEXTURE_CUBE_MAP;
+				auto it = s_Backend->m_TextureBindings.find((uint64_t(s_Backend->m_ActiveTextureUnit) << 32) | target);
+				return it == s_Backend->m_TextureBindings.end() ? 0 : it->second;
+			}
+
+			static void SetTextureData(GLenum target, size_t texelCount, GLenum format, GLenum type, const void* pixels)
+			{
+				GLuint texture = GetBoundTexture(target);
+				uint32_t texelSize = GetTexelSize(format, type);
+				s_Backend->m_TexelSizes[texture] = texelSize;
+				if (pixels)
+					s_Backend->Record(RecordedCommandType::UploadTexture, target, texture, texelCount * texelSize);
+			}
+
+			static void APIENTRY TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+			{
+				SetTextureData(target, size_t(width) * size_t(height), format, type, pixels);
+			}
+
+			static void APIENTRY TexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels)
+			{
+				SetTextureData(target, size_t(width) * size_t(height) * size_t(depth), format, type, pixels);
+			}
+
+			static void APIENTRY TexParameteri(GLenum target, GLenum name, GLint param)
+			{
+				SetState(name, GetBoundTexture(target));
+			}
+
+			static void APIENTRY GenerateMipmap(GLenum target) {}
+
+			static void APIENTRY ClearTexImage(GLuint texture, GLint level, GLenum format, GLenum type, const void* data)
+			{
+				s_Backend->Record(RecordedCommandType::Clear, GL_TEXTURE, texture);
+			}
+
+			static void APIENTRY CopyImageSubData(GLuint sourceName, GLenum sourceTarget, GLint sourceLevel, GLint sourceX, GLint sourceY, GLint sourceZ,
+				GLuint destinationName, GLenum destinationTarget, GLint destinationLevel, GLint destinationX, GLint destinationY, GLint destinationZ,
+				GLsizei width, GLsizei height, GLsizei depth)
+			{
+				auto it = s_Backend->m_TexelSizes.find(sourceName);
+				uint32_t texelSize = it == s_Backend->m_TexelSizes.end() ? 4 : it->second;
+				s_Backend->Record(RecordedCommandType::CopyTexture, destinationTarget, destinationName, size_t(width) * size_t(height) * size_t(depth) * texelSize);
+			}
+
+			// Framebuffers
+
+			static void APIENTRY CreateFramebuffers(GLsizei n, GLuint* framebuffers)
+			{
+				CreateHandles(n, framebuffers);
+			}
+
+			static void APIENTRY DeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {}
+
+			static void APIENTRY BindFramebuffer(GLenum target, GLuint framebuffer)
+			{
+				s_Backend->Record(RecordedCommandType::BindFramebuffer, target, framebuffer);
+			}
+
+			static void APIENTRY FramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) {}
+
+			static GLenum APIENTRY CheckFramebufferStatus(GLenum target)
+			{
+				return GL_FRAMEBUFFER_COMPLETE;
+			}
+
+			static void APIENTRY DrawBuffer(GLenum buffer)
+			{
+				SetState(GL_DRAW_BUFFER, buffer);
+			}
+
+			static void APIENTRY DrawBuffers(GLsizei n, const GLenum* buffers)
+			{
+				SetState(GL_DRAW_BUFFER, n > 0 ? buffers[0] : GL_NONE);
+			}
+
+			static void APIENTRY ReadBuffer(GLenum buffer)
+			{
+				SetState(GL_READ_BUFFER, buffer);
+			}
+
+			static void APIENTRY ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+			{
+				size_t size = size_t(width) * size_t(height) * GetTexelSize(format, type);
+				if (s_Backend->m_PixelPackBuffer)
+				{
+					std::vector<uint8_t>* storage = FindBuffer(s_Backend->m_PixelPackBuffer);
+					size_t offset = size_t(uintptr_t(pixels));
+					if (storage && offset + size <= storage->size())
+						std::memset(storage->data() + offset, 0, size);
+				}
+				else
+				{
+					std::memset(pixels, 0, size);
+				}
+				s_Backend->Record(RecordedCommandType::Readback, format, s_Backend->m_PixelPackBuffer, size);
+			}
+
+			// Shaders
+
+			static GLuint APIENTRY CreateShader(GLenum type)
+			{
+				GLuint shader = CreateHandle();
+				s_Backend->m_ShaderSources[shader];
+				return shader;
+			}
+
+			static void APIENTRY DeleteShader(GLuint shader)
+			{
+				if (s_Backend)
+					s_Backend->m_ShaderSources.erase(shader);
+			}
+
+			static void APIENTRY ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+			{
+				std::string& source = s_Backend->m_ShaderSources[shader];
+				source.clear();
+				for (GLsizei i = 0; i < count; i++)
+				{
+					if (lengths && lengths[i] >= 0)
+						source.append(strings[i], size_t(lengths[i]));
+					else
+						source.append(strings[i]);
+				}
+			}
+
+			static void APIENTRY CompileShader(GLuint shader) {}
+
+			static void APIENTRY GetShaderiv(GLuint shader, GLenum name, GLint* params)
+			{
+				*params = name == GL_COMPILE_STATUS ? GL_TRUE : 0;
+			}
+
+			static void APIENTRY GetShaderInfoLog(GLuint shader, GLsizei bufferSize, GLsizei* length, GLchar* log)
+			{
+				if (length)
+					*length = 0;
+				if (bufferSize > 0)
+					log[0] = '\0';
+			}
+
+			static GLuint APIENTRY CreateProgram()
+			{
+				GLuint program = CreateHandle();
+				s_Backend->m_Programs[program];
+				return program;
+			}
+
+			static void APIENTRY DeleteProgram(GLuint program)
+			{
+				if (s_Backend)
+					s_Backend->m_Programs.erase(program);
+			}
+
+			static void APIENTRY AttachShader(GLuint program, GLuint shader)
+			{
+				s_Backend->m_Programs[program].Shaders.push_back(shader);
+			}
+
+			static void APIENTRY LinkProgram(GLuint program)
+			{
+				s_Backend->LinkProgram(s_Backend->m_Programs[program]);
+			}
+
+			static void APIENTRY GetProgramiv(GLuint program, GLenum name, GLint* params)
+			{
+				switch (name)
+				{
+				case GL_LINK_STATUS:
+					*params = GL_TRUE;
+					return;
+				case GL_ACTIVE_UNIFORMS:
+					*params = GLint(s_Backend->m_Programs[program].Uniforms.size());
+					return;
+				}
+				*params = 0;
+			}
+
+			static void APIENTRY GetProgramInfoLog(GLuint program, GLsizei bufferSize, GLsizei* length, GLchar* log)
+			{
+				GetShaderInfoLog(program, bufferSize, length, log);
+			}
+
+			static void APIENTRY GetActiveUniform(GLuint program, GLuint index, GLsizei bufferSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+			{
+				const auto& uniforms = s_Backend->m_Programs[program].Uniforms;
+				if (index >= uniforms.size() || bufferSize <= 0)
+					return;
+				const auto& uniform = uniforms[index];
+				size_t count = std::min(uniform.Name.size(), size_t(bufferSize - 1));
+				std::memcpy(name, uniform.Name.data(), count);
+				name[count] = '\0';
+				if (length)
+					*length = GLsizei(count);
+				*size = uniform.Size;
+				*type = uniform.Type;
+			}
+
+			static GLint APIENTRY GetUniformLocation(GLuint program, const GLchar* name)
+			{
+				const auto& locations = s_Backend->m_Programs[program].Locations;
+				auto it = locations.find(name);
+				return it == locations.end() ? -1 : it->second;
+			}
+
+			static GLuint APIENTRY GetUniformBlockIndex(GLuint program, const GLchar* name)
+			{
+				const std::vector<std::string>& blocks = s_Backend->m_Programs[program].UniformBlocks;
+				auto it = std::find(blocks.begin(), blocks.end(), name);
+				return it == blocks.end() ? GL_INVALID_INDEX : GLuint(it - blocks.begin());
+			}
+
+			static void APIENTRY UseProgram(GLuint program)
+			{
+				s_Backend->m_CurrentProgram = program;
+				s_Backend->Record(RecordedCommandType::UseProgram, 0, program);
+			}
+
+			static void APIENTRY Uniform1i(GLint location, GLint v0)
+			{
+				SetUniform(location, sizeof(GLint));
+			}
+
+			static void APIENTRY Uniform1f(GLint location, GLfloat v0)
+			{
+				SetUniform(location, sizeof(GLfloat));
+			}
+
+			static void APIENTRY Uniform2f(GLint location, GLfloat v0, GLfloat v1)
+			{
+				SetUniform(location, 2 * sizeof(GLfloat));
+			}
+
+			static void APIENTRY Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+			{
+				SetUniform(location, 3 * sizeof(GLfloat));
+			}
+
+			static void APIENTRY Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+			{
+				SetUniform(location, 4 * sizeof(GLfloat));
+			}
+
+			static void APIENTRY UniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+			{
+				SetUniform(location, count * 4 * sizeof(GLfloat), uint32_t(count));
+			}
+
+			static void APIENTRY UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+			{
+				SetUniform(location, count * 9 * sizeof(GLfloat), uint32_t(count));
+			}
+
+			static void APIENTRY UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+			{
+				SetUniform(location, count * 16 * sizeof(GLfloat), uint32_t(count));
+			}
+		};
+
+		RecordingRenderBackend* RecordingFunctions::s_Backend = nullptr;
+
+	}
+
+	RecordingRenderBackend::RecordingRenderBackend(bool recordCommands)
+		: m_RecordCommands(recordCommands), m_Commands(), m_Stats(), m_NextHandle(1), m_Buffers(), m_ShaderSources(), m_Programs(), m_TexelSizes(),
+		m_TextureBindings(), m_ActiveTextureUnit(0), m_CurrentProgram(0), m_PixelPackBuffer(0)
+	{
+	}
+
+	RecordingRenderBackend::~RecordingRenderBackend()
+	{
+		if (Detail::RecordingFunctions::s_Backend == this)
+			Detail::RecordingFunctions::s_Backend = nullptr;
+	}
+
+	std::string RecordingRenderBackend::GetUniformName(uint32_t program, int location) const
+	{
+		auto it = m_Programs.find(program);
+		if (it == m_Programs.end())
+			return "";
+		for (const Uniform& uniform : it->second.Uniforms)
+		{
+			if (location >= uniform.Location && location < uniform.Location + uniform.Size)
+			{
+				if (uniform.Size == 1)
+					return uniform.Name;
+				return uniform.Name.substr(0, uniform.Name.size() - 3) + '[' + std::to_string(location - uniform.Location) + ']';
+			}
+		}
+		return "";
+	}
+
+	void RecordingRenderBackend::Reset()
+	{
+		m_Commands.clear();
+		m_Stats = {};
+	}
+
+	void* RecordingRenderBackend::GetProcAddress(const char* name)
+	{
+		using Functions = Detail::RecordingFunctions;
+		static const std::unordered_map<std::string, void*> s_Functions = {
+			{ "glGetString", (void*)&Functions::GetString },
+			{ "glGetStringi", (void*)&Functions::GetStringi },
+			{ "glGetIntegerv", (void*)&Functions::GetIntegerv },
+			{ "glDebugMessageCallback", (void*)&Functions::DebugMessageCallback },
+			{ "glDebugMessageControl", (void*)&Functions::DebugMessageControl },
+			{ "glFenceSync", (void*)&Functions::FenceSync },
+			{ "glClientWaitSync", (void*)&Functions::ClientWaitSync },
+			{ "glDeleteSync", (void*)&Functions::DeleteSync },
+			{ "glEnable", (void*)&Functions::Enable },
+			{ "glDisable", (void*)&Functions::Disable },
+			{ "glBlendFunc", (void*)&Functions::BlendFunc },
+			{ "glCullFace", (void*)&Functions::CullFace },
+			{ "glPolygonMode", (void*)&Functions::PolygonMode },
+			{ "glViewport", (void*)&Functions::Viewport },
+			{ "glClearColor", (void*)&Functions::ClearColor },
+			{ "glClear", (void*)&Functions::Clear },
+			{ "glActiveTexture", (void*)&Functions::ActiveTexture },
+			{ "glDrawElementsBaseVertex", (void*)&Functions::DrawElementsBaseVertex },
+			{ "glDrawElementsInstancedBaseVertexBaseInstance", (void*)&Functions::DrawElementsInstancedBaseVertexBaseInstance },
+			{ "glCreateBuffers", (void*)&Functions::CreateBuffers },
+			{ "glDeleteBuffers", (void*)&Functions::DeleteBuffers },
+			{ "glBindBuffer", (void*)&Functions::BindBuffer },
+			{ "glBindBufferBase", (void*)&Functions::BindBufferBase },
+			{ "glBindBufferRange", (void*)&Functions::BindBufferRange },
+			{ "glNamedBufferStorage", (void*)&Functions::NamedBufferStorage },
+			{ "glNamedBufferData", (void*)&Functions::NamedBufferData },
+			{ "glNamedBufferSubData", (void*)&Functions::NamedBufferSubData },
+			{ "glGetNamedBufferSubData", (void*)&Functions::GetNamedBufferSubData },
+			{ "glMapNamedBuffer", (void*)&Functions::MapNamedBuffer },
+			{ "glMapNamedBufferRange", (void*)&Functions::MapNamedBufferRange },
+			{ "glUnmapNamedBuffer", (void*)&Functions::UnmapNamedBuffer },
+			{ "glCreateVertexArrays", (void*)&Functions::CreateVertexArrays },
+			{ "glDeleteVertexArrays", (void*)&Functions::DeleteVertexArrays },
+			{ "glBindVertexArray", (void*)&Functions::BindVertexArray },
+			{ "glEnableVertexAttribArray", (void*)&Functions::EnableVertexAttribArray },
+			{ "glVertexAttribPointer", (void*)&Functions::VertexAttribPointer },
+			{ "glVertexAttribIPointer", (void*)&Functions::VertexAttribIPointer },
+			{ "glVertexAttribDivisor", (void*)&Functions::VertexAttribDivisor },
+			{ "glCreateTextures", (void*)&Functions::CreateTextures },
+			{ "glDeleteTextures", (void*)&Functions::DeleteTextures },
+			{ "glBindTexture", (void*)&Functions::BindTexture },
+			{ "glBindTextureUnit", (void*)&Functions::BindTextureUnit },
+			{ "glTexImage2D", (void*)&Functions::TexImage2D },
+			{ "glTexImage3D", (void*)&Functions::TexImage3D },
+			{ "glTexParameteri", (void*)&Functions::TexParameteri },
+			{ "glGenerateMipmap", (void*)&Functions::GenerateMipmap },
+			{ "glClearTexImage", (void*)&Functions::ClearTexImage },
+			{ "glCopyImageSubData", (void*)&Functions::CopyImageSubData },
+			{ "glCreateFramebuffers", (void*)&Functions::CreateFramebuffers },
+			{ "glGenFramebuffers", (void*)&Functions::CreateFramebuffers },
+			{ "glDeleteFramebuffers", (void*)&Functions::DeleteFramebuffers },
+			{ "glBindFramebuffer", (void*)&Functions::BindFramebuffer },
+			{ "glFramebufferTexture", (void*)&Functions::FramebufferTexture },
+			{ "glCheckFramebufferStatus", (void*)&Functions::CheckFramebufferStatus },
+			{ "glDrawBuffer", (void*)&Functions::DrawBuffer },
+			{ "glDrawBuffers", (void*)&Functions::DrawBuffers },
+			{ "glReadBuffer", (void*)&Functions::ReadBuffer },
+			{ "glReadPixels", (void*)&Functions::ReadPixels },
+			{ "glCreateShader", (void*)&Functions::CreateShader },
+			{ "glDeleteShader", (void*)&Functions::DeleteShader },
+			{ "glShaderSource", (void*)&Functions::ShaderSource },
+			{ "glCompileShader", (void*)&Functions::CompileShader },
+			{ "glGetShaderiv", (void*)&Functions::GetShaderiv },
+			{ "glGetShaderInfoLog", (void*)&Functions::GetShaderInfoLog },
+			{ "glCreateProgram", (void*)&Functions::CreateProgram },
+			{ "glDeleteProgram", (void*)&Functions::DeleteProgram },
+			{ "glAttachShader", (void*)&Functions::AttachShader },
+			{ "glLinkProgram", (void*)&Functions::LinkProgram },
+			{ "glGetProgramiv", (void*)&Functions::GetProgramiv },
+			{ "glGetProgramInfoLog", (void*)&Functions::GetProgramInfoLog },
+			{ "glGetActiveUniform", (void*)&Functions::GetActiveUniform },
+			{ "glGetUniformLocation", (void*)&Functions::GetUniformLocation },
+			{ "glGetUniformBlockIndex", (void*)&Functions::GetUniformBlockIndex },
+			{ "glUseProgram", (void*)&Functions::UseProgram },
+			{ "glUniform1i", (void*)&Functions::Uniform1i },
+			{ "glUniform1f", (void*)&Functions::Uniform1f },
+			{ "glUniform2f", (void*)&Functions::Uniform2f },
+			{ "glUniform3f", (void*)&Functions::Uniform3f },
+			{ "glUniform4f", (void*)&Functions::Uniform4f },
+			{ "glUniformMatrix2fv", (void*)&Functions::UniformMatrix2fv },
+			{ "glUniformMatrix3fv", (void*)&Functions::UniformMatrix3fv },
+			{ "glUniformMatrix4fv", (void*)&Functions::UniformMatrix4fv },
+		};
+
+		// glad asks for every function when this backend is loaded
+		Functions::s_Backend = this;
+		auto it = s_Functions.find(name);
+		// Functions the engine never calls are left null
+		return it == s_Functions.end() ? nullptr : it->second;
+	}
+
+	void RecordingRenderBackend::Record(RecordedCommandType type, uint32_t target, uint32_t handle, size_t size, uint32_t count)
+	{
+		switch (type)
+		{
+		case RecordedCommandType::BindFramebuffer:
+		case RecordedCommandType::BindVertexArray:
+		case RecordedCommandType::BindBuffer:
+		case RecordedCommandType::BindTexture:
+			m_Stats.BindCount++;
+			break;
+		case RecordedCommandType::UseProgram:
+			m_Stats.ShaderBindCount++;
+			break;
+		case RecordedCommandType::SetUniform:
+			m_Stats.UniformCount++;
+			break;
+		case RecordedCommandType::SetState:
+			m_Stats.StateChangeCount++;
+			break;
+		case RecordedCommandType::Clear:
+			m_Stats.ClearCount++;
+			break;
+		case RecordedCommandType::Draw:
+			m_Stats.DrawCount++;
+			m_Stats.IndexCount += size;
+			m_Stats.InstanceCount += count;
+			break;
+		case RecordedCommandType::UploadBuffer:
+			m_Stats.BufferUploadCount++;
+			m_Stats.BufferUploadBytes += size;
+			break;
+		case RecordedCommandType::UploadTexture:
+		case RecordedCommandType::CopyTexture:
+			m_Stats.TextureUploadCount++;
+			m_Stats.TextureUploadBytes += size;
+			break;
+		case RecordedCommandType::Readback:
+			m_Stats.ReadbackBytes += size;
+			break;
+		}
+		if (m_RecordCommands)
+			m_Commands.push_back({ type, target, handle, size, count });
+	}
+
+	void RecordingRenderBackend::LinkProgram(Program& program) const
+	{
+		program.Uniforms.clear();
+		program.Locations.clear();
+		program.UniformBlocks.clear();
+		int nextLocation = 0;
+		for (uint32_t shader : program.Shaders)
+		{
+			auto source = m_ShaderSources.find(shader);
+			if (source == m_ShaderSources.end())
+				continue;
+			Detail::GlslDeclarations declarations = Detail::ReflectGlsl(source->second);
+			for (const std::string& block : declarations.UniformBlocks)
+			{
+				if (std::find(program.UniformBlocks.begin(), program.UniformBlocks.end(), block) == program.UniformBlocks.end())
+					program.UniformBlocks.push_back(block);
+			}
+
+			// Structs are flattened into one uniform per member like GL reports them
+			std::function<void(const Detail::GlslVariable&, const std::string&)> addUniform = [&](const Detail::GlslVariable& variable, const std::string& name)
+			{
+				auto members = declarations.Structs.find(variable.Type);
+				if (members != declarations.Structs.end())
+				{
+					for (int i = 0; i < (variable.IsArray ? variable.Size : 1); i++)
+					{
+						std::string prefix = variable.IsArray ? name + '[' + std::to_string(i) + ']' : name;
+						for (const Detail::GlslVariable& member : members->second)
+							addUniform(member, prefix + '.' + member.Name);
+					}
+					return;
+				}
+				GLenum type = Detail::GetUniformType(variable.Type);
+				std::string reportedName = variable.IsArray ? name + "[0]" : name;
+				// Declared by an earlier stage
+				if (type == GL_NONE || program.Locations.find(reportedName) != program.Locations.end())
+					return;
+				int size = variable.IsArray ? variable.Size : 1;
+				program.Uniforms.push_back({ reportedName, type, size, nextLocation });
+				program.Locations[reportedName] = nextLocation;
+				if (variable.IsArray)
+				{
+					program.Locations[name] = nextLocation;
+					for (int i = 1; i < size; i++)
+						program.Locations[name + '[' + std::to_string(i) + ']'] = nextLocation + i;
+				}
+				nextLocation += size;
+			};
+			for (const Detail::GlslVariable& uniform : declarations.Uniforms)
+				addUniform(uniform, uniform.Name);
+		}
+	}
+
+}
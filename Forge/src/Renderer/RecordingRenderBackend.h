@@ -0,0 +1,135 @@
+#pragma once
+#include "RenderBackend.h"
+
+#include <unordered_map>
+
+namespace Forge
+{
+
+	namespace Detail
+	{
+		struct RecordingFunctions;
+	}
+
+	FORGE_API enum class RecordedCommandType
+	{
+		BindFramebuffer,
+		BindVertexArray,
+		BindBuffer,
+		BindTexture,
+		UseProgram,
+		SetUniform,
+		SetState,
+		Clear,
+		Draw,
+		UploadBuffer,
+		UploadTexture,
+		CopyTexture,
+		Readback,
+	};
+
+	// A GL call that reached the recording backend
+	struct FORGE_API RecordedCommand
+	{
+	public:
+		RecordedCommandType Type;
+		// GL target, draw mode or state of the call, the texture unit for BindTexture and the location for SetUniform
+		uint32_t Target = 0;
+		// Object bound, written or read, the current program for SetUniform and Draw
+		uint32_t Handle = 0;
+		// Bytes transferred, or indices drawn
+		size_t Size = 0;
+		// Instances drawn or uniform array elements set
+		uint32_t Count = 0;
+	};
+
+	struct FORGE_API RecordingStats
+	{
+	public:
+		int DrawCount = 0;
+		size_t IndexCount = 0;
+		size_t InstanceCount = 0;
+		// Framebuffer, vertex array, buffer and texture binds
+		int BindCount = 0;
+		int ShaderBindCount = 0;
+		int UniformCount = 0;
+		int StateChangeCount = 0;
+		int ClearCount = 0;
+		// Data set and ranges mapped for writing. Writes into persistently mapped buffers are not seen here, they are counted
+		// by DynamicVertexBuffer::EndFrame()
+		int BufferUploadCount = 0;
+		size_t BufferUploadBytes = 0;
+		// Pixels uploaded and copied between textures
+		int TextureUploadCount = 0;
+		size_t TextureUploadBytes = 0;
+		size_t ReadbackBytes = 0;
+	};
+
+	// Render backend without a GPU, GL calls are recorded and counted instead of executed. There is just enough emulation for the
+	// renderers to run: objects get names, buffers keep their data in memory so they can be mapped and read back, and shader
+	// uniforms are reflected from the GLSL source. Nothing is rasterized, so pixels read back are zero.
+	// Render headless by setting WindowProps::Backend, or by initializing a GraphicsContext with the backend followed by
+	// RenderCommand::Init()
+	class FORGE_API RecordingRenderBackend : public RenderBackend
+	{
+	private:
+		struct Uniform
+		{
+		public:
+			// As reported by glGetActiveUniform(), arrays end in [0]
+			std::string Name;
+			uint32_t Type;
+			int Size;
+			int Location;
+		};
+
+		struct Program
+		{
+		public:
+			std::vector<uint32_t> Shaders;
+			std::vector<Uniform> Uniforms;
+			// Every element of every array, as well as array names without [0]
+			std::unordered_map<std::string, int> Locations;
+			std::vector<std::string> UniformBlocks;
+		};
+
+	private:
+		bool m_RecordCommands;
+		std::vector<RecordedCommand> m_Commands;
+		RecordingStats m_Stats;
+
+		uint32_t m_NextHandle;
+		std::unordered_map<uint32_t, std::vector<uint8_t>> m_Buffers;
+		std::unordered_map<uint32_t, std::string> m_ShaderSources;
+		std::unordered_map<uint32_t, Program> m_Programs;
+		// Bytes per texel of the data last uploaded to each texture
+		std::unordered_map<uint32_t, uint32_t> m_TexelSizes;
+		// Texture bound to each target of each unit, keyed by unit << 32 | target
+		std::unordered_map<uint64_t, uint32_t> m_TextureBindings;
+		uint32_t m_ActiveTextureUnit;
+		uint32_t m_CurrentProgram;
+		uint32_t m_PixelPackBuffer;
+
+	public:
+		// Without recordCommands only the stats are kept, which avoids growing the command list in benchmarks
+		RecordingRenderBackend(bool recordCommands = true);
+		~RecordingRenderBackend();
+
+		// Commands and stats since construction or the last Reset()
+		inline const std::vector<RecordedCommand>& GetCommands() const { return m_Commands; }
+		inline const RecordingStats& GetStats() const { return m_Stats; }
+		// Name of the uniform at a location of a program, empty if there is none
+		std::string GetUniformName(uint32_t program, int location) const;
+		// Clears the recorded commands and stats, objects that were created are kept
+		void Reset();
+
+		void* GetProcAddress(const char* name) override;
+
+	private:
+		void Record(RecordedCommandType type, uint32_t target, uint32_t handle, size_t size = 0, uint32_t count = 0);
+		void LinkProgram(Program& program) const;
+
+		friend struct Detail::RecordingFunctions;
+	};
+
+}
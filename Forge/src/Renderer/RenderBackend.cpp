@@ -0,0 +1,19 @@
+#include "ForgePch.h"
+#include "RenderBackend.h"
+
+#include <glad/glad.h>
+
+namespace Forge
+{
+
+	RenderBackend* RenderBackend::s_Current = nullptr;
+
+	bool RenderBackend::Load(RenderBackend& backend)
+	{
+		s_Current = &backend;
+		// glad only takes a plain function, so lookups go through the current backend
+		int status = gladLoadGLLoader([](const char* name) { return s_Current->GetProcAddress(name); });
+		return status != 0;
+	}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Logging.h"
+
+namespace Forge
+{
+
+	// Supplies the OpenGL functions that every renderer class calls through glad. The window's context resolves them from the
+	// driver, a RecordingRenderBackend replaces them so that rendering runs without a GPU
+	class FORGE_API RenderBackend
+	{
+	private:
+		static RenderBackend* s_Current;
+
+	public:
+		virtual ~RenderBackend() = default;
+
+		// Address of the GL function with the given name, nullptr if the backend does not provide it
+		virtual void* GetProcAddress(const char* name) = 0;
+
+	public:
+		// Points every GL function at the backend, which must outlive any further rendering. Returns false if glad could not
+		// read the version of the backend
+		static bool Load(RenderBackend& backend);
+		// nullptr until a backend is loaded
+		inline static RenderBackend* Get() { return s_Current; }
+	};
+
+}
@@ -88,7 +88,14 @@ namespace Forge
 	{
 		uint32_t count = vertexArray->GetIndexCount();
 		vertexArray->Bind();
-		glDrawElements(drawMode, count, vertexArray->GetIndexBuffer()->GetGlDataType(), nullptr);
+		glDrawElementsBaseVertex(drawMode, count, vertexArray->GetIndexBuffer()->GetGlDataType(), nullptr, vertexArray->GetBaseVertex());
+	}
+
+	void RenderCommand::DrawIndexedInstanced(GLuint drawMode, const Ref<VertexArray>& vertexArray, uint32_t instanceCount, uint32_t baseInstance)
+	{
+		uint32_t count = vertexArray->GetIndexCount();
+		vertexArray->Bind();
+		glDrawElementsInstancedBaseVertexBaseInstance(drawMode, count, vertexArray->GetIndexBuffer()->GetGlDataType(), nullptr, instanceCount, vertexArray->GetBaseVertex(), baseInstance);
 	}
 
 	void RenderCommand::EnableClippingPlanes(int count)
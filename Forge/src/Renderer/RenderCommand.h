@@ -39,6 +39,7 @@ namespace Forge
 		static void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 		static void EnableWireframe(bool enable);
 		static void DrawIndexed(GLuint drawMode, const Ref<VertexArray>& vertexArray);
+		static void DrawIndexedInstanced(GLuint drawMode, const Ref<VertexArray>& vertexArray, uint32_t instanceCount, uint32_t baseInstance = 0);
 		static void EnableClippingPlanes(int count);
 	};
 
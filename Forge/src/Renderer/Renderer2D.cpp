@@ -1,39 +1,58 @@
 #include "ForgePch.h"
 #include "Renderer2D.h"
 #include "Assets/GraphicsCache.h"
+#include "Math/SimdLanes.h"
 
 namespace Forge
 {
 
-	static constexpr glm::vec3 s_QuadPositions[4] = {
-		glm::vec3{ -0.5f,  0.5f, 0.0f },
-		glm::vec3{ -0.5f, -0.5f, 0.0f },
-		glm::vec3{  0.5f, -0.5f, 0.0f },
-		glm::vec3{  0.5f,  0.5f, 0.0f },
-	};
+	static constexpr glm::vec4 s_FullUvRect = { 0.0f, 0.0f, 1.0f, 1.0f };
+	static constexpr uint32_t s_NoTextureIndex = ~uint32_t(0);
 
-	static constexpr glm::vec2 s_TexCoords[4] = {
-		glm::vec2{ 0.0f, 1.0f },
-		glm::vec2{ 0.0f, 0.0f },
-		glm::vec2{ 1.0f, 0.0f },
-		glm::vec2{ 1.0f, 1.0f },
-	};
-
-	Renderer2D::Renderer2D()
-		: m_UsedIndices(0), m_CurrentVertexIndex(0), m_CurrentTextureIndex(1), m_Vertices(), m_Indices(), m_Shader(), m_ModelIndex(0), m_Models()
+	Renderer2D::Renderer2D(JobSystem& jobs)
+		: m_Stats(), m_Sprites(), m_Commands(), m_SpriteCount(0), m_SortBuffer(), m_Batches(), m_Textures(), m_TextureIndexMap(), m_LastTexture(nullptr), m_LastTextureIndex(s_NoTextureIndex),
+		m_Atlas(), m_Jobs(&jobs), m_BatchId(0), m_BatchTextureCount(0), m_Indices(), m_Shader(), m_TextureUniformNames(), m_Models(), m_VertexBuffers()
 	{
 		Init();
 	}
 
 	void Renderer2D::BeginScene()
 	{
-		m_ModelIndex = 0;
-		StartBatch();
+		m_SpriteCount = 0;
+		m_Batches.clear();
+		m_Textures.clear();
+		m_TextureIndexMap.clear();
+		m_LastTexture = nullptr;
+		m_LastTextureIndex = s_NoTextureIndex;
 	}
 
 	void Renderer2D::EndScene()
 	{
-		EndBatch();
+		SortSprites();
+		CreateBatches();
+		for (size_t i = 0; i < m_Batches.size(); i++)
+			m_Batches[i].Vertices = (QuadVertex*)m_VertexBuffers[i]->Map(m_Batches[i].Count * 4 * sizeof(QuadVertex));
+		m_Jobs->ParallelFor(m_SpriteCount, QuadsPerJob, [this](size_t begin, size_t end)
+		{
+			WriteVertices(begin, end);
+		});
+		for (size_t i = 0; i < m_Batches.size(); i++)
+		{
+			m_VertexBuffers[i]->Unmap();
+			Ref<VertexArray> vertices = m_Models[i]->GetSubModels()[0].Mesh->GetVertices();
+			vertices->SetBaseVertex(m_VertexBuffers[i]->GetBaseVertex());
+			vertices->SetMaxIndices(m_Batches[i].Count * 6);
+		}
+
+		m_Stats.SpriteCount = int(m_SpriteCount);
+		m_Stats.BatchCount = int(m_Batches.size());
+		m_Stats.TextureCount = int(m_Textures.size());
+		m_Stats.AtlasTextureCount = 0;
+		for (const SpriteTexture& texture : m_Textures)
+		{
+			if (texture.Region.Layer >= 0)
+				m_Stats.AtlasTextureCount++;
+		}
 	}
 
 	void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const Color& color)
@@ -43,20 +62,44 @@ namespace Forge
 
 	void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const Ref<Texture2D>& texture, const Color& color)
 	{
-		if (m_UsedIndices >= MaxIndices)
+		DrawQuad(position, size, 0.0f, texture, s_FullUvRect, color);
+	}
+
+	void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<Texture2D>& texture, const glm::vec4& uvRect, const Color& color, int layer)
+	{
+		SetSprite(AddSprites(1), GetTextureIndex(texture), position, size, rotation, uvRect, color, layer);
+	}
+
+	void Renderer2D::DrawQuads(const QuadSpans& quads)
+	{
+		size_t first = AddSprites(quads.Count);
+		// New textures are copied into the atlas, so they are added on the calling thread before the jobs look them up
+		if (quads.Textures)
 		{
-			EndBatch();
-			StartBatch();
+			for (size_t i = 0; i < quads.Count; i++)
+				GetTextureIndex(quads.Textures[i]);
 		}
-		for (int i = 0; i < 4; i++)
+		else
 		{
-			m_Vertices[m_CurrentVertexIndex].Position = position + s_QuadPositions[i] * glm::vec3{ size.x, size.y, 1.0f };
-			m_Vertices[m_CurrentVertexIndex].TexCoord = s_TexCoords[i];
-			m_Vertices[m_CurrentVertexIndex].Color = color;
-			m_Vertices[m_CurrentVertexIndex].TextureId = BindTexture(texture);
-			m_CurrentVertexIndex++;
+			GetTextureIndex(nullptr);
 		}
-		m_UsedIndices += 6;
+
+		m_Jobs->ParallelFor(quads.Count, QuadsPerJob, [this, &quads, first](size_t begin, size_t end)
+		{
+			const Texture2D* texture = nullptr;
+			uint32_t textureIndex = s_NoTextureIndex;
+			for (size_t i = begin; i < end; i++)
+			{
+				const Texture2D* spriteTexture = quads.Textures ? quads.Textures[i].get() : nullptr;
+				if (spriteTexture != texture || textureIndex == s_NoTextureIndex)
+				{
+					texture = spriteTexture;
+					textureIndex = m_TextureIndexMap.find(texture)->second;
+				}
+				SetSprite(first + i, textureIndex, quads.Positions[i], quads.Sizes[i], quads.Rotations ? quads.Rotations[i] : 0.0f,
+					quads.UvRects ? quads.UvRects[i] : s_FullUvRect, quads.Colors[i], quads.Layers ? quads.Layers[i] : 0);
+			}
+		});
 	}
 
 	void Renderer2D::Init()
@@ -64,7 +107,6 @@ namespace Forge
 #include "Assets/Shaders/BatchTexture.h"
 		m_Shader = Shader::CreateFromSource(vertexShaderSource, fragmentShaderSource);
 
-		m_Vertices = std::make_unique<QuadVertex[]>(MaxVertices);
 		m_Indices = std::make_unique<uint32_t[]>(MaxIndices);
 
 		uint32_t offset = 0;
@@ -80,55 +122,226 @@ namespace Forge
 			offset += 4;
 		}
 
-		m_Models.push_back(CreateModel());
-	}
+		m_TextureUniformNames.resize(MaxBatchTextures);
+		for (uint32_t i = 0; i < MaxBatchTextures; i++)
+			m_TextureUniformNames[i] = "u_Textures[" + std::to_string(i) + ']';
 
-	void Renderer2D::StartBatch()
-	{
-		m_UsedIndices = 0;
-		m_CurrentVertexIndex = 0;
+		AddModel();
 	}
 
-	void Renderer2D::EndBatch()
+	void Renderer2D::StartBatch(uint32_t first)
 	{
-		if (m_UsedIndices > 0)
-		{
-			Ref<VertexArray> vertices = m_Models[m_ModelIndex]->GetSubModels()[0].Mesh->GetVertices();
-			vertices->GetVertexBuffer(0)->SetData(m_Vertices.get(), m_CurrentVertexIndex * sizeof(QuadVertex));
-			vertices->SetMaxIndices(m_UsedIndices);
-			m_ModelIndex++;
-		}
+		if (m_Batches.size() == m_Models.size())
+			AddModel();
+		m_Batches.push_back({ first, 0, nullptr });
+		m_BatchId++;
+		m_BatchTextureCount = 0;
+
+		// Textures of the last frame the model was used in are released
+		UniformContext& uniforms = m_Models[m_Batches.size() - 1]->GetSubModels()[0].Material->GetUniforms();
+		for (const std::string& name : m_TextureUniformNames)
+			uniforms.SetUniform(name, Ref<Texture2D>());
+		uniforms.SetUniform("u_Atlas", m_Atlas.GetTexture());
 	}
 
-	Ref<Model> Renderer2D::CreateModel()
+	void Renderer2D::AddModel()
 	{
 		BufferLayout layout = {
 			{ ShaderDataType::Float3 },
 			{ ShaderDataType::Float2 },
 			{ ShaderDataType::Float4 },
 			{ ShaderDataType::Int },
+			{ ShaderDataType::Int },
 		};
-		Ref<VertexBuffer> vbo = VertexBuffer::Create(MaxVertices * sizeof(QuadVertex), layout);
+		Ref<DynamicVertexBuffer> vbo = DynamicVertexBuffer::Create(MaxVertices * sizeof(QuadVertex), layout);
 		Ref<IndexBuffer> ibo = IndexBuffer::Create(m_Indices.get(), MaxIndices * sizeof(uint32_t));
 		Ref<VertexArray> vao = VertexArray::Create();
-		vao->AddVertexBuffer(vbo);
+		vao->AddVertexBuffer(vbo->GetVertexBuffer());
 		vao->SetIndexBuffer(ibo);
 		Ref<Material> material = Material::Create(m_Shader);
-		material->GetUniforms().SetUniform("u_Textures[0]", GraphicsCache::WhiteTexture());
-		return Model::Create(CreateRef<Mesh>(vao), material);
+		// Sprites are blended and layered in the order they were drawn
+		material->GetSettings().Transparent = true;
+		m_Models.push_back(Model::Create(CreateRef<Mesh>(vao), material));
+		m_VertexBuffers.push_back(vbo);
 	}
 
-	int Renderer2D::BindTexture(const Ref<Texture2D>& texture)
+	uint32_t Renderer2D::GetTextureIndex(const Ref<Texture2D>& texture)
 	{
-		if (!texture)
-			return 0;
+		// Sprites with the same texture are usually drawn one after the other
+		if (texture.get() == m_LastTexture && m_LastTextureIndex != s_NoTextureIndex)
+			return m_LastTextureIndex;
 		auto it = m_TextureIndexMap.find(texture.get());
+		uint32_t index;
 		if (it != m_TextureIndexMap.end())
-			return it->second;
-		int index = m_CurrentTextureIndex++;
-		m_TextureIndexMap[texture.get()] = index;
-		m_Models[m_ModelIndex]->GetSubModels()[0].Material->GetUniforms().SetUniform("u_Textures[" + std::to_string(index) + ']', texture);
+			index = it->second;
+		else
+		{
+			index = uint32_t(m_Textures.size());
+			SpriteTexture& spriteTexture = m_Textures.emplace_back();
+			spriteTexture.Texture = texture ? texture : GraphicsCache::WhiteTexture();
+			spriteTexture.BatchId = 0;
+			spriteTexture.Slot = 0;
+			m_Atlas.GetRegion(spriteTexture.Texture, spriteTexture.Region);
+			m_TextureIndexMap[texture.get()] = index;
+		}
+		m_LastTexture = texture.get();
+		m_LastTextureIndex = index;
 		return index;
 	}
 
+	int Renderer2D::BindTexture(SpriteTexture& texture)
+	{
+		if (texture.BatchId != m_BatchId)
+		{
+			texture.BatchId = m_BatchId;
+			texture.Slot = int(m_BatchTextureCount++);
+			m_Models[m_Batches.size() - 1]->GetSubModels()[0].Material->GetUniforms().SetUniform(m_TextureUniformNames[texture.Slot], texture.Texture);
+		}
+		return texture.Slot;
+	}
+
+	size_t Renderer2D::AddSprites(size_t count)
+	{
+		size_t first = m_SpriteCount;
+		m_SpriteCount += count;
+		if (m_Sprites.size() < m_SpriteCount)
+			m_Sprites.resize(std::max(m_SpriteCount, m_Sprites.size() * 2));
+		if (m_Commands.size() < m_SpriteCount)
+			m_Commands.resize(std::max(m_SpriteCount, m_Commands.size() * 2));
+		return first;
+	}
+
+	void Renderer2D::SetSprite(size_t index, uint32_t textureIndex, const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& uvRect, const Color& color, int layer)
+	{
+		Sprite& sprite = m_Sprites[index];
+		const AtlasRegion& region = m_Textures[textureIndex].Region;
+		float cosRotation = rotation == 0.0f ? 1.0f : std::cos(rotation);
+		float sinRotation = rotation == 0.0f ? 0.0f : std::sin(rotation);
+		sprite.Position = position;
+		sprite.TextureIndex = textureIndex;
+		sprite.HalfAxisX = glm::vec2{ cosRotation, sinRotation } * (0.5f * size.x);
+		sprite.HalfAxisY = glm::vec2{ -sinRotation, cosRotation } * (0.5f * size.y);
+		sprite.UvRect = uvRect;
+		if (region.Layer >= 0)
+		{
+			glm::vec2 regionSize = region.Max - region.Min;
+			sprite.UvRect = { region.Min.x + uvRect.x * regionSize.x, region.Min.y + uvRect.y * regionSize.y,
+				region.Min.x + uvRect.z * regionSize.x, region.Min.y + uvRect.w * regionSize.y };
+		}
+		sprite.Color = color;
+
+		// Sprites of the atlas share a texture group, other textures each have their own
+		uint64_t group = region.Layer >= 0 ? 0 : uint64_t(textureIndex) + 1;
+		m_Commands[index] = { (uint64_t(uint32_t(layer) ^ 0x80000000u) << 32) | group, uint32_t(index), 0 };
+	}
+
+	void Renderer2D::SortSprites()
+	{
+		// LSD radix sort over 8 bit digits, which keeps sprites with the same key in the order they were queued. Digits that are
+		// identical for every sprite are skipped
+		if (m_SpriteCount < 2)
+			return;
+		uint64_t varyingBits = 0;
+		for (size_t i = 0; i < m_SpriteCount; i++)
+			varyingBits |= m_Commands[i].SortKey ^ m_Commands[0].SortKey;
+		if (m_SortBuffer.size() < m_SpriteCount)
+			m_SortBuffer.resize(m_Commands.size());
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			if (((varyingBits >> shift) & 0xFF) == 0)
+				continue;
+			size_t offsets[256] = {};
+			for (size_t i = 0; i < m_SpriteCount; i++)
+				offsets[(m_Commands[i].SortKey >> shift) & 0xFF]++;
+			size_t total = 0;
+			for (size_t& offset : offsets)
+			{
+				size_t count = offset;
+				offset = total;
+				total += count;
+			}
+			for (size_t i = 0; i < m_SpriteCount; i++)
+				m_SortBuffer[offsets[(m_Commands[i].SortKey >> shift) & 0xFF]++] = m_Commands[i];
+			std::swap(m_Commands, m_SortBuffer);
+		}
+	}
+
+	void Renderer2D::CreateBatches()
+	{
+		m_Batches.clear();
+		for (uint32_t i = 0; i < uint32_t(m_SpriteCount); i++)
+		{
+			SpriteCommand& command = m_Commands[i];
+			uint32_t group = uint32_t(command.SortKey);
+			bool needsSlot = group != 0 && m_Textures[group - 1].BatchId != m_BatchId;
+			if (m_Batches.empty() || m_Batches.back().Count == MaxQuads || (needsSlot && m_BatchTextureCount >= MaxBatchTextures))
+				StartBatch(i);
+			command.TextureSlot = group != 0 ? BindTexture(m_Textures[group - 1]) : 0;
+			m_Batches.back().Count++;
+		}
+	}
+
+	void Renderer2D::WriteVertices(size_t begin, size_t end) const
+	{
+		constexpr size_t Width = FloatLanes::Width;
+
+		auto batch = std::upper_bound(m_Batches.begin(), m_Batches.end(), begin, [](size_t index, const SpriteBatch& batch) { return index < batch.First; }) - 1;
+		while (begin < end)
+		{
+			size_t batchEnd = std::min(end, size_t(batch->First) + batch->Count);
+			for (size_t first = begin; first < batchEnd && batch->Vertices; first += Width)
+			{
+				// The corners of Width sprites are computed together, unused lanes are zero
+				size_t count = std::min(Width, batchEnd - first);
+				float values[6][Width] = {};
+				for (size_t i = 0; i < count; i++)
+				{
+					const Sprite& sprite = m_Sprites[m_Commands[first + i].Index];
+					values[0][i] = sprite.Position.x;
+					values[1][i] = sprite.Position.y;
+					values[2][i] = sprite.HalfAxisX.x;
+					values[3][i] = sprite.HalfAxisX.y;
+					values[4][i] = sprite.HalfAxisY.x;
+					values[5][i] = sprite.HalfAxisY.y;
+				}
+				FloatLanes x = FloatLanes::Load(values[0]);
+				FloatLanes y = FloatLanes::Load(values[1]);
+				FloatLanes axisXx = FloatLanes::Load(values[2]);
+				FloatLanes axisXy = FloatLanes::Load(values[3]);
+				FloatLanes axisYx = FloatLanes::Load(values[4]);
+				FloatLanes axisYy = FloatLanes::Load(values[5]);
+				// Top left, bottom left, bottom right and top right, matching the winding of m_Indices
+				float cornersX[4][Width];
+				float cornersY[4][Width];
+				(x - axisXx + axisYx).Store(cornersX[0]);
+				(y - axisXy + axisYy).Store(cornersY[0]);
+				(x - axisXx - axisYx).Store(cornersX[1]);
+				(y - axisXy - axisYy).Store(cornersY[1]);
+				(x + axisXx - axisYx).Store(cornersX[2]);
+				(y + axisXy - axisYy).Store(cornersY[2]);
+				(x + axisXx + axisYx).Store(cornersX[3]);
+				(y + axisXy + axisYy).Store(cornersY[3]);
+
+				QuadVertex* vertices = batch->Vertices + (first - batch->First) * 4;
+				for (size_t i = 0; i < count; i++)
+				{
+					const SpriteCommand& command = m_Commands[first + i];
+					const Sprite& sprite = m_Sprites[command.Index];
+					int atlasLayer = m_Textures[sprite.TextureIndex].Region.Layer;
+					for (int corner = 0; corner < 4; corner++)
+					{
+						QuadVertex& vertex = vertices[i * 4 + corner];
+						vertex.Position = { cornersX[corner][i], cornersY[corner][i], sprite.Position.z };
+						vertex.TexCoord = { corner < 2 ? sprite.UvRect.x : sprite.UvRect.z, corner == 0 || corner == 3 ? sprite.UvRect.w : sprite.UvRect.y };
+						vertex.Color = sprite.Color;
+						vertex.TextureId = command.TextureSlot;
+						vertex.AtlasLayer = atlasLayer;
+					}
+				}
+			}
+			begin = batchEnd;
+			batch++;
+		}
+	}
+
 }
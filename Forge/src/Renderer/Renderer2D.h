@@ -1,16 +1,56 @@
 #pragma once
 #include "Model.h"
 #include "RendererContext.h"
+#include "DynamicVertexBuffer.h"
+#include "SpriteAtlas.h"
+#include "Core/JobSystem.h"
 
 namespace Forge
 {
 
+	struct FORGE_API Renderer2DStats
+	{
+	public:
+		int SpriteCount = 0;
+		// Draws the sprites were batched into
+		int BatchCount = 0;
+		// Distinct textures drawn and how many of them were read from the atlas
+		int TextureCount = 0;
+		int AtlasTextureCount = 0;
+	};
+
+	// Attributes of the sprites queued by Renderer2D::DrawQuads(), every array that is set holds Count elements
+	struct FORGE_API QuadSpans
+	{
+	public:
+		size_t Count = 0;
+		const glm::vec3* Positions = nullptr;
+		const glm::vec2* Sizes = nullptr;
+		const Color* Colors = nullptr;
+		// Optional, untextured sprites if nullptr
+		const Ref<Texture2D>* Textures = nullptr;
+		// Optional, in radians around the z axis
+		const float* Rotations = nullptr;
+		// Optional, the whole texture if nullptr
+		const glm::vec4* UvRects = nullptr;
+		// Optional, layer 0 if nullptr
+		const int* Layers = nullptr;
+	};
+
+	// Sprites are queued until EndScene(), then sorted by layer and texture and drawn in as few batches as possible.
+	// Small static textures are packed into a SpriteAtlas that every batch reads from, other textures are bound on their own
+	// and a batch ends when it runs out of texture slots for them. Within a layer the sprites of the atlas are drawn first,
+	// and sprites with the same texture are drawn in the order they were queued
 	class FORGE_API Renderer2D
 	{
 	private:
 		static constexpr uint32_t MaxQuads = 20000;
 		static constexpr uint32_t MaxVertices = MaxQuads * 4;
 		static constexpr uint32_t MaxIndices = MaxQuads * 6;
+		// Size of u_Textures in BatchTexture.shader
+		static constexpr uint32_t MaxBatchTextures = 16;
+		// Sprites queued or expanded into vertices by each job
+		static constexpr size_t QuadsPerJob = 2048;
 
 		struct FORGE_API QuadVertex
 		{
@@ -19,39 +59,113 @@ namespace Forge
 			glm::vec2 TexCoord;
 			Forge::Color Color;
 			int TextureId;
+			// Negative if the texture is bound to u_Textures[TextureId] rather than read from the atlas
+			int AtlasLayer;
+		};
+
+		struct Sprite
+		{
+		public:
+			glm::vec3 Position;
+			uint32_t TextureIndex;
+			// Rotated half size of the quad along its x and y axes
+			glm::vec2 HalfAxisX;
+			glm::vec2 HalfAxisY;
+			// Texture coordinates in the atlas for textures that are packed
+			glm::vec4 UvRect;
+			Forge::Color Color;
+		};
+
+		// Texture drawn this frame, with its slot in the batch it was last bound in
+		struct SpriteTexture
+		{
+		public:
+			Ref<Texture2D> Texture;
+			AtlasRegion Region;
+			uint32_t BatchId;
+			int Slot;
+		};
+
+		// Sorted by layer then texture, Index refers into m_Sprites. The low 32 bits of the key are 0 for textures in the atlas
+		// and the texture index + 1 otherwise
+		struct SpriteCommand
+		{
+		public:
+			uint64_t SortKey;
+			uint32_t Index;
+			// Index into u_Textures of the batch the sprite is drawn in
+			int TextureSlot;
+		};
+
+		// Consecutive sprite commands drawn by one model, written straight into its mapped vertex buffer
+		struct SpriteBatch
+		{
+		public:
+			uint32_t First;
+			uint32_t Count;
+			QuadVertex* Vertices;
 		};
 
 	private:
-		uint32_t m_UsedIndices;
-		uint32_t m_CurrentVertexIndex;
-		uint32_t m_CurrentTextureIndex;
+		Renderer2DStats m_Stats;
+		// Only grow so that they are not cleared every frame, the first m_SpriteCount elements are used
+		std::vector<Sprite> m_Sprites;
+		std::vector<SpriteCommand> m_Commands;
+		size_t m_SpriteCount;
+		std::vector<SpriteCommand> m_SortBuffer;
+		std::vector<SpriteBatch> m_Batches;
+		std::vector<SpriteTexture> m_Textures;
+		std::unordered_map<const Texture2D*, uint32_t> m_TextureIndexMap;
+		const Texture2D* m_LastTexture;
+		uint32_t m_LastTextureIndex;
+		SpriteAtlas m_Atlas;
+		JobSystem* m_Jobs;
+
+		uint32_t m_BatchId;
+		uint32_t m_BatchTextureCount;
 
-		std::unordered_map<Texture2D*, int> m_TextureIndexMap;
-		std::unique_ptr<QuadVertex[]> m_Vertices;
 		std::unique_ptr<uint32_t[]> m_Indices;
 		Ref<Shader> m_Shader;
+		std::vector<std::string> m_TextureUniformNames;
 
-		uint32_t m_ModelIndex;
 		std::vector<Ref<Model>> m_Models;
+		// Vertices of each model
+		std::vector<Ref<DynamicVertexBuffer>> m_VertexBuffers;
 
 	public:
-		Renderer2D();
+		// Vertices are generated across the given job system
+		Renderer2D(JobSystem& jobs = JobSystem::Get());
 
 		inline const Ref<Model>* GetRenderables() const { return m_Models.data(); }
-		inline uint32_t GetRenderableCount() const { return m_ModelIndex; }
+		inline uint32_t GetRenderableCount() const { return uint32_t(m_Batches.size()); }
+		// Stats of the last EndScene()
+		inline const Renderer2DStats& GetStats() const { return m_Stats; }
+		inline const SpriteAtlas& GetAtlas() const { return m_Atlas; }
 
 		void BeginScene();
 		void EndScene();
 
 		void DrawQuad(const glm::vec3& position, const glm::vec2& size, const Color& color);
 		void DrawQuad(const glm::vec3& position, const glm::vec2& size, const Ref<Texture2D>& texture, const Color& color = COLOR_WHITE);
+		// Rotation is in radians around the z axis. uvRect holds the minimum and maximum texture coordinates drawn, within [0, 1]
+		// for textures in the atlas. Sprites are drawn in increasing layer
+		void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<Texture2D>& texture, const glm::vec4& uvRect, const Color& color = COLOR_WHITE, int layer = 0);
+		// Same as calling DrawQuad() for each sprite in turn, the sprites are queued across the job system
+		void DrawQuads(const QuadSpans& quads);
 
 	private:
 		void Init();
-		void StartBatch();
-		void EndBatch();
-		Ref<Model> CreateModel();
-		int BindTexture(const Ref<Texture2D>& texture);
+		void StartBatch(uint32_t first);
+		void AddModel();
+		uint32_t GetTextureIndex(const Ref<Texture2D>& texture);
+		int BindTexture(SpriteTexture& texture);
+		// Index of the first of count new sprites
+		size_t AddSprites(size_t count);
+		void SetSprite(size_t index, uint32_t textureIndex, const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& uvRect, const Color& color, int layer);
+		void SortSprites();
+		void CreateBatches();
+		// Writes the vertices of the commands in [begin, end) into the mapped batches
+		void WriteVertices(size_t begin, size_t end) const;
 	};
 
 }
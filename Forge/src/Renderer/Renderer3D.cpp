@@ -1,11 +1,13 @@
 #include "ForgePch.h"
 #include "Renderer3D.h"
 #include "RenderCommand.h"
+#include "Animation/AnimatedMesh.h"
 
 #include "Assets/GraphicsCache.h"
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
+#include <limits>
 
 #include <imgui.h>
 #include <backends/imgui_impl_opengl3.h>
@@ -13,11 +15,29 @@
 namespace Forge
 {
 
+    // Per instance attributes of Instancing.shader, see Renderer3D::InstanceData
+    static Ref<DynamicVertexBuffer> CreateInstanceBuffer(size_t capacityBytes)
+    {
+        BufferLayout layout = {
+          {ShaderDataType::Mat4},
+          {ShaderDataType::Int},
+        };
+        return DynamicVertexBuffer::Create(capacityBytes, layout);
+    }
+
     Renderer3D::Renderer3D()
         : m_CurrentScene(),
           m_CurrentRenderPass(),
           m_RenderImGui(false),
           m_CurrentShadowLightIndex(0),
+          m_CullingFrustum(),
+          m_CurrentViewMatrix(1.0f),
+          m_CurrentNearPlane(0.0f),
+          m_CurrentFarPlane(1.0f),
+          m_CurrentMaterial(nullptr),
+          m_JointPaletteOffsets(),
+          m_InstanceBuffer(nullptr),
+          m_FrameInstanceBytes(0),
           m_Context(),
           m_ClearedFramebuffers(),
           m_ShadowFramebuffers(),
@@ -81,6 +101,7 @@ namespace Forge
     void Renderer3D::EndScene()
     {
         m_Context.Reset();
+        UpdateJointPalettes();
         if (m_CurrentRenderPass != RenderPass::Pick)
         {
             if (!m_ShadowPasses.empty())
@@ -114,12 +135,32 @@ namespace Forge
     {
         m_ClearedFramebuffers.clear();
         m_ShadowFramebuffers.clear();
+        m_JointPaletteOffsets.clear();
+        m_Context.ResetJointPalettes();
         m_Stats = {};
+
+        // Grown between frames rather than when a pass runs out of space, so that the buffer the earlier passes of a frame
+        // were drawn from is never replaced. The next frame fits in one region
+        if (m_InstanceBuffer && m_FrameInstanceBytes > m_InstanceBuffer->GetCapacity())
+            m_InstanceBuffer = CreateInstanceBuffer(std::max(m_FrameInstanceBytes, m_InstanceBuffer->GetCapacity() * 2));
+        m_FrameInstanceBytes = 0;
     }
 
     void Renderer3D::RenderModel(const Ref<Model>& model, const glm::mat4& transform, const RenderOptions& options)
     {
-        m_Renderables.push_back({model, transform, options});
+        for (const Model::SubModel& submodel : model->GetSubModels())
+        {
+            glm::mat4 overallTransform = transform * submodel.Transform;
+            BoundingBox worldBounds;
+            if (submodel.Mesh->IsCullable())
+                worldBounds = submodel.Mesh->GetBounds().Transform(overallTransform);
+            m_Renderables.push_back({submodel.Mesh,
+              submodel.Material,
+              overallTransform,
+              worldBounds,
+              options,
+              0});
+        }
     }
 
     void Renderer3D::RenderShadowScene(const ShadowPass& pass)
@@ -190,6 +231,10 @@ namespace Forge
                 RenderCommand::ClearDepth();
             }
         }
+        m_CullingFrustum = FrustumPlanes(data.Camera.Frustum.ProjectionMatrix * data.Camera.ViewMatrix);
+        m_CurrentViewMatrix = data.Camera.ViewMatrix;
+        m_CurrentNearPlane = data.Camera.Frustum.NearPlane;
+        m_CurrentFarPlane = data.Camera.Frustum.FarPlane;
         m_Context.NewScene();
         m_Context.SetCamera(data.Camera);
         m_Context.SetLightSources(data.LightSources);
@@ -201,8 +246,45 @@ namespace Forge
 
     void Renderer3D::RenderAll()
     {
-        for (const RenderData& data : m_Renderables)
-            RenderModelInternal(data);
+        CreateDrawQueue();
+        SortDrawQueue();
+        CreateDrawBatches();
+        m_CurrentMaterial = nullptr;
+        for (const DrawBatch& batch : m_DrawBatches)
+        {
+            const RenderData& data = m_Renderables[m_DrawQueue[batch.First].Index];
+            if (batch.InstanceCount > 0)
+                RenderInstancedInternal(data, batch.InstanceCount, m_InstanceBuffer->GetBaseVertex() + batch.BaseInstance);
+            else
+                RenderModelInternal(data);
+        }
+    }
+
+    void Renderer3D::UpdateJointPalettes()
+    {
+        for (RenderData& data : m_Renderables)
+        {
+            if (data.Mesh->IsAnimated())
+                data.JointPaletteOffset = GetJointPaletteOffset(data);
+        }
+        m_Context.UploadJointPalettes();
+    }
+
+    uint32_t Renderer3D::GetJointPaletteOffset(const RenderData& data)
+    {
+        const void* key = data.Options.JointTransforms ? (const void*)data.Options.JointTransforms : (const void*)data.Mesh.get();
+        auto it = m_JointPaletteOffsets.find(key);
+        if (it != m_JointPaletteOffsets.end())
+            return it->second;
+        uint32_t jointCount = uint32_t(((const AnimatedMesh&)*data.Mesh).GetJointCount());
+        uint32_t offset;
+        glm::mat4* palette = m_Context.AllocateJointPalette(jointCount, offset);
+        if (data.Options.JointTransforms)
+            std::copy(data.Options.JointTransforms, data.Options.JointTransforms + jointCount, palette);
+        else
+            std::fill(palette, palette + jointCount, glm::mat4(1.0f));
+        m_JointPaletteOffsets[key] = offset;
+        return offset;
     }
 
     void Renderer3D::RenderImGuiInternal()
@@ -216,44 +298,205 @@ namespace Forge
 
     void Renderer3D::RenderModelInternal(const RenderData& data)
     {
-        if (m_CurrentRenderPass == RenderPass::PointShadowFormation &&
-            !data.Options.ShadowMask.test(m_CurrentShadowLightIndex))
+        const Ref<Mesh>& mesh = data.Mesh;
+        const Ref<Shader>& shader = data.Material->GetShader(m_CurrentRenderPass);
+
+        const ShaderRequirements& requirements = BindMaterial(data.Material, shader);
+        if (requirements.ModelMatrix)
+            shader->SetUniform(requirements.ModelMatrixHandle, data.Transform);
+        if (m_CurrentRenderPass == RenderPass::Pick)
+            shader->SetUniform(requirements.EntityIdHandle, data.Options.EntityId);
+        if (requirements.Animation && mesh->IsAnimated())
+            m_Context.BindJointPalette(data.JointPaletteOffset);
+
+        RenderCommand::DrawIndexed(mesh->GetDrawMode(), mesh->GetVertices());
+        m_Context.NewDrawCall();
+        m_Stats.DrawCount++;
+    }
+
+    void Renderer3D::RenderInstancedInternal(const RenderData& data, uint32_t instanceCount, uint32_t baseInstance)
+    {
+        const Ref<Mesh>& mesh = data.Mesh;
+        const Ref<Shader>& shader = data.Material->GetInstancedShader(m_CurrentRenderPass);
+
+        BindMaterial(data.Material, shader);
+        mesh->GetVertices()->SetInstanceBuffer(INSTANCE_ATTRIBUTE_LOCATION, m_InstanceBuffer->GetVertexBuffer());
+
+        RenderCommand::DrawIndexedInstanced(mesh->GetDrawMode(), mesh->GetVertices(), instanceCount, baseInstance);
+        m_Context.NewDrawCall();
+        m_Stats.DrawCount++;
+        m_Stats.InstancedCount += instanceCount;
+    }
+
+    const ShaderRequirements& Renderer3D::BindMaterial(const Ref<Material>& material, const Ref<Shader>& shader)
+    {
+        if (m_CurrentRenderPass == RenderPass::PointShadowFormation ||
+            m_CurrentRenderPass == RenderPass::ShadowFormation)
+        {
+            RenderSettings settings = material->GetSettings();
+            if (settings.Culling != CullFace::None)
+                settings.Culling = CullFace::Front;
+            m_Stats.StateChangeCount += m_Context.ApplyRenderSettings(settings);
+        }
+        else
+            m_Stats.StateChangeCount += m_Context.ApplyRenderSettings(material->GetSettings());
+
+        const ShaderRequirements& requirements = m_Context.GetShaderRequirements(shader);
+        if (m_Context.BindShader(shader, requirements))
+        {
+            m_Stats.ShaderBindCount++;
+            m_CurrentMaterial = nullptr;
+        }
+        // Consecutive draws with the same material can reuse its uniforms and texture bindings
+        if (material.get() != m_CurrentMaterial)
+        {
+            material->Apply(m_CurrentRenderPass, shader, m_Context);
+            m_CurrentMaterial = material.get();
+        }
+        return requirements;
+    }
+
+    void Renderer3D::CreateDrawQueue()
+    {
+        m_DrawQueue.clear();
+        bool isShadowPass = m_CurrentRenderPass == RenderPass::PointShadowFormation ||
+                            m_CurrentRenderPass == RenderPass::ShadowFormation;
+        for (uint32_t i = 0; i < uint32_t(m_Renderables.size()); i++)
+        {
+            const RenderData& data = m_Renderables[i];
+            if (m_CurrentRenderPass == RenderPass::PointShadowFormation &&
+                !data.Options.ShadowMask.test(m_CurrentShadowLightIndex))
+                continue;
+            // Skip model if it does not cast shadows
+            if (isShadowPass && !data.Material->CastsShadows())
+                continue;
+            if (data.WorldBounds.IsValid() && !IsVisible(data.WorldBounds))
+            {
+                m_Stats.CulledCount++;
+                continue;
+            }
+            m_Stats.VisibleCount++;
+            m_DrawQueue.push_back({CreateSortKey(data, i), i});
+        }
+    }
+
+    void Renderer3D::SortDrawQueue()
+    {
+        // LSD radix sort over 8 bit digits, digits that are identical for every command are skipped
+        if (m_DrawQueue.size() < 2)
             return;
-        const Ref<Model>& model = data.Model;
-        const glm::mat4& transform = data.Transform;
-        for (const Model::SubModel& submodel : model->GetSubModels())
+        m_SortBuffer.resize(m_DrawQueue.size());
+        for (int shift = 0; shift < 64; shift += 8)
         {
-            const Ref<Mesh>& mesh = submodel.Mesh;
-            Ref<Material> material = submodel.Material;
-            glm::mat4 overallTransform = transform * submodel.Transform;
+            size_t offsets[256] = {};
+            for (const DrawCommand& command : m_DrawQueue)
+                offsets[(command.SortKey >> shift) & 0xFF]++;
+            if (offsets[(m_DrawQueue.front().SortKey >> shift) & 0xFF] == m_DrawQueue.size())
+                continue;
+            size_t total = 0;
+            for (size_t& offset : offsets)
+            {
+                size_t count = offset;
+                offset = total;
+                total += count;
+            }
+            for (const DrawCommand& command : m_DrawQueue)
+                m_SortBuffer[offsets[(command.SortKey >> shift) & 0xFF]++] = command;
+            std::swap(m_DrawQueue, m_SortBuffer);
+        }
+    }
 
-            if (m_CurrentRenderPass == RenderPass::PointShadowFormation ||
-                m_CurrentRenderPass == RenderPass::ShadowFormation)
+    void Renderer3D::CreateDrawBatches()
+    {
+        m_DrawBatches.clear();
+        m_InstanceData.clear();
+        size_t instanceCapacity = m_InstanceBuffer ? m_InstanceBuffer->GetCapacity() / sizeof(InstanceData)
+                                                   : std::numeric_limits<size_t>::max();
+        uint32_t first = 0;
+        while (first < uint32_t(m_DrawQueue.size()))
+        {
+            const RenderData& data = m_Renderables[m_DrawQueue[first].Index];
+            uint32_t end = first + 1;
+            while (end < uint32_t(m_DrawQueue.size()))
             {
-                // Skip model if it does not cast shadows
-                if (!material->CastsShadows())
-                    continue;
-                RenderSettings settings = submodel.Material->GetSettings();
-                if (settings.Culling != CullFace::None)
-                    settings.Culling = CullFace::Front;
-                m_Context.ApplyRenderSettings(settings);
+                const RenderData& next = m_Renderables[m_DrawQueue[end].Index];
+                if (next.Mesh != data.Mesh || next.Material != data.Material)
+                    break;
+                end++;
+            }
+
+            bool canInstance = !data.Mesh->IsAnimated() && data.Material->GetInstancedShader(m_CurrentRenderPass) &&
+                               end - first >= MinInstanceCount;
+            if (canInstance)
+            {
+                // Instances that do not fit in a region of the buffer are drawn one by one until Flush() grows it
+                m_FrameInstanceBytes += (end - first) * sizeof(InstanceData);
+                canInstance = m_InstanceData.size() + (end - first) <= instanceCapacity;
+            }
+            if (canInstance)
+            {
+                m_DrawBatches.push_back({first, end - first, uint32_t(m_InstanceData.size())});
+                for (uint32_t i = first; i < end; i++)
+                {
+                    const RenderData& instance = m_Renderables[m_DrawQueue[i].Index];
+                    m_InstanceData.push_back({instance.Transform, instance.Options.EntityId});
+                }
             }
             else
-                m_Context.ApplyRenderSettings(submodel.Material->GetSettings());
-
-            ShaderRequirements requirements = m_Context.GetShaderRequirements(material->GetShader(m_CurrentRenderPass));
-            m_Context.BindShader(material->GetShader(m_CurrentRenderPass), requirements);
-            if (requirements.ModelMatrix)
-                material->GetShader(m_CurrentRenderPass)->SetUniform(ModelMatrixUniformName, overallTransform);
-            if (m_CurrentRenderPass == RenderPass::Pick)
-                material->GetShader(m_CurrentRenderPass)->SetUniform(EntityIdUniformName, data.Options.EntityId);
-            material->Apply(m_CurrentRenderPass, m_Context);
-            mesh->Apply(material->GetShader(m_CurrentRenderPass), requirements);
-
-            RenderCommand::DrawIndexed(mesh->GetDrawMode(), mesh->GetVertices());
-            m_Context.NewDrawCall();
-            m_Stats.DrawCount++;
+            {
+                for (uint32_t i = first; i < end; i++)
+                    m_DrawBatches.push_back({i, 0, 0});
+            }
+            first = end;
         }
+
+        if (m_InstanceData.empty())
+            return;
+        // Every pass of the frame appends its instances to the region of the frame. A pass that does not fit moves on to the next
+        // region, which is safe since the earlier passes have already been drawn
+        size_t sizeBytes = m_InstanceData.size() * sizeof(InstanceData);
+        if (!m_InstanceBuffer)
+            m_InstanceBuffer = CreateInstanceBuffer(sizeBytes);
+        m_InstanceBuffer->SetData(m_InstanceData.data(), sizeBytes);
+    }
+
+    uint64_t Renderer3D::CreateSortKey(const RenderData& data, uint32_t index) const
+    {
+        // Opaque:      | pass (3) | 0 | shader (12) | material (16) | mesh (16) | depth (16) |
+        // Transparent: | pass (3) | 1 | submission index (60) |
+        // Opaque depth is sorted front to back. Transparent draws rely on blending with what is behind them,
+        // so they come after every opaque draw and keep the order they were submitted in
+        if (data.Material->GetSettings().Transparent)
+            return ((uint64_t(m_CurrentRenderPass) & 0x7) << 61) | (uint64_t(1) << 60) | index;
+        glm::vec3 center = data.WorldBounds.IsValid() ? data.WorldBounds.GetCenter() : glm::vec3(data.Transform[3]);
+        float depth;
+        if (m_CurrentRenderPass == RenderPass::PointShadowFormation)
+        {
+            const LightSource& light = m_CurrentScene.LightSources[m_CurrentShadowLightIndex];
+            depth = glm::length(center - light.Position) / light.ShadowFrustum.FarPlane;
+        }
+        else
+        {
+            float viewDepth = -(m_CurrentViewMatrix * glm::vec4(center, 1.0f)).z;
+            depth = (viewDepth - m_CurrentNearPlane) / (m_CurrentFarPlane - m_CurrentNearPlane);
+        }
+        uint64_t quantizedDepth = uint64_t(glm::clamp(depth, 0.0f, 1.0f) * 0xFFFF);
+        uint64_t shaderId = data.Material->GetShader(m_CurrentRenderPass)->GetId();
+        uint64_t materialId = data.Material->GetId();
+        uint64_t meshId = data.Mesh->GetVertices()->GetId();
+        return ((uint64_t(m_CurrentRenderPass) & 0x7) << 61) | ((shaderId & 0xFFF) << 48) |
+               ((materialId & 0xFFFF) << 32) | ((meshId & 0xFFFF) << 16) | quantizedDepth;
+    }
+
+    bool Renderer3D::IsVisible(const BoundingBox& worldBounds) const
+    {
+        if (m_CurrentRenderPass == RenderPass::PointShadowFormation)
+        {
+            // Point light shadows cover every direction out to the far plane of the shadow frustum
+            const LightSource& light = m_CurrentScene.LightSources[m_CurrentShadowLightIndex];
+            return IntersectsSphere(worldBounds, light.Position, light.ShadowFrustum.FarPlane);
+        }
+        return m_CullingFrustum.Intersects(worldBounds);
     }
 
     CameraData Renderer3D::CreateCameraFromLightSource(const glm::vec3& lightPosition, const glm::vec3& lightDirection,
@@ -261,11 +504,16 @@ namespace Forge
     {
         CameraData camera;
         camera.Viewport = {0, 0, renderTarget->GetWidth(), renderTarget->GetHeight()};
-        camera.ViewMatrix = glm::lookAt(lightPosition, lightPosition + lightDirection, {0.0f, 1.0f, 0.0f});
+        camera.ViewMatrix = GetLightViewMatrix(lightPosition, lightDirection);
         camera.Frustum = frustum;
         return camera;
     }
 
+    glm::mat4 Renderer3D::GetLightViewMatrix(const glm::vec3& lightPosition, const glm::vec3& lightDirection)
+    {
+        return glm::lookAt(lightPosition, lightPosition + lightDirection, {0.0f, 1.0f, 0.0f});
+    }
+
     void Renderer3D::GetCameraTransformsFromLightSource(
       const glm::vec3& lightPosition, float aspect, const Frustum& frustum, glm::mat4 transforms[6])
     {
@@ -1,5 +1,6 @@
 #pragma once
 #include "RendererContext.h"
+#include "DynamicVertexBuffer.h"
 #include "Model.h"
 #include "PostProcessor.h"
 
@@ -12,6 +13,14 @@ namespace Forge
     {
     public:
         int DrawCount = 0;
+        int VisibleCount = 0;
+        int CulledCount = 0;
+        int ShaderBindCount = 0;
+        int StateChangeCount = 0;
+        int InstancedCount = 0;
+        // Bytes written into dynamic vertex buffers and time spent waiting for the GPU to release them
+        size_t UploadBytes = 0;
+        float UploadStallMs = 0.0f;
     };
 
     struct FORGE_API RenderOptions
@@ -19,11 +28,16 @@ namespace Forge
     public:
         std::bitset<MAX_LIGHT_COUNT> ShadowMask;
         int EntityId;
+        // Skinning palette for animated meshes, indexed by joint id. Animated meshes are drawn in bind pose if null
+        const glm::mat4* JointTransforms = nullptr;
     };
 
     class FORGE_API Renderer3D
     {
     private:
+        // Runs of the same mesh and material shorter than this are drawn individually
+        static constexpr uint32_t MinInstanceCount = 2;
+
         struct SceneData
         {
             Ref<Framebuffer> RenderTarget;
@@ -32,12 +46,42 @@ namespace Forge
             bool UsePostProcessing = false;
         };
 
+        // A single submodel queued for rendering
         struct RenderData
         {
         public:
-            Ref<Forge::Model> Model;
+            Ref<Forge::Mesh> Mesh;
+            Ref<Forge::Material> Material;
             glm::mat4 Transform;
+            // Invalid for meshes that are never culled
+            BoundingBox WorldBounds;
             RenderOptions Options;
+            uint32_t JointPaletteOffset;
+        };
+
+        // Sorted per pass, Index refers into m_Renderables
+        struct DrawCommand
+        {
+        public:
+            uint64_t SortKey;
+            uint32_t Index;
+        };
+
+        // Consecutive draw commands, InstanceCount == 0 draws the single command at First without instancing
+        struct DrawBatch
+        {
+        public:
+            uint32_t First;
+            uint32_t InstanceCount;
+            uint32_t BaseInstance;
+        };
+
+        // Matches the per instance attributes in Instancing.shader
+        struct InstanceData
+        {
+        public:
+            glm::mat4 ModelMatrix;
+            int EntityId;
         };
 
         struct ShadowPass
@@ -53,9 +97,23 @@ namespace Forge
         SceneData m_CurrentScene;
         std::vector<ShadowPass> m_ShadowPasses;
         std::vector<RenderData> m_Renderables;
+        std::vector<DrawCommand> m_DrawQueue;
+        std::vector<DrawCommand> m_SortBuffer;
+        std::vector<DrawBatch> m_DrawBatches;
+        std::vector<InstanceData> m_InstanceData;
+        Ref<DynamicVertexBuffer> m_InstanceBuffer;
+        // Instance data requested by the passes of this frame, including the batches that did not fit in the buffer
+        size_t m_FrameInstanceBytes;
         bool m_RenderImGui;
         RenderPass m_CurrentRenderPass;
         int m_CurrentShadowLightIndex;
+        FrustumPlanes m_CullingFrustum;
+        glm::mat4 m_CurrentViewMatrix;
+        float m_CurrentNearPlane;
+        float m_CurrentFarPlane;
+        const Material* m_CurrentMaterial;
+        // Offset of each joint palette, keyed by RenderOptions::JointTransforms or the mesh for bind pose palettes
+        std::unordered_map<const void*, uint32_t> m_JointPaletteOffsets;
 
         RendererContext m_Context;
         Ref<Framebuffer> m_CurrentFramebuffer = nullptr;
@@ -93,13 +151,26 @@ namespace Forge
             m_RenderImGui = true;
         }
 
+    public:
+        // View matrix used to render the shadow map of a directional or spot light
+        static glm::mat4 GetLightViewMatrix(const glm::vec3& lightPosition, const glm::vec3& lightDirection);
+
     private:
         void AddShadowPass(const Ref<Framebuffer>& framebuffer, const LightSource& light, int index);
         void RenderShadowScene(const ShadowPass& pass);
         void SetupScene(const SceneData& data);
         void RenderAll();
+        void UpdateJointPalettes();
+        uint32_t GetJointPaletteOffset(const RenderData& data);
         void RenderImGuiInternal();
         void RenderModelInternal(const RenderData& data);
+        void RenderInstancedInternal(const RenderData& data, uint32_t instanceCount, uint32_t baseInstance);
+        const ShaderRequirements& BindMaterial(const Ref<Material>& material, const Ref<Shader>& shader);
+        bool IsVisible(const BoundingBox& worldBounds) const;
+        void CreateDrawQueue();
+        void SortDrawQueue();
+        void CreateDrawBatches();
+        uint64_t CreateSortKey(const RenderData& data, uint32_t index) const;
 
         CameraData CreateCameraFromLightSource(const glm::vec3& lightPosition, const glm::vec3& lightDirection,
           const Ref<Framebuffer>& renderTarget, const Frustum& frustum) const;
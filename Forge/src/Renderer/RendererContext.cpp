@@ -6,12 +6,20 @@ namespace Forge
 {
 
 	RendererContext::RendererContext()
-		: m_NextTextureSlot(FirstTextureSlot), m_NextSceneTextureSlot(FirstTextureSlot), m_CullingEnabled(false), m_RenderSettings(), m_RequirementsMap(), m_BoundSlots{ false, false }
+		: m_NextTextureSlot(FirstTextureSlot), m_NextSceneTextureSlot(FirstTextureSlot), m_CullingEnabled(false), m_RenderSettings(), m_RequirementsMap(), m_BoundSlots{ false, false },
+		m_JointTransformsUniformBuffer(nullptr), m_JointTransforms(), m_JointTransformsCapacity(0), m_UploadedJointTransforms(0), m_JointTransformsAlignment(1), m_MaxUniformBlockSize(0)
 	{
 		m_CameraUniformBuffer = UniformBuffer::Create(sizeof(UniformCameraData), CameraDataBindingPoint);
 		m_ShadowFormationUniformBuffer = UniformBuffer::Create(sizeof(UniformShadowFormationData), ShadowFormationDataBindingPoint);
 		m_ClippingPlaneUniformBuffer = UniformBuffer::Create(sizeof(UniformClippingPlaneData), ClippingPlaneDataBindingPoint);
 		m_LightingUniformBuffer = UniformBuffer::Create(sizeof(UniformLightingData), LightingDataBindingPoint);
+
+		GLint offsetAlignment;
+		GLint maxBlockSize;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+		glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+		m_JointTransformsAlignment = std::max(uint32_t(offsetAlignment) / uint32_t(sizeof(glm::mat4)), 1U);
+		m_MaxUniformBlockSize = uint32_t(maxBlockSize);
 	}
 
 	void RendererContext::SetCamera(const CameraData& camera)
@@ -84,6 +92,43 @@ namespace Forge
 		m_ShadowFormationUniformBuffer->SetData(&data, sizeof(UniformShadowFormationData));
 	}
 
+	glm::mat4* RendererContext::AllocateJointPalette(uint32_t jointCount, uint32_t& offset)
+	{
+		offset = uint32_t(m_JointTransforms.size());
+		uint32_t alignedCount = (jointCount + m_JointTransformsAlignment - 1) / m_JointTransformsAlignment * m_JointTransformsAlignment;
+		m_JointTransforms.resize(offset + alignedCount);
+		return m_JointTransforms.data() + offset;
+	}
+
+	void RendererContext::UploadJointPalettes()
+	{
+		uint32_t count = uint32_t(m_JointTransforms.size());
+		if (count == m_UploadedJointTransforms)
+			return;
+		if (count > m_JointTransformsCapacity)
+		{
+			// Every bound range is a full block, so keep one maximum sized block of slack after the last palette
+			m_JointTransformsCapacity = std::max(count, m_JointTransformsCapacity * 2);
+			uint32_t size = m_JointTransformsCapacity * sizeof(glm::mat4) + m_MaxUniformBlockSize;
+			m_JointTransformsUniformBuffer = UniformBuffer::Create(size, JointTransformsBindingPoint);
+			m_UploadedJointTransforms = 0;
+		}
+		m_JointTransformsUniformBuffer->SetData(m_JointTransforms.data() + m_UploadedJointTransforms, (count - m_UploadedJointTransforms) * sizeof(glm::mat4), m_UploadedJointTransforms * sizeof(glm::mat4));
+		m_UploadedJointTransforms = count;
+	}
+
+	void RendererContext::BindJointPalette(uint32_t offset)
+	{
+		FORGE_ASSERT(offset < m_UploadedJointTransforms, "Joint palette has not been uploaded");
+		m_JointTransformsUniformBuffer->BindRange(JointTransformsBindingPoint, offset * sizeof(glm::mat4), m_MaxUniformBlockSize);
+	}
+
+	void RendererContext::ResetJointPalettes()
+	{
+		m_JointTransforms.clear();
+		m_UploadedJointTransforms = 0;
+	}
+
 	void RendererContext::NewScene()
 	{
 		m_CurrentShader = nullptr;
@@ -102,26 +147,36 @@ namespace Forge
 		m_BoundSlots[0] = m_BoundSlots[1] = false;
 	}
 
-	ShaderRequirements RendererContext::GetShaderRequirements(const Ref<Shader>& shader)
+	const ShaderRequirements& RendererContext::GetShaderRequirements(const Ref<Shader>& shader)
 	{
-		auto it = m_RequirementsMap.find(shader.get());
+		auto it = m_RequirementsMap.find(shader->GetUniqueId());
 		if (it != m_RequirementsMap.end())
 			return it->second;
 		ShaderRequirements requirements;
-		requirements.ModelMatrix = shader->UniformExists(ModelMatrixUniformName);
-		requirements.LightSourceShadowMaps = shader->UniformExists(LightSourceShadowMapArrayUniformName);
-		requirements.Animation = shader->UniformExists(JointTransformsUniformName);
-		requirements.Time = shader->UniformExists(TimeUniformName);
-		m_RequirementsMap[shader.get()] = requirements;
-		return requirements;
+		requirements.ModelMatrixHandle = shader->GetUniformHandle(ModelMatrixUniformName);
+		requirements.EntityIdHandle = shader->GetUniformHandle(EntityIdUniformName);
+		requirements.TimeHandle = shader->GetUniformHandle(TimeUniformName);
+		for (int i = 0; i < MAX_LIGHT_COUNT; i++)
+		{
+			std::string uniformBase = std::string(LightSourceShadowMapArrayBase) + '[' + std::to_string(i) + ']';
+			requirements.ShadowMapHandles[i] = shader->GetUniformHandle(uniformBase + ".ShadowMap");
+			requirements.PointShadowMapHandles[i] = shader->GetUniformHandle(uniformBase + ".PointShadowMap");
+		}
+		requirements.ModelMatrix = requirements.ModelMatrixHandle.IsValid();
+		requirements.LightSourceShadowMaps = requirements.ShadowMapHandles[0].IsValid();
+		requirements.Animation = shader->UniformBlockExists(JointTransformsBlockName);
+		requirements.Time = requirements.TimeHandle.IsValid();
+		return m_RequirementsMap[shader->GetUniqueId()] = requirements;
 	}
 
-	void RendererContext::ApplyRenderSettings(const RenderSettings& settings)
+	int RendererContext::ApplyRenderSettings(const RenderSettings& settings)
 	{
+		int stateChanges = 0;
 		if (settings.Mode != m_RenderSettings.Mode)
 		{
 			glPolygonMode(GL_FRONT_AND_BACK, (GLenum)settings.Mode);
 			m_RenderSettings.Mode = settings.Mode;
+			stateChanges++;
 		}
 		if ((settings.Culling != m_RenderSettings.Culling && settings.Culling != CullFace::None) || (settings.Culling != CullFace::None && !m_CullingEnabled))
 		{
@@ -129,18 +184,22 @@ namespace Forge
 			{
 				RenderCommand::EnableCullFace(true);
 				m_CullingEnabled = true;
+				stateChanges++;
 			}
 			RenderCommand::SetCullFace(settings.Culling);
 			m_RenderSettings.Culling = settings.Culling;
+			stateChanges++;
 		}
 		else if (settings.Culling == CullFace::None && m_CullingEnabled)
 		{
 			RenderCommand::EnableCullFace(false);
 			m_CullingEnabled = false;
+			stateChanges++;
 		}
+		return stateChanges;
 	}
 
-	void RendererContext::BindShader(const Ref<Shader>& shader, const ShaderRequirements& requirements)
+	bool RendererContext::BindShader(const Ref<Shader>& shader, const ShaderRequirements& requirements)
 	{
 		if (m_CurrentShader != shader)
 		{
@@ -150,22 +209,23 @@ namespace Forge
 			{
 				for (size_t i = 0; i < m_LightSourceShadowBindings.size(); i++)
 				{
-					std::string uniformBase = std::string(LightSourceShadowMapArrayBase) + '[' + std::to_string(i) + ']';
 					if (m_LightSourceShadowBindings[i].Type == GL_TEXTURE_CUBE_MAP)
 					{
-						shader->SetUniform(uniformBase + ".PointShadowMap", m_LightSourceShadowBindings[i].Location);
-						shader->SetUniform(uniformBase + ".ShadowMap", BindTexture(nullptr, GL_TEXTURE_2D));
+						shader->SetUniform(requirements.PointShadowMapHandles[i], m_LightSourceShadowBindings[i].Location);
+						shader->SetUniform(requirements.ShadowMapHandles[i], BindTexture(nullptr, GL_TEXTURE_2D));
 					}
 					else
 					{
-						shader->SetUniform(uniformBase + ".ShadowMap", m_LightSourceShadowBindings[i].Location);
-						shader->SetUniform(uniformBase + ".PointShadowMap", BindTexture(nullptr, GL_TEXTURE_CUBE_MAP));
+						shader->SetUniform(requirements.ShadowMapHandles[i], m_LightSourceShadowBindings[i].Location);
+						shader->SetUniform(requirements.PointShadowMapHandles[i], BindTexture(nullptr, GL_TEXTURE_CUBE_MAP));
 					}
 				}
 			}
 			if (requirements.Time)
-				shader->SetUniform(TimeUniformName, m_Time);
+				shader->SetUniform(requirements.TimeHandle, m_Time);
+			return true;
 		}
+		return false;
 	}
 
 	int RendererContext::BindTexture(const Ref<Texture>& texture, GLenum textureTarget, bool sceneWideTexture)
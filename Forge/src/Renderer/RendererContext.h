@@ -14,6 +14,7 @@ namespace Forge
 	constexpr uint32_t ShadowFormationDataBindingPoint = 1;
 	constexpr uint32_t ClippingPlaneDataBindingPoint = 2;
 	constexpr uint32_t LightingDataBindingPoint = 3;
+	constexpr uint32_t JointTransformsBindingPoint = 4;
 
 	struct FORGE_API UniformCameraData
 	{
@@ -68,8 +69,7 @@ namespace Forge
 	constexpr const char LightSourceShadowMapArrayBase[] = "frg_LightShadowMaps";
 	constexpr const char LightSourceShadowMapArrayUniformName[] = "frg_LightShadowMaps[0].ShadowMap";
 
-	constexpr const char JointTransformsBase[] = "frg_JointTransforms";
-	constexpr const char JointTransformsUniformName[] = "frg_JointTransforms[0]";
+	constexpr const char JointTransformsBlockName[] = "JointTransforms";
 
 	constexpr const char TimeUniformName[] = "frg_Time";
 	constexpr const char EntityIdUniformName[] = "frg_EntityID";
@@ -83,6 +83,13 @@ namespace Forge
 		bool Animation;
 
 		bool Time;
+
+		// Automatic uniforms resolved once per shader
+		UniformHandle ModelMatrixHandle;
+		UniformHandle EntityIdHandle;
+		UniformHandle TimeHandle;
+		UniformHandle ShadowMapHandles[MAX_LIGHT_COUNT];
+		UniformHandle PointShadowMapHandles[MAX_LIGHT_COUNT];
 	};
 
 	class FORGE_API RendererContext
@@ -113,10 +120,19 @@ namespace Forge
 		float m_Time;
 		std::vector<LightShadowBinding> m_LightSourceShadowBindings;
 
+		// Joint palettes of every animated mesh drawn this frame, packed at uniform buffer offset alignment
+		Ref<UniformBuffer> m_JointTransformsUniformBuffer;
+		std::vector<glm::mat4> m_JointTransforms;
+		uint32_t m_JointTransformsCapacity;
+		uint32_t m_UploadedJointTransforms;
+		uint32_t m_JointTransformsAlignment;
+		uint32_t m_MaxUniformBlockSize;
+
 		bool m_CullingEnabled;
 		RenderSettings m_RenderSettings;
 
-		std::unordered_map<const Shader*, ShaderRequirements> m_RequirementsMap;
+		// Keyed by Shader::GetUniqueId()
+		std::unordered_map<uint32_t, ShaderRequirements> m_RequirementsMap;
 		Ref<Shader> m_CurrentShader;
 
 	public:
@@ -124,18 +140,27 @@ namespace Forge
 
 		inline int GetAvailableTextureSlots() const { return MaxTextureSlots - m_NextTextureSlot; }
 
-		void ApplyRenderSettings(const RenderSettings& settings);
+		// Returns the number of pipeline state changes made
+		int ApplyRenderSettings(const RenderSettings& settings);
 		void SetCamera(const CameraData& camera);
 		void SetLightSources(const std::vector<LightSource>& lights);
 		void SetClippingPlanes(const std::vector<glm::vec4>& planes);
 		void SetTime(float time);
 		void SetShadowPointMatrices(const glm::vec3& lightPosition, const glm::mat4 matrices[6]);
+
+		// Returns space for jointCount matrices, offset receives the value to pass to BindJointPalette
+		glm::mat4* AllocateJointPalette(uint32_t jointCount, uint32_t& offset);
+		// Uploads palettes allocated since the last upload
+		void UploadJointPalettes();
+		void BindJointPalette(uint32_t offset);
+		void ResetJointPalettes();
 		void NewScene();
 		void NewDrawCall();
 		void Reset();
 
-		ShaderRequirements GetShaderRequirements(const Ref<Shader>& shader);
-		void BindShader(const Ref<Shader>& shader, const ShaderRequirements& requirements);
+		const ShaderRequirements& GetShaderRequirements(const Ref<Shader>& shader);
+		// Returns true if the shader was not already bound
+		bool BindShader(const Ref<Shader>& shader, const ShaderRequirements& requirements);
 		int BindTexture(const Ref<Texture>& texture, GLenum textureTarget, bool sceneWideTexture = false);
 	};
 
@@ -89,6 +89,8 @@ namespace Forge
                 return ShaderDataType::Sampler1D;
             case GL_SAMPLER_2D:
                 return ShaderDataType::Sampler2D;
+            case GL_SAMPLER_2D_ARRAY:
+                return ShaderDataType::Sampler2DArray;
             case GL_SAMPLER_3D:
                 return ShaderDataType::Sampler3D;
             case GL_SAMPLER_CUBE:
@@ -155,8 +157,10 @@ namespace Forge
         }
     }
 
+    uint32_t Shader::s_NextUniqueId = 0;
+
     Shader::Shader(const std::string& vertexSource, const std::string& geometrySource, const std::string& fragmentSource, const ShaderDefines& defines)
-        : m_Handle(), m_UniformLocations(), m_UniformDescriptors()
+        : m_Handle(), m_UniqueId(s_NextUniqueId++), m_UniformLocations(), m_UniformDescriptors()
     {
         std::unordered_map<std::string, std::string> nameMap;
         Init(PreprocessShaderSource(vertexSource, defines, nameMap), PreprocessShaderSource(geometrySource, defines, nameMap), PreprocessShaderSource(fragmentSource, defines, nameMap), defines);
@@ -175,52 +179,112 @@ namespace Forge
 
     void Shader::SetUniform(const std::string& name, bool value)
     {
-        glUniform1i(GetUniformLocation(name), value);
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, int value)
     {
-        glUniform1i(GetUniformLocation(name), value);
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, float value)
     {
-        glUniform1f(GetUniformLocation(name), value);
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const glm::vec2& value)
     {
-        glUniform2f(GetUniformLocation(name), value.x, value.y);
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const glm::vec3& value)
     {
-        glUniform3f(GetUniformLocation(name), value.x, value.y, value.z);
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const glm::vec4& value)
     {
-        glUniform4f(GetUniformLocation(name), value.x, value.y, value.z, value.w);
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const Color& value)
     {
-        glUniform4f(GetUniformLocation(name), float(value.r), float(value.g), float(value.b), float(value.a));
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const glm::mat2& value)
     {
-        glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const glm::mat3& value)
     {
-        glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
     }
 
     void Shader::SetUniform(const std::string& name, const glm::mat4& value)
     {
-        glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+        SetUniform(UniformHandle { GetUniformLocation(name) }, value);
+    }
+
+    UniformHandle Shader::GetUniformHandle(const std::string& name) const
+    {
+        return UniformHandle { glGetUniformLocation(m_Handle.Id, name.c_str()) };
+    }
+
+    void Shader::SetUniform(UniformHandle handle, bool value)
+    {
+        glUniform1i(handle.Location, value);
+    }
+
+    void Shader::SetUniform(UniformHandle handle, int value)
+    {
+        glUniform1i(handle.Location, value);
+    }
+
+    void Shader::SetUniform(UniformHandle handle, float value)
+    {
+        glUniform1f(handle.Location, value);
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const glm::vec2& value)
+    {
+        glUniform2f(handle.Location, value.x, value.y);
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const glm::vec3& value)
+    {
+        glUniform3f(handle.Location, value.x, value.y, value.z);
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const glm::vec4& value)
+    {
+        glUniform4f(handle.Location, value.x, value.y, value.z, value.w);
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const Color& value)
+    {
+        glUniform4f(handle.Location, float(value.r), float(value.g), float(value.b), float(value.a));
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const glm::mat2& value)
+    {
+        glUniformMatrix2fv(handle.Location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const glm::mat3& value)
+    {
+        glUniformMatrix3fv(handle.Location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    void Shader::SetUniform(UniformHandle handle, const glm::mat4& value)
+    {
+        glUniformMatrix4fv(handle.Location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    void Shader::SetUniformArray(UniformHandle handle, const glm::mat4* values, int count)
+    {
+        glUniformMatrix4fv(handle.Location, count, GL_FALSE, glm::value_ptr(values[0]));
     }
 
     bool Shader::UniformExists(const std::string& name) const
@@ -228,6 +292,11 @@ namespace Forge
         return glGetUniformLocation(m_Handle.Id, name.c_str()) >= 0;
     }
 
+    bool Shader::UniformBlockExists(const std::string& name) const
+    {
+        return glGetUniformBlockIndex(m_Handle.Id, name.c_str()) != GL_INVALID_INDEX;
+    }
+
     Ref<Shader> Shader::CreateFromSource(const std::string& vertexSource, const std::string& fragmentSource, const ShaderDefines& defines)
     {
         return CreateFromSource(vertexSource, "", fragmentSource, defines);
@@ -48,18 +48,34 @@ namespace Forge
 		bool Automatic;
 	};
 
+	// Pre-resolved uniform location, setting a value through an invalid handle does nothing
+	struct FORGE_API UniformHandle
+	{
+	public:
+		int Location = -1;
+
+	public:
+		inline bool IsValid() const { return Location >= 0; }
+	};
+
 	class FORGE_API Shader
 	{
 	private:
 		using Handle = Detail::ScopedId<Detail::ShaderDestructor>;
 
+		static uint32_t s_NextUniqueId;
+
 		Handle m_Handle;
+		uint32_t m_UniqueId;
 		std::unordered_map<std::string, int> m_UniformLocations;
 		std::vector<UniformDescriptor> m_UniformDescriptors;
 
 	public:
 		Shader(const std::string& vertexSource, const std::string& geometrySource, const std::string& fragmentSource, const ShaderDefines& defines = {});
 
+		inline uint32_t GetId() const { return m_Handle.Id; }
+		// Never reused, unlike the GL id and the address of the shader, so it can key caches that outlive the shader
+		inline uint32_t GetUniqueId() const { return m_UniqueId; }
 		inline const std::vector<UniformDescriptor>& GetUniformDescriptors() const { return m_UniformDescriptors; }
 
 		void Bind() const;
@@ -76,7 +92,21 @@ namespace Forge
 		void SetUniform(const std::string& name, const glm::mat3& value);
 		void SetUniform(const std::string& name, const glm::mat4& value);
 
+		UniformHandle GetUniformHandle(const std::string& name) const;
+		void SetUniform(UniformHandle handle, bool value);
+		void SetUniform(UniformHandle handle, int value);
+		void SetUniform(UniformHandle handle, float value);
+		void SetUniform(UniformHandle handle, const glm::vec2& value);
+		void SetUniform(UniformHandle handle, const glm::vec3& value);
+		void SetUniform(UniformHandle handle, const glm::vec4& value);
+		void SetUniform(UniformHandle handle, const Color& value);
+		void SetUniform(UniformHandle handle, const glm::mat2& value);
+		void SetUniform(UniformHandle handle, const glm::mat3& value);
+		void SetUniform(UniformHandle handle, const glm::mat4& value);
+		void SetUniformArray(UniformHandle handle, const glm::mat4* values, int count);
+
 		bool UniformExists(const std::string& name) const;
+		bool UniformBlockExists(const std::string& name) const;
 
 	public:
 		static Ref<Shader> CreateFromSource(const std::string& vertexSource, const std::string& fragmentSource, const ShaderDefines& defines = {});
@@ -33,6 +33,12 @@ namespace Forge
 
             "const int MAX_CLIPPING_PLANES = " + std::to_string(MAX_CLIPPING_PLANES) + ";\n"
 #include "Shaders/Clipping.h"
+        },
+        {
+            "Instancing.h",
+
+            "#define INSTANCE_ATTRIBUTE_LOCATION " + std::to_string(INSTANCE_ATTRIBUTE_LOCATION) + "\n"
+#include "Shaders/Instancing.h"
         },
         {
             "PBRUtils.h",
@@ -5,6 +5,8 @@ namespace Forge
 {
 	
 	constexpr int MAX_CLIPPING_PLANES = 8;
+	// First of the 5 attribute locations used by per instance data (4 for the model matrix, 1 for the entity id)
+	constexpr int INSTANCE_ATTRIBUTE_LOCATION = 6;
 
 	class FORGE_API ShaderLibrary
 	{
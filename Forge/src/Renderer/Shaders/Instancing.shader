@@ -0,0 +1,7 @@
+#ifdef INSTANCED
+layout (location = INSTANCE_ATTRIBUTE_LOCATION) in mat4 frg_InstanceModelMatrix;
+layout (location = INSTANCE_ATTRIBUTE_LOCATION + 4) in int frg_InstanceEntityID;
+#define frg_ModelMatrix frg_InstanceModelMatrix
+#else
+uniform mat4 frg_ModelMatrix;
+#endif
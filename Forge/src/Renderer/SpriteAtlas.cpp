@@ -0,0 +1,114 @@
+#include "ForgePch.h"
+#include "SpriteAtlas.h"
+
+namespace Forge
+{
+
+	SpriteAtlas::SpriteAtlas(uint32_t pageSize, uint32_t maxPageCount)
+		: m_Texture(), m_PageSize(pageSize), m_MaxPageCount(maxPageCount), m_Pages(), m_Entries(), m_PackedCount(0)
+	{
+		GLint maxLayers = 0;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+		if (maxLayers > 0)
+			m_MaxPageCount = std::min(m_MaxPageCount, uint32_t(maxLayers));
+	}
+
+	bool SpriteAtlas::CanPack(const Texture2D& texture) const
+	{
+		return texture.IsStatic() && texture.GetInternalFormat() == InternalTextureFormat::RGBA &&
+			texture.GetMinFilter() == TextureFilter::Linear && texture.GetMagFilter() == TextureFilter::Linear &&
+			texture.GetWidth() <= MaxTextureSize && texture.GetHeight() <= MaxTextureSize;
+	}
+
+	bool SpriteAtlas::GetRegion(const Ref<Texture2D>& texture, AtlasRegion& region)
+	{
+		auto it = m_Entries.find(texture.get());
+		// Expired entries belong to a destroyed texture whose address has been reused, its space is not reclaimed
+		if (it == m_Entries.end() || it->second.Source.lock() != texture)
+		{
+			Entry entry;
+			entry.Source = texture;
+			if (CanPack(*texture) && Pack(*texture, entry.Region))
+				m_PackedCount++;
+			it = m_Entries.insert_or_assign(texture.get(), entry).first;
+		}
+		region = it->second.Region;
+		return region.Layer >= 0;
+	}
+
+	bool SpriteAtlas::Pack(const Texture2D& texture, AtlasRegion& region)
+	{
+		uint32_t width = texture.GetWidth();
+		uint32_t height = texture.GetHeight();
+		uint32_t x = 0;
+		uint32_t y = 0;
+		int layer = -1;
+		for (size_t i = 0; i < m_Pages.size() && layer < 0; i++)
+		{
+			if (Allocate(m_Pages[i], width + 2 * Padding, height + 2 * Padding, x, y))
+				layer = int(i);
+		}
+		if (layer < 0)
+		{
+			if (m_Pages.size() >= m_MaxPageCount)
+				return false;
+			AddPage();
+			layer = int(m_Pages.size() - 1);
+			Allocate(m_Pages.back(), width + 2 * Padding, height + 2 * Padding, x, y);
+		}
+		x += Padding;
+		y += Padding;
+
+		GLuint source = texture.GetId();
+		GLuint atlas = m_Texture->GetId();
+		glCopyImageSubData(source, GL_TEXTURE_2D, 0, 0, 0, 0, atlas, GL_TEXTURE_2D_ARRAY, 0, x, y, layer, width, height, 1);
+		glCopyImageSubData(source, GL_TEXTURE_2D, 0, 0, 0, 0, atlas, GL_TEXTURE_2D_ARRAY, 0, x - 1, y, layer, 1, height, 1);
+		glCopyImageSubData(source, GL_TEXTURE_2D, 0, width - 1, 0, 0, atlas, GL_TEXTURE_2D_ARRAY, 0, x + width, y, layer, 1, height, 1);
+		// The rows above and below are copied from the atlas to include the corners
+		glCopyImageSubData(atlas, GL_TEXTURE_2D_ARRAY, 0, x - 1, y, layer, atlas, GL_TEXTURE_2D_ARRAY, 0, x - 1, y - 1, layer, width + 2, 1, 1);
+		glCopyImageSubData(atlas, GL_TEXTURE_2D_ARRAY, 0, x - 1, y + height - 1, layer, atlas, GL_TEXTURE_2D_ARRAY, 0, x - 1, y + height, layer, width + 2, 1, 1);
+
+		region.Layer = layer;
+		region.Min = glm::vec2{ float(x), float(y) } / float(m_PageSize);
+		region.Max = glm::vec2{ float(x + width), float(y + height) } / float(m_PageSize);
+		return true;
+	}
+
+	bool SpriteAtlas::Allocate(Page& page, uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) const
+	{
+		// Lowest shelf that the texture fits in, otherwise a new shelf as tall as the texture
+		Shelf* best = nullptr;
+		for (Shelf& shelf : page.Shelves)
+		{
+			if (shelf.Height >= height && shelf.UsedWidth + width <= m_PageSize && (!best || shelf.Height < best->Height))
+				best = &shelf;
+		}
+		if (!best)
+		{
+			if (page.UsedHeight + height > m_PageSize || width > m_PageSize)
+				return false;
+			page.Shelves.push_back({ page.UsedHeight, height, 0 });
+			page.UsedHeight += height;
+			best = &page.Shelves.back();
+		}
+		x = best->UsedWidth;
+		y = best->Y;
+		best->UsedWidth += width;
+		return true;
+	}
+
+	void SpriteAtlas::AddPage()
+	{
+		m_Pages.emplace_back();
+		uint32_t pageCount = uint32_t(m_Pages.size());
+		if (m_Texture && pageCount <= m_Texture->GetLayerCount())
+			return;
+		// Layers are doubled so that the pages are copied into a new texture only a few times
+		uint32_t layerCount = m_Texture ? std::min(m_Texture->GetLayerCount() * 2, m_MaxPageCount) : 1;
+		Ref<Texture2DArray> texture = Texture2DArray::Create(m_PageSize, m_PageSize, layerCount);
+		if (m_Texture)
+			glCopyImageSubData(m_Texture->GetId(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, texture->GetId(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, m_PageSize, m_PageSize, m_Texture->GetLayerCount());
+		m_Texture = texture;
+	}
+
+}
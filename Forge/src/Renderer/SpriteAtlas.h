@@ -0,0 +1,83 @@
+#pragma once
+#include "Texture.h"
+
+#include <glm/glm.hpp>
+#include <unordered_map>
+
+namespace Forge
+{
+
+	// Area of a texture in the atlas, Layer is negative for textures that are not in the atlas
+	struct FORGE_API AtlasRegion
+	{
+	public:
+		int Layer = -1;
+		glm::vec2 Min = { 0.0f, 0.0f };
+		glm::vec2 Max = { 1.0f, 1.0f };
+	};
+
+	// Copies small static textures into the layers of a texture array so that sprites using any of them can be drawn together.
+	// Each layer is a page that textures are packed into in shelves, pages are added as they fill up. Textures keep their place
+	// for as long as they are alive
+	class FORGE_API SpriteAtlas
+	{
+	public:
+		static constexpr uint32_t DefaultPageSize = 2048;
+		static constexpr uint32_t DefaultMaxPageCount = 8;
+		// Largest width or height of a texture that is packed
+		static constexpr uint32_t MaxTextureSize = 256;
+		// Edge pixels are repeated around each texture so that linear filtering never reads the neighbouring texture
+		static constexpr uint32_t Padding = 1;
+
+	private:
+		struct Shelf
+		{
+		public:
+			uint32_t Y;
+			uint32_t Height;
+			uint32_t UsedWidth;
+		};
+
+		struct Page
+		{
+		public:
+			std::vector<Shelf> Shelves;
+			uint32_t UsedHeight = 0;
+		};
+
+		struct Entry
+		{
+		public:
+			std::weak_ptr<Texture2D> Source;
+			AtlasRegion Region;
+		};
+
+	private:
+		Ref<Texture2DArray> m_Texture;
+		uint32_t m_PageSize;
+		uint32_t m_MaxPageCount;
+		std::vector<Page> m_Pages;
+		std::unordered_map<const Texture2D*, Entry> m_Entries;
+		uint32_t m_PackedCount;
+
+	public:
+		SpriteAtlas(uint32_t pageSize = DefaultPageSize, uint32_t maxPageCount = DefaultMaxPageCount);
+
+		// nullptr until the first texture is packed, the texture is replaced when more pages are needed
+		inline const Ref<Texture2DArray>& GetTexture() const { return m_Texture; }
+		inline uint32_t GetPageCount() const { return uint32_t(m_Pages.size()); }
+		inline uint32_t GetPackedCount() const { return m_PackedCount; }
+
+		// Whether the texture can be packed at all: static, RGBA, linearly filtered and no larger than MaxTextureSize
+		bool CanPack(const Texture2D& texture) const;
+		// Region of the texture, which is copied into the atlas the first time it is seen. Returns false if the texture cannot be
+		// packed or the atlas is full, the texture must then be bound on its own
+		bool GetRegion(const Ref<Texture2D>& texture, AtlasRegion& region);
+
+	private:
+		bool Pack(const Texture2D& texture, AtlasRegion& region);
+		bool Allocate(Page& page, uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) const;
+		void AddPage();
+	};
+
+}
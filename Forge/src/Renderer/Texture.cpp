@@ -65,7 +65,8 @@ namespace Forge
 		return m_InternalFormat == InternalTextureFormat::DEPTH || m_InternalFormat == InternalTextureFormat::RGBA16F ? GL_FLOAT : GL_UNSIGNED_BYTE;
 	}
 
-	Texture2D::Texture2D(uint32_t width, uint32_t height, TextureFormat format, InternalTextureFormat internalFormat) : Texture(GL_TEXTURE_2D, width, height, format, internalFormat)
+	Texture2D::Texture2D(uint32_t width, uint32_t height, TextureFormat format, InternalTextureFormat internalFormat) : Texture(GL_TEXTURE_2D, width, height, format, internalFormat),
+		m_IsStatic(false)
 	{
 	}
 
@@ -88,6 +89,7 @@ namespace Forge
 		{
 			Ref<Texture2D> texture = CreateRef<Texture2D>(uint32_t(width), uint32_t(height), TextureFormat::RGBA);
 			texture->Init(pixels);
+			texture->m_IsStatic = true;
 			return texture;
 		}
 		return nullptr;
@@ -97,6 +99,7 @@ namespace Forge
 	{
 		Ref<Texture2D> texture = CreateRef<Texture2D>(width, height, format, internalFormat);
 		texture->Init((const void*)pixels);
+		texture->m_IsStatic = pixels != nullptr;
 		return texture;
 	}
 
@@ -110,6 +113,28 @@ namespace Forge
 		SetWrapMode(TextureWrap::Repeat);
 	}
 
+	Texture2DArray::Texture2DArray(uint32_t width, uint32_t height, uint32_t layerCount, TextureFormat format, InternalTextureFormat internalFormat) : Texture(GL_TEXTURE_2D_ARRAY, width, height, format, internalFormat),
+		m_LayerCount(layerCount)
+	{
+	}
+
+	Ref<Texture2DArray> Texture2DArray::Create(uint32_t width, uint32_t height, uint32_t layerCount, TextureFormat format, InternalTextureFormat internalFormat)
+	{
+		Ref<Texture2DArray> texture = CreateRef<Texture2DArray>(width, height, layerCount, format, internalFormat);
+		texture->Init();
+		return texture;
+	}
+
+	void Texture2DArray::Init()
+	{
+		glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_Handle.Id);
+		Bind();
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GLenum(m_InternalFormat), GetWidth(), GetHeight(), GetLayerCount(), 0, GLenum(m_Format), GetComponentType(), nullptr);
+		SetMinFilter(GetDefaultFilter());
+		SetMagFilter(GetDefaultFilter());
+		SetWrapMode(TextureWrap::ClampToEdge);
+	}
+
 	TextureCube::TextureCube(uint32_t width, uint32_t height, TextureFormat format, InternalTextureFormat internalFormat) : Texture(GL_TEXTURE_CUBE_MAP, width, height, format, internalFormat)
 	{
 	}
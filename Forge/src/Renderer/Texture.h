@@ -85,6 +85,9 @@ namespace Forge
 		inline uint32_t GetWidth() const { return m_Width; }
 		inline uint32_t GetHeight() const { return m_Height; }
 		inline TextureFormat GetFormat() const { return m_Format; }
+		inline InternalTextureFormat GetInternalFormat() const { return m_InternalFormat; }
+		inline TextureFilter GetMinFilter() const { return m_MinFilter; }
+		inline TextureFilter GetMagFilter() const { return m_MagFilter; }
 
 		void Bind() const;
 		void Unbind() const;
@@ -105,9 +108,16 @@ namespace Forge
 
 	class FORGE_API Texture2D : public Texture
 	{
+	private:
+		bool m_IsStatic;
+
 	public:
 		Texture2D(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA, InternalTextureFormat internalFormat = InternalTextureFormat::RGBA);
 
+		// Whether the texture was created from pixels, rather than as a render target. The pixels of static textures never change
+		// so they can be copied into sprite atlases
+		inline bool IsStatic() const { return m_IsStatic; }
+
 	public:
 		static Ref<Texture2D> Create(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA, InternalTextureFormat internalFormat = InternalTextureFormat::RGBA);
 		static Ref<Texture2D> Create(const std::string& filename);
@@ -118,6 +128,23 @@ namespace Forge
 
 	};
 
+	class FORGE_API Texture2DArray : public Texture
+	{
+	private:
+		uint32_t m_LayerCount;
+
+	public:
+		Texture2DArray(uint32_t width, uint32_t height, uint32_t layerCount, TextureFormat format = TextureFormat::RGBA, InternalTextureFormat internalFormat = InternalTextureFormat::RGBA);
+
+		inline uint32_t GetLayerCount() const { return m_LayerCount; }
+
+	public:
+		static Ref<Texture2DArray> Create(uint32_t width, uint32_t height, uint32_t layerCount, TextureFormat format = TextureFormat::RGBA, InternalTextureFormat internalFormat = InternalTextureFormat::RGBA);
+
+	private:
+		void Init();
+	};
+
 	class FORGE_API TextureCube : public Texture
 	{
 	public:
@@ -0,0 +1,70 @@
+#include "ForgePch.h"
+#include "TriangleMesh.h"
+
+namespace Forge
+{
+
+    TriangleMesh::TriangleMesh(std::vector<glm::vec3> positions, std::vector<uint32_t> indices)
+        : m_Positions(std::move(positions)), m_Indices(std::move(indices))
+    {
+        FORGE_ASSERT(m_Indices.size() % 3 == 0, "Index count must be a multiple of 3");
+    }
+
+    bool TriangleMesh::Raycast(const Ray& ray, float maxDistance, float& distance) const
+    {
+        // Moller-Trumbore
+        bool hit = false;
+        for (size_t i = 0; i + 2 < m_Indices.size(); i += 3)
+        {
+            const glm::vec3& a = m_Positions[m_Indices[i + 0]];
+            glm::vec3 edge1 = m_Positions[m_Indices[i + 1]] - a;
+            glm::vec3 edge2 = m_Positions[m_Indices[i + 2]] - a;
+            glm::vec3 p = glm::cross(ray.Direction, edge2);
+            float determinant = glm::dot(edge1, p);
+            if (determinant == 0.0f)
+                continue;
+            float inverseDeterminant = 1.0f / determinant;
+            glm::vec3 s = ray.Origin - a;
+            float u = glm::dot(s, p) * inverseDeterminant;
+            if (u < 0.0f || u > 1.0f)
+                continue;
+            glm::vec3 q = glm::cross(s, edge1);
+            float v = glm::dot(ray.Direction, q) * inverseDeterminant;
+            if (v < 0.0f || u + v > 1.0f)
+                continue;
+            float t = glm::dot(edge2, q) * inverseDeterminant;
+            if (t >= 0.0f && t <= maxDistance)
+            {
+                maxDistance = t;
+                distance = t;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    Ref<TriangleMesh> TriangleMesh::Create(
+      const float* positions, size_t vertexCount, size_t stride, const uint32_t* indices, size_t indexCount)
+    {
+        std::vector<glm::vec3> vertices(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const float* position = positions + i * stride;
+            vertices[i] = {position[0], position[1], position[2]};
+        }
+        std::vector<uint32_t> triangles;
+        if (indices)
+        {
+            triangles.assign(indices, indices + indexCount);
+        }
+        else
+        {
+            triangles.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+                triangles[i] = uint32_t(i);
+        }
+        triangles.resize(triangles.size() / 3 * 3);
+        return CreateRef<TriangleMesh>(std::move(vertices), std::move(triangles));
+    }
+
+}
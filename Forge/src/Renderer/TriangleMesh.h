@@ -0,0 +1,41 @@
+#pragma once
+#include "ForgePch.h"
+#include "Math/Bounds.h"
+
+namespace Forge
+{
+
+    // CPU copy of the triangles of a mesh, kept so that meshes can be ray cast without the GPU
+    class FORGE_API TriangleMesh
+    {
+    private:
+        std::vector<glm::vec3> m_Positions;
+        // 3 per triangle
+        std::vector<uint32_t> m_Indices;
+
+    public:
+        TriangleMesh(std::vector<glm::vec3> positions, std::vector<uint32_t> indices);
+
+        inline const std::vector<glm::vec3>& GetPositions() const
+        {
+            return m_Positions;
+        }
+        inline const std::vector<uint32_t>& GetIndices() const
+        {
+            return m_Indices;
+        }
+        inline size_t GetTriangleCount() const
+        {
+            return m_Indices.size() / 3;
+        }
+
+        // Closest hit of a double sided triangle within maxDistance, distance is measured in units of ray.Direction
+        bool Raycast(const Ray& ray, float maxDistance, float& distance) const;
+
+    public:
+        // stride is measured in floats, indices can be nullptr for meshes drawn without an index buffer
+        static Ref<TriangleMesh> Create(const float* positions, size_t vertexCount, size_t stride,
+          const uint32_t* indices = nullptr, size_t indexCount = 0);
+    };
+
+}
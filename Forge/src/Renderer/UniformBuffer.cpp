@@ -16,6 +16,11 @@ namespace Forge
         glNamedBufferSubData(m_Handle.Id, offset, size, data);
     }
 
+    void UniformBuffer::BindRange(uint32_t binding, uint32_t offset, uint32_t size) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_Handle.Id, offset, size);
+    }
+
     Ref<UniformBuffer> UniformBuffer::Create(uint32_t size, uint32_t binding)
     {
         return CreateRef<UniformBuffer>(size, binding);
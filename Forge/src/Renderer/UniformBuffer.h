@@ -15,6 +15,8 @@ namespace Forge
 		UniformBuffer(uint32_t size, uint32_t binding);
 
 		void SetData(const void* data, uint32_t size, uint32_t offset = 0);
+		// Binds size bytes starting at offset, offset must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+		void BindRange(uint32_t binding, uint32_t offset, uint32_t size) const;
 
 	public:
 		static Ref<UniformBuffer> Create(uint32_t size, uint32_t binding);
@@ -10,7 +10,7 @@ namespace Forge
 	}
 
 	VertexArray::VertexArray()
-		: m_Handle(), m_CurrentAttributeIndex(0), m_VertexBuffers(), m_IndexBuffer(nullptr)
+		: m_Handle(), m_CurrentAttributeIndex(0), m_VertexBuffers(), m_IndexBuffer(nullptr), m_InstanceBuffer(nullptr)
 	{
 		Init();
 	}
@@ -73,6 +73,35 @@ namespace Forge
 		m_IndexBuffer = buffer;
 	}
 
+	void VertexArray::SetInstanceBuffer(int index, const Ref<VertexBuffer>& buffer)
+	{
+		if (m_InstanceBuffer == buffer)
+			return;
+		Bind();
+		buffer->Bind();
+
+		const BufferLayout& layout = buffer->GetLayout();
+
+		for (const VertexAttribute& attribute : layout)
+		{
+			int columns = attribute.Type == ShaderDataType::Mat4 ? 4 : attribute.Type == ShaderDataType::Mat3 ? 3 : 1;
+			int components = columns > 1 ? columns : GetComponentCount(attribute.Type);
+			for (int column = 0; column < columns; column++)
+			{
+				const void* offset = (const void*)(attribute.Offset + column * components * sizeof(float));
+				glEnableVertexAttribArray(index);
+				if (IsIntegral(attribute.GlType))
+					glVertexAttribIPointer(index, components, attribute.GlType, layout.GetStride(), offset);
+				else
+					glVertexAttribPointer(index, components, attribute.GlType, attribute.Normalized ? GL_TRUE : GL_FALSE, layout.GetStride(), offset);
+				glVertexAttribDivisor(index, 1);
+				index++;
+			}
+		}
+
+		m_InstanceBuffer = buffer;
+	}
+
 	Ref<VertexArray> VertexArray::Create()
 	{
 		return CreateRef<VertexArray>();
@@ -27,16 +27,22 @@ namespace Forge
 		uint32_t m_CurrentAttributeIndex;
 		std::vector<Ref<VertexBuffer>> m_VertexBuffers;
 		Ref<IndexBuffer> m_IndexBuffer;
+		Ref<VertexBuffer> m_InstanceBuffer;
 
 		uint32_t m_MaxIndices = (uint32_t)-1;
+		int m_BaseVertex = 0;
 
 	public:
 		VertexArray();
 
+		inline uint32_t GetId() const { return m_Handle.Id; }
 		inline uint32_t GetIndexCount() const { return std::min(m_MaxIndices, m_IndexBuffer->GetCount()); }
 		inline const Ref<VertexBuffer>& GetVertexBuffer(int index) const { return m_VertexBuffers[index]; }
 		inline const Ref<IndexBuffer>& GetIndexBuffer() const { return m_IndexBuffer; }
 		inline void SetMaxIndices(uint32_t count) { m_MaxIndices = count; }
+		inline int GetBaseVertex() const { return m_BaseVertex; }
+		// Added to every index of the draws, used to draw the current region of a DynamicVertexBuffer
+		inline void SetBaseVertex(int baseVertex) { m_BaseVertex = baseVertex; }
 
 		void Bind() const;
 		void Unbind() const;
@@ -44,6 +50,8 @@ namespace Forge
 		void AddVertexBuffer(const Ref<VertexBuffer>& buffer);
 		void AddVertexBuffer(int index, const Ref<VertexBuffer>& buffer);
 		void SetIndexBuffer(const Ref<IndexBuffer>& buffer);
+		// Attributes are advanced once per instance, matrices use one attribute location per column
+		void SetInstanceBuffer(int index, const Ref<VertexBuffer>& buffer);
 
 	public:
 		static Ref<VertexArray> Create();
@@ -5,7 +5,7 @@ namespace Forge
 {
 
 	AnimatorComponent::AnimatorComponent()
-		: m_CurrentAnimation(), m_CurrentTime(0.0f)
+		: m_CurrentAnimation(), m_CurrentTime(0.0f), m_LocalTransforms(), m_WorldTransforms(), m_JointTransforms(), m_KeyFrameCursors()
 	{
 	}
 
@@ -19,77 +19,37 @@ namespace Forge
 		}
 	}
 
-	void AnimatorComponent::Apply(const Ref<AnimatedMesh>& mesh)
+	void AnimatorComponent::Evaluate(const Skeleton& skeleton)
 	{
+		size_t jointCount = size_t(skeleton.GetJointCount());
+		m_JointTransforms.resize(jointCount);
 		if (m_CurrentAnimation == nullptr)
 		{
-			ApplyIdentityToJoints(&mesh->GetRootJoint());
+			std::fill(m_JointTransforms.begin(), m_JointTransforms.end(), glm::mat4(1.0f));
 		}
 		else
 		{
-			FORGE_ASSERT(m_CurrentAnimation->KeyFrames[0].Transforms.size() == mesh->GetJointCount(), "Invalid mesh");
-			ApplyPoseToJoints(CalculateCurrentPose(), &mesh->GetRootJoint(), glm::mat4(1.0f));
+			FORGE_ASSERT(m_CurrentAnimation->GetJointCount() == jointCount, "Invalid skeleton");
+			m_LocalTransforms.resize(jointCount);
+			m_WorldTransforms.resize(jointCount);
+			m_KeyFrameCursors.resize(jointCount * 2, 0);
+			CalculateCurrentPose();
+			skeleton.CalculatePalette(m_LocalTransforms.data(), m_WorldTransforms.data(), m_JointTransforms.data());
 		}
 	}
 
-	std::vector<glm::mat4> AnimatorComponent::CalculateCurrentPose() const
+	void AnimatorComponent::CalculateCurrentPose()
 	{
-		AnimationKeyFrame* prev;
-		AnimationKeyFrame* next;
-		FindPrevAndNextKeyframes(&prev, &next);
-		FORGE_ASSERT(prev != nullptr && next != nullptr, "Invalid animation");
-		float progression = CalculateProgressionBetween(*prev, *next);
-		return InterpolatePoses(*prev, *next, progression);
-	}
-
-	void AnimatorComponent::ApplyIdentityToJoints(Joint* joint) const
-	{
-		joint->Transform = glm::mat4(1.0f);
-		for (const auto& child : joint->Children)
-			ApplyIdentityToJoints(child.get());
-	}
-
-	void AnimatorComponent::ApplyPoseToJoints(const std::vector<glm::mat4>& pose, Joint* joint, const glm::mat4& parentTransform) const
-	{
-		const glm::mat4& localTransform = pose[joint->Id];
-		glm::mat4 transform = parentTransform * localTransform;
-		for (const auto& child : joint->Children)
-			ApplyPoseToJoints(pose, child.get(), transform);
-		glm::mat4 modelTransform = transform * joint->InverseBindTransform;
-		joint->Transform = modelTransform;
-	}
-
-	void AnimatorComponent::FindPrevAndNextKeyframes(AnimationKeyFrame** prev, AnimationKeyFrame** next) const
-	{
-#ifndef FORGE_DIST
-		*prev = nullptr;
-		*next = nullptr;
-#endif
-		for (int i = 0; i < m_CurrentAnimation->KeyFrames.size() - 1; i++)
-		{
-			if (m_CurrentTime >= m_CurrentAnimation->KeyFrames[i].TimeStamp)
-			{
-				*prev = &m_CurrentAnimation->KeyFrames[i];
-				*next = &m_CurrentAnimation->KeyFrames[i + 1];
-			}
-		}
-	}
-
-	float AnimatorComponent::CalculateProgressionBetween(const AnimationKeyFrame& prev, const AnimationKeyFrame& next) const
-	{
-		float delta = m_CurrentTime - prev.TimeStamp;
-		return delta / (next.TimeStamp - prev.TimeStamp);
-	}
-
-	std::vector<glm::mat4> AnimatorComponent::InterpolatePoses(const AnimationKeyFrame& prev, const AnimationKeyFrame& next, float progression) const
-	{
-		FORGE_ASSERT(prev.Transforms.size() == next.Transforms.size(), "Invalid");
-		std::vector<glm::mat4> result(prev.Transforms.size());
-		for (size_t i = 0; i < prev.Transforms.size(); i++)
+		const std::vector<JointAnimation>& joints = m_CurrentAnimation->Joints;
+		for (size_t i = 0; i < joints.size(); i++)
 		{
-			result[i] = JointTransform::Interpolate(prev.Transforms[i], next.Transforms[i], progression).GetLocalTransform();
+			JointTransform transform = { glm::vec3{ 0.0f }, glm::quat{ 1.0f, 0.0f, 0.0f, 0.0f } };
+			if (!joints[i].Translation.IsEmpty())
+				transform.Translation = SampleTrack(joints[i].Translation, m_CurrentTime, m_KeyFrameCursors[i * 2 + 0]);
+			if (!joints[i].Orientation.IsEmpty())
+				transform.Orientation = SampleTrack(joints[i].Orientation, m_CurrentTime, m_KeyFrameCursors[i * 2 + 1]);
+			m_LocalTransforms[i] = transform.GetLocalTransform();
 		}
-		return result;
 	}
 
 }
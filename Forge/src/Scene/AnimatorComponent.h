@@ -12,6 +12,13 @@ namespace Forge
 		Ref<Animation> m_CurrentAnimation;
 		float m_CurrentTime;
 
+		// Reused between frames, indexed by joint id except m_WorldTransforms which follows the skeleton order
+		std::vector<glm::mat4> m_LocalTransforms;
+		std::vector<glm::mat4> m_WorldTransforms;
+		std::vector<glm::mat4> m_JointTransforms;
+		// Last key used on each track, translation then orientation for every joint
+		std::vector<uint32_t> m_KeyFrameCursors;
+
 	public:
 		AnimatorComponent();
 
@@ -21,22 +28,21 @@ namespace Forge
 
 		inline void SetCurrentAnimation(const Ref<Animation>& animation, float startTime = 0.0f)
 		{
-			FORGE_ASSERT(animation == nullptr || animation->KeyFrames.size() > 0, "Invalid animation");
+			FORGE_ASSERT(animation == nullptr || animation->GetJointCount() > 0, "Invalid animation");
 			m_CurrentAnimation = animation;
 			m_CurrentTime = startTime;
+			m_KeyFrameCursors.clear();
 		}
+
+		// Skinning palette written by the last call to Evaluate
+		inline const std::vector<glm::mat4>& GetJointTransforms() const { return m_JointTransforms; }
 		
 		void OnUpdate(Timestep ts);
-		void Apply(const Ref<AnimatedMesh>& mesh);
+		// Only touches this component, so different animators can be evaluated in parallel
+		void Evaluate(const Skeleton& skeleton);
 
-		std::vector<glm::mat4> CalculateCurrentPose() const;
-
-	private:		
-		void ApplyIdentityToJoints(Joint* joint) const;
-		void ApplyPoseToJoints(const std::vector<glm::mat4>& pose, Joint* joint, const glm::mat4& parentTransform) const;
-		void FindPrevAndNextKeyframes(AnimationKeyFrame** prev, AnimationKeyFrame** next) const;
-		float CalculateProgressionBetween(const AnimationKeyFrame& prev, const AnimationKeyFrame& next) const;
-		std::vector<glm::mat4> InterpolatePoses(const AnimationKeyFrame& prev, const AnimationKeyFrame& next, float progression) const;
+	private:
+		void CalculateCurrentPose();
 
 	};
 
@@ -0,0 +1,278 @@
+#pragma once
+#include "Collision.h"
+#include "Math/Bounds.h"
+#include "Math/SimdLanes.h"
+
+#include <cstdint>
+
+namespace Forge
+{
+
+    namespace Detail
+    {
+
+        struct FORGE_API Vec3Lanes
+        {
+        public:
+            FloatLanes X;
+            FloatLanes Y;
+            FloatLanes Z;
+
+        public:
+            static inline Vec3Lanes Load(const float (&values)[3][FloatLanes::Width])
+            {
+                return {FloatLanes::Load(values[0]), FloatLanes::Load(values[1]), FloatLanes::Load(values[2])};
+            }
+            static inline Vec3Lanes Set(const glm::vec3& value)
+            {
+                return {FloatLanes::Set(value.x), FloatLanes::Set(value.y), FloatLanes::Set(value.z)};
+            }
+
+            inline Vec3Lanes operator-(const Vec3Lanes& other) const
+            {
+                return {X - other.X, Y - other.Y, Z - other.Z};
+            }
+            inline Vec3Lanes operator*(FloatLanes scale) const
+            {
+                return {X * scale, Y * scale, Z * scale};
+            }
+            inline Vec3Lanes operator*(const Vec3Lanes& other) const
+            {
+                return {X * other.X, Y * other.Y, Z * other.Z};
+            }
+            inline const FloatLanes& operator[](int index) const
+            {
+                return index == 0 ? X : (index == 1 ? Y : Z);
+            }
+        };
+
+        // Same order of operations as glm::dot() and glm::cross() so that results match the scalar tests
+        inline FloatLanes Dot(const Vec3Lanes& a, const Vec3Lanes& b)
+        {
+            return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+        }
+
+        // Unused lanes of an AABBBatch have Min > Max
+        inline FloatLanes IsValid(const Vec3Lanes& min, const Vec3Lanes& max)
+        {
+            return (min.X <= max.X) & (min.Y <= max.Y) & (min.Z <= max.Z);
+        }
+
+        inline Vec3Lanes Cross(const Vec3Lanes& a, const Vec3Lanes& b)
+        {
+            return {a.Y * b.Z - b.Y * a.Z, a.Z * b.X - b.Z * a.X, a.X * b.Y - b.X * a.Y};
+        }
+
+        struct FORGE_API OBBLanes
+        {
+        public:
+            Vec3Lanes Center;
+            Vec3Lanes Axes[3];
+            // Axes scaled by the half size
+            Vec3Lanes Extents[3];
+        };
+
+        // Lanes where axis separates the boxes, sums the projections in the same order as IsSeparatingPlane()
+        inline FloatLanes IsSeparatingAxis(
+          const Vec3Lanes& relativePos, const Vec3Lanes& axis, const OBBLanes& box1, const OBBLanes& box2)
+        {
+            FloatLanes radius = FloatLanes::Abs(Dot(box1.Extents[0], axis));
+            radius = radius + FloatLanes::Abs(Dot(box1.Extents[1], axis));
+            radius = radius + FloatLanes::Abs(Dot(box1.Extents[2], axis));
+            for (int i = 0; i < 3; i++)
+                radius = radius + FloatLanes::Abs(Dot(box2.Extents[i], axis));
+            return FloatLanes::Abs(Dot(relativePos, axis)) > radius;
+        }
+
+        inline uint32_t TestOBBIntersections(const OBBLanes& box1, const OBBLanes& box2)
+        {
+            Vec3Lanes relativePos = box2.Center - box1.Center;
+            FloatLanes separated = IsSeparatingAxis(relativePos, box1.Axes[0], box1, box2);
+            for (int i = 1; i < 3; i++)
+                separated = separated | IsSeparatingAxis(relativePos, box1.Axes[i], box1, box2);
+            for (int i = 0; i < 3; i++)
+                separated = separated | IsSeparatingAxis(relativePos, box2.Axes[i], box1, box2);
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                    separated = separated | IsSeparatingAxis(relativePos, Cross(box1.Axes[i], box2.Axes[j]), box1, box2);
+            }
+            constexpr uint32_t allLanes = (1u << FloatLanes::Width) - 1;
+            return ~separated.GetMask() & allLanes;
+        }
+
+    }
+
+    // Number of boxes tested at once by the batch kernels
+    constexpr size_t CollisionBatchWidth = FloatLanes::Width;
+
+    // Structure of arrays used by the batch kernels, component c of box i is stored in [c][i].
+    // Unused lanes never intersect anything
+    struct FORGE_API AABBBatch
+    {
+    public:
+        float Min[3][CollisionBatchWidth];
+        float Max[3][CollisionBatchWidth];
+
+    public:
+        inline AABBBatch()
+        {
+            for (size_t i = 0; i < CollisionBatchWidth; i++)
+                Clear(i);
+        }
+
+        inline void Set(size_t lane, const BoundingBox& box)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                Min[c][lane] = box.Min[c];
+                Max[c][lane] = box.Max[c];
+            }
+        }
+
+        inline void Clear(size_t lane)
+        {
+            Set(lane, BoundingBox());
+        }
+    };
+
+    struct FORGE_API OBBBatch
+    {
+    public:
+        float Center[3][CollisionBatchWidth];
+        float Axes[3][3][CollisionBatchWidth];
+        float HalfSize[3][CollisionBatchWidth];
+        // Lanes that hold a box, the result of every test is masked with this
+        uint32_t Mask = 0;
+
+    public:
+        inline void Set(size_t lane, const OBB& box)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                Center[c][lane] = box.Center[c];
+                HalfSize[c][lane] = box.HalfSize[c];
+                for (int axis = 0; axis < 3; axis++)
+                    Axes[axis][c][lane] = box.Axes[axis][c];
+            }
+            Mask |= 1u << lane;
+        }
+
+        inline void Clear(size_t lane)
+        {
+            Set(lane, OBB {{glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f)}, glm::vec3(0.0f), glm::vec3(0.0f)});
+            Mask &= ~(1u << lane);
+        }
+    };
+
+    namespace Detail
+    {
+
+        inline OBBLanes LoadOBBLanes(const OBBBatch& batch)
+        {
+            OBBLanes result;
+            result.Center = Vec3Lanes::Load(batch.Center);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                result.Axes[axis] = Vec3Lanes::Load(batch.Axes[axis]);
+                result.Extents[axis] = result.Axes[axis] * FloatLanes::Load(batch.HalfSize[axis]);
+            }
+            return result;
+        }
+
+        inline OBBLanes SetOBBLanes(const OBB& box)
+        {
+            OBBLanes result;
+            result.Center = Vec3Lanes::Set(box.Center);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                result.Axes[axis] = Vec3Lanes::Set(box.Axes[axis]);
+                result.Extents[axis] = result.Axes[axis] * FloatLanes::Set(box.HalfSize[axis]);
+            }
+            return result;
+        }
+
+    }
+
+    // Bit i is set if box intersects lane i, the same result as TestOBBIntersection() for each lane
+    inline uint32_t TestOBBIntersections(const OBB& box, const OBBBatch& batch)
+    {
+        return Detail::TestOBBIntersections(Detail::SetOBBLanes(box), Detail::LoadOBBLanes(batch)) & batch.Mask;
+    }
+
+    // Bit i is set if lane i of a intersects lane i of b
+    inline uint32_t TestOBBIntersections(const OBBBatch& a, const OBBBatch& b)
+    {
+        return Detail::TestOBBIntersections(Detail::LoadOBBLanes(a), Detail::LoadOBBLanes(b)) & a.Mask & b.Mask;
+    }
+
+    // Bit i is set if box intersects lane i, the same result as BoundingBox::Intersects()
+    inline uint32_t TestAABBIntersections(const BoundingBox& box, const AABBBatch& batch)
+    {
+        FloatLanes result = FloatLanes::Set(box.Min.x) <= FloatLanes::Load(batch.Max[0]);
+        for (int c = 0; c < 3; c++)
+        {
+            if (c > 0)
+                result = result & (FloatLanes::Set(box.Min[c]) <= FloatLanes::Load(batch.Max[c]));
+            result = result & (FloatLanes::Set(box.Max[c]) >= FloatLanes::Load(batch.Min[c]));
+        }
+        return result.GetMask();
+    }
+
+    // Bit i is set if lane i of a intersects lane i of b
+    inline uint32_t TestAABBIntersections(const AABBBatch& a, const AABBBatch& b)
+    {
+        FloatLanes result = FloatLanes::Load(a.Min[0]) <= FloatLanes::Load(b.Max[0]);
+        for (int c = 0; c < 3; c++)
+        {
+            if (c > 0)
+                result = result & (FloatLanes::Load(a.Min[c]) <= FloatLanes::Load(b.Max[c]));
+            result = result & (FloatLanes::Load(a.Max[c]) >= FloatLanes::Load(b.Min[c]));
+        }
+        return result.GetMask();
+    }
+
+    // Bit i is set if lane i intersects the frustum, the same result as FrustumPlanes::Intersects()
+    inline uint32_t TestFrustumIntersections(const FrustumPlanes& frustum, const AABBBatch& batch)
+    {
+        Detail::Vec3Lanes min = Detail::Vec3Lanes::Load(batch.Min);
+        Detail::Vec3Lanes max = Detail::Vec3Lanes::Load(batch.Max);
+        FloatLanes result = Detail::IsValid(min, max);
+        for (const glm::vec4& plane : frustum.Planes)
+        {
+            // Test the corner furthest along the plane normal
+            Detail::Vec3Lanes corner = {
+              plane.x >= 0.0f ? max.X : min.X,
+              plane.y >= 0.0f ? max.Y : min.Y,
+              plane.z >= 0.0f ? max.Z : min.Z,
+            };
+            FloatLanes distance = Detail::Dot(Detail::Vec3Lanes::Set(glm::vec3(plane)), corner) + FloatLanes::Set(plane.w);
+            result = result & (distance >= FloatLanes::Set(0.0f));
+        }
+        return result.GetMask();
+    }
+
+    // Bit i is set if the ray hits lane i between 0 and maxDistance, the same result as IntersectsRay().
+    // distances[i] is set to where the ray enters lane i
+    inline uint32_t TestRayIntersections(const Ray& ray, const glm::vec3& inverseDirection, float maxDistance,
+      const AABBBatch& batch, float (&distances)[CollisionBatchWidth])
+    {
+        Detail::Vec3Lanes min = Detail::Vec3Lanes::Load(batch.Min);
+        Detail::Vec3Lanes max = Detail::Vec3Lanes::Load(batch.Max);
+        Detail::Vec3Lanes origin = Detail::Vec3Lanes::Set(ray.Origin);
+        Detail::Vec3Lanes inverse = Detail::Vec3Lanes::Set(inverseDirection);
+        Detail::Vec3Lanes t0 = (min - origin) * inverse;
+        Detail::Vec3Lanes t1 = (max - origin) * inverse;
+        FloatLanes enter = FloatLanes::Set(0.0f);
+        FloatLanes exit = FloatLanes::Set(maxDistance);
+        for (int c = 0; c < 3; c++)
+        {
+            // Slabs that produce NaN are ignored
+            enter = FloatLanes::Max(FloatLanes::Min(t0[c], t1[c]), enter);
+            exit = FloatLanes::Min(FloatLanes::Max(t0[c], t1[c]), exit);
+        }
+        enter.Store(distances);
+        return (Detail::IsValid(min, max) & (enter <= exit)).GetMask();
+    }
+
+}
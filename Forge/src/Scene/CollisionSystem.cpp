@@ -0,0 +1,384 @@
+#include "ForgePch.h"
+#include "CollisionSystem.h"
+
+#include "Core/JobSystem.h"
+
+namespace Forge
+{
+
+    CollisionSystem::CollisionSystem()
+        : m_Tree(), m_States(), m_Colliders(), m_FreeColliders(), m_ColliderIndices(), m_ColliderCount(0),
+          m_Contacts(), m_ContactKeys(), m_Enlarged(), m_Moved(), m_Outputs(), m_Began(), m_Stayed(), m_Ended(),
+          m_Frame(0), m_ContactFrame(0)
+    {
+    }
+
+    void CollisionSystem::UpdateColliders(entt::registry& registry, SpatialIndex& spatialIndex)
+    {
+        m_Frame++;
+        m_Moved.clear();
+
+        // The views are created here so that the jobs only read the component pools
+        auto colliders = registry.view<AabbColliderComponent>();
+        auto transforms = registry.view<TransformComponent>();
+        auto layers = registry.view<LayerId>();
+        auto enabled = registry.view<EnabledFlag>();
+
+        ResetOutputs(colliders.size(), ColliderGrainSize);
+        JobSystem::Get().ParallelFor(colliders.size(), ColliderGrainSize, [&](size_t begin, size_t end) {
+            JobOutput& output = m_Outputs[begin / ColliderGrainSize];
+            const entt::entity* entities = colliders.data();
+            const AabbColliderComponent* components = colliders.raw();
+            for (size_t i = begin; i < end; i++)
+            {
+                entt::entity entity = entities[i];
+                if (!enabled.contains(entity) || !transforms.contains(entity) || !layers.contains(entity))
+                    continue;
+                uint32_t index = FindCollider(entity);
+                // Adding a collider can grow the arrays that the other jobs are writing to
+                if (index == InvalidIndex)
+                {
+                    output.Added.push_back(entity);
+                    continue;
+                }
+                m_States[index].UpdatedFrame = m_Frame;
+                output.UpdatedCount++;
+                if (ReadCollider(index, transforms.get<TransformComponent>(entity), components[i],
+                      layers.get<LayerId>(entity)))
+                    output.Moved.push_back(index);
+            }
+        });
+
+        // Destroyed, disabled and removed colliders were not updated. They are removed before the new colliders are added
+        // since a new entity can reuse the identifier of a destroyed one
+        uint32_t updatedCount = 0;
+        for (const JobOutput& output : m_Outputs)
+            updatedCount += output.UpdatedCount;
+        if (updatedCount != m_ColliderCount)
+        {
+            for (uint32_t index = 0; index < m_States.size(); index++)
+            {
+                if (m_States[index].Entity != entt::null && m_States[index].UpdatedFrame != m_Frame)
+                {
+                    spatialIndex.Remove(SpatialCategory::Collider, m_States[index].Entity);
+                    RemoveCollider(index);
+                }
+            }
+        }
+
+        for (const JobOutput& output : m_Outputs)
+        {
+            m_Moved.insert(m_Moved.end(), output.Moved.begin(), output.Moved.end());
+            for (entt::entity entity : output.Added)
+            {
+                uint32_t index = AddCollider(entity);
+                m_States[index].UpdatedFrame = m_Frame;
+                ReadCollider(index, transforms.get<TransformComponent>(entity), colliders.get<AabbColliderComponent>(entity),
+                  layers.get<LayerId>(entity));
+                Collider& data = m_Colliders[index];
+                data.Proxy = m_Tree.CreateProxy(data.Bounds, index);
+                m_States[index].EnlargedFrame = m_Frame;
+                m_Enlarged.push_back(index);
+                spatialIndex.Update(SpatialCategory::Collider, entity, data.Bounds);
+            }
+        }
+
+        // Same trade off as SpatialIndex::EndUpdate(), refit once a large part of the tree has moved
+        bool refit = m_Moved.size() > m_Tree.GetProxyCount() / RefitFraction;
+        for (uint32_t index : m_Moved)
+        {
+            const Collider& data = m_Colliders[index];
+            bool enlarged = refit ? m_Tree.SetProxyBounds(data.Proxy, data.Bounds)
+                                  : m_Tree.MoveProxy(data.Proxy, data.Bounds);
+            if (enlarged)
+            {
+                m_States[index].EnlargedFrame = m_Frame;
+                m_Enlarged.push_back(index);
+            }
+            spatialIndex.Update(SpatialCategory::Collider, m_States[index].Entity, data.Bounds);
+        }
+        if (refit)
+            m_Tree.Refit();
+    }
+
+    bool CollisionSystem::ReadCollider(
+      uint32_t index, const TransformComponent& transform, const AabbColliderComponent& collider, const LayerId& layer)
+    {
+        Collider& data = m_Colliders[index];
+        uint32_t transformFrame = transform.GetChangedFrame();
+        if (data.Proxy != DynamicBvh::NullNode && data.TransformNode == transform.GetId() &&
+            data.TransformFrame == transformFrame && data.LocalTransform == collider.Transform &&
+            data.Dimensions == collider.Dimensions && data.Layers == layer.Mask && data.Mask == collider.LayerMask)
+            return false;
+
+        glm::mat4 worldTransform = transform.GetMatrix() * collider.Transform;
+        data.TransformNode = transform.GetId();
+        data.TransformFrame = transformFrame;
+        data.LocalTransform = collider.Transform;
+        data.Dimensions = collider.Dimensions;
+        data.Layers = layer.Mask;
+        data.Mask = collider.LayerMask;
+        data.Box = CreateOBB(collider.Dimensions, worldTransform);
+        BoundingBox bounds;
+        bounds.Max = glm::abs(collider.Dimensions) * 0.5f;
+        bounds.Min = -bounds.Max;
+        data.Bounds = bounds.Transform(worldTransform);
+        m_States[index].MovedFrame = m_Frame;
+        return true;
+    }
+
+    void CollisionSystem::UpdateContacts(entt::registry& registry)
+    {
+        m_Began.clear();
+        m_Stayed.clear();
+        m_Ended.clear();
+
+        // Existing contacts are validated first so that a contact with a stale collider is removed before its pair
+        // can be found again
+        JobSystem& jobs = JobSystem::Get();
+        jobs.ParallelFor(m_Contacts.size(), ContactGrainSize, [this](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; index++)
+            {
+                Contact& contact = m_Contacts[index];
+                contact.WasTouching = contact.Touching;
+                contact.Valid = IsContactValid(contact);
+            }
+        });
+        size_t index = 0;
+        while (index < m_Contacts.size())
+        {
+            const Contact& contact = m_Contacts[index];
+            if (contact.Valid)
+            {
+                index++;
+                continue;
+            }
+            if (contact.Touching)
+                m_Ended.push_back(CreateEvent(contact, registry));
+            RemoveContact(index);
+        }
+
+        // Fat bounds that did not change cannot start overlapping, so only enlarged colliders look for new pairs
+        FindContacts();
+        m_Enlarged.clear();
+        jobs.ParallelFor(m_Contacts.size(), ContactGrainSize, [this](size_t begin, size_t end) {
+            TestContacts(begin, end);
+        });
+        m_ContactFrame = m_Frame;
+
+        for (const Contact& contact : m_Contacts)
+        {
+            if (contact.Touching)
+                (contact.WasTouching ? m_Stayed : m_Began).push_back(CreateEvent(contact, registry));
+            else if (contact.WasTouching)
+                m_Ended.push_back(CreateEvent(contact, registry));
+        }
+
+        // Triggered once the contacts are consistent so that listeners are free to modify the scene
+        for (const ContactEvent& evt : m_Began)
+            OnContactBegin.Trigger(evt);
+        for (const ContactEvent& evt : m_Stayed)
+            OnContactStay.Trigger(evt);
+        for (const ContactEvent& evt : m_Ended)
+            OnContactEnd.Trigger(evt);
+    }
+
+    void CollisionSystem::FindContacts()
+    {
+        if (m_Enlarged.size() > m_ColliderCount / PairQueryFraction)
+        {
+            m_Tree.QueryPairs([this](uint32_t a, uint32_t b) {
+                if (m_States[a].EnlargedFrame > m_ContactFrame || m_States[b].EnlargedFrame > m_ContactFrame)
+                    AddContact(a, b);
+            });
+            return;
+        }
+        // The tree is only read by the queries, the pairs are added once every job has finished
+        ResetOutputs(m_Enlarged.size(), EnlargedGrainSize);
+        JobSystem::Get().ParallelFor(m_Enlarged.size(), EnlargedGrainSize, [this](size_t begin, size_t end) {
+            std::vector<std::pair<uint32_t, uint32_t>>& pairs = m_Outputs[begin / EnlargedGrainSize].Pairs;
+            for (size_t i = begin; i < end; i++)
+            {
+                uint32_t enlarged = m_Enlarged[i];
+                if (m_States[enlarged].Entity == entt::null)
+                    continue;
+                m_Tree.QueryBox(m_Tree.GetFatBounds(m_Colliders[enlarged].Proxy), [&pairs, enlarged](uint32_t other) {
+                    if (other != enlarged)
+                        pairs.push_back({enlarged, other});
+                });
+            }
+        });
+        for (const JobOutput& output : m_Outputs)
+        {
+            for (const auto& [a, b] : output.Pairs)
+                AddContact(a, b);
+        }
+    }
+
+    void CollisionSystem::Clear()
+    {
+        m_Tree.Clear();
+        m_States.clear();
+        m_Colliders.clear();
+        m_FreeColliders.clear();
+        m_ColliderIndices.clear();
+        m_ColliderCount = 0;
+        m_Contacts.clear();
+        m_ContactKeys.clear();
+        m_Enlarged.clear();
+        m_Moved.clear();
+        m_Outputs.clear();
+    }
+
+    uint32_t CollisionSystem::FindCollider(entt::entity entity) const
+    {
+        uint32_t entityIndex = Entities::GetIndex(entity);
+        if (entityIndex >= m_ColliderIndices.size())
+            return InvalidIndex;
+        uint32_t index = m_ColliderIndices[entityIndex];
+        // The identifier may belong to an older version of the entity
+        if (index == InvalidIndex || m_States[index].Entity != entity)
+            return InvalidIndex;
+        return index;
+    }
+
+    void CollisionSystem::ResetOutputs(size_t count, size_t grainSize)
+    {
+        // The job system runs everything as one range when it does not split the work, so every output is cleared
+        size_t outputCount = (count + grainSize - 1) / grainSize;
+        if (m_Outputs.size() < outputCount)
+            m_Outputs.resize(outputCount);
+        for (JobOutput& output : m_Outputs)
+        {
+            output.Added.clear();
+            output.Moved.clear();
+            output.UpdatedCount = 0;
+            output.Pairs.clear();
+        }
+    }
+
+    uint32_t CollisionSystem::AddCollider(entt::entity entity)
+    {
+        uint32_t index;
+        if (!m_FreeColliders.empty())
+        {
+            index = m_FreeColliders.back();
+            m_FreeColliders.pop_back();
+        }
+        else
+        {
+            index = uint32_t(m_States.size());
+            m_States.emplace_back();
+            m_Colliders.emplace_back();
+        }
+        ColliderState& state = m_States[index];
+        state.Entity = entity;
+        state.MovedFrame = 0;
+        state.EnlargedFrame = 0;
+        m_Colliders[index].Proxy = DynamicBvh::NullNode;
+
+        uint32_t entityIndex = Entities::GetIndex(entity);
+        if (entityIndex >= m_ColliderIndices.size())
+            m_ColliderIndices.resize(entityIndex + 1, InvalidIndex);
+        m_ColliderIndices[entityIndex] = index;
+        m_ColliderCount++;
+        return index;
+    }
+
+    void CollisionSystem::RemoveCollider(uint32_t index)
+    {
+        ColliderState& state = m_States[index];
+        Collider& collider = m_Colliders[index];
+        m_Tree.DestroyProxy(collider.Proxy);
+        m_ColliderIndices[Entities::GetIndex(state.Entity)] = InvalidIndex;
+        state.Entity = entt::null;
+        collider.Proxy = DynamicBvh::NullNode;
+        m_FreeColliders.push_back(index);
+        m_ColliderCount--;
+    }
+
+    void CollisionSystem::AddContact(uint32_t a, uint32_t b)
+    {
+        entt::entity entityA = m_States[a].Entity;
+        entt::entity entityB = m_States[b].Entity;
+        if (!m_ContactKeys.insert(GetContactKey(entityA, entityB)).second)
+            return;
+        Contact contact;
+        contact.Colliders[0] = a;
+        contact.Colliders[1] = b;
+        contact.Entities[0] = entityA;
+        contact.Entities[1] = entityB;
+        contact.TestedFrame = 0;
+        contact.Touching = false;
+        contact.WasTouching = false;
+        contact.Valid = true;
+        m_Contacts.push_back(contact);
+    }
+
+    void CollisionSystem::RemoveContact(size_t index)
+    {
+        const Contact& contact = m_Contacts[index];
+        m_ContactKeys.erase(GetContactKey(contact.Entities[0], contact.Entities[1]));
+        if (index != m_Contacts.size() - 1)
+            m_Contacts[index] = m_Contacts.back();
+        m_Contacts.pop_back();
+    }
+
+    bool CollisionSystem::IsContactValid(const Contact& contact) const
+    {
+        const ColliderState& a = m_States[contact.Colliders[0]];
+        const ColliderState& b = m_States[contact.Colliders[1]];
+        // Either slot may have been freed or reused by another entity since the contact was found
+        if (a.Entity != contact.Entities[0] || b.Entity != contact.Entities[1])
+            return false;
+        if (a.EnlargedFrame > m_ContactFrame || b.EnlargedFrame > m_ContactFrame)
+        {
+            return m_Tree.GetFatBounds(m_Colliders[contact.Colliders[0]].Proxy)
+              .Intersects(m_Tree.GetFatBounds(m_Colliders[contact.Colliders[1]].Proxy));
+        }
+        return true;
+    }
+
+    void CollisionSystem::TestContacts(size_t begin, size_t end)
+    {
+        // Pairs rejected by their layers or bounds are resolved here, the rest are tested CollisionBatchWidth at a time
+        OBBBatch first;
+        OBBBatch second;
+        uint32_t batch[CollisionBatchWidth];
+        size_t count = 0;
+        auto testBatch = [&]() {
+            for (size_t lane = count; lane < CollisionBatchWidth; lane++)
+            {
+                first.Clear(lane);
+                second.Clear(lane);
+            }
+            uint32_t touching = TestOBBIntersections(first, second);
+            for (size_t lane = 0; lane < count; lane++)
+                m_Contacts[batch[lane]].Touching = (touching >> lane) & 1;
+            count = 0;
+        };
+
+        for (size_t index = begin; index < end; index++)
+        {
+            Contact& contact = m_Contacts[index];
+            if (std::max(m_States[contact.Colliders[0]].MovedFrame, m_States[contact.Colliders[1]].MovedFrame) <=
+                contact.TestedFrame)
+                continue;
+            contact.TestedFrame = m_Frame;
+            const Collider& a = m_Colliders[contact.Colliders[0]];
+            const Collider& b = m_Colliders[contact.Colliders[1]];
+            contact.Touching = false;
+            if ((a.Mask & b.Layers) && (b.Mask & a.Layers) && a.Bounds.Intersects(b.Bounds))
+            {
+                first.Set(count, a.Box);
+                second.Set(count, b.Box);
+                batch[count++] = uint32_t(index);
+                if (count == CollisionBatchWidth)
+                    testBatch();
+            }
+        }
+        if (count > 0)
+            testBatch();
+    }
+
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include "CollisionBatch.h"
+#include "Colliders.h"
+#include "Entity.h"
+#include "SpatialIndex.h"
+#include "Core/EventEmitter.h"
+
+#include <entt/entt.hpp>
+#include <limits>
+#include <unordered_set>
+
+namespace Forge
+{
+
+    // Either entity may have been destroyed by the time OnContactEnd is triggered
+    struct FORGE_API ContactEvent
+    {
+    public:
+        Forge::Entity A;
+        Forge::Entity B;
+    };
+
+    // Finds the touching pairs of enabled AabbColliderComponents once per frame.
+    // Colliders are read across the job system and only those whose transform or component changed are recalculated.
+    // They are kept in a DynamicBvh so that only colliders whose fat bounds changed look for new pairs, and the
+    // SAT test only runs again for pairs where one of the colliders moved.
+    // Two colliders can touch if the LayerMask of each collider contains a layer of the other entity
+    class FORGE_API CollisionSystem
+    {
+    private:
+        // Switch from reinserting moved colliders to refitting the tree once more than 1 / RefitFraction move
+        static constexpr uint32_t RefitFraction = 16;
+        // Switch from querying the tree around each enlarged collider to finding every overlapping pair in one pass
+        // once more than 1 / PairQueryFraction are enlarged
+        static constexpr uint32_t PairQueryFraction = 4;
+        // Colliders read, enlarged colliders queried and contacts tested per job
+        static constexpr size_t ColliderGrainSize = 1024;
+        static constexpr size_t EnlargedGrainSize = 64;
+        static constexpr size_t ContactGrainSize = 4096;
+
+        // Read for every contact each frame, kept apart from the rest of the collider
+        struct FORGE_API ColliderState
+        {
+        public:
+            // entt::null while the slot is free
+            entt::entity Entity;
+            uint32_t MovedFrame;
+            uint32_t EnlargedFrame;
+            uint32_t UpdatedFrame;
+        };
+
+        struct FORGE_API Collider
+        {
+        public:
+            int32_t Proxy;
+            // The world transform is only read again once the node or its changed frame differ
+            TransformId TransformNode;
+            uint32_t TransformFrame;
+            glm::mat4 LocalTransform;
+            glm::vec3 Dimensions;
+            LayerMask Layers;
+            LayerMask Mask;
+            OBB Box;
+            BoundingBox Bounds;
+        };
+
+        struct FORGE_API Contact
+        {
+        public:
+            uint32_t Colliders[2];
+            entt::entity Entities[2];
+            uint32_t TestedFrame;
+            bool Touching;
+            // Touching before the current UpdateContacts()
+            bool WasTouching;
+            // Whether the contact survived the validation at the start of UpdateContacts()
+            bool Valid;
+        };
+
+        // Written by one job, indexed by the start of its range divided by the grain size.
+        // Merged once every job has finished so that the shared containers are only modified by one thread
+        struct FORGE_API JobOutput
+        {
+        public:
+            std::vector<entt::entity> Added;
+            std::vector<uint32_t> Moved;
+            uint32_t UpdatedCount;
+            std::vector<std::pair<uint32_t, uint32_t>> Pairs;
+        };
+
+        static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        DynamicBvh m_Tree;
+        std::vector<ColliderState> m_States;
+        std::vector<Collider> m_Colliders;
+        std::vector<uint32_t> m_FreeColliders;
+        // Collider index of each entity, indexed by the entity identifier without its version
+        std::vector<uint32_t> m_ColliderIndices;
+        uint32_t m_ColliderCount;
+        std::vector<Contact> m_Contacts;
+        std::unordered_set<uint64_t> m_ContactKeys;
+        // Colliders whose fat bounds changed since the last UpdateContacts()
+        std::vector<uint32_t> m_Enlarged;
+        std::vector<uint32_t> m_Moved;
+        std::vector<JobOutput> m_Outputs;
+        std::vector<ContactEvent> m_Began;
+        std::vector<ContactEvent> m_Stayed;
+        std::vector<ContactEvent> m_Ended;
+        uint32_t m_Frame;
+        uint32_t m_ContactFrame;
+
+    public:
+        EventEmitter<ContactEvent> OnContactBegin;
+        // Triggered every frame after OnContactBegin until the colliders separate
+        EventEmitter<ContactEvent> OnContactStay;
+        EventEmitter<ContactEvent> OnContactEnd;
+
+    public:
+        CollisionSystem();
+
+        inline uint32_t GetColliderCount() const
+        {
+            return m_ColliderCount;
+        }
+        // Pairs whose fat bounds overlap, touching or not
+        inline uint32_t GetContactCount() const
+        {
+            return uint32_t(m_Contacts.size());
+        }
+
+        // Reads the colliders from the registry and updates the collider category of the spatial index,
+        // must be called between SpatialIndex::BeginUpdate() and SpatialIndex::EndUpdate() on a retained collider category.
+        // World matrices are read from the transform hierarchy, which must have been updated since the last change
+        void UpdateColliders(entt::registry& registry, SpatialIndex& spatialIndex);
+        // Updates the contacts after UpdateColliders() and triggers the contact events
+        void UpdateContacts(entt::registry& registry);
+        // Drops every collider and contact without triggering events
+        void Clear();
+
+    private:
+        uint32_t FindCollider(entt::entity entity) const;
+        uint32_t AddCollider(entt::entity entity);
+        void RemoveCollider(uint32_t index);
+        // Clears enough outputs for count items split into ranges of grainSize
+        void ResetOutputs(size_t count, size_t grainSize);
+        // Recalculates the box and bounds if the collider changed since it was last read, safe to call for different
+        // colliders from several threads
+        bool ReadCollider(uint32_t index, const TransformComponent& transform, const AabbColliderComponent& collider,
+          const LayerId& layer);
+        void FindContacts();
+        void AddContact(uint32_t a, uint32_t b);
+        void RemoveContact(size_t index);
+        // False if either collider was removed or their fat bounds no longer overlap
+        bool IsContactValid(const Contact& contact) const;
+        // Runs the SAT test again for contacts where either collider moved, safe to call for different ranges of contacts
+        // from several threads
+        void TestContacts(size_t begin, size_t end);
+
+        static inline ContactEvent CreateEvent(const Contact& contact, entt::registry& registry)
+        {
+            return {Entity(contact.Entities[0], &registry), Entity(contact.Entities[1], &registry)};
+        }
+
+        static inline uint64_t GetContactKey(entt::entity a, entt::entity b)
+        {
+            uint64_t first = uint64_t(a);
+            uint64_t second = uint64_t(b);
+            return first < second ? (first << 32) | second : (second << 32) | first;
+        }
+    };
+
+}
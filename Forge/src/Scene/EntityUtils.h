@@ -8,6 +8,12 @@ namespace Forge
     namespace Entities
     {
 
+        // Identifier of the entity without its version, used to index arrays that map entities to other data
+        inline uint32_t GetIndex(entt::entity entity)
+        {
+            return uint32_t(entity) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask;
+        }
+
         namespace Detail
         {
 
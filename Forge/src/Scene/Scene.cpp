@@ -4,6 +4,7 @@
 #include "EntityUtils.h"
 #include "Entity.h"
 #include "Transform.h"
+#include "TransformHierarchy.h"
 #include "CameraComponent.h"
 #include "ModelRenderer.h"
 #include "AnimatorComponent.h"
@@ -12,6 +13,7 @@
 #include "Colliders.h"
 
 #include "Assets/GraphicsCache.h"
+#include "Core/JobSystem.h"
 
 namespace Forge
 {
@@ -23,16 +25,31 @@ namespace Forge
             to.AddComponent<T>(CloneComponent(from.GetComponent<T>()));
     }
 
+    // Lights are treated as having no effect once their attenuated intensity drops below this
+    constexpr float LightInfluenceThreshold = 1.0f / 256.0f;
+
+    // Distance at which 1 / (1 + d^2 / r^2) * intensity reaches LightInfluenceThreshold, matches the attenuation in OnUpdate()
+    inline float GetLightInfluenceRadius(const PointLightComponent& light)
+    {
+        return light.Radius * std::sqrt(std::max(light.Intensity / LightInfluenceThreshold - 1.0f, 0.0f));
+    }
+
     Scene::Scene(const Ref<Framebuffer>& defaultFramebuffer, Renderer3D* renderer)
-        : m_Registry(),
+        : m_TransformHierarchy(),
+          m_Registry(),
+          m_SpatialIndex(),
+          m_CollisionSystem(),
           m_PrimaryCamera(entt::null),
           m_Time(0.0f),
           m_Renderer(renderer),
           m_Renderer2D(nullptr),
           m_DefaultFramebuffer(defaultFramebuffer),
           m_PickFramebuffer(nullptr),
+          m_Animators(),
           m_DebugDrawColliders(false)
     {
+        // The collision system only updates the colliders that moved and removes the rest itself
+        m_SpatialIndex.SetRetained(SpatialCategory::Collider, true);
         if (m_Renderer)
             m_Renderer2D = std::make_unique<Renderer2D>();
     }
@@ -51,7 +68,7 @@ namespace Forge
     Entity Scene::CreateEntity(const std::string& name, uint8_t layer)
     {
         Entity entity(m_Registry.create(), &m_Registry);
-        entity.AddComponent<TransformComponent>();
+        entity.AddComponent<TransformComponent>(m_TransformHierarchy);
         entity.AddComponent<LayerId>(1ULL << layer);
         entity.AddComponent<TagComponent>(name);
         entity.SetEnabled(true);
@@ -79,6 +96,7 @@ namespace Forge
             Entities::DestroyChilden(entity, m_Registry);
         }
         Entities::SetParent(entity, entt::null, false, m_Registry);
+        m_SpatialIndex.Remove(entity);
         m_Registry.destroy(entity);
     }
 
@@ -111,6 +129,8 @@ namespace Forge
     void Scene::Clear()
     {
         m_Registry.clear();
+        m_SpatialIndex.Clear();
+        m_CollisionSystem.Clear();
         m_PrimaryCamera = entt::null;
     }
 
@@ -127,13 +147,78 @@ namespace Forge
         return camera;
     }
 
+    PickRequest::PickRequest(const PickResult& result)
+        : m_Registry(nullptr), m_EntityReadback(), m_DepthReadback(), m_Ndc(), m_InverseViewProjection(1.0f),
+          m_Result(result), m_Resolved(true)
+    {
+    }
+
+    PickRequest::PickRequest(entt::registry* registry, const Ref<PixelReadback>& entityReadback,
+      const Ref<PixelReadback>& depthReadback, const glm::vec2& ndc, const glm::mat4& inverseViewProjection)
+        : m_Registry(registry), m_EntityReadback(entityReadback), m_DepthReadback(depthReadback), m_Ndc(ndc),
+          m_InverseViewProjection(inverseViewProjection), m_Result(), m_Resolved(false)
+    {
+    }
+
+    bool PickRequest::IsReady()
+    {
+        if (!m_Resolved && m_EntityReadback->IsReady() && (!m_DepthReadback || m_DepthReadback->IsReady()))
+            Resolve();
+        return m_Resolved;
+    }
+
+    const PickResult& PickRequest::GetResult()
+    {
+        if (!m_Resolved)
+            Resolve();
+        return m_Result;
+    }
+
+    void PickRequest::Resolve()
+    {
+        entt::entity entity = (entt::entity)m_EntityReadback->GetInt();
+        // The entity can be destroyed while the read back is in flight
+        if (entity == entt::null || !m_Registry->valid(entity))
+            entity = entt::null;
+        m_Result.Entity = Entity(entity, m_Registry);
+
+        if (m_DepthReadback && m_Result.Entity)
+        {
+            float depth = m_DepthReadback->GetFloat();
+            glm::vec4 worldPos = m_InverseViewProjection * glm::vec4(m_Ndc, depth * 2.0f - 1.0f, 1.0f);
+            m_Result.Coordinate = glm::vec3(worldPos) / worldPos.w;
+        }
+
+        m_EntityReadback = nullptr;
+        m_DepthReadback = nullptr;
+        m_Resolved = true;
+    }
+
     PickResult Scene::PickEntity(const glm::vec2& viewportCoord, const Entity& camera, PickOptions options)
     {
+        if (options.Mode == PickMode::Raycast)
+        {
+            float maxDistance;
+            Ray ray = CreateCameraRay(viewportCoord, camera, maxDistance);
+            return RaycastEntity(ray, m_Registry.get<CameraComponent>(camera).LayerMask & options.LayerMask, maxDistance);
+        }
+        return PickEntityAsync(viewportCoord, camera, options)->GetResult();
+    }
+
+    Ref<PickRequest> Scene::PickEntityAsync(const glm::vec2& viewportCoord, const Entity& camera, PickOptions options)
+    {
+        if (options.Mode == PickMode::Raycast)
+        {
+            float maxDistance;
+            Ray ray = CreateCameraRay(viewportCoord, camera, maxDistance);
+            return CreateRef<PickRequest>(
+              RaycastEntity(ray, m_Registry.get<CameraComponent>(camera).LayerMask & options.LayerMask, maxDistance));
+        }
         if (!m_Renderer)
         {
             PickResult result;
             result.Entity = NullEntity();
-            return result;
+            return CreateRef<PickRequest>(result);
         }
 
         CameraData data;
@@ -163,39 +248,31 @@ namespace Forge
         RenderCommand::ClearDepth();
         m_PickFramebuffer->ClearAttachment(0, -1);
         m_Renderer->BeginPickScene(m_PickFramebuffer, data);
-        for (auto entity : m_Registry.view<TransformComponent, ModelRendererComponent, EnabledFlag>())
-        {
-            if (CheckLayerMask(entity, cameraComponent.LayerMask & options.LayerMask))
+        FrustumPlanes frustum(data.Frustum.ProjectionMatrix * data.ViewMatrix);
+        LayerMask layerMask = cameraComponent.LayerMask & options.LayerMask;
+        m_SpatialIndex.QueryFrustum(SpatialCategory::Renderable, frustum, [&](entt::entity entity) {
+            // Entities destroyed since the last update are still in the index
+            if (m_Registry.valid(entity) && m_Registry.has<ModelRendererComponent>(entity) &&
+                CheckLayerMask(entity, layerMask))
             {
                 auto [transform, model] = m_Registry.get<TransformComponent, ModelRendererComponent>(entity);
                 RenderOptions options;
                 options.EntityId = (int)entity;
+                options.JointTransforms = GetJointTransforms(entity);
                 m_Renderer->RenderModel(model.Model, transform.GetMatrix(), options);
             }
-        }
+        });
         m_Renderer->EndScene();
 
-        int pixel = m_PickFramebuffer->ReadPixel(0, viewportCoord.x, viewportCoord.y);
+        Ref<PixelReadback> entityReadback = m_PickFramebuffer->ReadPixelAsync(0, viewportCoord.x, viewportCoord.y);
+        Ref<PixelReadback> depthReadback = nullptr;
+        if (options.IncludeCoordinate)
+            depthReadback = m_PickFramebuffer->ReadDepthPixelAsync(viewportCoord.x, viewportCoord.y);
 
-        PickResult result;
-        result.Entity = Entity((entt::entity)pixel, &m_Registry);
-
-        if (options.IncludeCoordinate && result.Entity)
-        {
-            float depth = m_PickFramebuffer->ReadDepthPixel(viewportCoord.x, viewportCoord.y);
-            glm::vec4 position = {viewportCoord.x / data.Viewport.Width * 2.0f - 1.0f,
-              viewportCoord.y / data.Viewport.Height * 2.0f - 1.0f,
-              depth * 2.0f - 1.0f,
-              1.0f};
-            glm::vec4 eyePos = glm::inverse(data.Frustum.ProjectionMatrix) * position;
-            glm::vec4 worldPos = transform.GetMatrix() * eyePos;
-            worldPos.x /= worldPos.w;
-            worldPos.y /= worldPos.w;
-            worldPos.z /= worldPos.w;
-            result.Coordinate = {worldPos.x, worldPos.y, worldPos.z};
-        }
-
-        return result;
+        glm::vec2 ndc = {
+          viewportCoord.x / data.Viewport.Width * 2.0f - 1.0f, viewportCoord.y / data.Viewport.Height * 2.0f - 1.0f};
+        glm::mat4 inverseViewProjection = transform.GetMatrix() * glm::inverse(data.Frustum.ProjectionMatrix);
+        return CreateRef<PickRequest>(&m_Registry, entityReadback, depthReadback, ndc, inverseViewProjection);
     }
 
     void Scene::OnUpdate(Timestep ts)
@@ -205,9 +282,15 @@ namespace Forge
 
         static std::vector<LightSource> s_LightSources;
         static std::vector<LayerMask> s_LightSourceShadowLayerMasks;
+        static std::vector<entt::entity> s_VisibleEntities;
 
         m_Time += ts.Seconds();
 
+        m_TransformHierarchy.Update();
+        UpdateSpatialIndex();
+        m_CollisionSystem.UpdateContacts(m_Registry);
+        UpdateAnimators(ts);
+
         if (m_Renderer)
         {
             auto cameraView = m_Registry.view<TransformComponent, CameraComponent, EnabledFlag>();
@@ -240,33 +323,15 @@ namespace Forge
                 data.ClearColor = cameraComponent.ClearColor;
                 data.Mode = cameraComponent.Mode;
                 data.UsePostProcessing = cameraComponent.UsePostProcessing;
-
-                for (auto entity : m_Registry.view<AnimatorComponent, EnabledFlag>())
-                {
-                    auto& animation = m_Registry.get<AnimatorComponent>(entity);
-                    animation.OnUpdate(ts);
-                    if (m_Registry.has<ModelRendererComponent>(entity))
-                    {
-                        auto& model = m_Registry.get<ModelRendererComponent>(entity);
-                        for (auto& model : model.Model->GetSubModels())
-                        {
-                            if (model.Mesh->IsAnimated())
-                            {
-                                const Ref<AnimatedMesh>& animatedMesh = (const Ref<AnimatedMesh>&)model.Mesh;
-                                if (animatedMesh->IsCompatible(animation.GetCurrentAnimation()))
-                                {
-                                    animation.Apply(animatedMesh);
-                                }
-                            }
-                        }
-                    }
-                }
+                FrustumPlanes frustum(data.Frustum.ProjectionMatrix * data.ViewMatrix);
+                // Structured bindings cannot be captured by the query callbacks
+                LayerMask cameraLayerMask = cameraComponent.LayerMask;
+                const Frustum& cameraFrustum = cameraComponent.Frustum;
 
                 s_LightSources.clear();
                 s_LightSourceShadowLayerMasks.clear();
-                for (auto entity : m_Registry.view<TransformComponent, PointLightComponent, EnabledFlag>())
-                {
-                    if (CheckLayerMask(entity, cameraComponent.LayerMask))
+                m_SpatialIndex.QueryFrustum(SpatialCategory::Light, frustum, [&](entt::entity entity) {
+                    if (CheckLayerMask(entity, cameraLayerMask))
                     {
                         auto [transform, light] = m_Registry.get<TransformComponent, PointLightComponent>(entity);
                         LightSource source;
@@ -278,11 +343,11 @@ namespace Forge
                         source.Intensity = light.Intensity;
                         source.Type = light.Type;
                         source.ShadowFramebuffer = light.Shadows.Enabled ? light.Shadows.RenderTarget : nullptr;
-                        source.ShadowFrustum = cameraComponent.Frustum;
+                        source.ShadowFrustum = cameraFrustum;
                         s_LightSources.push_back(source);
                         s_LightSourceShadowLayerMasks.push_back(light.Shadows.LayerMask);
                     }
-                }
+                });
                 for (auto entity : m_Registry.view<TransformComponent, DirectionalLightComponent, EnabledFlag>())
                 {
                     if (CheckLayerMask(entity, cameraComponent.LayerMask))
@@ -308,7 +373,8 @@ namespace Forge
 
                 m_Renderer->SetTime(m_Time);
                 m_Renderer->BeginScene(framebuffer, data, s_LightSources);
-                for (auto entity : m_Registry.view<TransformComponent, ModelRendererComponent, EnabledFlag>())
+                FindVisibleRenderables(frustum, s_LightSources, s_VisibleEntities);
+                for (entt::entity entity : s_VisibleEntities)
                 {
                     if (CheckLayerMask(entity, cameraComponent.LayerMask))
                     {
@@ -317,6 +383,7 @@ namespace Forge
                         options.ShadowMask = 0;
                         for (int i = 0; i < s_LightSourceShadowLayerMasks.size(); i++)
                             options.ShadowMask.set(i, CheckLayerMask(entity, s_LightSourceShadowLayerMasks[i]));
+                        options.JointTransforms = GetJointTransforms(entity);
                         m_Renderer->RenderModel(model.Model, transform.GetMatrix(), options);
                         if (m_DebugDrawColliders && m_Registry.has<AabbColliderComponent>(entity))
                         {
@@ -331,15 +398,7 @@ namespace Forge
                 }
 
                 m_Renderer2D->BeginScene();
-                for (auto entity : m_Registry.view<TransformComponent, SpriteRendererComponent, EnabledFlag>())
-                {
-                    if (CheckLayerMask(entity, cameraComponent.LayerMask))
-                    {
-                        auto [transform, sprite] = m_Registry.get<TransformComponent, SpriteRendererComponent>(entity);
-                        m_Renderer2D->DrawQuad(
-                          transform.GetPosition(), transform.GetScale(), sprite.Texture, sprite.Color);
-                    }
-                }
+                DrawSprites(cameraComponent.LayerMask);
                 m_Renderer2D->EndScene();
                 const Ref<Model>* renderables = m_Renderer2D->GetRenderables();
                 for (uint32_t i = 0; i < m_Renderer2D->GetRenderableCount(); i++)
@@ -350,6 +409,221 @@ namespace Forge
         }
     }
 
+    PickResult Scene::RaycastEntity(const Ray& ray, LayerMask layerMask, float maxDistance)
+    {
+        // Bring the index up to date with anything that has changed since the last frame
+        m_TransformHierarchy.Update();
+        UpdateSpatialIndex();
+
+        PickResult result;
+        result.Entity = NullEntity();
+        m_SpatialIndex.Raycast(SpatialCategory::Renderable, ray, maxDistance, [&](entt::entity entity, float distance) {
+            if (!CheckLayerMask(entity, layerMask))
+                return distance;
+            auto [transform, model] = m_Registry.get<TransformComponent, ModelRendererComponent>(entity);
+            if (!model.Model)
+                return distance;
+            glm::mat4 modelMatrix = transform.GetMatrix();
+            bool hit = false;
+            for (const Model::SubModel& submodel : model.Model->GetSubModels())
+            {
+                // Transforming the ray without normalizing its direction keeps distances in world units
+                glm::mat4 inverseTransform = glm::inverse(modelMatrix * submodel.Transform);
+                Ray localRay;
+                localRay.Origin = glm::vec3(inverseTransform * glm::vec4(ray.Origin, 1.0f));
+                localRay.Direction = glm::vec3(inverseTransform * glm::vec4(ray.Direction, 0.0f));
+                float hitDistance;
+                if (submodel.Mesh->Raycast(localRay, distance, hitDistance))
+                {
+                    distance = hitDistance;
+                    hit = true;
+                }
+            }
+            if (hit)
+            {
+                result.Entity = Entity(entity, &m_Registry);
+                result.Coordinate = ray.Origin + ray.Direction * distance;
+            }
+            return distance;
+        });
+        return result;
+    }
+
+    void Scene::UpdateSpatialIndex()
+    {
+        m_SpatialIndex.BeginUpdate();
+        for (auto entity : m_Registry.view<TransformComponent, ModelRendererComponent, EnabledFlag>())
+        {
+            auto [transform, model] = m_Registry.get<TransformComponent, ModelRendererComponent>(entity);
+            // Only recalculated when the entity moves or its model is replaced
+            m_SpatialIndex.Update(SpatialCategory::Renderable,
+              entity,
+              m_TransformHierarchy.GetChangedFrame(transform.GetId()),
+              model.Model.get(),
+              [&transform = transform, &model = model]() {
+                  if (!model.Model || !model.Model->IsCullable())
+                      return BoundingBox();
+                  return model.Model->GetBounds().Transform(transform.GetMatrix());
+              });
+        }
+        for (auto entity : m_Registry.view<TransformComponent, PointLightComponent, EnabledFlag>())
+        {
+            auto [transform, light] = m_Registry.get<TransformComponent, PointLightComponent>(entity);
+            glm::vec3 radius = glm::vec3(GetLightInfluenceRadius(light));
+            BoundingBox bounds;
+            bounds.Min = transform.GetPosition() - radius;
+            bounds.Max = transform.GetPosition() + radius;
+            m_SpatialIndex.Update(SpatialCategory::Light, entity, bounds);
+        }
+        m_CollisionSystem.UpdateColliders(m_Registry, m_SpatialIndex);
+        m_SpatialIndex.EndUpdate();
+    }
+
+    void Scene::FindVisibleRenderables(const FrustumPlanes& frustum, const std::vector<LightSource>& lightSources,
+      std::vector<entt::entity>& entities) const
+    {
+        entities.clear();
+        auto addEntity = [&entities](entt::entity entity) { entities.push_back(entity); };
+        m_SpatialIndex.QueryFrustum(SpatialCategory::Renderable, frustum, addEntity);
+
+        bool hasShadows = false;
+        for (const LightSource& light : lightSources)
+        {
+            if (!light.ShadowFramebuffer)
+                continue;
+            hasShadows = true;
+            if (light.Type == LightType::Point)
+            {
+                m_SpatialIndex.QuerySphere(
+                  SpatialCategory::Renderable, light.Position, light.ShadowFrustum.FarPlane, addEntity);
+            }
+            else
+            {
+                FrustumPlanes lightFrustum(light.ShadowFrustum.ProjectionMatrix *
+                                           Renderer3D::GetLightViewMatrix(light.Position, light.Direction));
+                m_SpatialIndex.QueryFrustum(SpatialCategory::Renderable, lightFrustum, addEntity);
+            }
+        }
+        if (hasShadows)
+        {
+            std::sort(entities.begin(), entities.end());
+            entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+        }
+    }
+
+    void Scene::UpdateAnimators(Timestep ts)
+    {
+        m_Animators.clear();
+        for (auto entity : m_Registry.view<AnimatorComponent, ModelRendererComponent, EnabledFlag>())
+        {
+            auto [animator, model] = m_Registry.get<AnimatorComponent, ModelRendererComponent>(entity);
+            animator.OnUpdate(ts);
+            for (const Model::SubModel& submodel : model.Model->GetSubModels())
+            {
+                if (submodel.Mesh->IsAnimated())
+                {
+                    const AnimatedMesh& mesh = (const AnimatedMesh&)*submodel.Mesh;
+                    if (mesh.IsCompatible(animator.GetCurrentAnimation()))
+                    {
+                        m_Animators.push_back({ &animator, mesh.GetSkeleton().get() });
+                        break;
+                    }
+                }
+            }
+        }
+
+        JobSystem::Get().ParallelFor(m_Animators.size(), AnimatorGrainSize, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                m_Animators[i].first->Evaluate(*m_Animators[i].second);
+        });
+    }
+
+    void Scene::DrawSprites(LayerMask layerMask)
+    {
+        static std::vector<std::pair<const TransformComponent*, const SpriteRendererComponent*>> s_Sprites;
+        static std::vector<glm::vec3> s_Positions;
+        static std::vector<glm::vec2> s_Sizes;
+        static std::vector<float> s_Rotations;
+        static std::vector<Color> s_Colors;
+        static std::vector<Ref<Texture2D>> s_Textures;
+        static std::vector<glm::vec4> s_UvRects;
+        static std::vector<int> s_Layers;
+
+        s_Sprites.clear();
+        s_Textures.clear();
+        for (auto entity : m_Registry.view<TransformComponent, SpriteRendererComponent, EnabledFlag>())
+        {
+            if (CheckLayerMask(entity, layerMask))
+            {
+                auto [transform, sprite] = m_Registry.get<TransformComponent, SpriteRendererComponent>(entity);
+                s_Sprites.push_back({ &transform, &sprite });
+                s_Textures.push_back(sprite.Texture);
+            }
+        }
+        size_t count = s_Sprites.size();
+        s_Positions.resize(count);
+        s_Sizes.resize(count);
+        s_Rotations.resize(count);
+        s_Colors.resize(count);
+        s_UvRects.resize(count);
+        s_Layers.resize(count);
+
+        // Contact listeners may have moved entities after the hierarchy was updated at the start of the frame. Updating it again
+        // here, which does nothing if no node is dirty, lets the jobs read cached world matrices
+        m_TransformHierarchy.Update();
+        JobSystem::Get().ParallelFor(count, SpriteGrainSize, [](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const TransformComponent& transform = *s_Sprites[i].first;
+                const SpriteRendererComponent& sprite = *s_Sprites[i].second;
+                s_Positions[i] = transform.GetPosition();
+                s_Sizes[i] = transform.GetScale();
+                s_Rotations[i] = glm::roll(transform.GetRotation());
+                s_Colors[i] = sprite.Color;
+                s_UvRects[i] = sprite.UvRect;
+                s_Layers[i] = sprite.SortLayer;
+            }
+        });
+
+        QuadSpans quads;
+        quads.Count = count;
+        quads.Positions = s_Positions.data();
+        quads.Sizes = s_Sizes.data();
+        quads.Colors = s_Colors.data();
+        quads.Textures = s_Textures.data();
+        quads.Rotations = s_Rotations.data();
+        quads.UvRects = s_UvRects.data();
+        quads.Layers = s_Layers.data();
+        m_Renderer2D->DrawQuads(quads);
+    }
+
+    const glm::mat4* Scene::GetJointTransforms(entt::entity entity) const
+    {
+        const AnimatorComponent* animator = m_Registry.try_get<AnimatorComponent>(entity);
+        if (animator && !animator->GetJointTransforms().empty())
+            return animator->GetJointTransforms().data();
+        return nullptr;
+    }
+
+    Ray Scene::CreateCameraRay(const glm::vec2& viewportCoord, const Entity& camera, float& maxDistance) const
+    {
+        auto [transform, cameraComponent] = m_Registry.get<TransformComponent, CameraComponent>(camera);
+        glm::vec2 ndc = {viewportCoord.x / cameraComponent.Viewport.Width * 2.0f - 1.0f,
+          viewportCoord.y / cameraComponent.Viewport.Height * 2.0f - 1.0f};
+        glm::mat4 inverseProjection = glm::inverse(cameraComponent.Frustum.ProjectionMatrix);
+        glm::vec4 nearPoint = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+        glm::vec4 farPoint = inverseProjection * glm::vec4(ndc, 1.0f, 1.0f);
+        glm::mat4 cameraTransform = transform.GetMatrix();
+        glm::vec3 start = cameraTransform * (nearPoint / nearPoint.w);
+        glm::vec3 end = cameraTransform * (farPoint / farPoint.w);
+
+        Ray ray;
+        ray.Origin = start;
+        ray.Direction = glm::normalize(end - start);
+        maxDistance = glm::length(end - start);
+        return ray;
+    }
+
     void Scene::FindPrimaryCamera()
     {
         if (m_Registry.valid(m_PrimaryCamera) || !m_Registry.has<CameraComponent>(m_PrimaryCamera))
@@ -4,6 +4,9 @@
 #include "Renderer/Renderer3D.h"
 #include "Renderer/Renderer2D.h"
 #include "Entity.h"
+#include "TransformHierarchy.h"
+#include "SpatialIndex.h"
+#include "CollisionSystem.h"
 
 #include <entt/entt.hpp>
 #include <map>
@@ -26,12 +29,50 @@ namespace Forge
 #define FORGE_LAYERS(...) ::Forge::Detail::CreateLayerMask(__VA_ARGS__)
 
     struct PickResult;
+    class AnimatorComponent;
+    struct Skeleton;
+
+    FORGE_API enum class PickMode
+    {
+        // Renders the scene into the pick framebuffer and reads back the entity id, requires a renderer
+        Framebuffer,
+        // Casts a ray against mesh bounds and triangles on the CPU, does not need a GL context
+        Raycast,
+    };
 
     struct FORGE_API PickOptions
     {
     public:
         bool IncludeCoordinate = false;
         Forge::LayerMask LayerMask = FULL_LAYER_MASK;
+        PickMode Mode = PickMode::Framebuffer;
+    };
+
+    // Result of Scene::PickEntityAsync(), resolved once the pixels read back from the pick framebuffer arrive
+    class FORGE_API PickRequest
+    {
+    private:
+        entt::registry* m_Registry;
+        Ref<PixelReadback> m_EntityReadback;
+        // Only used if the coordinate was requested
+        Ref<PixelReadback> m_DepthReadback;
+        glm::vec2 m_Ndc;
+        glm::mat4 m_InverseViewProjection;
+        PickResult m_Result;
+        bool m_Resolved;
+
+    public:
+        PickRequest(const PickResult& result);
+        PickRequest(entt::registry* registry, const Ref<PixelReadback>& entityReadback,
+          const Ref<PixelReadback>& depthReadback, const glm::vec2& ndc, const glm::mat4& inverseViewProjection);
+
+        // Does not block
+        bool IsReady();
+        // Blocks until the result is ready
+        const PickResult& GetResult();
+
+    private:
+        void Resolve();
     };
 
     class FORGE_API Scene
@@ -41,8 +82,16 @@ namespace Forge
 
     private:
         static constexpr uint8_t DEFAULT_LAYER = 0;
+        // Animators evaluated per job
+        static constexpr size_t AnimatorGrainSize = 16;
+        // Sprite transforms read per job
+        static constexpr size_t SpriteGrainSize = 1024;
 
+        // Declared before the registry so that it outlives the TransformComponents that reference it
+        TransformHierarchy m_TransformHierarchy;
         entt::registry m_Registry;
+        SpatialIndex m_SpatialIndex;
+        CollisionSystem m_CollisionSystem;
         entt::entity m_PrimaryCamera;
         float m_Time;
 
@@ -53,6 +102,9 @@ namespace Forge
 
         std::vector<System> m_Systems;
 
+        // Scratch space reused by UpdateAnimators() every frame
+        std::vector<std::pair<AnimatorComponent*, const Skeleton*>> m_Animators;
+
         bool m_DebugDrawColliders;
 
     public:
@@ -85,6 +137,12 @@ namespace Forge
 
         Entity NullEntity();
 
+        // Sprites drawn and their batches as of the last OnUpdate()
+        inline const Renderer2DStats& GetSpriteStats() const
+        {
+            return m_Renderer2D->GetStats();
+        }
+
         inline bool GetDebugRenderColliders() const
         {
             return m_DebugDrawColliders;
@@ -104,11 +162,36 @@ namespace Forge
         {
             return m_Registry;
         }
+        // World matrices are recalculated at the start of OnUpdate(), after the systems have run
+        inline TransformHierarchy& GetTransformHierarchy()
+        {
+            return m_TransformHierarchy;
+        }
+        // Bounds of the enabled renderables, point lights and colliders as of the last OnUpdate()
+        inline const SpatialIndex& GetSpatialIndex() const
+        {
+            return m_SpatialIndex;
+        }
+        // Contact events are triggered from OnUpdate() after the systems have run
+        inline CollisionSystem& GetCollisionSystem()
+        {
+            return m_CollisionSystem;
+        }
 
         void SetPrimaryCamera(const Entity& entity);
         Entity CreateCamera(const Frustum& frustum);
 
+        // Blocks until the pick framebuffer has been read back, see PickEntityAsync()
         PickResult PickEntity(const glm::vec2& viewportCoord, const Entity& camera, PickOptions options = {});
+        // Renders the pick framebuffer immediately but resolves the entity a frame or two later without stalling.
+        // The entity may have been destroyed by the time the request is ready, in which case the result is null
+        Ref<PickRequest> PickEntityAsync(
+          const glm::vec2& viewportCoord, const Entity& camera, PickOptions options = {});
+        // Closest renderable hit by the ray, the coordinate is always included.
+        // Changes since the last OnUpdate() are picked up by updating the transform hierarchy and the spatial index first,
+        // so this must not run concurrently with OnUpdate() or another query on the same scene
+        PickResult RaycastEntity(const Ray& ray, LayerMask layerMask = FULL_LAYER_MASK,
+          float maxDistance = std::numeric_limits<float>::max());
 
         template<typename T>
         void AddSystem(const T& system)
@@ -119,6 +202,16 @@ namespace Forge
         void OnUpdate(Timestep ts);
 
     private:
+        void UpdateSpatialIndex();
+        // Renderables in the camera frustum and anything that can cast a shadow into it
+        void FindVisibleRenderables(const FrustumPlanes& frustum, const std::vector<LightSource>& lightSources,
+          std::vector<entt::entity>& entities) const;
+        // Evaluates every animator pose once per frame across the job system
+        void UpdateAnimators(Timestep ts);
+        // Queues the sprites visible to the layer mask into m_Renderer2D, reading their transforms across the job system
+        void DrawSprites(LayerMask layerMask);
+        const glm::mat4* GetJointTransforms(entt::entity entity) const;
+        Ray CreateCameraRay(const glm::vec2& viewportCoord, const Entity& camera, float& maxDistance) const;
         void FindPrimaryCamera();
         bool CheckLayerMask(entt::entity entity, LayerMask layerMask) const;
         glm::mat4 GenerateProjViewMatrixForLight(const LightSource& light) const;
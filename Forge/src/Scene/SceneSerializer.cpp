@@ -375,6 +375,7 @@ namespace Forge
                     break;
                 case ShaderDataType::Sampler1D:
                 case ShaderDataType::Sampler2D:
+                case ShaderDataType::Sampler2DArray:
                 case ShaderDataType::Sampler3D:
                 case ShaderDataType::SamplerCube:
                 {
@@ -0,0 +1,172 @@
+#include "ForgePch.h"
+#include "SpatialIndex.h"
+
+namespace Forge
+{
+
+    SpatialIndex::SpatialIndex() : m_Categories(), m_Frame(0)
+    {
+    }
+
+    void SpatialIndex::BeginUpdate()
+    {
+        m_Frame++;
+    }
+
+    void SpatialIndex::Update(SpatialCategory category, entt::entity entity, const BoundingBox& bounds)
+    {
+        Category& data = GetCategory(category);
+        uint32_t index = FindProxy(data, entity);
+        if (index == InvalidIndex)
+        {
+            AddProxy(data, entity, 0, nullptr, bounds);
+            return;
+        }
+        data.Proxies[index].UpdatedFrame = m_Frame;
+        SetBounds(data, index, bounds);
+    }
+
+    void SpatialIndex::EndUpdate()
+    {
+        for (Category& data : m_Categories)
+        {
+            if (data.Moved.size() > data.Proxies.size() / RefitFraction)
+            {
+                for (const auto& [node, bounds] : data.Moved)
+                    data.Tree.SetProxyBounds(node, bounds);
+                data.Tree.Refit();
+            }
+            else
+            {
+                for (const auto& [node, bounds] : data.Moved)
+                    data.Tree.MoveProxy(node, bounds);
+            }
+            data.Moved.clear();
+
+            if (data.Retained)
+                continue;
+            uint32_t index = 0;
+            while (index < data.Proxies.size())
+            {
+                if (data.Proxies[index].UpdatedFrame != m_Frame)
+                    RemoveProxy(data, index);
+                else
+                    index++;
+            }
+        }
+    }
+
+    void SpatialIndex::Remove(entt::entity entity)
+    {
+        for (Category& data : m_Categories)
+        {
+            uint32_t index = FindProxy(data, entity);
+            if (index != InvalidIndex)
+                RemoveProxy(data, index);
+        }
+    }
+
+    void SpatialIndex::Remove(SpatialCategory category, entt::entity entity)
+    {
+        Category& data = GetCategory(category);
+        uint32_t index = FindProxy(data, entity);
+        if (index != InvalidIndex)
+            RemoveProxy(data, index);
+    }
+
+    void SpatialIndex::Clear()
+    {
+        for (Category& data : m_Categories)
+        {
+            data.Tree.Clear();
+            data.Proxies.clear();
+            data.ProxyIndices.clear();
+            data.Unbounded.clear();
+            data.Moved.clear();
+        }
+    }
+
+    void SpatialIndex::AddProxy(
+      Category& data, entt::entity entity, uint32_t version, const void* source, const BoundingBox& bounds)
+    {
+        uint32_t index = uint32_t(data.Proxies.size());
+        Proxy proxy;
+        proxy.Entity = entity;
+        proxy.Node = DynamicBvh::NullNode;
+        proxy.Source = source;
+        proxy.Version = version;
+        proxy.UpdatedFrame = m_Frame;
+        if (bounds.IsValid())
+            proxy.Node = data.Tree.CreateProxy(bounds, index);
+        else
+            data.Unbounded.insert(entity);
+        data.Proxies.push_back(proxy);
+        SetProxyIndex(data, entity, index);
+    }
+
+    void SpatialIndex::RemoveProxy(Category& data, uint32_t index)
+    {
+        Proxy& proxy = data.Proxies[index];
+        if (proxy.Node != DynamicBvh::NullNode)
+            DestroyNode(data, proxy.Node);
+        else
+            data.Unbounded.erase(proxy.Entity);
+        SetProxyIndex(data, proxy.Entity, InvalidIndex);
+
+        // Swap with the last proxy so that the proxies stay contiguous
+        uint32_t last = uint32_t(data.Proxies.size() - 1);
+        if (index != last)
+        {
+            proxy = data.Proxies[last];
+            SetProxyIndex(data, proxy.Entity, index);
+            if (proxy.Node != DynamicBvh::NullNode)
+                data.Tree.SetUserData(proxy.Node, index);
+        }
+        data.Proxies.pop_back();
+    }
+
+    void SpatialIndex::SetProxyIndex(Category& data, entt::entity entity, uint32_t index)
+    {
+        uint32_t entityIndex = Entities::GetIndex(entity);
+        if (entityIndex >= data.ProxyIndices.size())
+            data.ProxyIndices.resize(entityIndex + 1, InvalidIndex);
+        data.ProxyIndices[entityIndex] = index;
+    }
+
+    void SpatialIndex::SetBounds(Category& data, uint32_t index, const BoundingBox& bounds)
+    {
+        Proxy& proxy = data.Proxies[index];
+        if (!bounds.IsValid())
+        {
+            if (proxy.Node != DynamicBvh::NullNode)
+            {
+                DestroyNode(data, proxy.Node);
+                proxy.Node = DynamicBvh::NullNode;
+                data.Unbounded.insert(proxy.Entity);
+            }
+        }
+        else if (proxy.Node == DynamicBvh::NullNode)
+        {
+            proxy.Node = data.Tree.CreateProxy(bounds, index);
+            data.Unbounded.erase(proxy.Entity);
+        }
+        else
+        {
+            // Applied in EndUpdate() once it is known how much of the tree has moved
+            data.Moved.push_back({proxy.Node, bounds});
+        }
+    }
+
+    void SpatialIndex::DestroyNode(Category& data, int32_t node)
+    {
+        // A move queued earlier in the same update must not be applied to the freed node, or to the proxy that reuses it
+        if (!data.Moved.empty())
+        {
+            data.Moved.erase(std::remove_if(data.Moved.begin(), data.Moved.end(),
+                               [node](const std::pair<int32_t, BoundingBox>& moved) { return moved.first == node; }),
+              data.Moved.end());
+        }
+        data.Tree.DestroyProxy(node);
+    }
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "Math/DynamicBvh.h"
+#include "EntityUtils.h"
+
+#include <entt/entt.hpp>
+#include <limits>
+#include <unordered_set>
+
+namespace Forge
+{
+
+    enum class SpatialCategory : uint8_t
+    {
+        Renderable,
+        Light,
+        Collider,
+    };
+
+    constexpr size_t SpatialCategoryCount = 3;
+
+    // World space bounds of the entities in a scene, kept in one DynamicBvh per category.
+    // Entities are updated between BeginUpdate() and EndUpdate(), and any entity that was not updated is removed unless its
+    // category is retained. Entities with invalid bounds are returned by every query
+    class FORGE_API SpatialIndex
+    {
+    private:
+        // Switch from reinserting moved proxies to refitting the whole tree once more than 1 / RefitFraction move
+        static constexpr uint32_t RefitFraction = 16;
+        static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        struct FORGE_API Proxy
+        {
+        public:
+            entt::entity Entity;
+            int32_t Node;
+            const void* Source;
+            uint32_t Version;
+            uint32_t UpdatedFrame;
+        };
+
+        struct FORGE_API Category
+        {
+        public:
+            DynamicBvh Tree;
+            std::vector<Proxy> Proxies;
+            // Indexed by Entities::GetIndex()
+            std::vector<uint32_t> ProxyIndices;
+            std::unordered_set<entt::entity> Unbounded;
+            std::vector<std::pair<int32_t, BoundingBox>> Moved;
+            bool Retained;
+        };
+
+        Category m_Categories[SpatialCategoryCount];
+        uint32_t m_Frame;
+
+    public:
+        SpatialIndex();
+
+        inline uint32_t GetEntityCount(SpatialCategory category) const
+        {
+            return uint32_t(GetCategory(category).Proxies.size());
+        }
+
+        // Entities of a retained category are only updated when they change and stay until they are removed
+        inline void SetRetained(SpatialCategory category, bool retained)
+        {
+            GetCategory(category).Retained = retained;
+        }
+
+        void BeginUpdate();
+        // calculateBounds() is only called if the entity is new or version/source changed since the last update,
+        // e.g. the frame its transform last changed and the model it renders
+        template<typename Func>
+        void Update(SpatialCategory category, entt::entity entity, uint32_t version, const void* source,
+          const Func& calculateBounds)
+        {
+            Category& data = GetCategory(category);
+            uint32_t index = FindProxy(data, entity);
+            if (index == InvalidIndex)
+            {
+                AddProxy(data, entity, version, source, calculateBounds());
+                return;
+            }
+            Proxy& proxy = data.Proxies[index];
+            proxy.UpdatedFrame = m_Frame;
+            if (proxy.Version != version || proxy.Source != source)
+            {
+                proxy.Version = version;
+                proxy.Source = source;
+                SetBounds(data, index, calculateBounds());
+            }
+        }
+        // Always recalculated, for cheap bounds that depend on component data
+        void Update(SpatialCategory category, entt::entity entity, const BoundingBox& bounds);
+        void EndUpdate();
+        void Remove(entt::entity entity);
+        void Remove(SpatialCategory category, entt::entity entity);
+        void Clear();
+
+        template<typename Callback>
+        void QueryFrustum(SpatialCategory category, const FrustumPlanes& frustum, const Callback& callback) const
+        {
+            const Category& data = GetCategory(category);
+            ForEachUnbounded(data, callback);
+            data.Tree.QueryFrustum(
+              frustum, [&data, &callback](uint32_t index) { callback(data.Proxies[index].Entity); });
+        }
+
+        template<typename Callback>
+        void QuerySphere(
+          SpatialCategory category, const glm::vec3& center, float radius, const Callback& callback) const
+        {
+            const Category& data = GetCategory(category);
+            ForEachUnbounded(data, callback);
+            data.Tree.QuerySphere(
+              center, radius, [&data, &callback](uint32_t index) { callback(data.Proxies[index].Entity); });
+        }
+
+        template<typename Callback>
+        void QueryBox(SpatialCategory category, const BoundingBox& box, const Callback& callback) const
+        {
+            const Category& data = GetCategory(category);
+            ForEachUnbounded(data, callback);
+            data.Tree.QueryBox(box, [&data, &callback](uint32_t index) { callback(data.Proxies[index].Entity); });
+        }
+
+        // callback(entity, maxDistance) returns the new maximum distance, see DynamicBvh::Raycast()
+        // Unbounded entities are tested first and can clip the ray before the tree is traversed
+        template<typename Callback>
+        void Raycast(SpatialCategory category, const Ray& ray, float maxDistance, const Callback& callback) const
+        {
+            const Category& data = GetCategory(category);
+            for (entt::entity entity : data.Unbounded)
+            {
+                maxDistance = callback(entity, maxDistance);
+                if (maxDistance <= 0.0f)
+                    return;
+            }
+            data.Tree.Raycast(ray, maxDistance, [&data, &callback](uint32_t index, float distance) {
+                return callback(data.Proxies[index].Entity, distance);
+            });
+        }
+
+    private:
+        inline Category& GetCategory(SpatialCategory category)
+        {
+            return m_Categories[size_t(category)];
+        }
+        inline const Category& GetCategory(SpatialCategory category) const
+        {
+            return m_Categories[size_t(category)];
+        }
+
+        template<typename Callback>
+        static void ForEachUnbounded(const Category& data, const Callback& callback)
+        {
+            for (entt::entity entity : data.Unbounded)
+                callback(entity);
+        }
+
+        static inline uint32_t FindProxy(const Category& data, entt::entity entity)
+        {
+            uint32_t entityIndex = Entities::GetIndex(entity);
+            if (entityIndex >= data.ProxyIndices.size())
+                return InvalidIndex;
+            uint32_t index = data.ProxyIndices[entityIndex];
+            // The identifier may belong to an older version of the entity
+            if (index == InvalidIndex || data.Proxies[index].Entity != entity)
+                return InvalidIndex;
+            return index;
+        }
+        static void SetProxyIndex(Category& data, entt::entity entity, uint32_t index);
+
+        void AddProxy(
+          Category& data, entt::entity entity, uint32_t version, const void* source, const BoundingBox& bounds);
+        void RemoveProxy(Category& data, uint32_t index);
+        void SetBounds(Category& data, uint32_t index, const BoundingBox& bounds);
+        static void DestroyNode(Category& data, int32_t node);
+    };
+
+}
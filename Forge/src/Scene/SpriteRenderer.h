@@ -1,6 +1,8 @@
 #pragma once
 #include "Renderer/Texture.h"
 
+#include <glm/glm.hpp>
+
 namespace Forge
 {
 
@@ -9,6 +11,10 @@ namespace Forge
 	public:
 		Forge::Color Color;
 		Ref<Texture2D> Texture = nullptr;
+		// Minimum and maximum texture coordinates of the part of the texture drawn
+		glm::vec4 UvRect = { 0.0f, 0.0f, 1.0f, 1.0f };
+		// Sprites are drawn in increasing sort layer
+		int SortLayer = 0;
 
 	public:
 		SpriteRendererComponent() = default;
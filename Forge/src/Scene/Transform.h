@@ -7,6 +7,7 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "Math/Math.h"
+#include "TransformHierarchy.h"
 
 namespace Forge
 {
@@ -17,33 +18,17 @@ namespace Forge
         Local,
     };
 
+    // View over a node in the TransformHierarchy of a Scene, which stores the transform data and updates world matrices
     class FORGE_API TransformComponent
     {
     private:
-        glm::vec3 m_Position;
-        glm::quat m_Rotation;
-        glm::vec3 m_Scale;
-
-        mutable bool m_Dirty;
-        mutable glm::mat4 m_CacheTransform;
-        mutable glm::mat4 m_CacheInvTransform;
-
-        bool m_Flip = false;
-
-        mutable const TransformComponent* m_Parent;
-        mutable std::vector<const TransformComponent*> m_Children;
+        TransformHierarchy* m_Hierarchy;
+        TransformId m_Id;
 
     public:
-        inline TransformComponent(const glm::vec3& position = {0, 0, 0},
+        inline TransformComponent(TransformHierarchy& hierarchy, const glm::vec3& position = {0, 0, 0},
           const glm::quat& rotation = {1.0f, 0.0f, 0.0f, 0.0f}, const glm::vec3& scale = {1.0f, 1.0f, 1.0f})
-            : m_Position(position),
-              m_Rotation(rotation),
-              m_Scale(scale),
-              m_Dirty(true),
-              m_CacheTransform(),
-              m_CacheInvTransform(),
-              m_Parent(nullptr),
-              m_Children()
+            : m_Hierarchy(&hierarchy), m_Id(hierarchy.Create(this, position, rotation, scale))
         {
         }
 
@@ -51,129 +36,101 @@ namespace Forge
         TransformComponent& operator=(const TransformComponent& other) = delete;
 
         inline TransformComponent(TransformComponent&& other)
-            : m_Position(other.m_Position),
-              m_Rotation(other.m_Rotation),
-              m_Scale(other.m_Scale),
-              m_Dirty(other.m_Dirty),
-              m_CacheTransform(std::move(other.m_CacheTransform)),
-              m_CacheInvTransform(std::move(other.m_CacheInvTransform)),
-              m_Parent(nullptr),
-              m_Children()
+            : m_Hierarchy(other.m_Hierarchy), m_Id(other.m_Id)
         {
-            if (&other != this)
-            {
-                m_Parent = other.m_Parent;
-                m_Children = std::move(other.m_Children);
-                FilterChildren(m_Children);
-                m_Parent = nullptr;
-                const TransformComponent* parent = other.m_Parent;
-                other.SetParent(nullptr);
-                other.m_Children = {};
-                SetParent(parent);
-                for (const TransformComponent* child : m_Children)
-                    child->m_Parent = this;
-            }
+            other.m_Id = InvalidTransformId;
+            if (m_Id != InvalidTransformId)
+                GetHierarchy().SetOwner(m_Id, this);
         }
 
         inline TransformComponent& operator=(TransformComponent&& other)
         {
             if (&other != this)
             {
-                m_Position = other.m_Position;
-                m_Rotation = other.m_Rotation;
-                m_Scale = other.m_Scale;
-                m_Dirty = other.m_Dirty;
-                m_CacheTransform = std::move(other.m_CacheTransform);
-                m_CacheInvTransform = std::move(other.m_CacheInvTransform);
-                m_Children = std::move(other.m_Children);
-                FilterChildren(m_Children);
-
-                const TransformComponent* parent = other.m_Parent;
-                other.SetParent(nullptr);
-                other.m_Children = {};
-                SetParent(parent);
-                for (const TransformComponent* child : m_Children)
-                    child->m_Parent = this;
+                if (m_Id != InvalidTransformId)
+                    GetHierarchy().Destroy(m_Id);
+                m_Hierarchy = other.m_Hierarchy;
+                m_Id = other.m_Id;
+                other.m_Id = InvalidTransformId;
+                if (m_Id != InvalidTransformId)
+                    GetHierarchy().SetOwner(m_Id, this);
             }
             return *this;
         }
 
         inline ~TransformComponent()
         {
-            for (const TransformComponent* child : m_Children)
-            {
-                child->m_Parent = nullptr;
-                child->SetDirty();
-            }
-            m_Children.clear();
-            SetParent(nullptr);
+            if (m_Id != InvalidTransformId)
+                GetHierarchy().Destroy(m_Id);
+        }
+
+        inline TransformId GetId() const
+        {
+            return m_Id;
+        }
+        // Value of the hierarchy's update counter during the last Update() that changed the world matrix
+        inline uint32_t GetChangedFrame() const
+        {
+            return GetHierarchy().GetChangedFrame(m_Id);
         }
 
         inline bool HasParent() const
         {
-            return m_Parent != nullptr;
+            return GetHierarchy().GetParent(m_Id) != InvalidTransformId;
         }
         inline const TransformComponent* GetParent() const
         {
-            return m_Parent;
+            return GetHierarchy().GetOwner(GetHierarchy().GetParent(m_Id));
         }
-        inline const std::vector<const TransformComponent*> GetChildren() const
+        inline std::vector<const TransformComponent*> GetChildren() const
         {
-            return m_Children;
+            const TransformHierarchy& hierarchy = GetHierarchy();
+            std::vector<const TransformComponent*> children;
+            for (TransformId child = hierarchy.GetFirstChild(m_Id); child != InvalidTransformId;
+                 child = hierarchy.GetNextSibling(child))
+                children.push_back(hierarchy.GetOwner(child));
+            return children;
         }
 
         inline void SetParent(const TransformComponent* parent)
         {
-            if (parent != m_Parent && parent != this)
+            if (parent != this)
             {
-                if (m_Parent)
-                {
-                    auto it = std::find(m_Parent->m_Children.begin(), m_Parent->m_Children.end(), this);
-                    if (it != m_Parent->m_Children.end())
-                        m_Parent->m_Children.erase(it);
-                }
-                m_Parent = parent;
-                if (m_Parent)
-                {
-                    m_Parent->m_Children.push_back(this);
-                }
-                SetDirty();
+                FORGE_ASSERT(parent == nullptr || parent->m_Hierarchy == m_Hierarchy, "Transforms belong to different scenes");
+                if (!GetHierarchy().SetParent(m_Id, parent ? parent->m_Id : InvalidTransformId))
+                    FORGE_WARN("Cannot parent a transform to one of its children");
             }
         }
 
         inline const glm::vec3& GetLocalPosition() const
         {
-            return m_Position;
+            return GetHierarchy().GetLocalPosition(m_Id);
         }
         inline const glm::quat& GetLocalRotation() const
         {
-            return m_Rotation;
+            return GetHierarchy().GetLocalRotation(m_Id);
         }
         inline const glm::vec3& GetLocalScale() const
         {
-            return m_Scale;
+            return GetHierarchy().GetLocalScale(m_Id);
         }
 
-        inline const glm::mat4& GetLocalMatrix() const
+        inline glm::mat4 GetLocalMatrix() const
         {
-            RecalculateMatrices();
-            return m_CacheTransform;
+            return GetHierarchy().GetLocalMatrix(m_Id);
         }
-        inline const glm::mat4& GetLocalInverseMatrix() const
+        inline glm::mat4 GetLocalInverseMatrix() const
         {
-            RecalculateMatrices();
-            return m_CacheInvTransform;
+            return GetHierarchy().GetLocalInverseMatrix(m_Id);
         }
 
         inline glm::mat4 GetMatrix() const
         {
-            RecalculateMatrices();
-            return m_Parent ? m_Parent->GetMatrix() * m_CacheTransform : m_CacheTransform;
+            return GetHierarchy().GetWorldMatrix(m_Id);
         }
         inline glm::mat4 GetInverseMatrix() const
         {
-            RecalculateMatrices();
-            return m_Parent ? m_CacheInvTransform * m_Parent->GetInverseMatrix() : m_CacheInvTransform;
+            return GetHierarchy().GetInverseWorldMatrix(m_Id);
         }
 
         inline glm::vec3 GetPosition() const
@@ -182,29 +139,28 @@ namespace Forge
         }
         inline glm::quat GetRotation() const
         {
-            return m_Parent ? m_Parent->GetRotation() * GetLocalRotation() : GetLocalRotation();
+            const TransformComponent* parent = GetParent();
+            return parent ? parent->GetRotation() * GetLocalRotation() : GetLocalRotation();
         }
         inline glm::vec3 GetScale() const
         {
-            return m_Parent ? m_Parent->GetScale() * GetLocalScale() : GetLocalScale();
+            const TransformComponent* parent = GetParent();
+            return parent ? parent->GetScale() * GetLocalScale() : GetLocalScale();
         }
 
         inline void SetLocalPosition(const glm::vec3& position)
         {
-            m_Position = position;
-            SetDirty();
+            GetHierarchy().SetLocalPosition(m_Id, position);
         }
 
         inline void SetLocalRotation(const glm::quat& rotation)
         {
-            m_Rotation = rotation;
-            SetDirty();
+            GetHierarchy().SetLocalRotation(m_Id, rotation);
         }
 
         inline void SetLocalScale(const glm::vec3& scale)
         {
-            m_Scale = scale;
-            SetDirty();
+            GetHierarchy().SetLocalScale(m_Id, scale);
         }
 
         inline glm::vec3 GetLocalForward() const
@@ -280,86 +236,47 @@ namespace Forge
             glm::vec3 translation;
             if (Math::DecomposeTransform(matrix, translation, rotation, scale))
             {
-                m_Position = translation;
-                m_Rotation = glm::normalize(rotation);
-                m_Scale = scale;
-                SetDirty();
+                SetLocalPosition(translation);
+                SetLocalRotation(glm::normalize(rotation));
+                SetLocalScale(scale);
             }
         }
 
         inline void FlipX()
         {
-            m_Flip = true;
-            SetDirty();
+            GetHierarchy().SetFlipped(m_Id, true);
         }
 
         inline TransformComponent Clone() const
         {
-            TransformComponent result;
-            result.m_Position = m_Position;
-            result.m_Rotation = m_Rotation;
-            result.m_Scale = m_Scale;
-            result.m_Dirty = m_Dirty;
-            result.m_CacheTransform = m_CacheTransform;
-            result.m_CacheInvTransform = m_CacheInvTransform;
-            result.SetParent(m_Parent);
+            TransformComponent result(GetHierarchy(), GetLocalPosition(), GetLocalRotation(), GetLocalScale());
+            if (GetHierarchy().IsFlipped(m_Id))
+                result.FlipX();
+            result.SetParent(GetParent());
             return result;
         }
 
         inline void SetFromTransform(const TransformComponent& other)
         {
-            m_Position = other.m_Position;
-            m_Rotation = other.m_Rotation;
-            m_Scale = other.m_Scale;
-            m_Dirty = other.m_Dirty;
-            m_CacheTransform = other.m_CacheTransform;
-            m_CacheInvTransform = other.m_CacheInvTransform;
-            SetParent(other.m_Parent);
+            SetLocalPosition(other.GetLocalPosition());
+            SetLocalRotation(other.GetLocalRotation());
+            SetLocalScale(other.GetLocalScale());
+            GetHierarchy().SetFlipped(m_Id, other.GetHierarchy().IsFlipped(other.m_Id));
+            SetParent(other.GetParent());
         }
 
     private:
-        inline glm::mat4 GetParentMatrix() const
-        {
-            if (m_Parent)
-                return m_Parent->GetMatrix();
-            return glm::mat4(1.0f);
-        }
-
-        inline void RecalculateMatrices() const
+        inline TransformHierarchy& GetHierarchy() const
         {
-            if (m_Dirty)
-            {
-                m_CacheTransform = glm::translate(glm::mat4(1.0f), m_Position) * GetRotationMatrix() *
-                                   glm::scale(glm::mat4(1.0f), m_Scale);
-                m_CacheInvTransform = glm::inverse(m_CacheTransform);
-                m_Dirty = false;
-            }
+            return *m_Hierarchy;
         }
 
-        inline glm::mat4 GetRotationMatrix() const
-        {
-            glm::mat4 matrix = glm::toMat4(m_Rotation);
-            if (m_Flip)
-            {
-                glm::mat4 flip = glm::scale(glm::mat4(1.0f), glm::vec3 {1.0f, -1.0f, 1.0f});
-                matrix = flip * matrix * flip;
-            }
-            return matrix;
-        }
-
-        inline void SetDirty() const
-        {
-            m_Dirty = true;
-            for (const TransformComponent* child : m_Children)
-                child->SetDirty();
-        }
-
-        inline void FilterChildren(std::vector<const TransformComponent*>& children) const
+        inline glm::mat4 GetParentMatrix() const
         {
-            children.erase(
-              std::remove_if(
-                children.begin(), children.end(), [this](const TransformComponent* child) { return child == this; }),
-              children.end());
+            const TransformComponent* parent = GetParent();
+            if (parent)
+                return parent->GetMatrix();
+            return glm::mat4(1.0f);
         }
     };
 
@@ -0,0 +1,337 @@
+#include "ForgePch.h"
+#include "TransformHierarchy.h"
+#include "Core/JobSystem.h"
+
+namespace Forge
+{
+
+    TransformHierarchy::TransformHierarchy()
+        : m_Indices(),
+          m_ParentIds(),
+          m_FirstChildIds(),
+          m_LastChildIds(),
+          m_NextSiblingIds(),
+          m_PreviousSiblingIds(),
+          m_Owners(),
+          m_FreeIds(),
+          m_DenseIds(),
+          m_ParentIndices(),
+          m_Positions(),
+          m_Rotations(),
+          m_Scales(),
+          m_Flip(),
+          m_LocalDirty(),
+          m_ChangedFrames(),
+          m_LocalMatrices(),
+          m_WorldMatrices(),
+          m_InverseWorldMatrices(),
+          m_LevelOffsets({0}),
+          m_Order(),
+          m_NodeCount(0),
+          m_OrderDirty(false),
+          m_PendingChanges(0),
+          m_Frame(0)
+    {
+    }
+
+    TransformId TransformHierarchy::Create(
+      const TransformComponent* owner, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        TransformId id;
+        if (!m_FreeIds.empty())
+        {
+            id = m_FreeIds.back();
+            m_FreeIds.pop_back();
+        }
+        else
+        {
+            id = TransformId(m_Indices.size());
+            m_Indices.push_back(InvalidIndex);
+            m_ParentIds.push_back(InvalidTransformId);
+            m_FirstChildIds.push_back(InvalidTransformId);
+            m_LastChildIds.push_back(InvalidTransformId);
+            m_NextSiblingIds.push_back(InvalidTransformId);
+            m_PreviousSiblingIds.push_back(InvalidTransformId);
+            m_Owners.push_back(nullptr);
+        }
+        m_ParentIds[id] = InvalidTransformId;
+        m_FirstChildIds[id] = InvalidTransformId;
+        m_LastChildIds[id] = InvalidTransformId;
+        m_NextSiblingIds[id] = InvalidTransformId;
+        m_PreviousSiblingIds[id] = InvalidTransformId;
+        m_Owners[id] = owner;
+
+        // New nodes are roots, appending keeps the depth order unless deeper levels exist
+        uint32_t index = uint32_t(m_DenseIds.size());
+        m_Indices[id] = index;
+        m_DenseIds.push_back(id);
+        m_ParentIndices.push_back(InvalidIndex);
+        m_Positions.push_back(position);
+        m_Rotations.push_back(rotation);
+        m_Scales.push_back(scale);
+        m_Flip.push_back(false);
+        m_LocalDirty.push_back(false);
+        m_ChangedFrames.push_back(0);
+        m_LocalMatrices.emplace_back(1.0f);
+        m_WorldMatrices.emplace_back(1.0f);
+        m_InverseWorldMatrices.emplace_back(1.0f);
+        if (m_LevelOffsets.size() > 2)
+            m_OrderDirty = true;
+        else
+            m_LevelOffsets = {0, index + 1};
+        m_NodeCount++;
+        SetDirty(index);
+        return id;
+    }
+
+    void TransformHierarchy::Destroy(TransformId id)
+    {
+        Unlink(id);
+        TransformId child = m_FirstChildIds[id];
+        while (child != InvalidTransformId)
+        {
+            TransformId next = m_NextSiblingIds[child];
+            m_ParentIds[child] = InvalidTransformId;
+            m_NextSiblingIds[child] = InvalidTransformId;
+            m_PreviousSiblingIds[child] = InvalidTransformId;
+            SetDirty(m_Indices[child]);
+            child = next;
+        }
+        m_DenseIds[m_Indices[id]] = InvalidTransformId;
+        m_Indices[id] = InvalidIndex;
+        m_Owners[id] = nullptr;
+        m_FreeIds.push_back(id);
+        m_NodeCount--;
+        m_OrderDirty = true;
+    }
+
+    bool TransformHierarchy::SetParent(TransformId id, TransformId parent)
+    {
+        if (m_ParentIds[id] == parent)
+            return true;
+        for (TransformId ancestor = parent; ancestor != InvalidTransformId; ancestor = m_ParentIds[ancestor])
+        {
+            if (ancestor == id)
+                return false;
+        }
+        Unlink(id);
+        m_ParentIds[id] = parent;
+        if (parent != InvalidTransformId)
+        {
+            m_PreviousSiblingIds[id] = m_LastChildIds[parent];
+            if (m_LastChildIds[parent] != InvalidTransformId)
+                m_NextSiblingIds[m_LastChildIds[parent]] = id;
+            else
+                m_FirstChildIds[parent] = id;
+            m_LastChildIds[parent] = id;
+        }
+        SetDirty(m_Indices[id]);
+        m_OrderDirty = true;
+        return true;
+    }
+
+    glm::mat4 TransformHierarchy::GetLocalMatrix(TransformId id) const
+    {
+        uint32_t index = m_Indices[id];
+        return m_LocalDirty[index] ? CalculateLocalMatrix(index) : m_LocalMatrices[index];
+    }
+
+    glm::mat4 TransformHierarchy::GetLocalInverseMatrix(TransformId id) const
+    {
+        return CalculateLocalInverseMatrix(m_Indices[id]);
+    }
+
+    glm::mat4 TransformHierarchy::GetWorldMatrix(TransformId id) const
+    {
+        TransformId highestChanged = m_PendingChanges == 0 ? InvalidTransformId : FindHighestChanged(id);
+        if (highestChanged == InvalidTransformId)
+            return m_WorldMatrices[m_Indices[id]];
+        return CalculateWorldMatrix(id, highestChanged);
+    }
+
+    glm::mat4 TransformHierarchy::GetInverseWorldMatrix(TransformId id) const
+    {
+        TransformId highestChanged = m_PendingChanges == 0 ? InvalidTransformId : FindHighestChanged(id);
+        if (highestChanged == InvalidTransformId)
+            return m_InverseWorldMatrices[m_Indices[id]];
+        return CalculateInverseWorldMatrix(id, highestChanged);
+    }
+
+    void TransformHierarchy::Update()
+    {
+        if (m_OrderDirty)
+            Reorder();
+        if (m_PendingChanges == 0)
+            return;
+        m_Frame++;
+        JobSystem& jobs = JobSystem::Get();
+        for (size_t level = 0; level + 1 < m_LevelOffsets.size(); level++)
+        {
+            // Nodes in a level only read their parent, which is in an earlier level
+            uint32_t levelBegin = m_LevelOffsets[level];
+            jobs.ParallelFor(m_LevelOffsets[level + 1] - levelBegin, UpdateGrainSize, [this, levelBegin](size_t begin, size_t end) {
+                UpdateRange(levelBegin + uint32_t(begin), levelBegin + uint32_t(end));
+            });
+        }
+        m_PendingChanges = 0;
+    }
+
+    void TransformHierarchy::Unlink(TransformId id)
+    {
+        TransformId parent = m_ParentIds[id];
+        if (parent == InvalidTransformId)
+            return;
+        TransformId previous = m_PreviousSiblingIds[id];
+        TransformId next = m_NextSiblingIds[id];
+        if (previous != InvalidTransformId)
+            m_NextSiblingIds[previous] = next;
+        else
+            m_FirstChildIds[parent] = next;
+        if (next != InvalidTransformId)
+            m_PreviousSiblingIds[next] = previous;
+        else
+            m_LastChildIds[parent] = previous;
+        m_ParentIds[id] = InvalidTransformId;
+        m_NextSiblingIds[id] = InvalidTransformId;
+        m_PreviousSiblingIds[id] = InvalidTransformId;
+        m_OrderDirty = true;
+    }
+
+    void TransformHierarchy::Reorder()
+    {
+        // Breadth first from the roots (in their current order) sorts nodes by depth
+        m_Order.clear();
+        for (TransformId id : m_DenseIds)
+        {
+            if (id != InvalidTransformId && m_ParentIds[id] == InvalidTransformId)
+                m_Order.push_back(id);
+        }
+        m_LevelOffsets = {0};
+        size_t levelBegin = 0;
+        while (levelBegin < m_Order.size())
+        {
+            size_t levelEnd = m_Order.size();
+            m_LevelOffsets.push_back(uint32_t(levelEnd));
+            for (size_t i = levelBegin; i < levelEnd; i++)
+            {
+                for (TransformId child = m_FirstChildIds[m_Order[i]]; child != InvalidTransformId; child = m_NextSiblingIds[child])
+                    m_Order.push_back(child);
+            }
+            levelBegin = levelEnd;
+        }
+        FORGE_ASSERT(m_Order.size() == GetNodeCount(), "Transform hierarchy contains a cycle");
+
+        auto permute = [this](auto& values) {
+            std::remove_reference_t<decltype(values)> result;
+            result.reserve(m_Order.size());
+            for (TransformId id : m_Order)
+                result.push_back(values[m_Indices[id]]);
+            values = std::move(result);
+        };
+        permute(m_Positions);
+        permute(m_Rotations);
+        permute(m_Scales);
+        permute(m_Flip);
+        permute(m_LocalDirty);
+        permute(m_ChangedFrames);
+        permute(m_LocalMatrices);
+        permute(m_WorldMatrices);
+        permute(m_InverseWorldMatrices);
+
+        for (uint32_t index = 0; index < m_Order.size(); index++)
+            m_Indices[m_Order[index]] = index;
+        m_ParentIndices.resize(m_Order.size());
+        for (uint32_t index = 0; index < m_Order.size(); index++)
+        {
+            TransformId parent = m_ParentIds[m_Order[index]];
+            m_ParentIndices[index] = parent == InvalidTransformId ? InvalidIndex : m_Indices[parent];
+        }
+        m_DenseIds.swap(m_Order);
+        m_OrderDirty = false;
+    }
+
+    void TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            uint32_t parent = m_ParentIndices[index];
+            bool parentChanged = parent != InvalidIndex && m_ChangedFrames[parent] == m_Frame;
+            if (m_LocalDirty[index])
+            {
+                m_LocalMatrices[index] = CalculateLocalMatrix(index);
+                m_LocalDirty[index] = false;
+            }
+            else if (!parentChanged)
+            {
+                continue;
+            }
+            glm::mat4 localInverse = CalculateLocalInverseMatrix(index);
+            if (parent == InvalidIndex)
+            {
+                m_WorldMatrices[index] = m_LocalMatrices[index];
+                m_InverseWorldMatrices[index] = localInverse;
+            }
+            else
+            {
+                m_WorldMatrices[index] = m_WorldMatrices[parent] * m_LocalMatrices[index];
+                m_InverseWorldMatrices[index] = localInverse * m_InverseWorldMatrices[parent];
+            }
+            m_ChangedFrames[index] = m_Frame;
+        }
+    }
+
+    TransformId TransformHierarchy::FindHighestChanged(TransformId id) const
+    {
+        // Structural changes mark the moved node as changed, so the cached matrices above the result are still valid
+        TransformId result = InvalidTransformId;
+        for (TransformId node = id; node != InvalidTransformId; node = m_ParentIds[node])
+        {
+            if (m_LocalDirty[m_Indices[node]])
+                result = node;
+        }
+        return result;
+    }
+
+    glm::mat4 TransformHierarchy::CalculateWorldMatrix(TransformId id, TransformId highestChanged) const
+    {
+        glm::mat4 local = GetLocalMatrix(id);
+        TransformId parent = m_ParentIds[id];
+        if (id != highestChanged)
+            return CalculateWorldMatrix(parent, highestChanged) * local;
+        return parent == InvalidTransformId ? local : m_WorldMatrices[m_Indices[parent]] * local;
+    }
+
+    glm::mat4 TransformHierarchy::CalculateInverseWorldMatrix(TransformId id, TransformId highestChanged) const
+    {
+        glm::mat4 localInverse = GetLocalInverseMatrix(id);
+        TransformId parent = m_ParentIds[id];
+        if (id != highestChanged)
+            return localInverse * CalculateInverseWorldMatrix(parent, highestChanged);
+        return parent == InvalidTransformId ? localInverse : localInverse * m_InverseWorldMatrices[m_Indices[parent]];
+    }
+
+    glm::mat4 TransformHierarchy::CalculateRotationMatrix(uint32_t index) const
+    {
+        glm::mat4 rotation = glm::toMat4(m_Rotations[index]);
+        if (m_Flip[index])
+        {
+            glm::mat4 flip = glm::scale(glm::mat4(1.0f), glm::vec3 {1.0f, -1.0f, 1.0f});
+            rotation = flip * rotation * flip;
+        }
+        return rotation;
+    }
+
+    glm::mat4 TransformHierarchy::CalculateLocalMatrix(uint32_t index) const
+    {
+        return glm::translate(glm::mat4(1.0f), m_Positions[index]) * CalculateRotationMatrix(index) *
+               glm::scale(glm::mat4(1.0f), m_Scales[index]);
+    }
+
+    glm::mat4 TransformHierarchy::CalculateLocalInverseMatrix(uint32_t index) const
+    {
+        // (T * R * S)^-1 = S^-1 * R^T * T^-1, the rotation is orthonormal with or without the flip
+        return glm::scale(glm::mat4(1.0f), 1.0f / m_Scales[index]) * glm::transpose(CalculateRotationMatrix(index)) *
+               glm::translate(glm::mat4(1.0f), -m_Positions[index]);
+    }
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "ForgePch.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/quaternion.hpp>
+
+#include <limits>
+
+namespace Forge
+{
+
+    class TransformComponent;
+
+    using TransformId = uint32_t;
+    constexpr TransformId InvalidTransformId = std::numeric_limits<TransformId>::max();
+
+    // Owns the data of the TransformComponents in a Scene.
+    // Local TRS and world matrices are stored in contiguous arrays sorted by hierarchy depth, so every parent is
+    // updated before its children and Update() recalculates all dirty world matrices in one pass per depth level.
+    // Const functions never write, so they can be called from several threads while nothing is modified
+    class FORGE_API TransformHierarchy
+    {
+    private:
+        static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+        // Nodes per job when a depth level is updated in parallel
+        static constexpr size_t UpdateGrainSize = 1024;
+
+        // Indexed by TransformId, only touched by structural changes
+        std::vector<uint32_t> m_Indices;
+        std::vector<TransformId> m_ParentIds;
+        std::vector<TransformId> m_FirstChildIds;
+        std::vector<TransformId> m_LastChildIds;
+        std::vector<TransformId> m_NextSiblingIds;
+        std::vector<TransformId> m_PreviousSiblingIds;
+        std::vector<const TransformComponent*> m_Owners;
+        std::vector<TransformId> m_FreeIds;
+
+        // Indexed by position in depth order
+        std::vector<TransformId> m_DenseIds;
+        std::vector<uint32_t> m_ParentIndices;
+        std::vector<glm::vec3> m_Positions;
+        std::vector<glm::quat> m_Rotations;
+        std::vector<glm::vec3> m_Scales;
+        std::vector<uint8_t> m_Flip;
+        std::vector<uint8_t> m_LocalDirty;
+        std::vector<uint32_t> m_ChangedFrames;
+        std::vector<glm::mat4> m_LocalMatrices;
+        std::vector<glm::mat4> m_WorldMatrices;
+        std::vector<glm::mat4> m_InverseWorldMatrices;
+
+        // Start of each depth level in the dense arrays followed by the end of the last level
+        std::vector<uint32_t> m_LevelOffsets;
+        std::vector<TransformId> m_Order;
+        // Destroyed nodes leave holes in m_DenseIds until the next Reorder(), so live nodes are counted separately
+        uint32_t m_NodeCount;
+        bool m_OrderDirty;
+        uint32_t m_PendingChanges;
+        uint32_t m_Frame;
+
+    public:
+        TransformHierarchy();
+        TransformHierarchy(const TransformHierarchy& other) = delete;
+        TransformHierarchy& operator=(const TransformHierarchy& other) = delete;
+
+        inline size_t GetNodeCount() const { return m_NodeCount; }
+
+        TransformId Create(const TransformComponent* owner, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+        // Children of a destroyed node become roots
+        void Destroy(TransformId id);
+        inline void SetOwner(TransformId id, const TransformComponent* owner) { m_Owners[id] = owner; }
+        inline const TransformComponent* GetOwner(TransformId id) const { return id == InvalidTransformId ? nullptr : m_Owners[id]; }
+
+        inline TransformId GetParent(TransformId id) const { return m_ParentIds[id]; }
+        inline TransformId GetFirstChild(TransformId id) const { return m_FirstChildIds[id]; }
+        inline TransformId GetNextSibling(TransformId id) const { return m_NextSiblingIds[id]; }
+        // Returns false if parent is id or one of its descendants
+        bool SetParent(TransformId id, TransformId parent);
+
+        inline const glm::vec3& GetLocalPosition(TransformId id) const { return m_Positions[m_Indices[id]]; }
+        inline const glm::quat& GetLocalRotation(TransformId id) const { return m_Rotations[m_Indices[id]]; }
+        inline const glm::vec3& GetLocalScale(TransformId id) const { return m_Scales[m_Indices[id]]; }
+        inline bool IsFlipped(TransformId id) const { return m_Flip[m_Indices[id]]; }
+
+        inline void SetLocalPosition(TransformId id, const glm::vec3& position) { uint32_t index = m_Indices[id]; m_Positions[index] = position; SetDirty(index); }
+        inline void SetLocalRotation(TransformId id, const glm::quat& rotation) { uint32_t index = m_Indices[id]; m_Rotations[index] = rotation; SetDirty(index); }
+        inline void SetLocalScale(TransformId id, const glm::vec3& scale) { uint32_t index = m_Indices[id]; m_Scales[index] = scale; SetDirty(index); }
+        inline void SetFlipped(TransformId id, bool flip) { uint32_t index = m_Indices[id]; m_Flip[index] = flip; SetDirty(index); }
+
+        // Value of the update counter during the last Update() that changed the world matrix of id
+        inline uint32_t GetChangedFrame(TransformId id) const { return m_ChangedFrames[m_Indices[id]]; }
+
+        glm::mat4 GetLocalMatrix(TransformId id) const;
+        glm::mat4 GetLocalInverseMatrix(TransformId id) const;
+        // Cached after Update(), nodes that changed since are calculated from the nearest unchanged ancestor
+        glm::mat4 GetWorldMatrix(TransformId id) const;
+        glm::mat4 GetInverseWorldMatrix(TransformId id) const;
+
+        // Recalculates every world matrix affected by changes since the last update
+        void Update();
+
+    private:
+        inline void SetDirty(uint32_t index)
+        {
+            m_LocalDirty[index] = true;
+            m_PendingChanges++;
+        }
+
+        void Unlink(TransformId id);
+        void Reorder();
+        void UpdateRange(uint32_t begin, uint32_t end);
+        // Highest node from id to its root with local changes since the last Update(), invalid if there are none
+        TransformId FindHighestChanged(TransformId id) const;
+        glm::mat4 CalculateWorldMatrix(TransformId id, TransformId highestChanged) const;
+        glm::mat4 CalculateInverseWorldMatrix(TransformId id, TransformId highestChanged) const;
+        glm::mat4 CalculateRotationMatrix(uint32_t index) const;
+        glm::mat4 CalculateLocalMatrix(uint32_t index) const;
+        glm::mat4 CalculateLocalInverseMatrix(uint32_t index) const;
+    };
+
+}
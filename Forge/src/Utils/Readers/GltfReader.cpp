@@ -145,44 +145,27 @@ namespace Forge
         );
     }
 
-    Scope<Joint> ProcessJoint(const tinygltf::Model& model, int nodeIndex, const glm::mat4& parentTransform, const std::unordered_set<int>& jointNodes, const std::vector<int>& jointOrder, std::unordered_map<int, Joint*>& jointsById, int& jointCount)
+    // Depth first, so every joint is added after its parent
+    void ProcessJoint(const tinygltf::Model& model, int nodeIndex, int parentIndex, const std::unordered_set<int>& jointNodes, const std::vector<int>& jointOrder, Skeleton& skeleton)
     {
-        jointCount++;
         const auto& jointData = model.nodes[nodeIndex];
-        Scope<Joint> joint = CreateScope<Joint>();
-        // joint->Transform = parentTransform * CreateMatrix(jointData.matrix, jointData.translation, jointData.rotation, jointData.scale);
         auto it = std::find(jointOrder.begin(), jointOrder.end(), nodeIndex);
         FORGE_ASSERT(it != jointOrder.end(), "Invalid joint");
-        joint->Id = int(it - jointOrder.begin());
-        jointsById[joint->Id] = joint.get();
-        // joint->InverseBindTransform = parentTransform;// *CreateMatrix(jointData.matrix, jointData.translation, jointData.rotation, jointData.scale);
+        int index = skeleton.GetJointCount();
+        skeleton.AddJoint(int(it - jointOrder.begin()), parentIndex, glm::mat4(1.0f));
 
-        for (int index : jointData.children)
+        for (int child : jointData.children)
         {
-            if (jointNodes.find(index) != jointNodes.end())
-                joint->Children.push_back(ProcessJoint(model, index, joint->Transform, jointNodes, jointOrder, jointsById, jointCount));
+            if (jointNodes.find(child) != jointNodes.end())
+                ProcessJoint(model, child, index, jointNodes, jointOrder, skeleton);
         }
-        return joint;
     }
 
-    Scope<Joint> ProcessSkin(const tinygltf::Model& model, const tinygltf::Skin& skin, const std::unordered_set<int>& jointNodes, const std::vector<int>& jointOrder, std::unordered_map<int, Joint*>& jointsById, int& jointCount)
+    Ref<Skeleton> ProcessSkin(const tinygltf::Model& model, const tinygltf::Skin& skin, const std::unordered_set<int>& jointNodes)
     {
-        jointCount = 0;
-        return ProcessJoint(model, skin.skeleton, glm::mat4(1.0f), jointNodes, jointOrder, jointsById, jointCount);
-    }
-
-    void UpdateJointTransforms(Joint* joint, const glm::mat4& parentTransform)
-    {
-        joint->Transform = parentTransform * joint->Transform;
-        for (const auto& child : joint->Children)
-            UpdateJointTransforms(child.get(), joint->Transform);
-    }
-
-    void UpdateJointInverseTransform(Joint* joint, const glm::mat4& parentTransform)
-    {
-        joint->InverseBindTransform = joint->InverseBindTransform * parentTransform;
-        for (const auto& child : joint->Children)
-            UpdateJointInverseTransform(child.get(), joint->InverseBindTransform);
+        Ref<Skeleton> skeleton = CreateRef<Skeleton>();
+        ProcessJoint(model, skin.skeleton, -1, jointNodes, skin.joints, *skeleton);
+        return skeleton;
     }
 
     float GetFloatValue(const tinygltf::Model& model, const tinygltf::Accessor& accessor, int index)
@@ -218,7 +201,15 @@ namespace Forge
         );
     }
 
-    void AddKeyFrame(const tinygltf::Model& model, std::unordered_map<float, AnimationKeyFrame>& keyFrames, const tinygltf::Accessor& timeAccessor, const tinygltf::Accessor& propertyAccessor, const std::string& path, int jointId, int jointCount)
+    // Uncompressed tracks as they appear in the file
+    struct SourceJointAnimation
+    {
+    public:
+        AnimationTrack<glm::vec3> Translation;
+        AnimationTrack<glm::quat> Orientation;
+    };
+
+    void AddChannel(const tinygltf::Model& model, SourceJointAnimation& joint, const tinygltf::Accessor& timeAccessor, const tinygltf::Accessor& propertyAccessor, const std::string& path)
     {
         if (path == "scale" || path == "weights")
         {
@@ -228,31 +219,63 @@ namespace Forge
         for (int i = 0; i < timeAccessor.count; i++)
         {
             float time = GetFloatValue(model, timeAccessor, i);
-            AnimationKeyFrame& frame = keyFrames[time];
-            if (frame.Transforms.empty())
-            {
-                frame.TimeStamp = time;
-                frame.Transforms.resize(jointCount);
-                for (int i = 0; i < jointCount; i++)
-                    frame.Transforms[i] = { glm::vec3{ 0, 0, 0}, glm::quat{ 0, 0, 0, 1.0f } };
-            }
             if (path == "translation")
             {
-                frame.Transforms[jointId].Translation = GetVec3Value(model, propertyAccessor, i);
+                joint.Translation.AddKey(time, GetVec3Value(model, propertyAccessor, i));
             }
             else
             {
-                frame.Transforms[jointId].Orientation = GetQuatValue(model, propertyAccessor, i);
+                joint.Orientation.AddKey(time, GetQuatValue(model, propertyAccessor, i));
             }
         }
     }
 
+    std::vector<uint32_t> ReadIndices(const tinygltf::Model& model, const tinygltf::Accessor& accessor)
+    {
+        const auto& view = model.bufferViews[accessor.bufferView];
+        const unsigned char* data = &model.buffers[view.buffer].data[view.byteOffset + accessor.byteOffset];
+        std::vector<uint32_t> result(accessor.count);
+        for (size_t i = 0; i < accessor.count; i++)
+        {
+            switch (accessor.componentType)
+            {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                result[i] = data[i];
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                result[i] = ((const uint16_t*)data)[i];
+                break;
+            default:
+                result[i] = ((const uint32_t*)data)[i];
+                break;
+            }
+        }
+        return result;
+    }
 
+    // Joints without a channel hold their rest pose
+    void AddRestPose(const tinygltf::Node& node, SourceJointAnimation& joint)
+    {
+        if (joint.Translation.IsEmpty())
+        {
+            glm::vec3 translation = { 0.0f, 0.0f, 0.0f };
+            if (node.translation.size() == 3)
+                translation = { float(node.translation[0]), float(node.translation[1]), float(node.translation[2]) };
+            joint.Translation.AddKey(0.0f, translation);
+        }
+        if (joint.Orientation.IsEmpty())
+        {
+            glm::quat orientation = { 1.0f, 0.0f, 0.0f, 0.0f };
+            if (node.rotation.size() == 4)
+                orientation = glm::quat(float(node.rotation[3]), float(node.rotation[0]), float(node.rotation[1]), float(node.rotation[2]));
+            joint.Orientation.AddKey(0.0f, orientation);
+        }
+    }
 
-    GltfReader::GltfReader(const std::string& filename)
+    GltfReader::GltfReader(const std::string& filename, const AnimationCompressionSettings& compression)
         : m_Meshes()
     {
-        ReadGltf(filename);
+        ReadGltf(filename, compression);
     }
 
     const std::vector<Ref<Mesh>>& GltfReader::GetMeshes() const
@@ -260,7 +283,7 @@ namespace Forge
         return m_Meshes;
     }
 
-    void GltfReader::ReadGltf(const std::string& filename)
+    void GltfReader::ReadGltf(const std::string& filename, const AnimationCompressionSettings& compression)
     {
         tinygltf::Model model;
         tinygltf::TinyGLTF loader;
@@ -346,15 +369,33 @@ namespace Forge
                     Ref<IndexBuffer> ibo = IndexBuffer::Create(indices, sizeof(uint32_t) * indexAccessor.count, GetShaderDataType(indexAccessor.type, indexAccessor.componentType));
                     vao->SetIndexBuffer(ibo);
 
+                    BoundingBox bounds;
+                    BoundingSphere boundingSphere;
+                    Ref<TriangleMesh> triangles;
+                    if (primitive.attributes.find("POSITION") != primitive.attributes.end())
+                    {
+                        const auto& accessor = model.accessors[primitive.attributes.at("POSITION")];
+                        const auto& view = model.bufferViews[accessor.bufferView];
+                        const auto& buffer = model.buffers[view.buffer];
+                        FORGE_ASSERT(accessor.type == TINYGLTF_TYPE_VEC3 && accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT, "Invalid position accessor");
+                        const float* positions = (const float*)&buffer.data[view.byteOffset + accessor.byteOffset];
+                        size_t stride = view.byteStride > 0 ? view.byteStride / sizeof(float) : 3;
+                        bounds = CalculateBoundingBox(positions, accessor.count, stride);
+                        boundingSphere = CalculateBoundingSphere(positions, accessor.count, stride, bounds);
+                        if (primitive.mode == TINYGLTF_MODE_TRIANGLES)
+                        {
+                            std::vector<uint32_t> triangleIndices = ReadIndices(model, indexAccessor);
+                            triangles = TriangleMesh::Create(positions, accessor.count, stride, triangleIndices.data(), triangleIndices.size());
+                        }
+                    }
+
                     // Skeleton
                     if (node.skin >= 0)
                     {
                         const auto& skin = model.skins[node.skin];
-                        int jointCount = 0;
                         if (jointNodes.find(skin.skeleton) != jointNodes.end())
                         {
-                            std::unordered_map<int, Joint*> jointsById;
-                            Scope<Joint> joint = ProcessSkin(model, skin, jointNodes, skin.joints, jointsById, jointCount);
+                            Ref<Skeleton> skeleton = ProcessSkin(model, skin, jointNodes);
 
                             for (int i = 0; i < skin.joints.size(); i++)
                             {
@@ -364,22 +405,23 @@ namespace Forge
                             if (skin.inverseBindMatrices >= 0)
                             {
                                 const auto& accessor = model.accessors[skin.inverseBindMatrices];
-                                FORGE_ASSERT(accessor.count == jointCount && accessor.type == TINYGLTF_TYPE_MAT4, "Invalid");
-                                for (int i = 0; i < skin.joints.size(); i++)
+                                FORGE_ASSERT(accessor.count == skeleton->GetJointCount() && accessor.type == TINYGLTF_TYPE_MAT4, "Invalid");
+                                for (int i = 0; i < skeleton->GetJointCount(); i++)
                                 {
-                                    Joint* target = jointsById.at(i);
-                                    target->InverseBindTransform = CreateMatrix(model, accessor, i);
+                                    skeleton->InverseBindTransforms[i] = CreateMatrix(model, accessor, skeleton->JointIds[i]);
                                 }
                             }
 
-                            // UpdateJointTransforms(joint.get(), glm::mat4(1.0f));
-                            // UpdateJointInverseTransform(joint.get(), glm::mat4(1.0f));
-
-                            m_Meshes.push_back(CreateRef<AnimatedMesh>(vao, CreateRef<Skeleton>(std::move(joint), jointCount)));
+                            // Bounds are taken from the bind pose
+                            m_Meshes.push_back(CreateRef<AnimatedMesh>(vao, skeleton));
+                            m_Meshes.back()->SetBounds(bounds, boundingSphere);
+                            m_Meshes.back()->SetTriangles(triangles);
                             continue;
                         }
                     }
                     m_Meshes.push_back(CreateRef<Mesh>(vao));
+                    m_Meshes.back()->SetBounds(bounds, boundingSphere);
+                    m_Meshes.back()->SetTriangles(triangles);
                 }
             }
         }
@@ -387,25 +429,27 @@ namespace Forge
         // Animations
         for (const auto& animation : model.animations)
         {
-            Ref<Animation> anim = CreateRef<Animation>();
-            std::unordered_map<float, AnimationKeyFrame> keyFrames;
+            std::vector<SourceJointAnimation> joints(nodeIndexToJointId.size());
             for (const auto& channel : animation.channels)
             {
                 const auto& sampler = animation.samplers[channel.sampler];
                 const auto& timeAccessor = model.accessors[sampler.input];
                 const auto& propertyAccessor = model.accessors[sampler.output];
-                AddKeyFrame(model, keyFrames, timeAccessor, propertyAccessor, channel.target_path, nodeIndexToJointId.at(channel.target_node), nodeIndexToJointId.size());
+                AddChannel(model, joints[nodeIndexToJointId.at(channel.target_node)], timeAccessor, propertyAccessor, channel.target_path);
             }
 
-            for (const auto& frame : keyFrames)
+            for (const auto& [nodeIndex, jointId] : nodeIndexToJointId)
             {
-                anim->KeyFrames.push_back(frame.second);
+                AddRestPose(model.nodes[nodeIndex], joints[jointId]);
             }
-            anim->KeyFrames.resize(2);
-            std::sort(anim->KeyFrames.begin(), anim->KeyFrames.end(), [](const AnimationKeyFrame& a, const AnimationKeyFrame& b)
+
+            Ref<Animation> anim = CreateRef<Animation>();
+            anim->Joints.resize(joints.size());
+            for (size_t i = 0; i < joints.size(); i++)
             {
-                return a.TimeStamp < b.TimeStamp;
-            });
+                anim->Joints[i].Translation = CompressTrack(joints[i].Translation, compression.TranslationTolerance);
+                anim->Joints[i].Orientation = CompressTrack(joints[i].Orientation, compression.OrientationTolerance);
+            }
 
             m_Animations[animation.name] = anim;
         }
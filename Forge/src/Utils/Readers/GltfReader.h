@@ -12,14 +12,14 @@ namespace Forge
 		std::unordered_map<std::string, Ref<Animation>> m_Animations;
 
 	public:
-		GltfReader(const std::string& filename);
+		GltfReader(const std::string& filename, const AnimationCompressionSettings& compression = {});
 
 		const std::vector<Ref<Mesh>>& GetMeshes() const;
 		inline bool HasAnimation(const std::string& name) const { return m_Animations.find(name) != m_Animations.end(); }
 		inline const Ref<Animation>& GetAnimation(const std::string& name) const { return m_Animations.at(name); }
 
 	private:
-		void ReadGltf(const std::string& filename);
+		void ReadGltf(const std::string& filename, const AnimationCompressionSettings& compression);
 
 	};
 
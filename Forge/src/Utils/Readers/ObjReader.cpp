@@ -223,6 +223,8 @@ namespace Forge
         vao->AddVertexBuffer(vbo);
         vao->SetIndexBuffer(ibo);
         m_Mesh = CreateRef<Mesh>(vao);
+        m_Mesh->CalculateBounds(vertexData, faces.size() * 3, vertexSize);
+        m_Mesh->SetTriangles(TriangleMesh::Create(vertexData, faces.size() * 3, vertexSize));
 
         delete[] indices;
         delete[] vertexData;
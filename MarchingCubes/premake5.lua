@@ -57,7 +57,8 @@ project "MarchingCubes"
 
         links 
         {
-            "stdc++fs"
+            "stdc++fs",
+            "pthread"
         }
 
     filter "system:macosx"
@@ -1,8 +1,54 @@
 #include "Ocean.h"
 
+using Lanes = Forge::FloatLanes;
+
+// Two radix-2 stages of the butterflies that span l and 2 * l values, applied to the values k, k + l, k + 2l and k + 3l.
+// w is the twiddle of the first stage and t the one of the second, the second twiddle of the odd outputs is t * i
+static inline void Butterfly4(float* real, float* imag, size_t l, Lanes wr, Lanes wi, Lanes tr, Lanes ti)
+{
+	Lanes r0 = Lanes::Load(real);
+	Lanes i0 = Lanes::Load(imag);
+	Lanes r1 = Lanes::Load(real + l);
+	Lanes i1 = Lanes::Load(imag + l);
+	Lanes r2 = Lanes::Load(real + 2 * l);
+	Lanes i2 = Lanes::Load(imag + 2 * l);
+	Lanes r3 = Lanes::Load(real + 3 * l);
+	Lanes i3 = Lanes::Load(imag + 3 * l);
+
+	Lanes ar = wr * r1 - wi * i1;
+	Lanes ai = wr * i1 + wi * r1;
+	Lanes cr = wr * r3 - wi * i3;
+	Lanes ci = wr * i3 + wi * r3;
+	Lanes b0r = r0 + ar;
+	Lanes b0i = i0 + ai;
+	Lanes b1r = r0 - ar;
+	Lanes b1i = i0 - ai;
+	Lanes b2r = r2 + cr;
+	Lanes b2i = i2 + ci;
+	Lanes b3r = r2 - cr;
+	Lanes b3i = i2 - ci;
+	Lanes dr = tr * b2r - ti * b2i;
+	Lanes di = tr * b2i + ti * b2r;
+	Lanes er = tr * b3r - ti * b3i;
+	Lanes ei = tr * b3i + ti * b3r;
+
+	(b0r + dr).Store(real);
+	(b0i + di).Store(imag);
+	(b1r - ei).Store(real + l);
+	(b1i + er).Store(imag + l);
+	(b0r - dr).Store(real + 2 * l);
+	(b0i - di).Store(imag + 2 * l);
+	(b1r + ei).Store(real + 3 * l);
+	(b1i - er).Store(imag + 3 * l);
+}
+
 FFT::FFT(uint32_t dimension)
-	: m_Dimension(dimension), m_Pi2(PI * PI), m_Log2N(log(dimension) / log(2))
+	: m_Dimension(dimension), m_Log2N(0), m_Pi2(2.0f * PI)
 {
+	FORGE_ASSERT(dimension > 0 && (dimension & (dimension - 1)) == 0, "FFT dimension must be a power of two");
+	while ((1u << m_Log2N) < m_Dimension)
+		m_Log2N++;
+
 	m_Reversed = std::make_unique<uint32_t[]>(m_Dimension);
 	for (int i = 0; i < m_Dimension; i++)
 		m_Reversed[i] = Reverse(uint32_t(i));
@@ -18,10 +64,6 @@ FFT::FFT(uint32_t dimension)
 		}
 		pow2 *= 2;
 	}
-
-	m_C[0] = std::make_unique<std::complex<float>[]>(m_Dimension);
-	m_C[1] = std::make_unique<std::complex<float>[]>(m_Dimension);
-	m_Which = 0;
 }
 
 uint32_t FFT::Reverse(uint32_t i) const
@@ -35,16 +77,123 @@ uint32_t FFT::Reverse(uint32_t i) const
 	return res;
 }
 
-std::complex<float> FFT::T(uint32_t x, uint32_t n)
+std::complex<float> FFT::T(uint32_t x, uint32_t n) const
 {
 	return { cos(m_Pi2 * x / n), sin(m_Pi2 * x / n) };
 }
 
-void FFT::FastFourierTransform(const std::complex<float>* input, std::complex<float>* output, int stride, int offset)
+void FFT::Transform(std::complex<float>* const* signals, size_t count, size_t stride, Scratch& scratch) const
+{
+	// Value i of signal s is at (s / width * size + i) * width + s % width, the lanes after the last signal are transformed as zeros
+	constexpr size_t width = Lanes::Width;
+	size_t size = m_Dimension;
+	size_t groups = (count + width - 1) / width;
+	scratch.Real.resize(groups * size * width);
+	scratch.Imag.resize(groups * size * width);
+	float* real = scratch.Real.data();
+	float* imag = scratch.Imag.data();
+	if (count % width != 0)
+	{
+		std::fill(scratch.Real.end() - size * width, scratch.Real.end(), 0.0f);
+		std::fill(scratch.Imag.end() - size * width, scratch.Imag.end(), 0.0f);
+	}
+
+	// Strided signals are read one value of every signal at a time, so that neighbouring signals share the cache lines
+	if (stride == 1)
+	{
+		for (size_t s = 0; s < count; s++)
+		{
+			size_t first = s / width * size * width + s % width;
+			for (size_t i = 0; i < size; i++)
+			{
+				const std::complex<float>& value = signals[s][m_Reversed[i]];
+				real[first + i * width] = value.real();
+				imag[first + i * width] = value.imag();
+			}
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			size_t offset = m_Reversed[i] * stride;
+			for (size_t s = 0; s < count; s++)
+			{
+				size_t index = (s / width * size + i) * width + s % width;
+				real[index] = signals[s][offset].real();
+				imag[index] = signals[s][offset].imag();
+			}
+		}
+	}
+
+	int stage = 0;
+	if (m_Log2N % 2 == 1)
+	{
+		// The twiddles of the first stage are all 1
+		for (size_t i = 0; i < groups * size * width; i += 2 * width)
+		{
+			Lanes r0 = Lanes::Load(real + i);
+			Lanes i0 = Lanes::Load(imag + i);
+			Lanes r1 = Lanes::Load(real + i + width);
+			Lanes i1 = Lanes::Load(imag + i + width);
+			(r0 + r1).Store(real + i);
+			(i0 + i1).Store(imag + i);
+			(r0 - r1).Store(real + i + width);
+			(i0 - i1).Store(imag + i + width);
+		}
+		stage = 1;
+	}
+
+	for (; stage < m_Log2N; stage += 2)
+	{
+		size_t l = size_t(1) << stage;
+		for (size_t block = 0; block < size; block += 4 * l)
+		{
+			for (size_t k = 0; k < l; k++)
+			{
+				Lanes wr = Lanes::Set(m_T[stage][k].real());
+				Lanes wi = Lanes::Set(m_T[stage][k].imag());
+				Lanes tr = Lanes::Set(m_T[stage + 1][k].real());
+				Lanes ti = Lanes::Set(m_T[stage + 1][k].imag());
+				for (size_t g = 0; g < groups; g++)
+				{
+					size_t index = (g * size + block + k) * width;
+					Butterfly4(real + index, imag + index, l * width, wr, wi, tr, ti);
+				}
+			}
+		}
+	}
+
+	if (stride == 1)
+	{
+		for (size_t s = 0; s < count; s++)
+		{
+			size_t first = s / width * size * width + s % width;
+			for (size_t i = 0; i < size; i++)
+				signals[s][i] = { real[first + i * width], imag[first + i * width] };
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			for (size_t s = 0; s < count; s++)
+			{
+				size_t index = (s / width * size + i) * width + s % width;
+				signals[s][i * stride] = { real[index], imag[index] };
+			}
+		}
+	}
+}
+
+void FFT::FastFourierTransform(const std::complex<float>* input, std::complex<float>* output, int stride, int offset, Scratch& scratch) const
 {
+	scratch.Buffers[0].resize(m_Dimension);
+	scratch.Buffers[1].resize(m_Dimension);
+	int which = 0;
 	for (int i = 0; i < m_Dimension; i++)
 	{
-		m_C[m_Which][i] = input[m_Reversed[i] * stride + offset];
+		scratch.Buffers[which][i] = input[m_Reversed[i] * stride + offset];
 	}
 	int loops = m_Dimension >> 1;
 	int size = 1 << 1;
@@ -53,16 +202,18 @@ void FFT::FastFourierTransform(const std::complex<float>* input, std::complex<fl
 
 	for (int i = 1; i <= m_Log2N; i++)
 	{
-		m_Which ^= 1;
+		which ^= 1;
+		std::complex<float>* current = scratch.Buffers[which].data();
+		const std::complex<float>* previous = scratch.Buffers[which ^ 1].data();
 		for (int j = 0; j < loops; j++)
 		{
 			for (int k = 0; k < sizeOver2; k++)
 			{
-				m_C[m_Which][size * j + k] = m_C[m_Which ^ 1][size * j + k] + m_C[m_Which ^ 1][size * j + sizeOver2 + k] * m_T[w][k];
+				current[size * j + k] = previous[size * j + k] + previous[size * j + sizeOver2 + k] * m_T[w][k];
 			}
 			for (int k = sizeOver2; k < size; k++)
 			{
-				m_C[m_Which][size * j + k] = m_C[m_Which ^ 1][size * j - sizeOver2 + k] - m_C[m_Which ^ 1][size * j + k] * m_T[w][k - sizeOver2];
+				current[size * j + k] = previous[size * j - sizeOver2 + k] - previous[size * j + k] * m_T[w][k - sizeOver2];
 			}
 		}
 		loops >>= 1;
@@ -72,7 +223,7 @@ void FFT::FastFourierTransform(const std::complex<float>* input, std::complex<fl
 	}
 	for (int i = 0; i < m_Dimension; i++)
 	{
-		output[i * stride + offset] = m_C[m_Which][i];
+		output[i * stride + offset] = scratch.Buffers[which][i];
 	}
 }
 
@@ -84,6 +235,14 @@ Ocean::Ocean(int dimension, float amplitude, const glm::vec2& wind, float length
 	m_HTildeSlopeZ = std::make_unique<std::complex<float>[]>(dimension * dimension);
 	m_HTildeDx = std::make_unique<std::complex<float>[]>(dimension * dimension);
 	m_HTildeDz = std::make_unique<std::complex<float>[]>(dimension * dimension);
+	m_Omega = std::make_unique<float[]>(dimension * dimension);
+	for (int m = 0; m < m_Dimension; m++)
+	{
+		for (int n = 0; n < m_Dimension; n++)
+			m_Omega[m * m_Dimension + n] = Dispersion(n, m);
+	}
+	size_t transforms = (m_Dimension + LinesPerTransform - 1) / LinesPerTransform;
+	m_Scratch.resize((transforms + TransformsPerJob - 1) / TransformsPerJob);
 
 	m_Vertices = std::make_unique<OceanVertex[]>(m_DimensionPlusOne * m_DimensionPlusOne);
 	m_Indices = std::make_unique<uint32_t[]>(m_DimensionPlusOne * m_DimensionPlusOne * 6);
@@ -131,10 +290,12 @@ Ocean::Ocean(int dimension, float amplitude, const glm::vec2& wind, float length
 		{ ShaderDataType::Float3 },
 		{ ShaderDataType::Float3 },
 	};
-	m_VBO = VertexBuffer::Create(m_Vertices.get(), m_DimensionPlusOne * m_DimensionPlusOne * sizeof(OceanVertex), layout);
+	m_VBO = DynamicVertexBuffer::Create(m_DimensionPlusOne * m_DimensionPlusOne * sizeof(OceanVertex), layout);
+	m_VBO->SetData(m_Vertices.get(), m_DimensionPlusOne * m_DimensionPlusOne * sizeof(OceanVertex));
 	m_IBO = IndexBuffer::Create(m_Indices.get(), m_DimensionPlusOne * m_DimensionPlusOne * 6 * sizeof(uint32_t));
 	m_VAO = VertexArray::Create();
-	m_VAO->AddVertexBuffer(m_VBO);
+	m_VAO->AddVertexBuffer(m_VBO->GetVertexBuffer());
+	m_VAO->SetBaseVertex(m_VBO->GetBaseVertex());
 	m_VAO->SetIndexBuffer(m_IBO);
 	m_Mesh = CreateRef<Mesh>(m_VAO);
 }
@@ -266,9 +427,130 @@ void Ocean::EvaluateWaves(float t)
 	}
 
 	m_VBO->SetData(m_Vertices.get(), m_DimensionPlusOne * m_DimensionPlusOne * sizeof(OceanVertex));
+	m_VAO->SetBaseVertex(m_VBO->GetBaseVertex());
 }
 
 void Ocean::EvaluateWavesFFT(float t)
+{
+	float lambda = -1.0f;
+	std::complex<float>* spectra[SpectrumCount] = { m_HTilde.get(), m_HTildeSlopeX.get(), m_HTildeSlopeZ.get(), m_HTildeDx.get(), m_HTildeDz.get() };
+	JobSystem& jobs = JobSystem::Get();
+
+	// Rows and columns are transformed LinesPerTransform at a time, so that the transforms fill the SIMD lanes and the columns
+	// are read a cache line at a time. The spectra of the rows are built by the job that transforms them while they are in the cache
+	size_t transforms = (m_Dimension + LinesPerTransform - 1) / LinesPerTransform;
+	jobs.ParallelFor(transforms, TransformsPerJob, [&](size_t begin, size_t end)
+	{
+		FFT::Scratch& scratch = m_Scratch[begin / TransformsPerJob];
+		std::complex<float>* rows[SpectrumCount * LinesPerTransform];
+		for (size_t transform = begin; transform < end; transform++)
+		{
+			int first = int(transform * LinesPerTransform);
+			int last = std::min(first + int(LinesPerTransform), m_Dimension);
+			for (int m = first; m < last; m++)
+			{
+				float kz = PI * (2.0f * m - m_Dimension) / m_Length;
+				for (int n = 0; n < m_Dimension; n++)
+				{
+					float kx = PI * (2.0f * n - m_Dimension) / m_Length;
+					float len = sqrtf(kx * kx + kz * kz);
+					int index = m * m_Dimension + n;
+					int index1 = m * m_DimensionPlusOne + n;
+
+					// HTilde() with the dispersion looked up and one cos and sin
+					std::complex<float> hTilde0(m_Vertices[index1].Tilde0.x, m_Vertices[index1].Tilde0.y);
+					std::complex<float> hTilde0mk(m_Vertices[index1].Tilde0mk.x, m_Vertices[index1].Tilde0mk.y);
+					float omegaT = m_Omega[index] * t;
+					float cosOmegaT = cos(omegaT);
+					float sinOmegaT = sin(omegaT);
+					std::complex<float> hTilde = hTilde0 * std::complex<float>(cosOmegaT, sinOmegaT) + hTilde0mk * std::complex<float>(cosOmegaT, -sinOmegaT);
+
+					m_HTilde[index] = hTilde;
+					m_HTildeSlopeX[index] = hTilde * std::complex<float>{ 0, kx };
+					m_HTildeSlopeZ[index] = hTilde * std::complex<float>{ 0, kz };
+					if (len < 0.0000001f)
+					{
+						m_HTildeDx[index] = std::complex<float>(0.0f, 0.0f);
+						m_HTildeDz[index] = std::complex<float>(0.0f, 0.0f);
+					}
+					else
+					{
+						m_HTildeDx[index] = hTilde * std::complex<float>(0.0f, -kx / len);
+						m_HTildeDz[index] = hTilde * std::complex<float>(0.0f, -kz / len);
+					}
+				}
+			}
+
+			size_t count = 0;
+			for (size_t i = 0; i < SpectrumCount; i++)
+			{
+				for (int m = first; m < last; m++)
+					rows[count++] = spectra[i] + m * m_Dimension;
+			}
+			m_FFT.Transform(rows, count, 1, scratch);
+		}
+	});
+
+	jobs.ParallelFor(transforms, TransformsPerJob, [&](size_t begin, size_t end)
+	{
+		FFT::Scratch& scratch = m_Scratch[begin / TransformsPerJob];
+		std::complex<float>* columns[SpectrumCount * LinesPerTransform];
+		for (size_t transform = begin; transform < end; transform++)
+		{
+			int first = int(transform * LinesPerTransform);
+			int last = std::min(first + int(LinesPerTransform), m_Dimension);
+			size_t count = 0;
+			for (size_t i = 0; i < SpectrumCount; i++)
+			{
+				for (int n = first; n < last; n++)
+					columns[count++] = spectra[i] + n;
+			}
+			m_FFT.Transform(columns, count, m_Dimension, scratch);
+		}
+	});
+
+	// Each job writes its rows and their copies along the far edges, which no other row writes, straight into the vertex buffer
+	OceanVertex* mapped = (OceanVertex*)m_VBO->Map(m_DimensionPlusOne * m_DimensionPlusOne * sizeof(OceanVertex));
+	jobs.ParallelFor(m_Dimension, LinesPerJob, [&](size_t begin, size_t end)
+	{
+		for (int m = int(begin); m < int(end); m++)
+		{
+			for (int n = 0; n < m_Dimension; n++)
+			{
+				int index = m * m_Dimension + n;
+				int index1 = m * m_DimensionPlusOne + n;
+
+				float sign = ((n + m) & 1) ? -1.0f : 1.0f;
+				float height = m_HTilde[index].real() * sign;
+				float dx = m_HTildeDx[index].real() * sign;
+				float dz = m_HTildeDz[index].real() * sign;
+				glm::vec3 normal = glm::normalize(glm::vec3{ -m_HTildeSlopeX[index].real() * sign, 1.0f, -m_HTildeSlopeZ[index].real() * sign });
+
+				auto setVertex = [&](int vertexIndex)
+				{
+					OceanVertex& vertex = m_Vertices[vertexIndex];
+					vertex.Position.y = height;
+					vertex.Position.x = vertex.OriginalPosition.x + dx * lambda;
+					vertex.Position.z = vertex.OriginalPosition.z + dz * lambda;
+					vertex.Normal = normal;
+					mapped[vertexIndex] = vertex;
+				};
+				setVertex(index1);
+				if (m == 0 && n == 0)
+					setVertex(index1 + m_Dimension + m_DimensionPlusOne * m_Dimension);
+				if (n == 0)
+					setVertex(index1 + m_Dimension);
+				if (m == 0)
+					setVertex(index1 + m_DimensionPlusOne * m_Dimension);
+			}
+		}
+	});
+
+	m_VBO->Unmap();
+	m_VAO->SetBaseVertex(m_VBO->GetBaseVertex());
+}
+
+void Ocean::EvaluateWavesFFTScalar(float t)
 {
 	float lambda = -1.0f;
 	for (int m = 0; m < m_Dimension; m++)
@@ -296,21 +578,22 @@ void Ocean::EvaluateWavesFFT(float t)
 		}
 	}
 
+	FFT::Scratch& scratch = m_Scratch[0];
 	for (int m = 0; m < m_Dimension; m++)
 	{
-		m_FFT.FastFourierTransform(m_HTilde.get(), m_HTilde.get(), 1, m * m_Dimension);
-		m_FFT.FastFourierTransform(m_HTildeSlopeX.get(), m_HTildeSlopeX.get(), 1, m * m_Dimension);
-		m_FFT.FastFourierTransform(m_HTildeSlopeZ.get(), m_HTildeSlopeZ.get(), 1, m * m_Dimension);
-		m_FFT.FastFourierTransform(m_HTildeDx.get(), m_HTildeDx.get(), 1, m * m_Dimension);
-		m_FFT.FastFourierTransform(m_HTildeDz.get(), m_HTildeDz.get(), 1, m * m_Dimension);
+		m_FFT.FastFourierTransform(m_HTilde.get(), m_HTilde.get(), 1, m * m_Dimension, scratch);
+		m_FFT.FastFourierTransform(m_HTildeSlopeX.get(), m_HTildeSlopeX.get(), 1, m * m_Dimension, scratch);
+		m_FFT.FastFourierTransform(m_HTildeSlopeZ.get(), m_HTildeSlopeZ.get(), 1, m * m_Dimension, scratch);
+		m_FFT.FastFourierTransform(m_HTildeDx.get(), m_HTildeDx.get(), 1, m * m_Dimension, scratch);
+		m_FFT.FastFourierTransform(m_HTildeDz.get(), m_HTildeDz.get(), 1, m * m_Dimension, scratch);
 	}
 	for (int n = 0; n < m_Dimension; n++)
 	{
-		m_FFT.FastFourierTransform(m_HTilde.get(), m_HTilde.get(), m_Dimension, n);
-		m_FFT.FastFourierTransform(m_HTildeSlopeX.get(), m_HTildeSlopeX.get(), m_Dimension, n);
-		m_FFT.FastFourierTransform(m_HTildeSlopeZ.get(), m_HTildeSlopeZ.get(), m_Dimension, n);
-		m_FFT.FastFourierTransform(m_HTildeDx.get(), m_HTildeDx.get(), m_Dimension, n);
-		m_FFT.FastFourierTransform(m_HTildeDz.get(), m_HTildeDz.get(), m_Dimension, n);
+		m_FFT.FastFourierTransform(m_HTilde.get(), m_HTilde.get(), m_Dimension, n, scratch);
+		m_FFT.FastFourierTransform(m_HTildeSlopeX.get(), m_HTildeSlopeX.get(), m_Dimension, n, scratch);
+		m_FFT.FastFourierTransform(m_HTildeSlopeZ.get(), m_HTildeSlopeZ.get(), m_Dimension, n, scratch);
+		m_FFT.FastFourierTransform(m_HTildeDx.get(), m_HTildeDx.get(), m_Dimension, n, scratch);
+		m_FFT.FastFourierTransform(m_HTildeDz.get(), m_HTildeDz.get(), m_Dimension, n, scratch);
 	}
 
 	float signs[] = { 1.0f, -1.0f };
@@ -360,4 +643,5 @@ void Ocean::EvaluateWavesFFT(float t)
 	}
 
 	m_VBO->SetData(m_Vertices.get(), m_DimensionPlusOne * m_DimensionPlusOne * sizeof(OceanVertex));
+	m_VAO->SetBaseVertex(m_VBO->GetBaseVertex());
 }
@@ -3,6 +3,7 @@
 using namespace Forge;
 #include <complex>
 #include <random>
+#include <vector>
 
 struct OceanVertex
 {
@@ -27,28 +28,51 @@ inline std::complex<float> Conjugate(const std::complex<float>& a)
 	return std::complex<float>(a.real(), -a.imag());
 }
 
+// Complex FFT of a power of two size, built from radix-4 butterflies with one radix-2 stage when log2(size) is odd.
+// Transforms only read the FFT, so one FFT can be shared by several threads as long as every thread has its own scratch
 class FFT
 {
+public:
+	// Working memory of Transform() and FastFourierTransform()
+	struct Scratch
+	{
+	public:
+		std::vector<float> Real;
+		std::vector<float> Imag;
+		std::vector<std::complex<float>> Buffers[2];
+	};
+
 private:
 	uint32_t m_Dimension;
-	int m_Which;
 	int m_Log2N;
 	float m_Pi2;
 	std::unique_ptr<uint32_t[]> m_Reversed;
 	std::unique_ptr<std::unique_ptr<std::complex<float>[]>[]> m_T;
-	std::unique_ptr<std::complex<float>[]> m_C[2];
 
 public:
 	FFT(uint32_t dimension);
 
 	uint32_t Reverse(uint32_t i) const;
-	std::complex<float> T(uint32_t x, uint32_t n);
-	void FastFourierTransform(const std::complex<float>* input, std::complex<float>* output, int stride, int offset);
+	std::complex<float> T(uint32_t x, uint32_t n) const;
+	// Replaces every signal by sum_k x[k] * T(j * k, N) in place, value i of signal s is signals[s][i * stride].
+	// The signals are transformed side by side in SIMD lanes, signals next to each other in memory should be next to each other in signals
+	void Transform(std::complex<float>* const* signals, size_t count, size_t stride, Scratch& scratch) const;
+	// Radix-2 transform of the signal at input[i * stride + offset], one value at a time. This is the transform Transform() replaced,
+	// it is kept as the reference for BenchmarkOcean()
+	void FastFourierTransform(const std::complex<float>* input, std::complex<float>* output, int stride, int offset, Scratch& scratch) const;
 };
 
 class Ocean
 {
 private:
+	// Height, slope x, slope z, displacement x and displacement z
+	static constexpr size_t SpectrumCount = 5;
+	// Rows or columns of every spectrum transformed together, a cache line of complex values
+	static constexpr size_t LinesPerTransform = 8;
+	static constexpr size_t TransformsPerJob = 2;
+	// Rows of vertices written by each job
+	static constexpr size_t LinesPerJob = 16;
+
 	float m_Gravity;
 	int m_Dimension;
 	int m_DimensionPlusOne;
@@ -64,9 +88,13 @@ private:
 	std::unique_ptr<std::complex<float>[]> m_HTildeSlopeZ;
 	std::unique_ptr<std::complex<float>[]> m_HTildeDx;
 	std::unique_ptr<std::complex<float>[]> m_HTildeDz;
+	// Dispersion() of every wave vector, index m * dimension + n
+	std::unique_ptr<float[]> m_Omega;
+	// One per job of EvaluateWavesFFT(), indexed by the first transform of the job divided by TransformsPerJob
+	std::vector<FFT::Scratch> m_Scratch;
 
 	Ref<VertexArray> m_VAO;
-	Ref<VertexBuffer> m_VBO;
+	Ref<DynamicVertexBuffer> m_VBO;
 	Ref<IndexBuffer> m_IBO;
 	Ref<Mesh> m_Mesh;
 
@@ -78,6 +106,9 @@ public:
 	Ocean(int dimension, float amplitude, const glm::vec2& wind, float length);
 
 	inline Ref<Mesh> GetMesh() const { return m_Mesh; }
+	// (dimension + 1)^2 vertices as of the last evaluation
+	inline const OceanVertex* GetVertices() const { return m_Vertices.get(); }
+	inline int GetDimension() const { return m_Dimension; }
 
 	float Dispersion(int n, int m);
 	float Phillips(int n, int m);
@@ -86,4 +117,6 @@ public:
 	ComplexVectorNormal HeightDisplacementNormal(const glm::vec2& x, float t);
 	void EvaluateWaves(float t);
 	void EvaluateWavesFFT(float t);
+	// Serial evaluation with FFT::FastFourierTransform(), gives the same waves as EvaluateWavesFFT() up to rounding
+	void EvaluateWavesFFTScalar(float t);
 };
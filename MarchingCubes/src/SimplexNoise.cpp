@@ -28,6 +28,14 @@
 
 #include <cstdint>  // int32_t/uint8_t
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMPLEX_NOISE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMPLEX_NOISE_SSE2
+#endif
+
  /**
   * Computes the largest integer value not greater than the float one
   *
@@ -486,3 +494,357 @@ float SimplexNoise::fractal(size_t octaves, float x, float y, float z) const {
 
     return (output / denom);
 }
+
+
+/**
+ * Lanes used by the grid functions: 8 floats with AVX2, 4 with SSE2 and a single float otherwise.
+ *
+ * Every operation is the same IEEE operation as the scalar noise functions perform, in the same order,
+ * so the grid functions return exactly the same values as fractal(). Masks have every bit set where they hold.
+ */
+#if defined(SIMPLEX_NOISE_AVX2)
+static const size_t laneCount = 8;
+typedef __m256 lanes;
+typedef __m256i int_lanes;
+typedef __m256 mask_lanes;
+
+static inline lanes lanes_set(float v) { return _mm256_set1_ps(v); }
+static inline lanes lanes_load(const float* p) { return _mm256_loadu_ps(p); }
+static inline void lanes_store(float* p, lanes v) { _mm256_storeu_ps(p, v); }
+static inline lanes lanes_add(lanes a, lanes b) { return _mm256_add_ps(a, b); }
+static inline lanes lanes_sub(lanes a, lanes b) { return _mm256_sub_ps(a, b); }
+static inline lanes lanes_mul(lanes a, lanes b) { return _mm256_mul_ps(a, b); }
+static inline lanes lanes_div(lanes a, lanes b) { return _mm256_div_ps(a, b); }
+static inline mask_lanes lanes_lt(lanes a, lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline mask_lanes lanes_gt(lanes a, lanes b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline mask_lanes lanes_ge(lanes a, lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline lanes lanes_select(mask_lanes m, lanes a, lanes b) { return _mm256_blendv_ps(b, a, m); }
+static inline lanes lanes_negate_if(mask_lanes m, lanes v) { return _mm256_xor_ps(v, _mm256_and_ps(m, _mm256_set1_ps(-0.0f))); }
+static inline lanes lanes_from_int(int_lanes v) { return _mm256_cvtepi32_ps(v); }
+static inline int_lanes lanes_truncate(lanes v) { return _mm256_cvttps_epi32(v); }
+
+static inline int_lanes int_lanes_set(int32_t v) { return _mm256_set1_epi32(v); }
+static inline int_lanes int_lanes_add(int_lanes a, int_lanes b) { return _mm256_add_epi32(a, b); }
+static inline int_lanes int_lanes_sub(int_lanes a, int_lanes b) { return _mm256_sub_epi32(a, b); }
+static inline int_lanes int_lanes_and(int_lanes a, int_lanes b) { return _mm256_and_si256(a, b); }
+static inline mask_lanes int_lanes_eq(int_lanes a, int_lanes b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+static inline mask_lanes int_lanes_lt(int_lanes a, int_lanes b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)); }
+
+static inline mask_lanes mask_and(mask_lanes a, mask_lanes b) { return _mm256_and_ps(a, b); }
+static inline mask_lanes mask_or(mask_lanes a, mask_lanes b) { return _mm256_or_ps(a, b); }
+static inline mask_lanes mask_not(mask_lanes a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+static inline int_lanes mask_to_int(mask_lanes m) { return _mm256_and_si256(_mm256_castps_si256(m), _mm256_set1_epi32(1)); }
+#elif defined(SIMPLEX_NOISE_SSE2)
+static const size_t laneCount = 4;
+typedef __m128 lanes;
+typedef __m128i int_lanes;
+typedef __m128 mask_lanes;
+
+static inline lanes lanes_set(float v) { return _mm_set1_ps(v); }
+static inline lanes lanes_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void lanes_store(float* p, lanes v) { _mm_storeu_ps(p, v); }
+static inline lanes lanes_add(lanes a, lanes b) { return _mm_add_ps(a, b); }
+static inline lanes lanes_sub(lanes a, lanes b) { return _mm_sub_ps(a, b); }
+static inline lanes lanes_mul(lanes a, lanes b) { return _mm_mul_ps(a, b); }
+static inline lanes lanes_div(lanes a, lanes b) { return _mm_div_ps(a, b); }
+static inline mask_lanes lanes_lt(lanes a, lanes b) { return _mm_cmplt_ps(a, b); }
+static inline mask_lanes lanes_gt(lanes a, lanes b) { return _mm_cmpgt_ps(a, b); }
+static inline mask_lanes lanes_ge(lanes a, lanes b) { return _mm_cmpge_ps(a, b); }
+static inline lanes lanes_select(mask_lanes m, lanes a, lanes b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline lanes lanes_negate_if(mask_lanes m, lanes v) { return _mm_xor_ps(v, _mm_and_ps(m, _mm_set1_ps(-0.0f))); }
+static inline lanes lanes_from_int(int_lanes v) { return _mm_cvtepi32_ps(v); }
+static inline int_lanes lanes_truncate(lanes v) { return _mm_cvttps_epi32(v); }
+
+static inline int_lanes int_lanes_set(int32_t v) { return _mm_set1_epi32(v); }
+static inline int_lanes int_lanes_add(int_lanes a, int_lanes b) { return _mm_add_epi32(a, b); }
+static inline int_lanes int_lanes_sub(int_lanes a, int_lanes b) { return _mm_sub_epi32(a, b); }
+static inline int_lanes int_lanes_and(int_lanes a, int_lanes b) { return _mm_and_si128(a, b); }
+static inline mask_lanes int_lanes_eq(int_lanes a, int_lanes b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+static inline mask_lanes int_lanes_lt(int_lanes a, int_lanes b) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, b)); }
+
+static inline mask_lanes mask_and(mask_lanes a, mask_lanes b) { return _mm_and_ps(a, b); }
+static inline mask_lanes mask_or(mask_lanes a, mask_lanes b) { return _mm_or_ps(a, b); }
+static inline mask_lanes mask_not(mask_lanes a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+static inline int_lanes mask_to_int(mask_lanes m) { return _mm_and_si128(_mm_castps_si128(m), _mm_set1_epi32(1)); }
+#else
+static const size_t laneCount = 1;
+typedef float lanes;
+typedef int32_t int_lanes;
+typedef bool mask_lanes;
+
+static inline lanes lanes_set(float v) { return v; }
+static inline lanes lanes_load(const float* p) { return *p; }
+static inline void lanes_store(float* p, lanes v) { *p = v; }
+static inline lanes lanes_add(lanes a, lanes b) { return a + b; }
+static inline lanes lanes_sub(lanes a, lanes b) { return a - b; }
+static inline lanes lanes_mul(lanes a, lanes b) { return a * b; }
+static inline lanes lanes_div(lanes a, lanes b) { return a / b; }
+static inline mask_lanes lanes_lt(lanes a, lanes b) { return a < b; }
+static inline mask_lanes lanes_gt(lanes a, lanes b) { return a > b; }
+static inline mask_lanes lanes_ge(lanes a, lanes b) { return a >= b; }
+static inline lanes lanes_select(mask_lanes m, lanes a, lanes b) { return m ? a : b; }
+static inline lanes lanes_negate_if(mask_lanes m, lanes v) { return m ? -v : v; }
+static inline lanes lanes_from_int(int_lanes v) { return static_cast<float>(v); }
+static inline int_lanes lanes_truncate(lanes v) { return static_cast<int32_t>(v); }
+
+static inline int_lanes int_lanes_set(int32_t v) { return v; }
+static inline int_lanes int_lanes_add(int_lanes a, int_lanes b) { return a + b; }
+static inline int_lanes int_lanes_sub(int_lanes a, int_lanes b) { return a - b; }
+static inline int_lanes int_lanes_and(int_lanes a, int_lanes b) { return a & b; }
+static inline mask_lanes int_lanes_eq(int_lanes a, int_lanes b) { return a == b; }
+static inline mask_lanes int_lanes_lt(int_lanes a, int_lanes b) { return a < b; }
+
+static inline mask_lanes mask_and(mask_lanes a, mask_lanes b) { return a && b; }
+static inline mask_lanes mask_or(mask_lanes a, mask_lanes b) { return a || b; }
+static inline mask_lanes mask_not(mask_lanes a) { return !a; }
+static inline int_lanes mask_to_int(mask_lanes m) { return m ? 1 : 0; }
+#endif
+
+/**
+ * Permutation table widened to 32 bits, so that AVX2 can gather from it
+ */
+struct PermutationTable {
+    int32_t values[256];
+
+    PermutationTable() {
+        for (int i = 0; i < 256; i++) {
+            values[i] = perm[i];
+        }
+    }
+};
+
+static const PermutationTable perm32;
+
+/**
+ * Lane version of hash()
+ */
+static inline int_lanes hash_lanes(int_lanes i) {
+    int_lanes index = int_lanes_and(i, int_lanes_set(0xFF));
+#if defined(SIMPLEX_NOISE_AVX2)
+    return _mm256_i32gather_epi32(perm32.values, index, 4);
+#elif defined(SIMPLEX_NOISE_SSE2)
+    alignas(16) int32_t indices[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+    return _mm_setr_epi32(perm32.values[indices[0]], perm32.values[indices[1]], perm32.values[indices[2]], perm32.values[indices[3]]);
+#else
+    return perm32.values[index];
+#endif
+}
+
+/**
+ * Lane version of fastfloor()
+ */
+static inline int_lanes fastfloor_lanes(lanes fp) {
+    int_lanes i = lanes_truncate(fp);
+    return int_lanes_sub(i, mask_to_int(lanes_lt(fp, lanes_from_int(i))));
+}
+
+/**
+ * Lane version of the 2D grad()
+ */
+static inline lanes grad_lanes(int_lanes hash, lanes x, lanes y) {
+    const int_lanes h = int_lanes_and(hash, int_lanes_set(0x3F));
+    const mask_lanes low = int_lanes_lt(h, int_lanes_set(4));
+    const lanes u = lanes_select(low, x, y);
+    const lanes v = lanes_select(low, y, x);
+    const mask_lanes negateU = int_lanes_eq(int_lanes_and(h, int_lanes_set(1)), int_lanes_set(1));
+    const mask_lanes negateV = int_lanes_eq(int_lanes_and(h, int_lanes_set(2)), int_lanes_set(2));
+    return lanes_add(lanes_negate_if(negateU, u), lanes_negate_if(negateV, lanes_mul(lanes_set(2.0f), v)));
+}
+
+/**
+ * Lane version of the 3D grad()
+ */
+static inline lanes grad_lanes(int_lanes hash, lanes x, lanes y, lanes z) {
+    const int_lanes h = int_lanes_and(hash, int_lanes_set(15));
+    const lanes u = lanes_select(int_lanes_lt(h, int_lanes_set(8)), x, y);
+    const mask_lanes useX = mask_or(int_lanes_eq(h, int_lanes_set(12)), int_lanes_eq(h, int_lanes_set(14)));
+    const lanes v = lanes_select(int_lanes_lt(h, int_lanes_set(4)), y, lanes_select(useX, x, z));
+    const mask_lanes negateU = int_lanes_eq(int_lanes_and(h, int_lanes_set(1)), int_lanes_set(1));
+    const mask_lanes negateV = int_lanes_eq(int_lanes_and(h, int_lanes_set(2)), int_lanes_set(2));
+    return lanes_add(lanes_negate_if(negateU, u), lanes_negate_if(negateV, v));
+}
+
+/**
+ * Contribution of a simplex corner, zero where t is negative
+ */
+static inline lanes corner_lanes(lanes t, lanes grad) {
+    const lanes t2 = lanes_mul(t, t);
+    const lanes n = lanes_mul(lanes_mul(t2, t2), grad);
+    return lanes_select(lanes_lt(t, lanes_set(0.0f)), lanes_set(0.0f), n);
+}
+
+/**
+ * Lane version of the 2D noise(), the branches on the simplex are replaced by masks
+ */
+static lanes noise_lanes(lanes x, lanes y) {
+    static const float F2 = 0.366025403f;
+    static const float G2 = 0.211324865f;
+
+    const lanes s = lanes_mul(lanes_add(x, y), lanes_set(F2));
+    const int_lanes i = fastfloor_lanes(lanes_add(x, s));
+    const int_lanes j = fastfloor_lanes(lanes_add(y, s));
+
+    const lanes t = lanes_mul(lanes_from_int(int_lanes_add(i, j)), lanes_set(G2));
+    const lanes x0 = lanes_sub(x, lanes_sub(lanes_from_int(i), t));
+    const lanes y0 = lanes_sub(y, lanes_sub(lanes_from_int(j), t));
+
+    const mask_lanes lower = lanes_gt(x0, y0);
+    const int_lanes i1 = mask_to_int(lower);
+    const int_lanes j1 = mask_to_int(mask_not(lower));
+
+    const lanes x1 = lanes_add(lanes_sub(x0, lanes_from_int(i1)), lanes_set(G2));
+    const lanes y1 = lanes_add(lanes_sub(y0, lanes_from_int(j1)), lanes_set(G2));
+    const lanes x2 = lanes_add(lanes_sub(x0, lanes_set(1.0f)), lanes_set(2.0f * G2));
+    const lanes y2 = lanes_add(lanes_sub(y0, lanes_set(1.0f)), lanes_set(2.0f * G2));
+
+    const int_lanes one = int_lanes_set(1);
+    const int_lanes gi0 = hash_lanes(int_lanes_add(i, hash_lanes(j)));
+    const int_lanes gi1 = hash_lanes(int_lanes_add(int_lanes_add(i, i1), hash_lanes(int_lanes_add(j, j1))));
+    const int_lanes gi2 = hash_lanes(int_lanes_add(int_lanes_add(i, one), hash_lanes(int_lanes_add(j, one))));
+
+    const lanes half = lanes_set(0.5f);
+    const lanes n0 = corner_lanes(lanes_sub(lanes_sub(half, lanes_mul(x0, x0)), lanes_mul(y0, y0)), grad_lanes(gi0, x0, y0));
+    const lanes n1 = corner_lanes(lanes_sub(lanes_sub(half, lanes_mul(x1, x1)), lanes_mul(y1, y1)), grad_lanes(gi1, x1, y1));
+    const lanes n2 = corner_lanes(lanes_sub(lanes_sub(half, lanes_mul(x2, x2)), lanes_mul(y2, y2)), grad_lanes(gi2, x2, y2));
+    return lanes_mul(lanes_set(45.23065f), lanes_add(lanes_add(n0, n1), n2));
+}
+
+/**
+ * Lane version of the 3D noise(), the branches on the simplex are replaced by masks
+ */
+static lanes noise_lanes(lanes x, lanes y, lanes z) {
+    static const float F3 = 1.0f / 3.0f;
+    static const float G3 = 1.0f / 6.0f;
+
+    const lanes s = lanes_mul(lanes_add(lanes_add(x, y), z), lanes_set(F3));
+    const int_lanes i = fastfloor_lanes(lanes_add(x, s));
+    const int_lanes j = fastfloor_lanes(lanes_add(y, s));
+    const int_lanes k = fastfloor_lanes(lanes_add(z, s));
+    const lanes t = lanes_mul(lanes_from_int(int_lanes_add(int_lanes_add(i, j), k)), lanes_set(G3));
+    const lanes x0 = lanes_sub(x, lanes_sub(lanes_from_int(i), t));
+    const lanes y0 = lanes_sub(y, lanes_sub(lanes_from_int(j), t));
+    const lanes z0 = lanes_sub(z, lanes_sub(lanes_from_int(k), t));
+
+    // The second corner steps along the largest of x0, y0 and z0, the third along all but the smallest
+    const mask_lanes xy = lanes_ge(x0, y0);
+    const mask_lanes yz = lanes_ge(y0, z0);
+    const mask_lanes xz = lanes_ge(x0, z0);
+    const mask_lanes xLargest = mask_and(xy, xz);
+    const mask_lanes yLargest = mask_and(mask_not(xy), yz);
+    const int_lanes i1 = mask_to_int(xLargest);
+    const int_lanes j1 = mask_to_int(yLargest);
+    const int_lanes k1 = mask_to_int(mask_not(mask_or(xLargest, yLargest)));
+    const int_lanes i2 = mask_to_int(mask_or(xy, xz));
+    const int_lanes j2 = mask_to_int(mask_or(mask_not(xy), yz));
+    const int_lanes k2 = mask_to_int(mask_or(mask_not(yz), mask_not(xz)));
+
+    const lanes x1 = lanes_add(lanes_sub(x0, lanes_from_int(i1)), lanes_set(G3));
+    const lanes y1 = lanes_add(lanes_sub(y0, lanes_from_int(j1)), lanes_set(G3));
+    const lanes z1 = lanes_add(lanes_sub(z0, lanes_from_int(k1)), lanes_set(G3));
+    const lanes x2 = lanes_add(lanes_sub(x0, lanes_from_int(i2)), lanes_set(2.0f * G3));
+    const lanes y2 = lanes_add(lanes_sub(y0, lanes_from_int(j2)), lanes_set(2.0f * G3));
+    const lanes z2 = lanes_add(lanes_sub(z0, lanes_from_int(k2)), lanes_set(2.0f * G3));
+    const lanes x3 = lanes_add(lanes_sub(x0, lanes_set(1.0f)), lanes_set(3.0f * G3));
+    const lanes y3 = lanes_add(lanes_sub(y0, lanes_set(1.0f)), lanes_set(3.0f * G3));
+    const lanes z3 = lanes_add(lanes_sub(z0, lanes_set(1.0f)), lanes_set(3.0f * G3));
+
+    const int_lanes one = int_lanes_set(1);
+    const int_lanes gi0 = hash_lanes(int_lanes_add(i, hash_lanes(int_lanes_add(j, hash_lanes(k)))));
+    const int_lanes gi1 = hash_lanes(int_lanes_add(int_lanes_add(i, i1), hash_lanes(int_lanes_add(int_lanes_add(j, j1), hash_lanes(int_lanes_add(k, k1))))));
+    const int_lanes gi2 = hash_lanes(int_lanes_add(int_lanes_add(i, i2), hash_lanes(int_lanes_add(int_lanes_add(j, j2), hash_lanes(int_lanes_add(k, k2))))));
+    const int_lanes gi3 = hash_lanes(int_lanes_add(int_lanes_add(i, one), hash_lanes(int_lanes_add(int_lanes_add(j, one), hash_lanes(int_lanes_add(k, one))))));
+
+    const lanes radius = lanes_set(0.6f);
+    const lanes t0 = lanes_sub(lanes_sub(lanes_sub(radius, lanes_mul(x0, x0)), lanes_mul(y0, y0)), lanes_mul(z0, z0));
+    const lanes t1 = lanes_sub(lanes_sub(lanes_sub(radius, lanes_mul(x1, x1)), lanes_mul(y1, y1)), lanes_mul(z1, z1));
+    const lanes t2 = lanes_sub(lanes_sub(lanes_sub(radius, lanes_mul(x2, x2)), lanes_mul(y2, y2)), lanes_mul(z2, z2));
+    const lanes t3 = lanes_sub(lanes_sub(lanes_sub(radius, lanes_mul(x3, x3)), lanes_mul(y3, y3)), lanes_mul(z3, z3));
+    const lanes n0 = corner_lanes(t0, grad_lanes(gi0, x0, y0, z0));
+    const lanes n1 = corner_lanes(t1, grad_lanes(gi1, x1, y1, z1));
+    const lanes n2 = corner_lanes(t2, grad_lanes(gi2, x2, y2, z2));
+    const lanes n3 = corner_lanes(t3, grad_lanes(gi3, x3, y3, z3));
+    return lanes_mul(lanes_set(32.0f), lanes_add(lanes_add(lanes_add(n0, n1), n2), n3));
+}
+
+/**
+ * Fractal/Fractional Brownian Motion (fBm) summation of 2D Perlin Simplex noise over a grid
+ *
+ * @param[in] octaves   number of fraction of noise to sum
+ * @param[in] xs        x float coordinate of each column
+ * @param[in] width     number of columns
+ * @param[in] ys        y float coordinate of each row
+ * @param[in] height    number of rows
+ * @param[out] output   fractal(octaves, xs[x], ys[y]) at output[x + y * width]
+ */
+void SimplexNoise::fractalGrid(size_t octaves, const float* xs, size_t width, const float* ys, size_t height, float* output) const {
+    for (size_t y = 0; y < height; y++) {
+        float* row = output + y * width;
+        size_t x = 0;
+        for (; x + laneCount <= width; x += laneCount) {
+            const lanes px = lanes_load(xs + x);
+            const lanes py = lanes_set(ys[y]);
+            lanes sum = lanes_set(0.0f);
+            float denom = 0.f;
+            float frequency = mFrequency;
+            float amplitude = mAmplitude;
+
+            for (size_t i = 0; i < octaves; i++) {
+                const lanes f = lanes_set(frequency);
+                sum = lanes_add(sum, lanes_mul(lanes_set(amplitude), noise_lanes(lanes_mul(px, f), lanes_mul(py, f))));
+                denom += amplitude;
+
+                frequency *= mLacunarity;
+                amplitude *= mPersistence;
+            }
+            lanes_store(row + x, lanes_div(sum, lanes_set(denom)));
+        }
+        for (; x < width; x++) {
+            row[x] = fractal(octaves, xs[x], ys[y]);
+        }
+    }
+}
+
+/**
+ * Fractal/Fractional Brownian Motion (fBm) summation of 3D Perlin Simplex noise over a grid
+ *
+ * @param[in] octaves   number of fraction of noise to sum
+ * @param[in] xs        x float coordinate of each column
+ * @param[in] width     number of columns
+ * @param[in] ys        y float coordinate of each row
+ * @param[in] height    number of rows
+ * @param[in] zs        z float coordinate of each slice
+ * @param[in] depth     number of slices
+ * @param[out] output   fractal(octaves, xs[x], ys[y], zs[z]) at output[x + y * width + z * width * height]
+ */
+void SimplexNoise::fractalGrid(size_t octaves, const float* xs, size_t width, const float* ys, size_t height,
+                               const float* zs, size_t depth, float* output) const {
+    for (size_t z = 0; z < depth; z++) {
+        for (size_t y = 0; y < height; y++) {
+            float* row = output + (z * height + y) * width;
+            size_t x = 0;
+            for (; x + laneCount <= width; x += laneCount) {
+                const lanes px = lanes_load(xs + x);
+                const lanes py = lanes_set(ys[y]);
+                const lanes pz = lanes_set(zs[z]);
+                lanes sum = lanes_set(0.0f);
+                float denom = 0.f;
+                float frequency = mFrequency;
+                float amplitude = mAmplitude;
+
+                for (size_t i = 0; i < octaves; i++) {
+                    const lanes f = lanes_set(frequency);
+                    sum = lanes_add(sum, lanes_mul(lanes_set(amplitude), noise_lanes(lanes_mul(px, f), lanes_mul(py, f), lanes_mul(pz, f))));
+                    denom += amplitude;
+
+                    frequency *= mLacunarity;
+                    amplitude *= mPersistence;
+                }
+                lanes_store(row + x, lanes_div(sum, lanes_set(denom)));
+            }
+            for (; x < width; x++) {
+                row[x] = fractal(octaves, xs[x], ys[y], zs[z]);
+            }
+        }
+    }
+}
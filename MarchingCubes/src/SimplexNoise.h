@@ -28,6 +28,11 @@ public:
     float fractal(size_t octaves, float x, float y) const;
     float fractal(size_t octaves, float x, float y, float z) const;
 
+    // Fractal noise over a grid, several points at a time (AVX2 or SSE2, scalar otherwise)
+    void fractalGrid(size_t octaves, const float* xs, size_t width, const float* ys, size_t height, float* output) const;
+    void fractalGrid(size_t octaves, const float* xs, size_t width, const float* ys, size_t height,
+                     const float* zs, size_t depth, float* output) const;
+
     /**
      * Constructor of to initialize a fractal noise summation
      *
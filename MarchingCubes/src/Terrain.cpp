@@ -2,223 +2,587 @@
 #include "MarchTables.h"
 
 #include <iostream>
+#include <limits>
+
+// Offset of each cube corner from the cell, in the order used by MarchTables.h
+static const glm::ivec3 s_CornerOffsets[8] = {
+	{ 0, 0, 0 },
+	{ 1, 0, 0 },
+	{ 1, 0, 1 },
+	{ 0, 0, 1 },
+	{ 0, 1, 0 },
+	{ 1, 1, 0 },
+	{ 1, 1, 1 },
+	{ 0, 1, 1 },
+};
+
+static constexpr uint32_t InvalidVertex = std::numeric_limits<uint32_t>::max();
+
+// Axis that each transition side faces and whether it is at the end of the axis
+struct TransitionSide
+{
+public:
+	TerrainTransition Flag;
+	int Axis;
+	bool Positive;
+};
+
+static const TransitionSide s_TransitionSides[4] = {
+	{ TerrainTransitionNegativeX, 0, false },
+	{ TerrainTransitionPositiveX, 0, true },
+	{ TerrainTransitionNegativeZ, 2, false },
+	{ TerrainTransitionPositiveZ, 2, true },
+};
+
+struct TransitionCorner
+{
+public:
+	TerrainTransition Flag;
+	bool PositiveX;
+	bool PositiveZ;
+};
+
+static const TransitionCorner s_TransitionCorners[4] = {
+	{ TerrainTransitionNegativeXNegativeZ, false, false },
+	{ TerrainTransitionPositiveXNegativeZ, true, false },
+	{ TerrainTransitionNegativeXPositiveZ, false, true },
+	{ TerrainTransitionPositiveXPositiveZ, true, true },
+};
 
 Terrain::Terrain(const glm::vec3& position, float surfaceLevel)
 	: m_Position(position), m_SurfaceLevel(surfaceLevel)
 {}
 
-Ref<Mesh> Terrain::GenerateMesh(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const
+Ref<Mesh> Terrain::GenerateMesh(const glm::vec3& size, const glm::ivec3& resolution, float heightScale, TerrainShading shading, GLuint drawMode) const
 {
-	std::vector<Triangle> triangles = MarchingCubes(size, resolution, heightScale);
+	DensityField field = SampleDensity(size, resolution, heightScale);
+	BoundingBox bounds;
+	Scope<MeshBuilder> builder = March(field, 0, shading, MeshBuilderMode::Mapped, true, bounds);
+	return builder->Build(bounds, drawMode);
+}
 
-	uint32_t* indices = new uint32_t[triangles.size() * 3];
-	for (size_t i = 0; i < triangles.size(); i++)
+Scope<MeshBuilder> Terrain::GenerateChunk(const TerrainChunkDesc& desc, BoundingBox& bounds) const
+{
+	DensityField field;
+	field.Resolution = desc.Resolution;
+	field.Size = desc.Size;
+	field.Offset = { 0.0f, 0.0f, 0.0f };
+	field.Padding = 1;
+	glm::ivec3 samples = desc.Resolution + 3;
+	field.Values.resize(size_t(samples.x) * size_t(samples.y) * size_t(samples.z));
+
+	// Points are placed the same way as March() places them and the coordinates are computed the same way as
+	// GetDensity(), so the points on a shared side are sampled at exactly the same world positions by both chunks
+	std::vector<float> coordinates[3];
+	for (int axis = 0; axis < 3; axis++)
 	{
-		indices[i * 3 + 0] = i * 3 + 0;
-		indices[i * 3 + 1] = i * 3 + 1;
-		indices[i * 3 + 2] = i * 3 + 2;
+		coordinates[axis].resize(samples[axis]);
+		for (int i = -1; i <= desc.Resolution[axis] + 1; i++)
+		{
+			float position = desc.Origin[axis] + float(i) / float(desc.Resolution[axis]) * desc.Size[axis];
+			coordinates[axis][i + 1] = position / desc.NoiseScale + m_Position[axis];
+		}
 	}
-
-	Ref<VertexArray> vao = VertexArray::Create();
-	BufferLayout layout = {
-		{ ShaderDataType::Float3 },
-		{ ShaderDataType::Float3 },
-		{ ShaderDataType::Float2 },
-	};
-
-	float* vertexData = new float[triangles.size() * 3 * (3 + 3 + 2)];
-	float* ptr = vertexData;
-
-	for (size_t i = 0; i < triangles.size(); i++)
+	// Whole z slices are sampled at a time, every point is written by exactly one call
+	SimplexNoise simplex;
+	size_t sliceSize = size_t(samples.x) * size_t(samples.y);
+	auto sampleSlices = [&](size_t begin, size_t end)
 	{
-		glm::vec3 a = triangles[i].Vertices[1] - triangles[i].Vertices[0];
-		glm::vec3 b = triangles[i].Vertices[2] - triangles[i].Vertices[0];
-		glm::vec3 normal = glm::normalize(glm::cross(a, b));
-		for (int k = 0; k < 3; k++)
+		simplex.fractalGrid(4, coordinates[0].data(), samples.x, coordinates[1].data(), samples.y, coordinates[2].data() + begin, end - begin, field.Values.data() + begin * sliceSize);
+		for (size_t k = begin; k < end; k++)
 		{
-			*ptr++ = triangles[i].Vertices[k].x;
-			*ptr++ = triangles[i].Vertices[k].y;
-			*ptr++ = triangles[i].Vertices[k].z;
-			*ptr++ = normal.x;
-			*ptr++ = normal.y;
-			*ptr++ = normal.z;
-			*ptr++ = triangles[i].UVs[k].x;
-			*ptr++ = triangles[i].UVs[k].y;
+			for (int j = 0; j < samples.y; j++)
+			{
+				float y = desc.Origin.y + float(j - 1) / float(desc.Resolution.y) * desc.Size.y;
+				float* row = field.Values.data() + k * sliceSize + size_t(j) * samples.x;
+				for (int i = 0; i < samples.x; i++)
+					row[i] = -y + row[i] * desc.HeightScale;
+			}
 		}
-	}
-
-	Ref<VertexBuffer> vbo = VertexBuffer::Create(vertexData, triangles.size() * 3 * layout.GetStride(), layout);
-	Ref<IndexBuffer> ibo = IndexBuffer::Create(indices, triangles.size() * 3 * sizeof(uint32_t));
-
-	delete[] vertexData;
-	delete[] indices;
-
-	vao->AddVertexBuffer(vbo);
-	vao->SetIndexBuffer(ibo);
+	};
+	if (desc.Parallel)
+		JobSystem::Get().ParallelFor(samples.z, SlicesPerJob, sampleSlices);
+	else
+		sampleSlices(0, samples.z);
+	return March(field, desc.Transitions, desc.Shading, MeshBuilderMode::Staging, desc.Parallel, bounds);
+}
 
-	return CreateRef<Mesh>(vao);
+float Terrain::GetDensity(const glm::vec3& position, float noiseScale, float heightScale) const
+{
+	SimplexNoise simplex;
+	float noise = simplex.fractal(4, position.x / noiseScale + m_Position.x, position.y / noiseScale + m_Position.y, position.z / noiseScale + m_Position.z);
+	return -position.y + noise * heightScale;
 }
 
-Ref<Mesh> Terrain::GeneratePointsMesh(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const
+Scope<MeshBuilder> Terrain::March(DensityField& field, uint32_t transitions, TerrainShading shading, MeshBuilderMode mode, bool parallel, BoundingBox& bounds) const
 {
-	std::vector<Triangle> triangles = MarchingCubes(size, resolution, heightScale);
+	const glm::ivec3& resolution = field.Resolution;
+	const glm::vec3& size = field.Size;
+	int xPoints = resolution.x + 1;
+	int yPoints = resolution.y + 1;
+	int zPoints = resolution.z + 1;
+	int padding = field.Padding;
+	int xSamples = xPoints + 2 * padding;
+	int ySamples = yPoints + 2 * padding;
+	bool flat = shading == TerrainShading::Flat;
 
-	uint32_t* indices = new uint32_t[triangles.size() * 3];
-	for (size_t i = 0; i < triangles.size(); i++)
+	auto getIndex = [padding, xSamples, ySamples](int x, int y, int z)
 	{
-		indices[i * 3 + 0] = i * 3 + 0;
-		indices[i * 3 + 1] = i * 3 + 1;
-		indices[i * 3 + 2] = i * 3 + 2;
-	}
+		return (x + padding) + (y + padding) * xSamples + (z + padding) * xSamples * ySamples;
+	};
 
-	Ref<VertexArray> vao = VertexArray::Create();
-	BufferLayout layout = {
-		{ ShaderDataType::Float3 },
-		{ ShaderDataType::Float3 },
-		{ ShaderDataType::Float2 },
+	float* marchingCubes = field.Values.data();
+
+	auto getPosition = [&](int x, int y, int z)
+	{
+		return field.Offset + glm::vec3{ float(x) / float(resolution.x) * size.x, float(y) / float(resolution.y) * size.y, float(z) / float(resolution.z) * size.z };
 	};
 
-	float* vertexData = new float[triangles.size() * 3 * (3 + 3 + 2)];
-	float* ptr = vertexData;
+	auto isInside = [marchingCubes, this](int index)
+	{
+		return marchingCubes[index] >= m_SurfaceLevel;
+	};
 
-	for (size_t i = 0; i < triangles.size(); i++)
+	auto getLookupIndex = [&](int i, int j, int k)
 	{
-		glm::vec3 a = triangles[i].Vertices[1] - triangles[i].Vertices[0];
-		glm::vec3 b = triangles[i].Vertices[2] - triangles[i].Vertices[0];
-		glm::vec3 normal = glm::normalize(glm::cross(a, b));
-		for (int k = 0; k < 3; k++)
+		uint32_t lookupIndex = 0;
+		for (int corner = 0; corner < 8; corner++)
 		{
-			*ptr++ = triangles[i].Vertices[k].x;
-			*ptr++ = triangles[i].Vertices[k].y;
-			*ptr++ = triangles[i].Vertices[k].z;
-			*ptr++ = normal.x;
-			*ptr++ = normal.y;
-			*ptr++ = normal.z;
-			*ptr++ = triangles[i].UVs[k].x;
-			*ptr++ = triangles[i].UVs[k].y;
+			const glm::ivec3& offset = s_CornerOffsets[corner];
+			if (isInside(getIndex(i + offset.x, j + offset.y, k + offset.z)))
+			{
+				lookupIndex |= (1 << corner);
+			}
 		}
-	}
-
-	Ref<VertexBuffer> vbo = VertexBuffer::Create(vertexData, triangles.size() * 3 * layout.GetStride(), layout);
-	Ref<IndexBuffer> ibo = IndexBuffer::Create(indices, triangles.size() * 3 * sizeof(uint32_t));
-
-	delete[] vertexData;
-	delete[] indices;
-
-	vao->AddVertexBuffer(vbo);
-	vao->SetIndexBuffer(ibo);
-
-	return CreateRef<Mesh>(vao);
-}
-
-std::vector<Triangle> Terrain::MarchingCubes(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const
-{
-	SimplexNoise simplex;
-	int xPoints = resolution.x + 1;
-	int yPoints = resolution.y + 1;
-	int zPoints = resolution.z + 1;
+		return lookupIndex;
+	};
 
-	auto getIndex = [xPoints, yPoints, zPoints](int x, int y, int z)
+	// Central differences, one sided on the border of the padded grid
+	glm::vec3 cellSize = size / glm::vec3(resolution);
+	auto getGradient = [&](int x, int y, int z)
 	{
-		return x + y * xPoints + z * xPoints * yPoints;
+		int x0 = std::max(x - 1, -padding), x1 = std::min(x + 1, xPoints - 1 + padding);
+		int y0 = std::max(y - 1, -padding), y1 = std::min(y + 1, yPoints - 1 + padding);
+		int z0 = std::max(z - 1, -padding), z1 = std::min(z + 1, zPoints - 1 + padding);
+		return glm::vec3{
+			(marchingCubes[getIndex(x1, y, z)] - marchingCubes[getIndex(x0, y, z)]) / (float(x1 - x0) * cellSize.x),
+			(marchingCubes[getIndex(x, y1, z)] - marchingCubes[getIndex(x, y0, z)]) / (float(y1 - y0) * cellSize.y),
+			(marchingCubes[getIndex(x, y, z1)] - marchingCubes[getIndex(x, y, z0)]) / (float(z1 - z0) * cellSize.z),
+		};
 	};
 
-	auto getNeighbours = [](int i, int j, int k, glm::ivec3 neighbours[8])
+	// The coarser chunk beyond a transition side only samples the even points of the side. Interpolating the odd points
+	// from them gives the side the same contour as the coarser chunk, which is adapted from the transition cells of
+	// Transvoxel without its tables: vertices on the coarse grid lines are placed exactly where the coarser chunk places
+	// them and the vertices between them are moved onto the coarse contour
+	struct TransitionFace
 	{
-		neighbours[0] = { i, j, k };
-		neighbours[1] = { i + 1, j, k };
-		neighbours[2] = { i + 1, j, k + 1 };
-		neighbours[3] = { i, j, k + 1 };
-		neighbours[4] = { i, j + 1, k };
-		neighbours[5] = { i + 1, j + 1, k };
-		neighbours[6] = { i + 1, j + 1, k + 1 };
-		neighbours[7] = { i, j + 1, k + 1 };
+	public:
+		int Axis;
+		int Plane;
+		int U;
+		int V;
 	};
 
-	float* marchingCubes = new float[size_t(xPoints) * size_t(yPoints) * size_t(zPoints)];
-	float heightPerPoint = float(size.y) / float(resolution.y - 1);
-	float scale = 50.0f;
+	TransitionFace faces[4];
+	int faceCount = 0;
+	glm::ivec2 corners[4];
+	int cornerCount = 0;
+	for (const TransitionSide& side : s_TransitionSides)
+	{
+		if (!(transitions & side.Flag))
+			continue;
+		TransitionFace& face = faces[faceCount++];
+		face.Axis = side.Axis;
+		face.Plane = side.Positive ? resolution[side.Axis] : 0;
+		face.U = (side.Axis + 1) % 3;
+		face.V = (side.Axis + 2) % 3;
+		FORGE_ASSERT(resolution[face.U] % 2 == 0 && resolution[face.V] % 2 == 0, "Transition sides need an even resolution");
+	}
+	for (const TransitionCorner& corner : s_TransitionCorners)
+	{
+		if (transitions & corner.Flag)
+			corners[cornerCount++] = { corner.PositiveX ? resolution.x : 0, corner.PositiveZ ? resolution.z : 0 };
+	}
+	FORGE_ASSERT(cornerCount == 0 || resolution.y % 2 == 0, "Transition corners need an even resolution");
+
+	// Only reads the even points, which are never written, so the sides and corners can be conformed in any order
+	for (int f = 0; f < faceCount; f++)
+	{
+		const TransitionFace& face = faces[f];
+		for (int u = 0; u <= resolution[face.U]; u++)
+		{
+			for (int v = 0; v <= resolution[face.V]; v++)
+			{
+				if (u % 2 == 0 && v % 2 == 0)
+					continue;
+				auto sample = [&](int du, int dv)
+				{
+					glm::ivec3 point;
+					point[face.Axis] = face.Plane;
+					point[face.U] = u + du;
+					point[face.V] = v + dv;
+					return marchingCubes[getIndex(point.x, point.y, point.z)];
+				};
+				glm::ivec3 point;
+				point[face.Axis] = face.Plane;
+				point[face.U] = u;
+				point[face.V] = v;
+				float& value = marchingCubes[getIndex(point.x, point.y, point.z)];
+				if (u % 2 != 0 && v % 2 != 0)
+					value = (sample(-1, -1) + sample(1, -1) + sample(-1, 1) + sample(1, 1)) * 0.25f;
+				else if (u % 2 != 0)
+					value = (sample(-1, 0) + sample(1, 0)) * 0.5f;
+				else
+					value = (sample(0, -1) + sample(0, 1)) * 0.5f;
+			}
+		}
+	}
+	for (int c = 0; c < cornerCount; c++)
+	{
+		const glm::ivec2& corner = corners[c];
+		for (int j = 1; j < yPoints; j += 2)
+			marchingCubes[getIndex(corner.x, j, corner.y)] = (marchingCubes[getIndex(corner.x, j - 1, corner.y)] + marchingCubes[getIndex(corner.x, j + 1, corner.y)]) * 0.5f;
+	}
 
-	auto getPosition = [&](const glm::ivec3& pos)
+	// Same interpolation as createVertex() along the edge of the coarser chunk that contains the edge from point
+	auto getCoarseCrossing = [&](glm::ivec3 point, int axis)
 	{
-		return glm::vec4{ float(pos.x) / float(resolution.x) * size.x - size.x / 2, float(pos.y) / float(resolution.y) * size.y, float(pos.z) / float(resolution.z) * size.z - size.z / 2, marchingCubes[getIndex(pos.x, pos.y, pos.z)] };
+		point[axis] -= point[axis] % 2;
+		glm::ivec3 end = point;
+		end[axis] += 2;
+		float densityA = marchingCubes[getIndex(point.x, point.y, point.z)];
+		float densityB = marchingCubes[getIndex(end.x, end.y, end.z)];
+		float t = (m_SurfaceLevel - densityA) / (densityB - densityA);
+		glm::vec3 positionA = getPosition(point.x, point.y, point.z);
+		glm::vec3 positionB = getPosition(end.x, end.y, end.z);
+		return positionA + (positionB - positionA) * t;
 	};
 
-	for (int i = 0; i < xPoints; i++)
+	// Projects the position onto the contour of the coarse square around the edge from point, which runs along axis
+	// halfway between two coarse grid lines of the other axis
+	auto snapToCoarseContour = [&](const glm::ivec3& point, int axis, int other, const glm::vec3& position)
 	{
-		for (int j = 0; j < yPoints; j++)
+		glm::ivec3 corner = point;
+		corner[axis] -= corner[axis] % 2;
+		corner[other] -= 1;
+		glm::ivec3 starts[4] = { corner, corner, corner, corner };
+		int axes[4] = { axis, other, axis, other };
+		starts[1][axis] += 2;
+		starts[2][other] += 2;
+
+		// Crossings in order around the square, a saddle has four
+		glm::vec3 crossings[4];
+		int count = 0;
+		for (int edge = 0; edge < 4; edge++)
 		{
-			for (int k = 0; k < zPoints; k++)
+			glm::ivec3 end = starts[edge];
+			end[axes[edge]] += 2;
+			if (isInside(getIndex(starts[edge].x, starts[edge].y, starts[edge].z)) != isInside(getIndex(end.x, end.y, end.z)))
+				crossings[count++] = getCoarseCrossing(starts[edge], axes[edge]);
+		}
+		if (count < 2)
+			return position;
+
+		glm::vec3 result = position;
+		float bestDistance = std::numeric_limits<float>::max();
+		for (int segment = 0; segment < (count == 2 ? 1 : 4); segment++)
+		{
+			const glm::vec3& a = crossings[segment];
+			const glm::vec3& b = crossings[(segment + 1) % count];
+			glm::vec3 direction = b - a;
+			float lengthSqr = glm::dot(direction, direction);
+			float t = lengthSqr > 0.0f ? glm::clamp(glm::dot(position - a, direction) / lengthSqr, 0.0f, 1.0f) : 0.0f;
+			glm::vec3 projected = a + direction * t;
+			float distance = glm::dot(projected - position, projected - position);
+			if (distance < bestDistance)
 			{
-				float noise = simplex.fractal(4, float(i) / scale + m_Position.x, float(j) / scale + m_Position.y, float(k) / scale + m_Position.z);
-				float value = float(j) * -heightPerPoint + noise * heightScale;
-				marchingCubes[getIndex(i, j, k)] = value;
+				bestDistance = distance;
+				result = projected;
 			}
 		}
-	}
+		return result;
+	};
 
-	auto calculateLookupIndex = [marchingCubes, &getIndex, this](glm::ivec3 neighbours[8])
+	auto getTransitionPosition = [&](const glm::ivec3& point, int axis, const glm::vec3& position)
 	{
-		uint32_t index = 0;
-		for (int i = 0; i < 8; i++)
+		for (int f = 0; f < faceCount; f++)
+		{
+			const TransitionFace& face = faces[f];
+			if (point[face.Axis] != face.Plane || axis == face.Axis)
+				continue;
+			int other = face.U == axis ? face.V : face.U;
+			if (point[other] % 2 == 0)
+				return getCoarseCrossing(point, axis);
+			return snapToCoarseContour(point, axis, other, position);
+		}
+		for (int c = 0; c < cornerCount; c++)
+		{
+			if (axis == 1 && point.x == corners[c].x && point.z == corners[c].y)
+				return getCoarseCrossing(point, axis);
+		}
+		return position;
+	};
+
+	// Each vertex lies on the edge from a grid point towards +x, +y or +z.
+	// Calls func(j, k, axis) for the edges starting in slice i that cross the surface, always in the same order
+	auto forEachEdge = [&](int i, auto&& func)
+	{
+		for (int j = 0; j < yPoints; j++)
 		{
-			if (marchingCubes[getIndex(neighbours[i].x, neighbours[i].y, neighbours[i].z)] >= m_SurfaceLevel)
+			for (int k = 0; k < zPoints; k++)
 			{
-				index |= (1 << i);
+				int index = getIndex(i, j, k);
+				bool inside = isInside(index);
+				if (i + 1 < xPoints && isInside(getIndex(i + 1, j, k)) != inside)
+					func(j, k, 0);
+				if (j + 1 < yPoints && isInside(getIndex(i, j + 1, k)) != inside)
+					func(j, k, 1);
+				if (k + 1 < zPoints && isInside(getIndex(i, j, k + 1)) != inside)
+					func(j, k, 2);
 			}
 		}
-		return index;
 	};
 
-	auto interpolate = [this](const glm::vec4& a, const glm::vec4& b)
+	auto createVertex = [&](int i, int j, int k, int axis)
 	{
-		return glm::vec3(a) + (glm::vec3(b) - glm::vec3(a)) * (m_SurfaceLevel - a.w) / (b.w - a.w);
+		glm::ivec3 a = { i, j, k };
+		glm::ivec3 b = a;
+		b[axis]++;
+		float densityA = marchingCubes[getIndex(a.x, a.y, a.z)];
+		float densityB = marchingCubes[getIndex(b.x, b.y, b.z)];
+		float t = (m_SurfaceLevel - densityA) / (densityB - densityA);
+		glm::vec3 positionA = getPosition(a.x, a.y, a.z);
+		glm::vec3 positionB = getPosition(b.x, b.y, b.z);
+		glm::vec3 gradientA = getGradient(a.x, a.y, a.z);
+		glm::vec3 gradientB = getGradient(b.x, b.y, b.z);
+
+		TerrainVertex vertex;
+		vertex.Position = positionA + (positionB - positionA) * t;
+		if (faceCount > 0 || cornerCount > 0)
+			vertex.Position = getTransitionPosition(a, axis, vertex.Position);
+		// Density increases towards the inside of the terrain
+		glm::vec3 gradient = gradientA + (gradientB - gradientA) * t;
+		float length = glm::length(gradient);
+		vertex.Normal = length > 0.0f ? -gradient / length : glm::vec3{ 0.0f, 1.0f, 0.0f };
+		vertex.UV = { 0.0f, 0.0f };
+		return vertex;
 	};
 
-	auto interpolateUVs = [](int a, int b)
+	// Grid point that each cube edge starts from and the axis it runs along
+	glm::ivec3 edgeOffsets[12];
+	int edgeAxes[12];
+	for (int edge = 0; edge < 12; edge++)
 	{
-		glm::vec2 aUv = { 0.0f, 0.0f };
-		glm::vec2 bUv = { 0.0f, 0.0f };
-		return (aUv + bUv) / 2.0f;
+		glm::ivec3 a = s_CornerOffsets[cornerIndexAFromEdge[edge]];
+		glm::ivec3 b = s_CornerOffsets[cornerIndexBFromEdge[edge]];
+		edgeOffsets[edge] = { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) };
+		edgeAxes[edge] = a.x != b.x ? 0 : (a.y != b.y ? 1 : 2);
+	}
+
+	uint32_t triangulationSizes[256];
+	for (int lookupIndex = 0; lookupIndex < 256; lookupIndex++)
+	{
+		uint32_t count = 0;
+		while (triangulation[lookupIndex][count] != -1)
+			count++;
+		triangulationSizes[lookupIndex] = count;
+	}
+
+	// Each job owns the vertices on the edges starting in its slices and the triangles of the cells in its slices.
+	// Counting them first gives every job the offset of its output, so the jobs can write straight into the mesh buffers
+	// and the triangles of the last slice can refer to the vertices of the next job before they exist
+	auto forEachJob = [&](const std::function<void(size_t, size_t)>& func)
+	{
+		if (parallel)
+		{
+			JobSystem::Get().ParallelFor(xPoints, SlicesPerJob, func);
+			return;
+		}
+		for (size_t begin = 0; begin < size_t(xPoints); begin += SlicesPerJob)
+			func(begin, std::min(begin + SlicesPerJob, size_t(xPoints)));
 	};
 
-	std::vector<Triangle> triangles;
-	for (int i = 0; i < xPoints - 1; i++)
+	size_t chunkCount = (size_t(xPoints) + SlicesPerJob - 1) / SlicesPerJob;
+	std::vector<uint32_t> vertexOffsets(chunkCount + 1, 0);
+	std::vector<uint32_t> indexOffsets(chunkCount + 1, 0);
+	forEachJob([&](size_t begin, size_t end)
 	{
-		for (int j = 0; j < yPoints - 1; j++)
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		for (int i = int(begin); i < int(end); i++)
 		{
-			for (int k = 0; k < zPoints - 1; k++)
+			forEachEdge(i, [&vertexCount](int, int, int) { vertexCount++; });
+			if (i + 1 >= xPoints)
+				continue;
+			for (int j = 0; j < yPoints - 1; j++)
 			{
-				glm::ivec3 neighbours[8];
-				getNeighbours(i, j, k, neighbours);
-				uint32_t lookupIndex = calculateLookupIndex(neighbours);
+				for (int k = 0; k < zPoints - 1; k++)
+					indexCount += triangulationSizes[getLookupIndex(i, j, k)];
+			}
+		}
+		vertexOffsets[begin / SlicesPerJob + 1] = vertexCount;
+		indexOffsets[begin / SlicesPerJob + 1] = indexCount;
+	});
+	for (size_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		vertexOffsets[chunk + 1] += vertexOffsets[chunk];
+		indexOffsets[chunk + 1] += indexOffsets[chunk];
+	}
 
-				for (int i = 0; triangulation[lookupIndex][i] != -1; i += 3)
+	BufferLayout layout = {
+		{ ShaderDataType::Float3 },
+		{ ShaderDataType::Float3 },
+		{ ShaderDataType::Float2 },
+	};
+	static_assert(sizeof(TerrainVertex) == (3 + 3 + 2) * sizeof(float));
+
+	// Flat shading gives every index its own vertex
+	uint32_t indexCount = indexOffsets[chunkCount];
+	Scope<MeshBuilder> builder = CreateScope<MeshBuilder>(layout, flat ? indexCount : vertexOffsets[chunkCount], indexCount, mode);
+	TerrainVertex* vertices = builder->GetVertices<TerrainVertex>();
+	uint32_t* indices = builder->GetIndices();
+	std::vector<BoundingBox> chunkBounds(chunkCount);
+	size_t sliceSize = size_t(yPoints) * size_t(zPoints) * 3;
+
+	// Only the vertex indices of two slices are kept at a time, indexed by (j * zPoints + k) * 3 + axis.
+	// Flat shading keeps the vertices of the two slices as well, and the indices refer to those instead
+	forEachJob([&](size_t begin, size_t end)
+	{
+		size_t chunk = begin / SlicesPerJob;
+		BoundingBox& bounds = chunkBounds[chunk];
+		std::vector<uint32_t> current(sliceSize, InvalidVertex);
+		std::vector<uint32_t> next(sliceSize, InvalidVertex);
+		std::vector<TerrainVertex> currentVertices;
+		std::vector<TerrainVertex> nextVertices;
+		uint32_t vertexIndex = vertexOffsets[chunk];
+		uint32_t indexIndex = indexOffsets[chunk];
+
+		auto fillSlice = [&](int i, std::vector<uint32_t>& slice, std::vector<TerrainVertex>& sliceVertices, uint32_t& index, bool owned)
+		{
+			sliceVertices.clear();
+			forEachEdge(i, [&](int j, int k, int axis)
+			{
+				uint32_t& id = slice[(size_t(j) * zPoints + k) * 3 + axis];
+				if (flat)
 				{
-					int a0 = cornerIndexAFromEdge[triangulation[lookupIndex][i]];
-					int b0 = cornerIndexBFromEdge[triangulation[lookupIndex][i]];
-
-					int a1 = cornerIndexAFromEdge[triangulation[lookupIndex][i + 1]];
-					int b1 = cornerIndexBFromEdge[triangulation[lookupIndex][i + 1]];
-
-					int a2 = cornerIndexAFromEdge[triangulation[lookupIndex][i + 2]];
-					int b2 = cornerIndexBFromEdge[triangulation[lookupIndex][i + 2]];
+					id = uint32_t(sliceVertices.size());
+					sliceVertices.push_back(createVertex(i, j, k, axis));
+					return;
+				}
+				if (owned)
+				{
+					vertices[index] = createVertex(i, j, k, axis);
+					bounds.Expand(vertices[index].Position);
+				}
+				id = index++;
+			});
+		};
 
-					Triangle triangle;
+		auto getEdgeId = [&](int j, int k, int edge)
+		{
+			const glm::ivec3& offset = edgeOffsets[edge];
+			const std::vector<uint32_t>& slice = offset.x == 0 ? current : next;
+			return slice[(size_t(j + offset.y) * zPoints + (k + offset.z)) * 3 + edgeAxes[edge]];
+		};
 
-					triangle.Vertices[0] = interpolate(getPosition(neighbours[a0]), getPosition(neighbours[b0]));
-					triangle.Vertices[1] = interpolate(getPosition(neighbours[a1]), getPosition(neighbours[b1]));
-					triangle.Vertices[2] = interpolate(getPosition(neighbours[a2]), getPosition(neighbours[b2]));
+		fillSlice(int(begin), current, currentVertices, vertexIndex, true);
+		for (int i = int(begin); i < int(end) && i + 1 < xPoints; i++)
+		{
+			if (i + 1 < int(end))
+			{
+				fillSlice(i + 1, next, nextVertices, vertexIndex, true);
+			}
+			else
+			{
+				uint32_t nextIndex = vertexOffsets[chunk + 1];
+				fillSlice(i + 1, next, nextVertices, nextIndex, false);
+			}
 
-					triangle.UVs[0] = interpolateUVs(a0, b0);
-					triangle.UVs[1] = interpolateUVs(a1, b1);
-					triangle.UVs[2] = interpolateUVs(a2, b2);
-					triangles.push_back(triangle);
+			for (int j = 0; j < yPoints - 1; j++)
+			{
+				for (int k = 0; k < zPoints - 1; k++)
+				{
+					const int* edges = triangulation[getLookupIndex(i, j, k)];
+					for (int t = 0; edges[t] != -1; t += 3)
+					{
+						if (!flat)
+						{
+							for (int v = 0; v < 3; v++)
+								indices[indexIndex++] = getEdgeId(j, k, edges[t + v]);
+							continue;
+						}
+
+						const TerrainVertex* corners[3];
+						for (int v = 0; v < 3; v++)
+						{
+							const std::vector<TerrainVertex>& sliceVertices = edgeOffsets[edges[t + v]].x == 0 ? currentVertices : nextVertices;
+							corners[v] = &sliceVertices[getEdgeId(j, k, edges[t + v])];
+						}
+						glm::vec3 normal = glm::normalize(glm::cross(corners[1]->Position - corners[0]->Position, corners[2]->Position - corners[0]->Position));
+						for (const TerrainVertex* corner : corners)
+						{
+							vertices[indexIndex] = { corner->Position, normal, corner->UV };
+							bounds.Expand(corner->Position);
+							indices[indexIndex] = indexIndex;
+							indexIndex++;
+						}
+					}
 				}
 			}
+			std::swap(current, next);
+			std::swap(currentVertices, nextVertices);
 		}
-	}
+	});
+
+	bounds = BoundingBox();
+	for (const BoundingBox& chunk : chunkBounds)
+		bounds = Union(bounds, chunk);
+	return builder;
+}
 
-	delete[] marchingCubes;
-	return triangles;
+Terrain::DensityField Terrain::SampleDensity(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const
+{
+	SimplexNoise simplex;
+	int xPoints = resolution.x + 1;
+	int yPoints = resolution.y + 1;
+	int zPoints = resolution.z + 1;
+	float heightPerPoint = float(size.y) / float(resolution.y - 1);
+	float scale = 50.0f;
+
+	DensityField field;
+	field.Resolution = resolution;
+	field.Size = size;
+	field.Offset = { -size.x / 2, 0.0f, -size.z / 2 };
+	field.Padding = 0;
+	field.Values.resize(size_t(xPoints) * size_t(yPoints) * size_t(zPoints));
+	std::vector<float>& density = field.Values;
+
+	std::vector<float> xs(xPoints);
+	std::vector<float> ys(yPoints);
+	std::vector<float> zs(zPoints);
+	for (int i = 0; i < xPoints; i++)
+		xs[i] = float(i) / scale + m_Position.x;
+	for (int j = 0; j < yPoints; j++)
+		ys[j] = float(j) / scale + m_Position.y;
+	for (int k = 0; k < zPoints; k++)
+		zs[k] = float(k) / scale + m_Position.z;
+
+	// Each job fills whole z slices so that the noise is evaluated along contiguous rows of x.
+	// Every point is written by exactly one job, so the field is the same as when sampled serially
+	size_t sliceSize = size_t(xPoints) * size_t(yPoints);
+	JobSystem::Get().ParallelFor(zPoints, SlicesPerJob, [&](size_t begin, size_t end)
+	{
+		simplex.fractalGrid(4, xs.data(), xPoints, ys.data(), yPoints, zs.data() + begin, end - begin, density.data() + begin * sliceSize);
+		for (size_t k = begin; k < end; k++)
+		{
+			for (int j = 0; j < yPoints; j++)
+			{
+				float* row = density.data() + k * sliceSize + size_t(j) * xPoints;
+				for (int i = 0; i < xPoints; i++)
+					row[i] = float(j) * -heightPerPoint + row[i] * heightScale;
+			}
+		}
+	});
+	return field;
 }
@@ -3,26 +3,90 @@
 #include "Forge.h"
 using namespace Forge;
 
-struct Triangle
+struct TerrainVertex
 {
 public:
-	glm::vec3 Vertices[3];
-	glm::vec2 UVs[3];
+	glm::vec3 Position;
+	glm::vec3 Normal;
+	glm::vec2 UV;
+};
+
+enum class TerrainShading
+{
+	// Shared vertices with normals taken from the density gradient
+	Smooth,
+	// Three vertices per triangle with the face normal
+	Flat,
+};
+
+// Sides and vertical corner lines of a chunk that border a chunk generated at half the resolution
+enum TerrainTransition : uint32_t
+{
+	TerrainTransitionNegativeX = 1 << 0,
+	TerrainTransitionPositiveX = 1 << 1,
+	TerrainTransitionNegativeZ = 1 << 2,
+	TerrainTransitionPositiveZ = 1 << 3,
+	// Corner lines are set when any of the chunks that share them is coarser, they are implied by the sides
+	TerrainTransitionNegativeXNegativeZ = 1 << 4,
+	TerrainTransitionPositiveXNegativeZ = 1 << 5,
+	TerrainTransitionNegativeXPositiveZ = 1 << 6,
+	TerrainTransitionPositiveXPositiveZ = 1 << 7,
+};
+
+// Box of the world space density field marched into one chunk
+struct TerrainChunkDesc
+{
+public:
+	glm::vec3 Origin;
+	glm::vec3 Size;
+	// Cells along each axis, must be even along the sides of a transition
+	glm::ivec3 Resolution;
+	// World units per unit of the noise
+	float NoiseScale;
+	float HeightScale;
+	// TerrainTransition flags
+	uint32_t Transitions = 0;
+	TerrainShading Shading = TerrainShading::Smooth;
+	// Samples and marches the chunk across the JobSystem, the mesh is the same as when generated serially.
+	// Chunks generated on a streaming thread should leave this off
+	bool Parallel = false;
 };
 
 class Terrain
 {
 private:
+	// Number of slices sampled or marched by each job
+	static constexpr size_t SlicesPerJob = 4;
+
+	// Density of a grid of Resolution + 1 points per axis plus Padding points on every side, which are only read for the
+	// normals. Point (x, y, z) is at Offset + (x, y, z) / Resolution * Size
+	struct DensityField
+	{
+	public:
+		std::vector<float> Values;
+		glm::ivec3 Resolution;
+		glm::vec3 Size;
+		glm::vec3 Offset;
+		int Padding;
+	};
+
 	glm::vec3 m_Position;
 	float m_SurfaceLevel;
 
 public:
 	Terrain(const glm::vec3& position, float surfaceLevel);
 
-	Ref<Mesh> GenerateMesh(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const;
-	Ref<Mesh> GeneratePointsMesh(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const;
+	// Marches the density field straight into the mesh buffers, pass GL_POINTS as the draw mode to render the vertices
+	Ref<Mesh> GenerateMesh(const glm::vec3& size, const glm::ivec3& resolution, float heightScale, TerrainShading shading = TerrainShading::Smooth, GLuint drawMode = GL_TRIANGLES) const;
+	// Marches one chunk of GetDensity() on the calling thread without any GL calls, vertices are relative to desc.Origin.
+	// Chunks that share a side and have the same resolution, or the transition flags set towards the coarser chunk, meet without cracks
+	Scope<MeshBuilder> GenerateChunk(const TerrainChunkDesc& desc, BoundingBox& bounds) const;
+	// Density in world space, the terrain is where it is at least the surface level
+	float GetDensity(const glm::vec3& position, float noiseScale, float heightScale) const;
 
 private:
-	std::vector<Triangle> MarchingCubes(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const;
+	DensityField SampleDensity(const glm::vec3& size, const glm::ivec3& resolution, float heightScale) const;
+	// Conforms the transition sides of the field and builds the mesh, jobs are run on the JobSystem if parallel is set
+	Scope<MeshBuilder> March(DensityField& field, uint32_t transitions, TerrainShading shading, MeshBuilderMode mode, bool parallel, BoundingBox& bounds) const;
 
 };
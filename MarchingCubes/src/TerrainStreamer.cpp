@@ -0,0 +1,286 @@
+#include "TerrainStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Neighbouring chunks in the order of the side flags of TerrainTransition
+static const glm::ivec2 s_SideOffsets[4] = {
+	{ -1, 0 },
+	{ 1, 0 },
+	{ 0, -1 },
+	{ 0, 1 },
+};
+
+// Diagonal chunks in the order of the corner flags of TerrainTransition
+static const glm::ivec2 s_CornerOffsets[4] = {
+	{ -1, -1 },
+	{ 1, -1 },
+	{ -1, 1 },
+	{ 1, 1 },
+};
+
+TerrainStreamer::TerrainStreamer(const Terrain& terrain, Scene& scene, const Ref<Material>& material, uint8_t layer, const TerrainStreamingSettings& settings)
+	: m_Terrain(terrain), m_Settings(settings), m_Scene(&scene), m_Material(material), m_Layer(layer), m_Frame(0),
+	m_Resident(), m_ResidentBytes(0), m_Visible(), m_Pending(), m_Finished(), m_Workers(), m_Mutex(), m_RequestsAvailable(),
+	m_Requests(), m_Results(), m_Running(true), m_GeneratedChunks(0), m_TotalGenerationMs(0.0f), m_MaxGenerationMs(0.0f),
+	m_UploadedChunks(0), m_TotalUploadMs(0.0f), m_MaxUploadMs(0.0f)
+{
+	int coarsest = 1 << (m_Settings.LodCount - 1);
+	FORGE_ASSERT(m_Settings.Resolution.x % coarsest == 0 && m_Settings.Resolution.y % coarsest == 0 && m_Settings.Resolution.z % coarsest == 0, "Resolution must be divisible by 2^(LodCount - 1)");
+	FORGE_ASSERT(m_Settings.LodRings > 0, "Every level of detail needs at least one ring");
+	for (uint32_t i = 0; i < std::max(m_Settings.WorkerCount, 1u); i++)
+		m_Workers.emplace_back([this]() { RunWorker(); });
+}
+
+TerrainStreamer::~TerrainStreamer()
+{
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_RequestsAvailable.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+	for (const auto& [coord, chunk] : m_Visible)
+		m_Scene->DestroyEntity(chunk.Entity);
+}
+
+void TerrainStreamer::Update(const glm::vec3& cameraPosition)
+{
+	m_Frame++;
+	glm::ivec2 center = { int(std::floor(cameraPosition.x / m_Settings.ChunkSize)), int(std::floor(cameraPosition.z / m_Settings.ChunkSize)) };
+
+	// The chunk of every coordinate in view for this camera position, with the level of detail of its neighbours
+	std::vector<std::pair<glm::ivec2, uint64_t>> chunks;
+	std::unordered_set<uint64_t> wanted;
+	for (int z = -m_Settings.ViewDistance; z <= m_Settings.ViewDistance; z++)
+	{
+		for (int x = -m_Settings.ViewDistance; x <= m_Settings.ViewDistance; x++)
+		{
+			glm::ivec2 coord = center + glm::ivec2{ x, z };
+			int lod = GetLod(coord, center);
+			uint64_t key = GetChunkKey(coord, lod, GetTransitions(coord, center, lod));
+			chunks.push_back({ coord, key });
+			wanted.insert(key);
+		}
+	}
+
+	UploadChunks(wanted);
+
+	// Coordinates whose chunk is not resident yet keep showing the chunk of the previous level of detail
+	std::vector<ChunkRequest> requests;
+	for (const auto& [coord, key] : chunks)
+	{
+		if (m_Resident.find(key) != m_Resident.end())
+		{
+			ShowChunk(coord, key);
+			continue;
+		}
+		auto visible = m_Visible.find(GetCoordKey(key));
+		if (visible != m_Visible.end())
+		{
+			visible->second.Frame = m_Frame;
+			m_Resident.at(visible->second.Key).UsedFrame = m_Frame;
+		}
+		if (m_Pending.insert(key).second)
+		{
+			int lod = int((key >> 8) & 0xFF);
+			requests.push_back({ key, coord, GetChunkDesc(coord, lod, uint32_t(key & 0xFF)) });
+		}
+	}
+
+	for (auto it = m_Visible.begin(); it != m_Visible.end();)
+	{
+		if (it->second.Frame != m_Frame)
+		{
+			m_Scene->DestroyEntity(it->second.Entity);
+			it = m_Visible.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		// Queued chunks that left the view are dropped before a worker starts them
+		for (ChunkRequest& request : m_Requests)
+		{
+			if (wanted.find(request.Key) != wanted.end())
+				requests.push_back(std::move(request));
+			else
+				m_Pending.erase(request.Key);
+		}
+		auto getDistance = [center](const ChunkRequest& request)
+		{
+			glm::ivec2 offset = request.Coord - center;
+			return std::max(std::abs(offset.x), std::abs(offset.y));
+		};
+		std::sort(requests.begin(), requests.end(), [&getDistance](const ChunkRequest& a, const ChunkRequest& b)
+		{
+			return getDistance(a) > getDistance(b);
+		});
+		m_Requests = std::move(requests);
+	}
+	m_RequestsAvailable.notify_all();
+
+	EvictChunks();
+}
+
+TerrainStreamingStats TerrainStreamer::GetStats() const
+{
+	TerrainStreamingStats stats;
+	stats.VisibleChunks = uint32_t(m_Visible.size());
+	stats.ResidentChunks = uint32_t(m_Resident.size());
+	stats.ResidentBytes = m_ResidentBytes;
+	stats.PendingChunks = uint32_t(m_Pending.size());
+	stats.GeneratedChunks = m_GeneratedChunks;
+	stats.AverageGenerationMs = m_GeneratedChunks > 0 ? m_TotalGenerationMs / float(m_GeneratedChunks) : 0.0f;
+	stats.MaxGenerationMs = m_MaxGenerationMs;
+	stats.AverageUploadMs = m_UploadedChunks > 0 ? m_TotalUploadMs / float(m_UploadedChunks) : 0.0f;
+	stats.MaxUploadMs = m_MaxUploadMs;
+	return stats;
+}
+
+int TerrainStreamer::GetLod(const glm::ivec2& coord, const glm::ivec2& center) const
+{
+	// Rings of the Chebyshev distance, so that neighbouring chunks are at most one level of detail apart
+	int distance = std::max(std::abs(coord.x - center.x), std::abs(coord.y - center.y));
+	return std::min(distance / m_Settings.LodRings, m_Settings.LodCount - 1);
+}
+
+uint32_t TerrainStreamer::GetTransitions(const glm::ivec2& coord, const glm::ivec2& center, int lod) const
+{
+	uint32_t transitions = 0;
+	for (int side = 0; side < 4; side++)
+	{
+		if (GetLod(coord + s_SideOffsets[side], center) > lod)
+			transitions |= TerrainTransitionNegativeX << side;
+	}
+	for (int corner = 0; corner < 4; corner++)
+	{
+		const glm::ivec2& offset = s_CornerOffsets[corner];
+		if (GetLod(coord + glm::ivec2{ offset.x, 0 }, center) > lod || GetLod(coord + glm::ivec2{ 0, offset.y }, center) > lod || GetLod(coord + offset, center) > lod)
+			transitions |= TerrainTransitionNegativeXNegativeZ << corner;
+	}
+	return transitions;
+}
+
+TerrainChunkDesc TerrainStreamer::GetChunkDesc(const glm::ivec2& coord, int lod, uint32_t transitions) const
+{
+	TerrainChunkDesc desc;
+	desc.Origin = { float(coord.x) * m_Settings.ChunkSize, m_Settings.MinHeight, float(coord.y) * m_Settings.ChunkSize };
+	desc.Size = { m_Settings.ChunkSize, m_Settings.Height, m_Settings.ChunkSize };
+	desc.Resolution = m_Settings.Resolution / (1 << lod);
+	desc.NoiseScale = m_Settings.NoiseScale;
+	desc.HeightScale = m_Settings.HeightScale;
+	desc.Transitions = transitions;
+	desc.Shading = m_Settings.Shading;
+	return desc;
+}
+
+void TerrainStreamer::UploadChunks(const std::unordered_set<uint64_t>& wanted)
+{
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		for (ChunkResult& result : m_Results)
+		{
+			m_GeneratedChunks++;
+			m_TotalGenerationMs += result.GenerationMs;
+			m_MaxGenerationMs = std::max(m_MaxGenerationMs, result.GenerationMs);
+			m_Finished.push_back(std::move(result));
+		}
+		m_Results.clear();
+	}
+
+	// Uploading is spread over several frames so that a burst of finished chunks does not stall one of them
+	size_t uploadedBytes = 0;
+	size_t index = 0;
+	for (; index < m_Finished.size() && uploadedBytes < m_Settings.UploadBytesPerFrame; index++)
+	{
+		ChunkResult& result = m_Finished[index];
+		m_Pending.erase(result.Key);
+		if (wanted.find(result.Key) == wanted.end())
+			continue;
+
+		size_t sizeBytes = result.Builder->GetSizeBytes();
+		auto start = std::chrono::steady_clock::now();
+		Ref<Mesh> mesh = result.Builder->Build(result.Bounds);
+		float uploadMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_UploadedChunks++;
+		m_TotalUploadMs += uploadMs;
+		m_MaxUploadMs = std::max(m_MaxUploadMs, uploadMs);
+
+		m_Resident[result.Key] = { mesh, sizeBytes, m_Frame };
+		m_ResidentBytes += sizeBytes;
+		uploadedBytes += sizeBytes;
+	}
+	m_Finished.erase(m_Finished.begin(), m_Finished.begin() + index);
+}
+
+void TerrainStreamer::ShowChunk(const glm::ivec2& coord, uint64_t key)
+{
+	ResidentChunk& resident = m_Resident.at(key);
+	resident.UsedFrame = m_Frame;
+	VisibleChunk& visible = m_Visible[GetCoordKey(key)];
+	if (!visible.Entity)
+	{
+		visible.Entity = m_Scene->CreateEntity(m_Layer);
+		visible.Entity.AddComponent<ModelRendererComponent>(Model::Create(resident.Mesh, m_Material));
+		visible.Entity.GetTransform().SetLocalPosition({ float(coord.x) * m_Settings.ChunkSize, m_Settings.MinHeight, float(coord.y) * m_Settings.ChunkSize });
+	}
+	else if (visible.Key != key)
+	{
+		visible.Entity.GetComponent<ModelRendererComponent>().Model = Model::Create(resident.Mesh, m_Material);
+	}
+	visible.Key = key;
+	visible.Frame = m_Frame;
+}
+
+void TerrainStreamer::EvictChunks()
+{
+	if (m_ResidentBytes <= m_Settings.MemoryBudget)
+		return;
+	// Chunks used this frame are visible and are never evicted
+	std::vector<std::pair<uint64_t, uint64_t>> unused;
+	for (const auto& [key, chunk] : m_Resident)
+	{
+		if (chunk.UsedFrame != m_Frame)
+			unused.push_back({ chunk.UsedFrame, key });
+	}
+	std::sort(unused.begin(), unused.end());
+	for (const auto& [frame, key] : unused)
+	{
+		if (m_ResidentBytes <= m_Settings.MemoryBudget)
+			break;
+		auto it = m_Resident.find(key);
+		m_ResidentBytes -= it->second.SizeBytes;
+		m_Resident.erase(it);
+	}
+}
+
+void TerrainStreamer::RunWorker()
+{
+	while (true)
+	{
+		ChunkRequest request;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_RequestsAvailable.wait(lock, [this]() { return !m_Running || !m_Requests.empty(); });
+			if (!m_Running)
+				return;
+			request = m_Requests.back();
+			m_Requests.pop_back();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		ChunkResult result;
+		result.Key = request.Key;
+		result.Builder = m_Terrain.GenerateChunk(request.Desc, result.Bounds);
+		result.GenerationMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		m_Results.push_back(std::move(result));
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "Terrain.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+struct TerrainStreamingSettings
+{
+public:
+	// Horizontal size of every chunk, the chunks cover the whole height of the terrain
+	float ChunkSize = 8.0f;
+	float MinHeight = -8.0f;
+	float Height = 16.0f;
+	// Cells of the chunks around the camera, halved for each level of detail. Must be divisible by 2^(LodCount - 1)
+	glm::ivec3 Resolution = { 32, 64, 32 };
+	int LodCount = 3;
+	// Rings of chunks around the camera chunk at each level of detail
+	int LodRings = 2;
+	// Chunks kept visible in each direction from the camera chunk
+	int ViewDistance = 6;
+	float NoiseScale = 5.0f;
+	float HeightScale = 2.0f;
+	TerrainShading Shading = TerrainShading::Smooth;
+	uint32_t WorkerCount = 2;
+	// Chunk meshes that are no longer visible are kept until this is exceeded, least recently used first
+	size_t MemoryBudget = 128 * 1024 * 1024;
+	// Uploads for the frame stop once this many bytes were uploaded, at least one chunk is uploaded each frame
+	size_t UploadBytesPerFrame = 4 * 1024 * 1024;
+};
+
+struct TerrainStreamingStats
+{
+public:
+	uint32_t VisibleChunks;
+	uint32_t ResidentChunks;
+	size_t ResidentBytes;
+	// Chunks queued or being generated
+	uint32_t PendingChunks;
+	uint32_t GeneratedChunks;
+	float AverageGenerationMs;
+	float MaxGenerationMs;
+	float AverageUploadMs;
+	float MaxUploadMs;
+};
+
+// Keeps the chunks within the view distance of the camera generated and visible.
+// Chunks are generated on worker threads at a level of detail that drops with the distance, and uploaded on the main
+// thread within a budget per frame. Until the chunk for the current level of detail is uploaded the previous one stays visible
+class TerrainStreamer
+{
+private:
+	struct ChunkRequest
+	{
+	public:
+		uint64_t Key;
+		glm::ivec2 Coord;
+		TerrainChunkDesc Desc;
+	};
+
+	struct ChunkResult
+	{
+	public:
+		uint64_t Key;
+		Scope<MeshBuilder> Builder;
+		BoundingBox Bounds;
+		float GenerationMs;
+	};
+
+	struct ResidentChunk
+	{
+	public:
+		Ref<Forge::Mesh> Mesh;
+		size_t SizeBytes;
+		uint64_t UsedFrame;
+	};
+
+	struct VisibleChunk
+	{
+	public:
+		Forge::Entity Entity;
+		uint64_t Key;
+		uint64_t Frame;
+	};
+
+	Terrain m_Terrain;
+	TerrainStreamingSettings m_Settings;
+	Scene* m_Scene;
+	Ref<Material> m_Material;
+	uint8_t m_Layer;
+	uint64_t m_Frame;
+
+	// Uploaded meshes by chunk key
+	std::unordered_map<uint64_t, ResidentChunk> m_Resident;
+	size_t m_ResidentBytes;
+	// Displayed chunk of each coordinate, by coordinate key
+	std::unordered_map<uint64_t, VisibleChunk> m_Visible;
+	// Keys of the chunks that are queued, being generated or waiting to be uploaded
+	std::unordered_set<uint64_t> m_Pending;
+	std::vector<ChunkResult> m_Finished;
+
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_RequestsAvailable;
+	// Sorted so that the nearest chunk is at the back, guarded by m_Mutex
+	std::vector<ChunkRequest> m_Requests;
+	std::vector<ChunkResult> m_Results;
+	bool m_Running;
+
+	uint32_t m_GeneratedChunks;
+	float m_TotalGenerationMs;
+	float m_MaxGenerationMs;
+	uint32_t m_UploadedChunks;
+	float m_TotalUploadMs;
+	float m_MaxUploadMs;
+
+public:
+	// The scene must outlive the streamer
+	TerrainStreamer(const Terrain& terrain, Scene& scene, const Ref<Material>& material, uint8_t layer, const TerrainStreamingSettings& settings = {});
+	TerrainStreamer(const TerrainStreamer& other) = delete;
+	TerrainStreamer& operator=(const TerrainStreamer& other) = delete;
+	~TerrainStreamer();
+
+	// Must be called on the main thread once per frame
+	void Update(const glm::vec3& cameraPosition);
+	TerrainStreamingStats GetStats() const;
+
+private:
+	int GetLod(const glm::ivec2& coord, const glm::ivec2& center) const;
+	uint32_t GetTransitions(const glm::ivec2& coord, const glm::ivec2& center, int lod) const;
+	TerrainChunkDesc GetChunkDesc(const glm::ivec2& coord, int lod, uint32_t transitions) const;
+	void UploadChunks(const std::unordered_set<uint64_t>& wanted);
+	void ShowChunk(const glm::ivec2& coord, uint64_t key);
+	void EvictChunks();
+	void RunWorker();
+
+	static inline uint64_t GetChunkKey(const glm::ivec2& coord, int lod, uint32_t transitions)
+	{
+		return (uint64_t(uint32_t(coord.x) & 0xFFFFFF) << 40) | (uint64_t(uint32_t(coord.y) & 0xFFFFFF) << 16) | (uint64_t(lod) << 8) | uint64_t(transitions);
+	}
+	static inline uint64_t GetCoordKey(uint64_t chunkKey)
+	{
+		return chunkKey & ~uint64_t(0xFFFF);
+	}
+
+};
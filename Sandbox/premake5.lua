@@ -56,7 +56,8 @@ project "Sandbox"
 
         links 
         {
-            "stdc++fs"
+            "stdc++fs",
+            "pthread"
         }
 
     filter "system:macosx"
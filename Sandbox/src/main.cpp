@@ -2,13 +2,274 @@
 #include <glm/ext.hpp>
 
 #include "Forge.h"
+#include "Renderer/Renderer2D.h"
 
 using namespace Forge;
 
-int main()
+#include <chrono>
+
+// Prints the sprite throughput of Renderer2D::DrawQuads() and EndScene() over a million rotated quads with 1, 4 and 8 threads
+void BenchmarkSprites()
+{
+	constexpr size_t count = 1000000;
+	constexpr int frames = 10;
+	std::vector<glm::vec3> positions(count);
+	std::vector<glm::vec2> sizes(count);
+	std::vector<float> rotations(count);
+	std::vector<Color> colors(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		positions[i] = { float(i % 1000), float(i / 1000), 0.0f };
+		sizes[i] = { 0.5f + float(i % 7) * 0.1f, 0.5f + float(i % 5) * 0.1f };
+		rotations[i] = float(i % 360) * PI / 180.0f;
+		colors[i] = Color(uint8_t(i % 256), 128, 255);
+	}
+	QuadSpans quads;
+	quads.Count = count;
+	quads.Positions = positions.data();
+	quads.Sizes = sizes.data();
+	quads.Rotations = rotations.data();
+	quads.Colors = colors.data();
+
+	for (uint32_t threads : { 1, 4, 8 })
+	{
+		JobSystem jobs(threads - 1);
+		Renderer2D renderer(jobs);
+		// The first frame allocates the sprite storage and vertex buffers
+		renderer.BeginScene();
+		renderer.DrawQuads(quads);
+		renderer.EndScene();
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; i++)
+		{
+			renderer.BeginScene();
+			renderer.DrawQuads(quads);
+			renderer.EndScene();
+		}
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+		std::cout << "Sprites " << threads << " thread(s): " << ms << " ms/frame, " << count / ms << " quads/ms in " << renderer.GetStats().BatchCount << " batches" << std::endl;
+	}
+}
+
+// Prints the time Scene::OnUpdate() takes with 1,000 skinned characters of 64 joints each, which is dominated by pose evaluation.
+// The target is under 2 ms on 8 cores
+void BenchmarkAnimators()
+{
+	constexpr int characterCount = 1000;
+	constexpr int jointCount = 64;
+	constexpr int keyCount = 60;
+	constexpr float clipLength = 2.0f;
+	constexpr int frames = 100;
+
+	Ref<Skeleton> skeleton = CreateRef<Skeleton>();
+	Ref<Animation> animation = CreateRef<Animation>();
+	animation->Joints.resize(jointCount);
+	AnimationCompressionSettings compression;
+	for (int i = 0; i < jointCount; i++)
+	{
+		skeleton->AddJoint(i, i == 0 ? -1 : (i - 1) / 2, glm::mat4(1.0f));
+		AnimationTrack<glm::vec3> translation;
+		AnimationTrack<glm::quat> orientation;
+		glm::vec3 axis = glm::normalize(glm::vec3{ 1.0f, float(i % 3), 0.5f });
+		for (int key = 0; key <= keyCount; key++)
+		{
+			float time = clipLength * key / keyCount;
+			translation.AddKey(time, { 0.0f, 1.0f + 0.1f * std::sin(time * PI + i), 0.0f });
+			orientation.AddKey(time, glm::angleAxis(0.5f * std::sin(time * PI + i), axis));
+		}
+		animation->Joints[i].Translation = CompressTrack(translation, compression.TranslationTolerance);
+		animation->Joints[i].Orientation = CompressTrack(orientation, compression.OrientationTolerance);
+	}
+	// Never drawn, so the mesh needs no vertices
+	Ref<Model> model = Model::Create(CreateRef<AnimatedMesh>(nullptr, skeleton), nullptr);
+
+	Scene scene(nullptr, nullptr);
+	std::vector<Entity> characters;
+	for (int i = 0; i < characterCount; i++)
+	{
+		Entity character = scene.CreateEntity();
+		character.AddComponent<ModelRendererComponent>(model);
+		character.AddComponent<AnimatorComponent>().SetCurrentAnimation(animation);
+		characters.push_back(character);
+	}
+	std::vector<AnimatorComponent*> animators;
+	for (Entity& character : characters)
+		animators.push_back(&character.GetComponent<AnimatorComponent>());
+
+	// The first update allocates the palettes
+	scene.OnUpdate(1.0f / 60.0f);
+	double totalMs = 0.0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		// Characters are out of phase so that they sample different keys
+		for (size_t i = 0; i < animators.size(); i++)
+			animators[i]->SetAnimationTime(std::fmod(frame / 60.0f + i * 0.37f, clipLength));
+		auto start = std::chrono::steady_clock::now();
+		scene.OnUpdate(1.0f / 60.0f);
+		auto end = std::chrono::steady_clock::now();
+		totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+	}
+	std::cout << "Animators: " << characterCount << " characters, " << jointCount << " joints, " << JobSystem::Get().GetThreadCount() << " thread(s): "
+		<< totalMs / frames << " ms/frame (target 2 ms on 8 cores)" << std::endl;
+}
+
+// Prints the time TransformHierarchy::Update() takes on a 100k node scene graph when every node and when 1% of the nodes move,
+// compared to reading every world matrix by walking its parent chain, which is what TransformComponent::GetMatrix() used to do
+void BenchmarkTransforms()
+{
+	constexpr int nodeCount = 100000;
+	constexpr int frames = 20;
+
+	Scene scene(nullptr, nullptr);
+	TransformHierarchy& hierarchy = scene.GetTransformHierarchy();
+	std::vector<TransformComponent*> transforms;
+	std::vector<Entity> entities;
+	for (int i = 0; i < nodeCount; i++)
+		entities.push_back(scene.CreateEntity());
+	for (int i = 0; i < nodeCount; i++)
+	{
+		transforms.push_back(&entities[i].GetTransform());
+		// Four children per node, 9 levels deep
+		if (i > 0)
+			transforms[i]->SetParent(transforms[(i - 1) / 4]);
+	}
+	hierarchy.Update();
+
+	auto move = [&transforms](int frame, int step)
+	{
+		for (size_t i = frame % step; i < transforms.size(); i += step)
+			transforms[i]->SetLocalPosition({ std::sin(frame + float(i)), 0.1f * frame, 1.0f });
+	};
+
+	double walkMs = 0.0;
+	double updateMs = 0.0;
+	double sparseUpdateMs = 0.0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		move(frame, 1);
+		auto start = std::chrono::steady_clock::now();
+		// Nothing has been updated yet, so every matrix is calculated from its parent chain
+		for (const TransformComponent* transform : transforms)
+			transform->GetMatrix();
+		auto walked = std::chrono::steady_clock::now();
+		hierarchy.Update();
+		auto updated = std::chrono::steady_clock::now();
+		walkMs += std::chrono::duration<double, std::milli>(walked - start).count();
+		updateMs += std::chrono::duration<double, std::milli>(updated - walked).count();
+
+		move(frame, 100);
+		start = std::chrono::steady_clock::now();
+		hierarchy.Update();
+		sparseUpdateMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	std::cout << "Transforms: " << nodeCount << " nodes, " << JobSystem::Get().GetThreadCount() << " thread(s): parent chain walks "
+		<< walkMs / frames << " ms, Update() " << updateMs / frames << " ms (" << walkMs / updateMs << "x), Update() with 1% moving "
+		<< sparseUpdateMs / frames << " ms" << std::endl;
+}
+
+// Prints the time Scene::OnUpdate() takes with 50k colliders when none, 1% and all of them move, which is dominated by
+// CollisionSystem::UpdateColliders() and UpdateContacts(). The target is 1 ms on 8 cores
+void BenchmarkColliders()
+{
+	constexpr int colliderCount = 50000;
+	constexpr int gridSize = 37;
+	constexpr int frames = 20;
+
+	auto getGridPosition = [](int i)
+	{
+		return glm::vec3{ float(i % gridSize), float(i / gridSize % gridSize), float(i / (gridSize * gridSize)) };
+	};
+
+	Scene scene(nullptr, nullptr);
+	std::vector<Entity> entities;
+	for (int i = 0; i < colliderCount; i++)
+	{
+		Entity entity = scene.CreateEntity();
+		entity.GetTransform().SetLocalPosition(getGridPosition(i));
+		entity.GetTransform().SetLocalRotation(glm::angleAxis(float(i % 11) * 0.3f, glm::vec3{ 0, 1, 0 }));
+		// Neighbours are one unit apart, so the larger boxes touch
+		entity.AddComponent<AabbColliderComponent>().Dimensions = { 0.6f + float(i % 5) * 0.1f, 0.8f, 0.6f + float(i % 3) * 0.1f };
+		entities.push_back(entity);
+	}
+	std::vector<TransformComponent*> transforms;
+	for (Entity& entity : entities)
+		transforms.push_back(&entity.GetTransform());
+	// The first update builds the tree and finds every contact
+	scene.OnUpdate(1.0f / 60.0f);
+
+	std::cout << "Colliders: " << colliderCount << " colliders, " << JobSystem::Get().GetThreadCount() << " thread(s):";
+	for (int step : { 0, 100, 1 })
+	{
+		double totalMs = 0.0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			for (int i = step > 0 ? frame % step : colliderCount; i < colliderCount; i += step)
+				transforms[i]->SetLocalPosition(getGridPosition(i) + glm::vec3{ 0.05f * std::sin(frame + float(i)), 0.0f, 0.0f });
+			// World matrices are updated before the timer starts so that only the collision system is measured
+			scene.GetTransformHierarchy().Update();
+			auto start = std::chrono::steady_clock::now();
+			scene.OnUpdate(1.0f / 60.0f);
+			auto end = std::chrono::steady_clock::now();
+			totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+		}
+		std::cout << (step == 0 ? " static " : step == 1 ? ", all moving " : ", 1% moving ") << totalMs / frames << " ms";
+	}
+	std::cout << " (target 1 ms on 8 cores), " << scene.GetCollisionSystem().GetContactCount() << " contacts" << std::endl;
+}
+
+// Renders frames of a lit scene through the recording backend and prints what reached GL, then runs the benchmarks without the
+// driver in the way
+void RunHeadless()
+{
+	constexpr int frames = 100;
+	RecordingRenderBackend backend(false);
+	WindowProps props;
+	props.Backend = &backend;
+	Application app(props);
+
+	Scene& scene = app.CreateScene();
+	Entity camera = scene.CreateCamera(Frustum::Perspective(PI / 3.0f, float(props.Width) / float(props.Height), 0.1f, 1000.0f));
+	camera.GetComponent<TransformComponent>().SetLocalPosition({ 0, 0, 10 });
+	camera.GetComponent<CameraComponent>().Viewport = { 0, 0, props.Width, props.Height };
+
+	Entity sphere = scene.CreateEntity();
+	sphere.AddComponent<ModelRendererComponent>(Model::Create(GraphicsCache::SphereMesh(), GraphicsCache::PbrColorMaterial(COLOR_WHITE)));
+
+	Entity sun = scene.CreateEntity();
+	sun.AddComponent<DirectionalLightComponent>().CreateShadowPass(4096, 4096);
+	sun.GetTransform().Rotate(-PI / 4.0f, glm::vec3{ 1, 0, 0 });
+
+	app.OnUpdate();
+	backend.Reset();
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++)
+		app.OnUpdate();
+	auto end = std::chrono::steady_clock::now();
+
+	const RecordingStats& stats = backend.GetStats();
+	std::cout << "Headless: " << std::chrono::duration<double, std::milli>(end - start).count() / frames << " ms/frame, per frame "
+		<< stats.DrawCount / frames << " draws, " << stats.BindCount / frames << " binds, " << stats.ShaderBindCount / frames << " shader binds, "
+		<< stats.UniformCount / frames << " uniforms, " << stats.StateChangeCount / frames << " state changes, "
+		<< stats.BufferUploadBytes / frames << " buffer bytes, " << stats.TextureUploadBytes / frames << " texture bytes" << std::endl;
+
+	BenchmarkSprites();
+	BenchmarkAnimators();
+	BenchmarkTransforms();
+	BenchmarkColliders();
+}
+
+int main(int argc, char** argv)
 {
 	ForgeInstance::Init();
 
+	if (argc > 1 && std::string(argv[1]) == "--headless")
+	{
+		RunHeadless();
+		return 0;
+	}
+
 	WindowProps props;
 	Application app(props);
 
@@ -51,6 +312,19 @@ int main()
 		return true;
 	});
 
+	Input::OnKeyPressed.AddEventListener([](const KeyCode& key)
+	{
+		if (key == KeyCode::B)
+			BenchmarkSprites();
+		if (key == KeyCode::N)
+			BenchmarkAnimators();
+		if (key == KeyCode::H)
+			BenchmarkTransforms();
+		if (key == KeyCode::C)
+			BenchmarkColliders();
+		return false;
+	});
+
 	while (!app.ShouldExit())
 	{
 		Timestep ts = app.GetTimestep();
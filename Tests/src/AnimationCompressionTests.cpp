@@ -0,0 +1,174 @@
+#include "TestFramework.h"
+
+#include <glm/ext.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace Forge;
+
+namespace
+{
+
+	constexpr int KeyCount = 61;
+	constexpr float ClipLength = 2.0f;
+
+	float GetKeyTime(int key)
+	{
+		return ClipLength * key / (KeyCount - 1);
+	}
+
+	// Animated by the file: node 1 (the root joint) translates and node 2 (its child) rotates
+	glm::vec3 GetSourceTranslation(float time)
+	{
+		return { std::sin(time * PI), 0.5f * time, 0.0f };
+	}
+
+	glm::quat GetSourceOrientation(float time)
+	{
+		return glm::angleAxis(1.2f * std::sin(2.0f * time), glm::normalize(glm::vec3{ 1.0f, 1.0f, 0.0f }));
+	}
+
+	// Minimal glTF with a skinned triangle and one animation, the binary buffer is written next to the json
+	class TestGltfWriter
+	{
+	private:
+		std::vector<uint8_t> m_Buffer;
+		std::vector<std::string> m_BufferViews;
+		std::vector<std::string> m_Accessors;
+
+	public:
+		int AddAccessor(const void* data, size_t size, int componentType, int count, const char* type, const std::string& bounds = "")
+		{
+			size_t offset = m_Buffer.size();
+			m_Buffer.insert(m_Buffer.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+			m_BufferViews.push_back("{ \"buffer\": 0, \"byteOffset\": " + std::to_string(offset) + ", \"byteLength\": " + std::to_string(size) + " }");
+			m_Accessors.push_back("{ \"bufferView\": " + std::to_string(m_BufferViews.size() - 1) + ", \"componentType\": " + std::to_string(componentType) +
+				", \"count\": " + std::to_string(count) + ", \"type\": \"" + type + "\"" + bounds + " }");
+			return int(m_Accessors.size() - 1);
+		}
+
+		std::string Write(const std::filesystem::path& directory)
+		{
+			std::ofstream(directory / "CompressionTest.bin", std::ios::binary).write((const char*)m_Buffer.data(), m_Buffer.size());
+
+			std::ostringstream json;
+			json << "{\n\"asset\": { \"version\": \"2.0\" },\n";
+			json << "\"scene\": 0,\n\"scenes\": [ { \"nodes\": [ 0, 1 ] } ],\n";
+			json << "\"nodes\": [\n";
+			json << "  { \"mesh\": 0, \"skin\": 0 },\n";
+			json << "  { \"name\": \"Root\", \"children\": [ 2 ] },\n";
+			json << "  { \"name\": \"Child\", \"translation\": [ 0.0, 1.0, 0.0 ] }\n],\n";
+			json << "\"meshes\": [ { \"primitives\": [ { \"attributes\": { \"POSITION\": 0 }, \"indices\": 1 } ] } ],\n";
+			json << "\"skins\": [ { \"joints\": [ 1, 2 ], \"skeleton\": 1 } ],\n";
+			json << "\"animations\": [ { \"name\": \"Clip\",\n";
+			json << "  \"samplers\": [ { \"input\": 2, \"output\": 3 }, { \"input\": 2, \"output\": 4 } ],\n";
+			json << "  \"channels\": [ { \"sampler\": 0, \"target\": { \"node\": 1, \"path\": \"translation\" } }, ";
+			json << "{ \"sampler\": 1, \"target\": { \"node\": 2, \"path\": \"rotation\" } } ] } ],\n";
+			json << "\"buffers\": [ { \"uri\": \"CompressionTest.bin\", \"byteLength\": " << m_Buffer.size() << " } ],\n";
+			json << "\"bufferViews\": [\n  " << Join(m_BufferViews) << "\n],\n";
+			json << "\"accessors\": [\n  " << Join(m_Accessors) << "\n]\n}\n";
+
+			std::filesystem::path filename = directory / "CompressionTest.gltf";
+			std::ofstream(filename) << json.str();
+			return filename.string();
+		}
+
+	private:
+		static std::string Join(const std::vector<std::string>& values)
+		{
+			std::string result;
+			for (size_t i = 0; i < values.size(); i++)
+				result += (i > 0 ? ",\n  " : "") + values[i];
+			return result;
+		}
+	};
+
+	std::string WriteTestGltf()
+	{
+		constexpr int FloatType = 5126;
+		constexpr int UintType = 5125;
+
+		TestGltfWriter writer;
+		float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+		uint32_t indices[] = { 0, 1, 2 };
+		writer.AddAccessor(positions, sizeof(positions), FloatType, 3, "VEC3", ", \"min\": [ 0, 0, 0 ], \"max\": [ 1, 1, 0 ]");
+		writer.AddAccessor(indices, sizeof(indices), UintType, 3, "SCALAR");
+
+		std::vector<float> times;
+		std::vector<float> translations;
+		std::vector<float> rotations;
+		for (int key = 0; key < KeyCount; key++)
+		{
+			float time = GetKeyTime(key);
+			glm::vec3 translation = GetSourceTranslation(time);
+			glm::quat orientation = GetSourceOrientation(time);
+			times.push_back(time);
+			translations.insert(translations.end(), { translation.x, translation.y, translation.z });
+			// glTF stores quaternions as xyzw
+			rotations.insert(rotations.end(), { orientation.x, orientation.y, orientation.z, orientation.w });
+		}
+		writer.AddAccessor(times.data(), times.size() * sizeof(float), FloatType, KeyCount, "SCALAR",
+			", \"min\": [ 0.0 ], \"max\": [ " + std::to_string(ClipLength) + " ]");
+		writer.AddAccessor(translations.data(), translations.size() * sizeof(float), FloatType, KeyCount, "VEC3");
+		writer.AddAccessor(rotations.data(), rotations.size() * sizeof(float), FloatType, KeyCount, "VEC4");
+		return writer.Write(std::filesystem::temp_directory_path());
+	}
+
+}
+
+// Samples the decoded tracks at every key of the file and compares them to the values that were written
+FORGE_TEST(CompressedGltfTracksStayWithinTolerance)
+{
+	std::string filename = WriteTestGltf();
+
+	AnimationCompressionSettings fine;
+	AnimationCompressionSettings coarse;
+	coarse.TranslationTolerance = 0.01f;
+	coarse.OrientationTolerance = 0.02f;
+	size_t previousKeyCount = 0;
+	for (const AnimationCompressionSettings& settings : { fine, coarse })
+	{
+		GltfReader reader(filename, settings);
+		FORGE_CHECK(reader.HasAnimation("Clip"));
+		if (!reader.HasAnimation("Clip"))
+			return;
+		const Ref<Animation>& animation = reader.GetAnimation("Clip");
+		FORGE_CHECK(animation->GetJointCount() == 2);
+		if (animation->GetJointCount() != 2)
+			return;
+		// Joint ids follow the order of skin.joints
+		const JointAnimation& root = animation->Joints[0];
+		const JointAnimation& child = animation->Joints[1];
+		FORGE_CHECK_NEAR(animation->GetLength(), ClipLength, 1e-6f);
+
+		// A looser tolerance must drop more keys
+		size_t keyCount = root.Translation.TimeStamps.size() + child.Orientation.TimeStamps.size();
+		FORGE_CHECK(keyCount <= size_t(KeyCount) * 2);
+		if (previousKeyCount > 0)
+			FORGE_CHECK(keyCount < previousKeyCount);
+		previousKeyCount = keyCount;
+
+		float translationError = 0.0f;
+		float orientationError = 0.0f;
+		uint32_t translationCursor = 0;
+		uint32_t orientationCursor = 0;
+		for (int key = 0; key < KeyCount; key++)
+		{
+			float time = GetKeyTime(key);
+			glm::vec3 translation = SampleTrack(root.Translation, time, translationCursor);
+			glm::quat orientation = SampleTrack(child.Orientation, time, orientationCursor);
+			translationError = std::max(translationError, glm::length(translation - GetSourceTranslation(time)));
+			orientationError = std::max(orientationError, AngleBetween(orientation, GetSourceOrientation(time)));
+		}
+		FORGE_CHECK(translationError <= settings.TranslationTolerance);
+		FORGE_CHECK(orientationError <= settings.OrientationTolerance);
+
+		// Channels missing from the file are a single key of the node's rest pose
+		uint32_t cursor = 0;
+		FORGE_CHECK(child.Translation.TimeStamps.size() == 1);
+		FORGE_CHECK(glm::length(SampleTrack(child.Translation, 1.0f, cursor) - glm::vec3{ 0.0f, 1.0f, 0.0f }) <= settings.TranslationTolerance);
+		FORGE_CHECK(root.Orientation.TimeStamps.size() == 1);
+		FORGE_CHECK(AngleBetween(SampleTrack(root.Orientation, 1.0f, cursor), glm::quat(1.0f, 0.0f, 0.0f, 0.0f)) <= settings.OrientationTolerance);
+	}
+}
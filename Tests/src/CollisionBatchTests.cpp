@@ -0,0 +1,384 @@
+#include "TestFramework.h"
+
+#include <random>
+#include <set>
+
+using namespace Forge;
+
+namespace
+{
+
+	using OBBPair = std::pair<OBB, OBB>;
+
+	OBB CreateBox(const glm::vec3& center, const glm::vec3& dimensions, const glm::quat& rotation = { 1.0f, 0.0f, 0.0f, 0.0f })
+	{
+		return CreateOBB(dimensions, glm::translate(glm::mat4(1.0f), center) * glm::toMat4(rotation));
+	}
+
+	// Boxes whose faces, edges or corners exactly touch are intersecting, moving them slightly apart separates them.
+	// The rotated box is placed just inside and just outside the face of the other
+	void AddTouchingPairs(std::vector<OBBPair>& pairs)
+	{
+		glm::vec3 unit = { 1.0f, 1.0f, 1.0f };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			glm::vec3 offset(0.0f);
+			offset[axis] = 1.0f;
+			pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox(offset, unit) });
+			pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox(offset * 1.0625f, unit) });
+		}
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 1.0f, 1.0f, 0.0f }, unit) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 1.0f, 1.0f, 1.0f }, unit) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 1.0f, 1.0f, 1.0625f }, unit) });
+		glm::quat diagonal = glm::angleAxis(PI / 4.0f, glm::vec3{ 0.0f, 0.0f, 1.0f });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 1.0f, 0.0f, 0.0f }, unit, diagonal) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 1.25f, 0.0f, 0.0f }, unit, diagonal) });
+	}
+
+	// Flat and point boxes have zero extents and parallel boxes make every cross product axis zero
+	void AddDegeneratePairs(std::vector<OBBPair>& pairs)
+	{
+		glm::vec3 unit = { 1.0f, 1.0f, 1.0f };
+		glm::vec3 point(0.0f);
+		glm::vec3 flat = { 1.0f, 1.0f, 0.0f };
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox(glm::vec3(0.0f), unit) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), point), CreateBox(glm::vec3(0.0f), point) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), point), CreateBox({ 0.5f, 0.0f, 0.0f }, point) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 0.5f, 0.5f, 0.5f }, point) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit), CreateBox({ 0.75f, 0.0f, 0.0f }, point) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), flat), CreateBox({ 0.0f, 0.0f, 0.5f }, unit) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), flat), CreateBox({ 0.0f, 0.0f, 0.75f }, unit) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), flat), CreateBox(glm::vec3(0.0f), flat) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), flat), CreateBox({ 0.0f, 0.0f, 0.25f }, flat) });
+		pairs.push_back({ CreateBox(glm::vec3(0.0f), unit, glm::angleAxis(1.0f, glm::vec3{ 0.0f, 1.0f, 0.0f })),
+		  CreateBox({ 0.0f, 0.0f, 3.0f }, unit, glm::angleAxis(1.0f, glm::vec3{ 0.0f, 1.0f, 0.0f })) });
+	}
+
+	BoundingBox CreateAABB(const glm::vec3& center, const glm::vec3& halfSize)
+	{
+		BoundingBox box;
+		box.Min = center - halfSize;
+		box.Max = center + halfSize;
+		return box;
+	}
+
+	// Random boxes followed by boxes that exactly touch the first one on a face, an edge and a corner, and a flat box
+	std::vector<BoundingBox> CreateRandomAABBs(std::mt19937& engine, size_t count, float range)
+	{
+		std::uniform_real_distribution<float> position(-range, range);
+		std::uniform_real_distribution<float> size(0.05f, 2.0f);
+		std::vector<BoundingBox> boxes;
+		for (size_t i = 0; i < count; i++)
+			boxes.push_back(CreateAABB({ position(engine), position(engine), position(engine) }, { size(engine), size(engine), size(engine) }));
+		glm::vec3 unit = { 0.5f, 0.5f, 0.5f };
+		boxes.push_back(CreateAABB(glm::vec3(0.0f), unit));
+		boxes.push_back(CreateAABB({ 1.0f, 0.0f, 0.0f }, unit));
+		boxes.push_back(CreateAABB({ 1.0f, 1.0f, 0.0f }, unit));
+		boxes.push_back(CreateAABB({ 1.0f, 1.0f, 1.0f }, unit));
+		boxes.push_back(CreateAABB({ 0.0f, 0.0f, 1.0f }, { 0.5f, 0.5f, 0.0f }));
+		return boxes;
+	}
+
+	FrustumPlanes CreateFrustum(const glm::vec3& position, float yaw, bool perspective)
+	{
+		glm::mat4 projection = perspective ? glm::perspective(PI / 3.0f, 1.5f, 0.1f, 20.0f) : glm::ortho(-4.0f, 4.0f, -3.0f, 3.0f, 0.1f, 20.0f);
+		glm::mat4 view = glm::rotate(glm::mat4(1.0f), -yaw, glm::vec3{ 0.0f, 1.0f, 0.0f }) * glm::translate(glm::mat4(1.0f), -position);
+		return FrustumPlanes(projection * view);
+	}
+
+	// Directions along the axes have infinite inverse components, which the slab tests have to handle
+	std::vector<Ray> CreateRandomRays(std::mt19937& engine, size_t count, float range)
+	{
+		std::uniform_real_distribution<float> position(-range, range);
+		std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+		std::vector<Ray> rays;
+		for (size_t i = 0; i < count; i++)
+		{
+			Ray ray;
+			ray.Origin = { position(engine), position(engine), position(engine) };
+			ray.Direction = { direction(engine), direction(engine), direction(engine) };
+			if (i % 4 == 1)
+				ray.Direction[i % 3] = 0.0f;
+			else if (i % 4 == 2)
+				ray.Direction = glm::vec3(0.0f);
+			if (i % 4 == 2)
+				ray.Direction[i % 3] = 1.0f;
+			rays.push_back(ray);
+		}
+		return rays;
+	}
+
+	void AddRandomPairs(std::vector<OBBPair>& pairs, size_t count)
+	{
+		std::mt19937 engine(42);
+		std::uniform_real_distribution<float> position(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> size(0.1f, 2.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 2.0f * PI);
+		auto createBox = [&]()
+		{
+			glm::vec3 axis = { position(engine), position(engine), position(engine) };
+			glm::quat rotation = glm::length(axis) > 0.0f ? glm::angleAxis(angle(engine), glm::normalize(axis)) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			return CreateBox({ position(engine), position(engine), position(engine) }, { size(engine), size(engine), size(engine) }, rotation);
+		};
+		for (size_t i = 0; i < count; i++)
+		{
+			OBB first = createBox();
+			pairs.push_back({ first, createBox() });
+		}
+	}
+
+}
+
+// The batched separating axis test must give exactly the result of TestOBBIntersection() for every lane,
+// both when testing lanes against each other and when testing one box against a whole batch
+FORGE_TEST(CollisionBatchMatchesScalarOBBTest)
+{
+	std::vector<OBBPair> pairs;
+	AddTouchingPairs(pairs);
+	AddDegeneratePairs(pairs);
+	AddRandomPairs(pairs, 512);
+
+	int collisionCount = 0;
+	for (size_t first = 0; first < pairs.size(); first += CollisionBatchWidth)
+	{
+		size_t count = std::min(CollisionBatchWidth, pairs.size() - first);
+		OBBBatch a;
+		OBBBatch b;
+		uint32_t expected = 0;
+		for (size_t lane = 0; lane < CollisionBatchWidth; lane++)
+		{
+			if (lane < count)
+			{
+				const OBBPair& pair = pairs[first + lane];
+				a.Set(lane, pair.first);
+				b.Set(lane, pair.second);
+				if (TestOBBIntersection(pair.first, pair.second).Collision)
+					expected |= 1u << lane;
+			}
+			else
+			{
+				a.Clear(lane);
+				b.Clear(lane);
+			}
+		}
+		FORGE_CHECK(TestOBBIntersections(a, b) == expected);
+
+		for (size_t lane = 0; lane < count; lane++)
+		{
+			const OBB& box = pairs[first + lane].first;
+			uint32_t expectedWithBox = 0;
+			for (size_t other = 0; other < count; other++)
+			{
+				if (TestOBBIntersection(box, pairs[first + other].second).Collision)
+					expectedWithBox |= 1u << other;
+			}
+			FORGE_CHECK(TestOBBIntersections(box, b) == expectedWithBox);
+		}
+		for (size_t lane = 0; lane < count; lane++)
+			collisionCount += (expected >> lane) & 1;
+	}
+	// Both outcomes have to be covered for the comparison to mean anything
+	FORGE_CHECK(collisionCount > 0);
+	FORGE_CHECK(collisionCount < int(pairs.size()));
+}
+
+// The batched AABB tests must agree with BoundingBox::Intersects() for one box against a batch and lane by lane
+FORGE_TEST(CollisionBatchMatchesScalarAABBTest)
+{
+	std::mt19937 engine(7);
+	std::vector<BoundingBox> boxes = CreateRandomAABBs(engine, 256, 4.0f);
+	int intersectionCount = 0;
+	for (size_t first = 0; first < boxes.size(); first += CollisionBatchWidth)
+	{
+		size_t count = std::min(CollisionBatchWidth, boxes.size() - first);
+		AABBBatch batch;
+		AABBBatch shifted;
+		uint32_t expectedLanes = 0;
+		for (size_t lane = 0; lane < count; lane++)
+		{
+			batch.Set(lane, boxes[first + lane]);
+			const BoundingBox& other = boxes[(first + lane + 1) % boxes.size()];
+			shifted.Set(lane, other);
+			if (boxes[first + lane].Intersects(other))
+				expectedLanes |= 1u << lane;
+		}
+		FORGE_CHECK(TestAABBIntersections(batch, shifted) == expectedLanes);
+
+		for (const BoundingBox& box : boxes)
+		{
+			uint32_t expected = 0;
+			for (size_t lane = 0; lane < count; lane++)
+			{
+				if (box.Intersects(boxes[first + lane]))
+					expected |= 1u << lane;
+			}
+			FORGE_CHECK(TestAABBIntersections(box, batch) == expected);
+			intersectionCount += int(expected != 0);
+		}
+	}
+	FORGE_CHECK(intersectionCount > 0);
+}
+
+// The batched frustum test must agree with FrustumPlanes::Intersects() for perspective and orthographic frustums
+FORGE_TEST(CollisionBatchMatchesScalarFrustumTest)
+{
+	std::mt19937 engine(11);
+	std::vector<BoundingBox> boxes = CreateRandomAABBs(engine, 512, 12.0f);
+	std::vector<FrustumPlanes> frustums = {
+		CreateFrustum({ 0.0f, 0.0f, 10.0f }, 0.0f, true),
+		CreateFrustum({ 2.0f, 1.0f, 0.0f }, PI / 4.0f, true),
+		CreateFrustum({ 0.0f, 0.0f, 10.0f }, 0.0f, false),
+		CreateFrustum({ -3.0f, 0.0f, -2.0f }, PI * 0.75f, false),
+	};
+	int insideCount = 0;
+	for (const FrustumPlanes& frustum : frustums)
+	{
+		for (size_t first = 0; first < boxes.size(); first += CollisionBatchWidth)
+		{
+			size_t count = std::min(CollisionBatchWidth, boxes.size() - first);
+			AABBBatch batch;
+			uint32_t expected = 0;
+			for (size_t lane = 0; lane < count; lane++)
+			{
+				batch.Set(lane, boxes[first + lane]);
+				if (frustum.Intersects(boxes[first + lane]))
+					expected |= 1u << lane;
+			}
+			uint32_t result = TestFrustumIntersections(frustum, batch);
+			FORGE_CHECK(result == expected);
+			for (size_t lane = 0; lane < count; lane++)
+				insideCount += (expected >> lane) & 1;
+		}
+	}
+	FORGE_CHECK(insideCount > 0);
+	FORGE_CHECK(insideCount < int(frustums.size() * boxes.size()));
+}
+
+// The batched slab test must agree with IntersectsRay() on both the result and the entry distance of every hit
+FORGE_TEST(CollisionBatchMatchesScalarRayTest)
+{
+	std::mt19937 engine(13);
+	std::vector<BoundingBox> boxes = CreateRandomAABBs(engine, 64, 4.0f);
+	std::vector<Ray> rays = CreateRandomRays(engine, 256, 6.0f);
+	int hitCount = 0;
+	for (const Ray& ray : rays)
+	{
+		glm::vec3 inverseDirection = 1.0f / ray.Direction;
+		for (float maxDistance : { 2.0f, 100.0f })
+		{
+			for (size_t first = 0; first < boxes.size(); first += CollisionBatchWidth)
+			{
+				size_t count = std::min(CollisionBatchWidth, boxes.size() - first);
+				AABBBatch batch;
+				uint32_t expected = 0;
+				float expectedDistances[CollisionBatchWidth] = {};
+				for (size_t lane = 0; lane < count; lane++)
+				{
+					batch.Set(lane, boxes[first + lane]);
+					if (IntersectsRay(boxes[first + lane], ray, inverseDirection, maxDistance, expectedDistances[lane]))
+						expected |= 1u << lane;
+				}
+				float distances[CollisionBatchWidth];
+				FORGE_CHECK(TestRayIntersections(ray, inverseDirection, maxDistance, batch, distances) == expected);
+				for (size_t lane = 0; lane < count; lane++)
+				{
+					if (expected & (1u << lane))
+					{
+						FORGE_CHECK(distances[lane] == expectedDistances[lane]);
+						hitCount++;
+					}
+				}
+			}
+		}
+	}
+	FORGE_CHECK(hitCount > 0);
+}
+
+// DynamicBvh tests whole batches of nodes while it descends, every query must still find exactly the proxies whose fat
+// bounds pass the scalar test
+FORGE_TEST(DynamicBvhBatchedQueriesMatchBruteForce)
+{
+	std::mt19937 engine(17);
+	std::vector<BoundingBox> boxes = CreateRandomAABBs(engine, 300, 20.0f);
+	DynamicBvh tree;
+	std::vector<int32_t> proxies;
+	for (size_t i = 0; i < boxes.size(); i++)
+		proxies.push_back(tree.CreateProxy(boxes[i], uint32_t(i)));
+	auto getBounds = [&tree, &proxies](uint32_t index) { return tree.GetFatBounds(proxies[index]); };
+
+	for (const BoundingBox& box : CreateRandomAABBs(engine, 16, 20.0f))
+	{
+		std::set<uint32_t> expected;
+		for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+		{
+			if (getBounds(i).Intersects(box))
+				expected.insert(i);
+		}
+		std::set<uint32_t> result;
+		tree.QueryBox(box, [&result](uint32_t index) { result.insert(index); });
+		FORGE_CHECK(result == expected);
+	}
+
+	FrustumPlanes frustum = CreateFrustum({ 0.0f, 0.0f, 25.0f }, 0.0f, true);
+	std::set<uint32_t> expectedVisible;
+	for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+	{
+		if (frustum.Intersects(getBounds(i)))
+			expectedVisible.insert(i);
+	}
+	std::set<uint32_t> visible;
+	tree.QueryFrustum(frustum, [&visible](uint32_t index) { visible.insert(index); });
+	FORGE_CHECK(visible == expectedVisible);
+	FORGE_CHECK(!visible.empty());
+
+	std::set<std::pair<uint32_t, uint32_t>> expectedPairs;
+	for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+	{
+		for (uint32_t j = i + 1; j < uint32_t(boxes.size()); j++)
+		{
+			if (getBounds(i).Intersects(getBounds(j)))
+				expectedPairs.insert({ i, j });
+		}
+	}
+	std::set<std::pair<uint32_t, uint32_t>> pairs;
+	int pairCount = 0;
+	tree.QueryPairs([&pairs, &pairCount](uint32_t a, uint32_t b) {
+		pairs.insert({ std::min(a, b), std::max(a, b) });
+		pairCount++;
+	});
+	FORGE_CHECK(pairs == expectedPairs);
+	FORGE_CHECK(pairCount == int(expectedPairs.size()));
+
+	// Without clipping every box along the ray is reported, with clipping the closest box must still be found
+	for (const Ray& ray : CreateRandomRays(engine, 32, 20.0f))
+	{
+		glm::vec3 inverseDirection = 1.0f / ray.Direction;
+		std::set<uint32_t> expectedHits;
+		float closestDistance = std::numeric_limits<float>::max();
+		for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+		{
+			float distance;
+			if (IntersectsRay(getBounds(i), ray, inverseDirection, 50.0f, distance))
+			{
+				expectedHits.insert(i);
+				closestDistance = std::min(closestDistance, distance);
+			}
+		}
+		std::set<uint32_t> hits;
+		tree.Raycast(ray, 50.0f, [&hits](uint32_t index, float maxDistance) {
+			hits.insert(index);
+			return maxDistance;
+		});
+		FORGE_CHECK(hits == expectedHits);
+
+		float closest = std::numeric_limits<float>::max();
+		tree.Raycast(ray, 50.0f, [&](uint32_t index, float maxDistance) {
+			float distance;
+			if (!IntersectsRay(getBounds(index), ray, inverseDirection, maxDistance, distance))
+				return maxDistance;
+			closest = std::min(closest, distance);
+			return distance;
+		});
+		FORGE_CHECK(closest == closestDistance);
+	}
+}
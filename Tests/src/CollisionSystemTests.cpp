@@ -0,0 +1,58 @@
+#include "TestFramework.h"
+
+using namespace Forge;
+
+namespace
+{
+
+	Entity CreateBox(Scene& scene, const glm::vec3& position)
+	{
+		Entity entity = scene.CreateEntity();
+		entity.GetTransform().SetLocalPosition(position);
+		entity.AddComponent<AabbColliderComponent>().Dimensions = { 1.0f, 1.0f, 1.0f };
+		return entity;
+	}
+
+}
+
+// Colliders are only read again once their transform or component changes. Moving a collider through its parent, resizing it,
+// and replacing a destroyed collider with an entity that reuses its identifier must all be picked up by the next update
+FORGE_TEST(CollisionSystemFollowsChangedColliders)
+{
+	Scene scene(nullptr, nullptr);
+	CollisionSystem& collisions = scene.GetCollisionSystem();
+	const SpatialIndex& index = scene.GetSpatialIndex();
+	int beganCount = 0;
+	int endedCount = 0;
+	collisions.OnContactBegin.AddEventListener([&beganCount](const ContactEvent&) { beganCount++; return false; });
+	collisions.OnContactEnd.AddEventListener([&endedCount](const ContactEvent&) { endedCount++; return false; });
+
+	Entity parent = scene.CreateEntity();
+	CreateBox(scene, { 0.0f, 0.0f, 0.0f });
+	Entity b = CreateBox(scene, { 3.0f, 0.0f, 0.0f });
+	b.GetTransform().SetParent(&parent.GetTransform());
+	scene.OnUpdate(0.0f);
+	FORGE_CHECK(beganCount == 0);
+	FORGE_CHECK(index.GetEntityCount(SpatialCategory::Collider) == 2);
+
+	parent.GetTransform().SetLocalPosition({ -2.1f, 0.0f, 0.0f });
+	scene.OnUpdate(0.0f);
+	FORGE_CHECK(beganCount == 1);
+
+	b.GetComponent<AabbColliderComponent>().Dimensions = { 0.2f, 0.2f, 0.2f };
+	scene.OnUpdate(0.0f);
+	FORGE_CHECK(endedCount == 1);
+
+	scene.DestroyEntity(b);
+	Entity c = CreateBox(scene, { 0.5f, 0.0f, 0.0f });
+	scene.OnUpdate(0.0f);
+	FORGE_CHECK(beganCount == 2);
+	FORGE_CHECK(collisions.GetColliderCount() == 2);
+	FORGE_CHECK(index.GetEntityCount(SpatialCategory::Collider) == 2);
+
+	c.SetEnabled(false);
+	scene.OnUpdate(0.0f);
+	FORGE_CHECK(endedCount == 2);
+	FORGE_CHECK(collisions.GetColliderCount() == 1);
+	FORGE_CHECK(index.GetEntityCount(SpatialCategory::Collider) == 1);
+}
@@ -0,0 +1,128 @@
+#include "TestFramework.h"
+
+using namespace Forge;
+
+namespace
+{
+
+	// Program, vertex array and framebuffer bound when a draw was recorded
+	struct RecordedDraw
+	{
+	public:
+		RecordedCommand Command;
+		uint32_t VertexArray = 0;
+		uint32_t Framebuffer = 0;
+		// Whether the model matrix was set on the program since it was bound
+		bool ModelMatrixSet = false;
+	};
+
+	std::vector<RecordedDraw> FindDraws(const RecordingRenderBackend& backend, uint32_t& clearedFramebuffer)
+	{
+		std::vector<RecordedDraw> draws;
+		uint32_t vertexArray = 0;
+		uint32_t framebuffer = 0;
+		bool modelMatrixSet = false;
+		clearedFramebuffer = 0;
+		for (const RecordedCommand& command : backend.GetCommands())
+		{
+			switch (command.Type)
+			{
+			case RecordedCommandType::BindVertexArray:
+				vertexArray = command.Handle;
+				break;
+			case RecordedCommandType::BindFramebuffer:
+				framebuffer = command.Handle;
+				break;
+			case RecordedCommandType::UseProgram:
+				modelMatrixSet = false;
+				break;
+			case RecordedCommandType::SetUniform:
+				if (backend.GetUniformName(command.Handle, int(command.Target)) == ModelMatrixUniformName)
+					modelMatrixSet = true;
+				break;
+			case RecordedCommandType::Clear:
+				if (draws.empty())
+					clearedFramebuffer = framebuffer;
+				break;
+			case RecordedCommandType::Draw:
+				draws.push_back({ command, vertexArray, framebuffer, modelMatrixSet });
+				break;
+			default:
+				break;
+			}
+		}
+		return draws;
+	}
+
+}
+
+// Renders three cubes sharing a material and a sphere headless. The cubes must become a single instanced draw and the sphere a
+// plain draw with its model matrix set, each with its own vertex array bound, into the framebuffer that was cleared for the camera
+FORGE_TEST(RendererRecordsSceneDrawCalls)
+{
+	RecordingRenderBackend& backend = Tests::GetRecordingBackend();
+	FramebufferProps props;
+	props.Width = 64;
+	props.Height = 64;
+	props.Attachments = { FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::Depth };
+	Ref<Framebuffer> framebuffer = Framebuffer::Create(props);
+	Renderer3D renderer;
+	Scene scene(framebuffer, &renderer);
+
+	Entity camera = scene.CreateCamera(Frustum::Perspective(PI / 3.0f, framebuffer->GetAspect(), 0.1f, 100.0f));
+	camera.GetComponent<TransformComponent>().SetLocalPosition({ 0.0f, 0.0f, 10.0f });
+	CameraComponent& cameraComponent = camera.GetComponent<CameraComponent>();
+	cameraComponent.Viewport = framebuffer->GetViewport();
+	cameraComponent.UsePostProcessing = false;
+
+	Ref<Mesh> cube = GraphicsCache::CubeMesh();
+	Ref<Model> cubeModel = Model::Create(cube, GraphicsCache::DefaultColorMaterial(COLOR_WHITE));
+	for (int i = 0; i < 3; i++)
+	{
+		Entity entity = scene.CreateEntity();
+		entity.GetTransform().SetLocalPosition({ 2.0f * (i - 1), 0.0f, 0.0f });
+		entity.AddComponent<ModelRendererComponent>(cubeModel);
+	}
+	Ref<Mesh> sphere = GraphicsCache::SphereMesh();
+	Entity sphereEntity = scene.CreateEntity();
+	sphereEntity.GetTransform().SetLocalPosition({ 0.0f, 2.0f, 0.0f });
+	sphereEntity.AddComponent<ModelRendererComponent>(Model::Create(sphere, GraphicsCache::DefaultColorMaterial(COLOR_RED)));
+
+	backend.Reset();
+	scene.OnUpdate(0.0f);
+	RendererStats stats = renderer.GetStats();
+	DynamicVertexBuffer::EndFrame();
+	renderer.Flush();
+
+	uint32_t clearedFramebuffer;
+	std::vector<RecordedDraw> draws = FindDraws(backend, clearedFramebuffer);
+	FORGE_CHECK(draws.size() == 2);
+	FORGE_CHECK(backend.GetStats().DrawCount == stats.DrawCount);
+	FORGE_CHECK(backend.GetStats().ClearCount > 0);
+	FORGE_CHECK(clearedFramebuffer != 0);
+
+	const RecordedDraw* cubeDraw = nullptr;
+	const RecordedDraw* sphereDraw = nullptr;
+	for (const RecordedDraw& draw : draws)
+	{
+		FORGE_CHECK(draw.Command.Handle != 0);
+		FORGE_CHECK(draw.Framebuffer == clearedFramebuffer);
+		if (draw.VertexArray == cube->GetVertices()->GetId())
+			cubeDraw = &draw;
+		else if (draw.VertexArray == sphere->GetVertices()->GetId())
+			sphereDraw = &draw;
+	}
+	FORGE_CHECK(cubeDraw != nullptr);
+	FORGE_CHECK(sphereDraw != nullptr);
+	if (cubeDraw && sphereDraw)
+	{
+		FORGE_CHECK(cubeDraw->Command.Count == 3);
+		FORGE_CHECK(cubeDraw->Command.Size == cube->GetVertices()->GetIndexCount());
+		FORGE_CHECK(sphereDraw->Command.Count == 1);
+		FORGE_CHECK(sphereDraw->Command.Size == sphere->GetVertices()->GetIndexCount());
+		FORGE_CHECK(sphereDraw->ModelMatrixSet);
+		// The instanced variant of the shader takes the model matrix from the instance buffer instead
+		FORGE_CHECK(cubeDraw->Command.Handle != sphereDraw->Command.Handle);
+	}
+	FORGE_CHECK(stats.InstancedCount == 3);
+}
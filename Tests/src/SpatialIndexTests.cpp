@@ -0,0 +1,73 @@
+#include "TestFramework.h"
+
+using namespace Forge;
+
+namespace
+{
+
+	BoundingBox CreateBox(const glm::vec3& center)
+	{
+		BoundingBox box;
+		box.Min = center - glm::vec3(0.5f);
+		box.Max = center + glm::vec3(0.5f);
+		return box;
+	}
+
+	bool ContainsEntity(const SpatialIndex& index, const BoundingBox& box, entt::entity entity)
+	{
+		bool found = false;
+		index.QueryBox(SpatialCategory::Collider, box, [&found, entity](entt::entity result) { found |= result == entity; });
+		return found;
+	}
+
+}
+
+// An entity that moves and then loses its bounds in the same update frees its tree node while the move is still queued.
+// The node is reused by the next new proxy, which must keep its own bounds. Run with few and many moving entities among
+// static ones so that EndUpdate() takes both the reinsert and the refit path
+FORGE_TEST(SpatialIndexDropsMovesOfClearedBounds)
+{
+	constexpr int staticCount = 64;
+	for (int movingCount : { 2, 64 })
+	{
+		entt::registry registry;
+		SpatialIndex index;
+		std::vector<entt::entity> statics;
+		std::vector<entt::entity> moving;
+		for (int i = 0; i < staticCount; i++)
+			statics.push_back(registry.create());
+		for (int i = 0; i < movingCount; i++)
+			moving.push_back(registry.create());
+
+		index.BeginUpdate();
+		for (int i = 0; i < staticCount; i++)
+			index.Update(SpatialCategory::Collider, statics[i], CreateBox({ float(i) * 10.0f, 50.0f, 0.0f }));
+		for (int i = 0; i < movingCount; i++)
+			index.Update(SpatialCategory::Collider, moving[i], CreateBox({ float(i) * 10.0f, 0.0f, 0.0f }));
+		index.EndUpdate();
+
+		entt::entity cleared = moving[0];
+		entt::entity added = registry.create();
+		index.BeginUpdate();
+		for (int i = 0; i < staticCount; i++)
+			index.Update(SpatialCategory::Collider, statics[i], CreateBox({ float(i) * 10.0f, 50.0f, 0.0f }));
+		for (int i = 0; i < movingCount; i++)
+			index.Update(SpatialCategory::Collider, moving[i], CreateBox({ float(i) * 10.0f, 5.0f, 0.0f }));
+		index.Update(SpatialCategory::Collider, cleared, BoundingBox());
+		index.Update(SpatialCategory::Collider, added, CreateBox({ 0.0f, -100.0f, 0.0f }));
+		index.EndUpdate();
+
+		FORGE_CHECK(index.GetEntityCount(SpatialCategory::Collider) == uint32_t(staticCount + movingCount + 1));
+		// Unbounded entities are returned by every query
+		FORGE_CHECK(ContainsEntity(index, CreateBox({ 1000.0f, 0.0f, 0.0f }), cleared));
+		FORGE_CHECK(ContainsEntity(index, CreateBox({ 0.0f, -100.0f, 0.0f }), added));
+		FORGE_CHECK(!ContainsEntity(index, CreateBox({ 0.0f, 5.0f, 0.0f }), added));
+		for (int i = 1; i < movingCount; i++)
+		{
+			FORGE_CHECK(ContainsEntity(index, CreateBox({ float(i) * 10.0f, 5.0f, 0.0f }), moving[i]));
+			FORGE_CHECK(!ContainsEntity(index, CreateBox({ float(i) * 10.0f, -5.0f, 0.0f }), moving[i]));
+		}
+		for (int i = 0; i < staticCount; i++)
+			FORGE_CHECK(ContainsEntity(index, CreateBox({ float(i) * 10.0f, 50.0f, 0.0f }), statics[i]));
+	}
+}
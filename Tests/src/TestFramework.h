@@ -0,0 +1,57 @@
+#pragma once
+#include "Forge.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Forge::Tests
+{
+
+	struct TestCase
+	{
+	public:
+		const char* Name;
+		void (*Run)();
+	};
+
+	// Every test registered with FORGE_TEST, in the order their files were initialized
+	std::vector<TestCase>& GetTestCases();
+	// Number of failed checks in the test that is running
+	int& GetFailureCount();
+	// Shared by all tests, GL calls made by a test go through it. Reset() it before recording
+	RecordingRenderBackend& GetRecordingBackend();
+
+	struct TestRegistrar
+	{
+	public:
+		inline TestRegistrar(const char* name, void (*run)())
+		{
+			GetTestCases().push_back({ name, run });
+		}
+	};
+
+	inline void ReportFailure(const char* file, int line, const std::string& message)
+	{
+		std::cout << "  " << file << "(" << line << "): " << message << std::endl;
+		GetFailureCount()++;
+	}
+
+}
+
+#define FORGE_TEST(name) \
+	static void name(); \
+	static ::Forge::Tests::TestRegistrar s_##name##Registrar(#name, name); \
+	static void name()
+
+// Failed checks are reported and the test carries on
+#define FORGE_CHECK(condition) \
+	do { if (!(condition)) ::Forge::Tests::ReportFailure(__FILE__, __LINE__, "Check failed: " #condition); } while (false)
+
+#define FORGE_CHECK_NEAR(value, expected, tolerance) \
+	do { \
+		double forgeValue = double(value), forgeExpected = double(expected); \
+		if (!(std::abs(forgeValue - forgeExpected) <= double(tolerance))) \
+			::Forge::Tests::ReportFailure(__FILE__, __LINE__, "Check failed: " #value " = " + std::to_string(forgeValue) + \
+				", expected " + std::to_string(forgeExpected) + " +- " + std::to_string(double(tolerance))); \
+	} while (false)
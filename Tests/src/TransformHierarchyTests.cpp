@@ -0,0 +1,69 @@
+#include "TestFramework.h"
+
+using namespace Forge;
+
+namespace
+{
+
+	float MaxDifference(const glm::mat4& a, const glm::mat4& b)
+	{
+		float result = 0.0f;
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+				result = std::max(result, std::abs(a[column][row] - b[column][row]));
+		}
+		return result;
+	}
+
+	glm::mat4 CreateTranslation(const glm::vec3& position)
+	{
+		return glm::translate(glm::mat4(1.0f), position);
+	}
+
+}
+
+// Destroying a node leaves a hole in the depth ordered arrays until the next update removes it. The node count must stay
+// correct once the hole is gone, so that later structural changes reorder the remaining nodes and update their world matrices
+FORGE_TEST(TransformHierarchyUpdatesAfterDestroy)
+{
+	TransformHierarchy hierarchy;
+	glm::quat rotation = { 1.0f, 0.0f, 0.0f, 0.0f };
+	glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
+	TransformId a = hierarchy.Create(nullptr, { 1.0f, 0.0f, 0.0f }, rotation, scale);
+	TransformId b = hierarchy.Create(nullptr, { 0.0f, 2.0f, 0.0f }, rotation, scale);
+	TransformId c = hierarchy.Create(nullptr, { 0.0f, 0.0f, 3.0f }, rotation, scale);
+	hierarchy.Update();
+	FORGE_CHECK(hierarchy.GetNodeCount() == 3);
+
+	hierarchy.Destroy(b);
+	FORGE_CHECK(hierarchy.GetNodeCount() == 2);
+	hierarchy.Update();
+	FORGE_CHECK(hierarchy.GetNodeCount() == 2);
+
+	// The freed identifier has not been reused, so the next reorder runs over a hierarchy without holes
+	FORGE_CHECK(hierarchy.SetParent(c, a));
+	hierarchy.Update();
+	FORGE_CHECK(hierarchy.GetNodeCount() == 2);
+	FORGE_CHECK(hierarchy.GetParent(c) == a);
+	FORGE_CHECK_NEAR(MaxDifference(hierarchy.GetWorldMatrix(a), CreateTranslation({ 1.0f, 0.0f, 0.0f })), 0.0f, 1e-5f);
+	FORGE_CHECK_NEAR(MaxDifference(hierarchy.GetWorldMatrix(c), CreateTranslation({ 1.0f, 0.0f, 3.0f })), 0.0f, 1e-5f);
+	FORGE_CHECK_NEAR(MaxDifference(hierarchy.GetInverseWorldMatrix(c), CreateTranslation({ -1.0f, 0.0f, -3.0f })), 0.0f, 1e-5f);
+
+	hierarchy.SetLocalPosition(a, { -1.0f, 0.0f, 0.0f });
+	hierarchy.Update();
+	FORGE_CHECK_NEAR(MaxDifference(hierarchy.GetWorldMatrix(c), CreateTranslation({ -1.0f, 0.0f, 3.0f })), 0.0f, 1e-5f);
+
+	// Children of a destroyed node become roots
+	hierarchy.Destroy(a);
+	hierarchy.Update();
+	FORGE_CHECK(hierarchy.GetNodeCount() == 1);
+	FORGE_CHECK(hierarchy.GetParent(c) == InvalidTransformId);
+	FORGE_CHECK_NEAR(MaxDifference(hierarchy.GetWorldMatrix(c), CreateTranslation({ 0.0f, 0.0f, 3.0f })), 0.0f, 1e-5f);
+
+	TransformId d = hierarchy.Create(nullptr, { 0.0f, 1.0f, 0.0f }, rotation, scale);
+	FORGE_CHECK(hierarchy.SetParent(d, c));
+	hierarchy.Update();
+	FORGE_CHECK(hierarchy.GetNodeCount() == 2);
+	FORGE_CHECK_NEAR(MaxDifference(hierarchy.GetWorldMatrix(d), CreateTranslation({ 0.0f, 1.0f, 3.0f })), 0.0f, 1e-5f);
+}
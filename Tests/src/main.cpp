@@ -0,0 +1,54 @@
+#include "TestFramework.h"
+
+using namespace Forge;
+
+namespace Forge::Tests
+{
+
+	std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> s_TestCases;
+		return s_TestCases;
+	}
+
+	int& GetFailureCount()
+	{
+		static int s_FailureCount = 0;
+		return s_FailureCount;
+	}
+
+	RecordingRenderBackend& GetRecordingBackend()
+	{
+		static RecordingRenderBackend s_Backend;
+		return s_Backend;
+	}
+
+}
+
+// Runs every test, or only those whose name contains the first argument, and returns the number of tests that failed.
+// GL is provided by the recording backend, so no window or GPU is needed
+int main(int argc, char** argv)
+{
+	ForgeInstance::Init();
+
+	GraphicsContext context(Tests::GetRecordingBackend());
+	context.Init();
+	RenderCommand::Init();
+
+	std::string filter = argc > 1 ? argv[1] : "";
+	int failedTests = 0;
+	int testCount = 0;
+	for (const Tests::TestCase& test : Tests::GetTestCases())
+	{
+		if (std::string(test.Name).find(filter) == std::string::npos)
+			continue;
+		Tests::GetFailureCount() = 0;
+		test.Run();
+		bool passed = Tests::GetFailureCount() == 0;
+		std::cout << (passed ? "[PASS] " : "[FAIL] ") << test.Name << std::endl;
+		failedTests += passed ? 0 : 1;
+		testCount++;
+	}
+	std::cout << testCount - failedTests << "/" << testCount << " tests passed" << std::endl;
+	return failedTests;
+}
@@ -29,6 +29,7 @@ SHADER_LIBRARY_FILES = [
     ["Lighting.shader", "Lighting.h"],
     ["Shadows.shader", "Shadows.h"],
     ["Clipping.shader", "Clipping.h"],
+    ["Instancing.shader", "Instancing.h"],
     ["PBRUtils.shader", "PBRUtils.h"],
     ["PBR.shader", "PBR.h"],
     ["Constants.shader", "Constants.h"],
@@ -28,3 +28,5 @@ include ("Editor")
 group ("Sandbox")
 include ("Sandbox")
 include ("MarchingCubes")
+group ("Tests")
+include ("Tests")